@@ -42,6 +42,9 @@ if( NOT HAVE_NAMEINFO )
   compiler_define_if_found( HAVE_NAMEINFO_IN_SOCKET HAVE_NAMEINFO )
 endif()
 
+check_function_exists( sendmmsg HAVE_SENDMMSG )
+compiler_define_if_found( HAVE_SENDMMSG HAVE_SENDMMSG )
+
 check_function_exists( getprotobyname_r HAVE_PROTOR )
 compiler_define_if_found( HAVE_PROTOR HAVE_PROTOR )
 if( NOT HAVE_PROTOR )
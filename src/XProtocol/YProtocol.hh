@@ -88,6 +88,7 @@ enum CmsReqCode            // Request Codes
      kYR_update  = 25,
      kYR_usage   = 26,
      kYR_xauth   = 27,
+     kYR_summary = 28,
      kYR_MaxReq            // Count of request numbers (highest + 1)
 };
 
@@ -200,9 +201,17 @@ struct CmsGoneRequest
 // Request: have <path>
 // Respond: n/a
 //
+// Servers fronting a disk cache (e.g. caching proxies) also encode how much of
+// the file is cached in the CacheLvl bits; zero means the server did not say.
+//
 struct CmsHaveRequest
 {      CmsRRHdr      Hdr;
-       enum          {Online = 1, Pending = 2};  // Modifiers
+       enum          {Online    = 1, Pending = 2,   // Modifiers
+                      CacheLow  = 4,  // Less than half of the file is cached
+                      CacheHalf = 8,  // At least half of the file is cached
+                      CacheFull = 12, // The whole file is cached
+                      CacheLvl  = 12  // Mask for the above
+                     };
 //     kXR_string    Path;
 };
 
@@ -269,6 +278,7 @@ struct CmsLoginData
                   kYR_suspend =   0x00000100,   // Suspended login
                   kYR_nostage =   0x00000200,   // Staging unavailable
                   kYR_trying  =   0x00000400,   // Extensive login retries
+                  kYR_bulkprep=   0x00000800,   // Accepts batched prepadd
                   kYR_debug   =   0x80000000,
                   kYR_share   =   0x7f000000,   // Mask to isolate share
                   kYR_shift   =   24,           // Share shift position
@@ -373,6 +383,11 @@ struct CmsPongRequest {
 // Request: <id> prepadd <reqid> <usr> <prty> <mode> <path>\n
 // Respond: No response.
 //
+// When kYR_batch is set, <path> is a newline separated list of <path>[?<cgi>]
+// entries and <opaque> is not sent. Each entry is handled as if it were sent
+// in its own prepadd request. Batches may only be sent to a cmsd that set
+// kYR_bulkprep in its login response.
+//
 struct CmsPrepAddRequest
 {      CmsRRHdr      Hdr;    // Modifier used with following options
 
@@ -380,7 +395,8 @@ enum  {kYR_stage   = 0x0001, // Stage   the data
        kYR_write   = 0x0002, // Prepare for writing
        kYR_coloc   = 0x0004, // Prepare for co-location
        kYR_fresh   = 0x0008, // Prepare by  time refresh
-       kYR_metaman = 0x0010  // Prepare via meta-manager
+       kYR_metaman = 0x0010, // Prepare via meta-manager
+       kYR_batch   = 0x0040  // Path is a path list (prepadd is never forwarded)
       };
 //     kXR_string    Ident;
 //     kXR_string    reqid;
@@ -560,6 +576,30 @@ struct CmsTruncRequest
 //     kXR_string    Path;
 };
 
+/******************************************************************************/
+/*                       s u m m a r y   R e q u e s t                        */
+/******************************************************************************/
+  
+// Request: summary <size> <offset> <hashes> <bits>
+// Respond: n/a
+//
+// A data server sends a Bloom filter of its namespace in segments. A new
+// filter is bracketed by the kYR_begin and kYR_end modifiers; segments sent
+// without either modifier incrementally update the current filter in place.
+//
+struct CmsSummaryRequest
+{      CmsRRHdr      Hdr;
+       kXR_unt32     Size;   // Total filter size in bytes (power of two)
+       kXR_unt32     Offset; // Byte offset of the segment that follows
+       kXR_char      Hashes; // Number of hash functions used
+       kXR_char      Rsvd[3];
+//     kXR_char      Bits[Hdr.datalen-12];
+
+enum  {kYR_begin = 0x01,     // Modifier: first segment of a new filter
+       kYR_end   = 0x02      // Modifier: last  segment of a new filter
+      };
+};
+
 /******************************************************************************/
 /*                           t r y   R e q u e s t                            */
 /******************************************************************************/
@@ -199,6 +199,16 @@ XrdNetAddr   *NetAddr() {return &Addr;}
 
 int           Peek(char *buff, int blen, int timeout=-1);
 
+//-----------------------------------------------------------------------------
+//! Obtain and clear the time the link was last queued for dispatch.
+//!
+//! @return The time, in microseconds since the epoch, when the poller queued
+//!         the link to the scheduler or zero if it was not queued since the
+//!         previous call.
+//-----------------------------------------------------------------------------
+inline
+long long     QueueTime() {long long qt = qTime; qTime = 0; return qt;}
+
 int           Recv(char *buff, int blen);
 int           Recv(char *buff, int blen, int timeout);
 
@@ -310,6 +320,7 @@ char               *Etext;
 int                 FD;
 unsigned int        Instance;
 time_t              conTime;
+long long           qTime;          // Set by poller when queued for dispatch
 int                 InUse;
 int                 doPost;
 char                LockReads;
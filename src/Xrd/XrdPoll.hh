@@ -30,6 +30,7 @@
 /******************************************************************************/
 
 #include <sys/poll.h>
+#include <sys/time.h>
 #include "XrdSys/XrdSysPthread.hh"
 
 #define XRD_NUMPOLLERS 3
@@ -104,6 +105,14 @@ static     XrdOucTrace  *XrdTrace;
 static     XrdSysError  *XrdLog;
 static     XrdScheduler *XrdSched;
 
+// Now() returns the time in microseconds used to stamp links being queued
+//
+static inline long long  Now()
+                        {struct timeval tNow;
+                         gettimeofday(&tNow, 0);
+                         return tNow.tv_sec*1000000LL + tNow.tv_usec;
+                        }
+
 // Gets the next request on the poll pipe. This is common to all implentations.
 //
            int         getRequest();             // Implementation supplied
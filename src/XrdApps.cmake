@@ -47,6 +47,34 @@ target_link_libraries(
   pthread
   ${SOCKET_LIBRARY} )
 
+#-------------------------------------------------------------------------------
+# xrdmondump
+#-------------------------------------------------------------------------------
+add_executable(
+  xrdmondump
+  XrdApps/XrdMonDump.cc )
+
+target_link_libraries(
+  xrdmondump
+  XrdUtils
+  ${EXTRA_LIBS}
+  pthread
+  ${SOCKET_LIBRARY} )
+
+#-------------------------------------------------------------------------------
+# xrdhttpload
+#-------------------------------------------------------------------------------
+add_executable(
+  xrdhttpload
+  XrdApps/XrdHttpLoad.cc )
+
+target_link_libraries(
+  xrdhttpload
+  XrdUtils
+  ${EXTRA_LIBS}
+  pthread
+  ${SOCKET_LIBRARY} )
+
 #-------------------------------------------------------------------------------
 # wait41
 #-------------------------------------------------------------------------------
@@ -115,6 +143,7 @@ target_link_libraries(
 #-------------------------------------------------------------------------------
 install(
   TARGETS xrdadler32 cconfig mpxstats wait41 xrdcp-old XrdAppUtils xrdmapc
+          xrdmondump xrdhttpload
   LIBRARY DESTINATION ${CMAKE_INSTALL_LIBDIR}
   RUNTIME DESTINATION ${CMAKE_INSTALL_BINDIR} )
 
@@ -0,0 +1,324 @@
+/******************************************************************************/
+/*                                                                            */
+/*                        X r d H t t p L o a d . c c                         */
+/*                                                                            */
+/* (c) 2014 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                            All Rights Reserved                             */
+/*   Produced by Andrew Hanushevsky for Stanford University under contract    */
+/*              DE-AC02-76-SFO0515 with the Department of Energy              */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/types.h>
+
+#include "XrdNet/XrdNetSocket.hh"
+#include "XrdSys/XrdSysError.hh"
+#include "XrdSys/XrdSysLogger.hh"
+#include "XrdSys/XrdSysHeaders.hh"
+#include "XrdSys/XrdSysPlatform.hh"
+#include "XrdSys/XrdSysPthread.hh"
+
+/******************************************************************************/
+/*                      G l o b a l   V a r i a b l e s                       */
+/******************************************************************************/
+
+namespace XrdHttpLoad
+{
+       XrdSysLogger       Logger;
+
+       XrdSysError        Say(&Logger, "xrdhttpload");
+
+       const char        *Dest;
+       char              *Req;
+       int                Rlen;
+       int                Depth  = 1;
+       int                Count  = 1000;
+       bool               isHead = false;
+
+       XrdSysMutex        Mutex;
+       long long          nDone  = 0;
+       long long          nErrs  = 0;
+       long long          nBytes = 0;
+};
+
+using namespace XrdHttpLoad;
+
+/******************************************************************************/
+/*                         L o c a l   C l a s s e s                          */
+/******************************************************************************/
+/******************************************************************************/
+/*                            X r d H t t p C o n n                           */
+/******************************************************************************/
+
+// One kept-alive connection. Requests are written in groups of Depth without
+// waiting for any response, which is what a pipelining client does. A Depth
+// of one gives strictly sequential requests for comparison.
+
+class XrdHttpConn
+{
+public:
+
+void  Run();
+
+      XrdHttpConn() : Sock(&Say), inBeg(0), inEnd(0), Errs(0), Bytes(0),
+                      Done(0) {}
+     ~XrdHttpConn() {}
+
+private:
+
+bool  Fill();
+bool  Response();
+
+XrdNetSocket Sock;
+int          FD;
+int          inBeg;
+int          inEnd;
+long long    Errs;
+long long    Bytes;
+long long    Done;
+static const int inSize = 65536;
+char         inBuff[inSize+1];
+};
+
+/******************************************************************************/
+/*                    X r d H t t p C o n n : : F i l l                       */
+/******************************************************************************/
+
+bool XrdHttpConn::Fill()
+{
+   int rc;
+
+// Shift out what was consumed and read whatever is available
+//
+   if (inBeg)
+      {memmove(inBuff, inBuff+inBeg, inEnd-inBeg);
+       inEnd -= inBeg; inBeg = 0;
+      }
+   if (inEnd >= inSize)
+      {Say.Emsg(":", "Response header too long from", Dest); return false;}
+
+   do {rc = read(FD, inBuff+inEnd, inSize-inEnd);}
+      while(rc < 0 && errno == EINTR);
+   if (rc > 0) {inEnd += rc; return true;}
+   if (rc < 0) Say.Emsg(":", errno, "read from", Dest);
+      else     Say.Emsg(":", Dest, "closed the connection.");
+   return false;
+}
+
+/******************************************************************************/
+/*                X r d H t t p C o n n : : R e s p o n s e                   */
+/******************************************************************************/
+
+bool XrdHttpConn::Response()
+{
+   char *hEnd, *lP;
+   long long bLen = 0;
+   int hLen;
+
+// Get the complete response header
+//
+   while(1)
+        {inBuff[inEnd] = 0;
+         if ((hEnd = strstr(inBuff+inBeg, "\r\n\r\n"))) break;
+         if (!Fill()) return false;
+        }
+   *hEnd = 0; hLen = hEnd + 4 - (inBuff+inBeg);
+
+// Check the status and get the body length
+//
+   if (strncmp(inBuff+inBeg, "HTTP/1.", 7) || strncmp(inBuff+inBeg+8, " 2", 2))
+      Errs++;
+   lP = inBuff+inBeg;
+   while((lP = strstr(lP, "\r\n")))
+        {lP += 2;
+         if (!strncasecmp(lP, "Content-Length:", 15))
+            {bLen = strtoll(lP+15, 0, 10); break;}
+        }
+   inBeg += hLen;
+
+// Skip the body, if any
+//
+   if (!isHead)
+      {Bytes += bLen;
+       while(bLen)
+            {if (inBeg == inEnd && !Fill()) return false;
+             if (bLen <= inEnd-inBeg) {inBeg += bLen; break;}
+             bLen -= inEnd-inBeg; inBeg = inEnd;
+            }
+      }
+   Done++;
+   return true;
+}
+
+/******************************************************************************/
+/*                     X r d H t t p C o n n : : R u n                        */
+/******************************************************************************/
+
+void XrdHttpConn::Run()
+{
+   char *oBuff = (char *)malloc(Rlen*Depth);
+   int i, n, left = Count;
+
+// Connect to the server
+//
+   if ((FD = Sock.Open(Dest)) < 0)
+      {Say.Emsg(":", -Sock.LastError(), "connect to", Dest); left = 0;}
+   for (i = 0; i < Depth; i++) memcpy(oBuff+i*Rlen, Req, Rlen);
+
+// Send Depth requests at a time and then collect their responses
+//
+   while(left)
+        {n = (left < Depth ? left : Depth);
+         if (write(FD, oBuff, n*Rlen) != n*Rlen)
+            {Say.Emsg(":", errno, "write to", Dest); break;}
+         for (i = 0; i < n; i++) if (!Response()) break;
+         if (i < n) break;
+         left -= n;
+        }
+
+// Requests that were never answered count as errors. Add our counts to the
+// totals.
+//
+   Errs += Count - Done;
+   Mutex.Lock();
+   nDone += Done; nErrs += Errs; nBytes += Bytes;
+   Mutex.UnLock();
+   free(oBuff);
+}
+
+/******************************************************************************/
+/*                     T h r e a d   I n t e r f a c e s                      */
+/******************************************************************************/
+
+void *XrdHttpLoadConn(void *carg)
+{
+   ((XrdHttpConn *)carg)->Run();
+   return (void *)0;
+}
+
+/******************************************************************************/
+/*                                 U s a g e                                  */
+/******************************************************************************/
+
+void Usage(int rc)
+{
+   cerr <<"\nUsage: xrdhttpload [-c <conns>] [-d <depth>] [-h] [-m get|head] "
+          "[-n <reqs>]\n                   <host>:<port> <path>" <<endl;
+   exit(rc);
+}
+
+/******************************************************************************/
+/*                                  m a i n                                   */
+/******************************************************************************/
+
+int main(int argc, char *argv[])
+{
+   extern char *optarg;
+   extern int optind, opterr, optopt;
+   XrdHttpConn *cP;
+   pthread_t *tid;
+   struct timeval tBeg, tEnd;
+   char eBuff[64], c;
+   double elapsed;
+   int i, rc, Conns = 1;
+
+// Process the options
+//
+   opterr = 0;
+   while ((c = getopt(argc,argv,"c:d:hm:n:")) && ((unsigned char)c != 0xff))
+     { switch(c)
+       {
+       case 'c': if ((Conns = atoi(optarg)) <= 0)
+                    {Say.Emsg(":", "Invalid connection count - ", optarg);
+                     Usage(1);
+                    }
+                 break;
+       case 'd': if ((Depth = atoi(optarg)) <= 0)
+                    {Say.Emsg(":", "Invalid pipeline depth - ", optarg);
+                     Usage(1);
+                    }
+                 break;
+       case 'h': Usage(0);
+                 break;
+       case 'm':      if (!strcasecmp(optarg, "get"))  isHead = false;
+                 else if (!strcasecmp(optarg, "head")) isHead = true;
+                 else {Say.Emsg(":", "Invalid method - ", optarg); Usage(1);}
+                 break;
+       case 'n': if ((Count = atoi(optarg)) <= 0)
+                    {Say.Emsg(":", "Invalid request count - ", optarg);
+                     Usage(1);
+                    }
+                 break;
+       default:  sprintf(eBuff,"'%c'", optopt);
+                 if (c == ':') Say.Emsg(":", eBuff, "value not specified.");
+                    else Say.Emsg(0, eBuff, "option is invalid");
+                 Usage(1);
+       }
+     }
+
+// We need a destination and a path
+//
+   if (optind+2 != argc)
+      {Say.Emsg(":", "Specify the server and the path to be requested.");
+       Usage(1);
+      }
+   Dest = argv[optind];
+   if (*argv[optind+1] != '/')
+      {Say.Emsg(":", "Path must be absolute - ", argv[optind+1]); Usage(1);}
+
+// Format the request every connection sends
+//
+   Rlen = strlen(argv[optind+1]) + strlen(Dest) + 64;
+   Req  = (char *)malloc(Rlen);
+   Rlen = snprintf(Req, Rlen, "%s %s HTTP/1.1\r\nHost: %s\r\n"
+                   "Connection: Keep-Alive\r\n\r\n",
+                   (isHead ? "HEAD" : "GET"), argv[optind+1], Dest);
+
+// Start a thread for each connection and wait for all of them to finish
+//
+   cP  = new XrdHttpConn[Conns];
+   tid = new pthread_t[Conns];
+   gettimeofday(&tBeg, 0);
+   for (i = 0; i < Conns; i++)
+       if ((rc = XrdSysThread::Run(&tid[i], XrdHttpLoadConn, (void *)&cP[i],
+                                   XRDSYSTHREAD_HOLD, "load connection")))
+          {Say.Emsg(":", rc, "create connection thread"); exit(4);}
+   for (i = 0; i < Conns; i++) XrdSysThread::Join(tid[i], 0);
+   gettimeofday(&tEnd, 0);
+
+// Report the results
+//
+   elapsed = (tEnd.tv_sec - tBeg.tv_sec) + (tEnd.tv_usec - tBeg.tv_usec)/1.0e6;
+   if (elapsed <= 0) elapsed = 1.0e-6;
+   printf("%s %s: %d conns, depth %d, %lld responses, %lld errors, "
+          "%lld bytes in %.3f sec; %.0f req/sec\n",
+          (isHead ? "HEAD" : "GET"), argv[optind+1], Conns, Depth,
+          nDone, nErrs, nBytes, elapsed, nDone/elapsed);
+   exit(nErrs ? 8 : 0);
+}
@@ -0,0 +1,422 @@
+/******************************************************************************/
+/*                                                                            */
+/*                         X r d M o n D u m p . c c                          */
+/*                                                                            */
+/* (c) 2014 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                            All Rights Reserved                             */
+/*   Produced by Andrew Hanushevsky for Stanford University under contract    */
+/*              DE-AC02-76-SFO0515 with the Department of Energy              */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+
+#include "XrdNet/XrdNetOpts.hh"
+#include "XrdNet/XrdNetSocket.hh"
+#include "XrdSys/XrdSysError.hh"
+#include "XrdSys/XrdSysLogger.hh"
+#include "XrdSys/XrdSysHeaders.hh"
+#include "XrdSys/XrdSysPlatform.hh"
+#include "XrdXrootd/XrdXrootdMonData.hh"
+#include "XrdXrootd/XrdXrootdMonPack.hh"
+
+/******************************************************************************/
+/*                      G l o b a l   V a r i a b l e s                       */
+/******************************************************************************/
+
+namespace XrdMonDump
+{
+       XrdSysLogger       Logger;
+
+       XrdSysError        Say(&Logger, "xrdmondump");
+
+       int                Debug;
+};
+
+using namespace XrdMonDump;
+
+/******************************************************************************/
+/*                         L o c a l   C l a s s e s                          */
+/******************************************************************************/
+/******************************************************************************/
+/*                             X r d M o n P k t                              */
+/******************************************************************************/
+
+// Decode a compact "f" stream packet into one line of text per record. Each
+// line starts with the server start time and the packet sequence number so
+// that records from different servers and packets can be told apart.
+
+class XrdMonPkt
+{
+public:
+
+int   Decode(const char *buff, int blen);
+
+      XrdMonPkt() : oP(oBuff) {}
+     ~XrdMonPkt() {}
+
+private:
+
+bool  Bad(const char *what);
+bool  Close(const char *&bP, const char *eP, char flags);
+void  Emit();
+void  Put(const char *fmt, ...);
+bool  Val(const char *&bP, const char *eP, const char *name);
+
+char  Pfx[64];
+char *oP;
+char  oBuff[65536];
+};
+
+/******************************************************************************/
+/*                       X r d M o n P k t : : B a d                          */
+/******************************************************************************/
+
+bool XrdMonPkt::Bad(const char *what)
+{
+   Emit();
+   Say.Emsg(":", "Truncated or malformed", what, "record; packet skipped.");
+   return false;
+}
+
+/******************************************************************************/
+/*                     X r d M o n P k t : : C l o s e                        */
+/******************************************************************************/
+
+bool XrdMonPkt::Close(const char *&bP, const char *eP, char flags)
+{
+   static const char *opsName[] = {"rd.ops", "rv.ops", "wr.ops",
+                                   "rs.min", "rs.max", "rs.segs",
+                                   "rd.min", "rd.max", "rv.min", "rv.max",
+                                   "wr.min", "wr.max"};
+   static const char *ssqName[] = {"rd.ssq", "rv.ssq", "rs.ssq", "wr.ssq"};
+   unsigned long long uval;
+   double dval;
+   int i, nBins;
+
+// Do the transfer counts (always present)
+//
+   if (!Val(bP, eP, "rd") || !Val(bP, eP, "rv") || !Val(bP, eP, "wr"))
+      return false;
+
+// Do the ops counts if present
+//
+   if (flags & XrdXrootdMonPack::hasOPS)
+      for (i = 0; i < (int)(sizeof(opsName)/sizeof(char *)); i++)
+          if (!Val(bP, eP, opsName[i])) return false;
+
+// Do the sum of squares if present
+//
+   if (flags & XrdXrootdMonPack::hasSSQ)
+      for (i = 0; i < (int)(sizeof(ssqName)/sizeof(char *)); i++)
+          {if (!(bP = XrdXrootdMonPack::GetD(bP, eP, dval))) return false;
+           Put(" %s=%.17g", ssqName[i], dval);
+          }
+
+// Do the latency histogram if present
+//
+   if (flags & XrdXrootdMonPack::hasLAT)
+      {if (bP >= eP) return false;
+       nBins = static_cast<unsigned char>(*bP++);
+       if (nBins > XrdXrootdMonPack::latBins) return false;
+       Put(" lat=");
+       for (i = 0; i < nBins; i++)
+           {if (!(bP = XrdXrootdMonPack::GetV(bP, eP, uval))) return false;
+            Put((i ? ",%llu" : "%llu"), uval);
+           }
+      }
+   return true;
+}
+
+/******************************************************************************/
+/*                    X r d M o n P k t : : D e c o d e                       */
+/******************************************************************************/
+
+int XrdMonPkt::Decode(const char *buff, int blen)
+{
+   const XrdXrootdMonHeader  *hP = (const XrdXrootdMonHeader  *)buff;
+   const XrdXrootdMonFileTOD *tP;
+   const char *bP, *eP;
+   unsigned long long uval, nSegs, sLen;
+   long long offs, prvEnd;
+   char rType, rFlag;
+   int  plen;
+
+// Validate the header and ignore anything that is not a compact "f" stream
+//
+   if (blen < (int)(sizeof(XrdXrootdMonHeader)+sizeof(XrdXrootdMonFileTOD)))
+      {Say.Emsg(":", "Packet is too short; skipped."); return 0;}
+   plen = static_cast<unsigned short>(ntohs(hP->plen));
+   if (plen < blen) blen = plen;
+   if (hP->code != XROOTD_MON_MAPFPCK)
+      {if (Debug) Say.Emsg(":", "Ignoring non-compact packet.");
+       return 0;
+      }
+
+// Establish the prefix and the packet's time window
+//
+   tP = (const XrdXrootdMonFileTOD *)(buff + sizeof(XrdXrootdMonHeader));
+   if (tP->Hdr.recFlag != XrdXrootdMonPack::Version)
+      {Say.Emsg(":", "Unsupported compact encoding version; packet skipped.");
+       return 0;
+      }
+   snprintf(Pfx, sizeof(Pfx), "%u %d ",
+            static_cast<unsigned int>(ntohl(hP->stod)),
+            static_cast<int>(static_cast<unsigned char>(hP->pseq)));
+   Put("%stime beg=%d end=%d xfr=%d recs=%d", Pfx,
+       static_cast<int>(ntohl(tP->tBeg)), static_cast<int>(ntohl(tP->tEnd)),
+       static_cast<int>(ntohs(tP->Hdr.nRecs[0])),
+       static_cast<int>(ntohs(tP->Hdr.nRecs[1])));
+   Emit();
+
+// Run through all of the records
+//
+   bP = buff + sizeof(XrdXrootdMonHeader) + sizeof(XrdXrootdMonFileTOD);
+   eP = buff + blen;
+   while(eP - bP >= 2)
+        {rType = *bP++; rFlag = *bP++;
+         switch(rType)
+               {case XrdXrootdMonPack::isOpen:
+                     Put("%sopen", Pfx);
+                     if (!Val(bP, eP, "fid") || !Val(bP, eP, "size"))
+                        return Bad("open");
+                     Put(" rw=%d", (rFlag & XrdXrootdMonPack::hasRW ? 1 : 0));
+                     if (rFlag & XrdXrootdMonPack::hasLFN)
+                        {if (!Val(bP, eP, "uid")
+                         ||  !(bP = XrdXrootdMonPack::GetV(bP, eP, uval))
+                         ||  uval > static_cast<unsigned long long>(eP - bP))
+                            return Bad("open");
+                         Put(" lfn=%.*s", static_cast<int>(uval), bP);
+                         bP += uval;
+                        }
+                     break;
+                case XrdXrootdMonPack::isClose:
+                     Put("%sclose", Pfx);
+                     if (!Val(bP, eP, "fid")) return Bad("close");
+                     Put(" forced=%d",
+                         (rFlag & XrdXrootdMonPack::forced ? 1 : 0));
+                     if (!Close(bP, eP, rFlag)) return Bad("close");
+                     break;
+                case XrdXrootdMonPack::isXfr:
+                     Put("%sxfr", Pfx);
+                     if (!Val(bP, eP, "fid") || !Val(bP, eP, "rd")
+                     ||  !Val(bP, eP, "rv")  || !Val(bP, eP, "wr"))
+                        return Bad("xfr");
+                     break;
+                case XrdXrootdMonPack::isDisc:
+                     Put("%sdisc", Pfx);
+                     if (!Val(bP, eP, "uid")) return Bad("disc");
+                     break;
+                case XrdXrootdMonPack::isReadV:
+                     Put("%sreadv", Pfx);
+                     if (!Val(bP, eP, "fid")
+                     ||  !(bP = XrdXrootdMonPack::GetV(bP, eP, nSegs)))
+                        return Bad("readv");
+                     Put(" nsegs=%llu segs=", nSegs);
+                     prvEnd = 0;
+                     while(nSegs--)
+                          {if (!(bP = XrdXrootdMonPack::GetZ(bP, eP, offs))
+                           ||  !(bP = XrdXrootdMonPack::GetV(bP, eP, sLen)))
+                              return Bad("readv");
+                           offs += prvEnd; prvEnd = offs + sLen;
+                           Put("%lld:%llu%s", offs, sLen, (nSegs ? "," : ""));
+                          }
+                     break;
+                default:
+                     Emit();
+                     Say.Emsg(":", "Unknown record type; packet skipped.");
+                     return 0;
+               }
+         Emit();
+        }
+   return 1;
+}
+
+/******************************************************************************/
+/*                      X r d M o n P k t : : E m i t                         */
+/******************************************************************************/
+
+void XrdMonPkt::Emit()
+{
+   if (oP != oBuff)
+      {*oP++ = '\n';
+       fwrite(oBuff, 1, oP - oBuff, stdout);
+       oP = oBuff;
+      }
+}
+
+/******************************************************************************/
+/*                       X r d M o n P k t : : P u t                          */
+/******************************************************************************/
+
+void XrdMonPkt::Put(const char *fmt, ...)
+{
+   va_list ap;
+   int n, room = sizeof(oBuff) - (oP - oBuff) - 1;
+
+   if (room <= 0) return;
+   va_start(ap, fmt);
+   n = vsnprintf(oP, room, fmt, ap);
+   va_end(ap);
+   oP += (n < room ? n : room - 1);
+}
+
+/******************************************************************************/
+/*                       X r d M o n P k t : : V a l                          */
+/******************************************************************************/
+
+bool XrdMonPkt::Val(const char *&bP, const char *eP, const char *name)
+{
+   unsigned long long uval;
+
+   if (!(bP = XrdXrootdMonPack::GetV(bP, eP, uval))) return false;
+   Put(" %s=%llu", name, uval);
+   return true;
+}
+
+/******************************************************************************/
+/*                                 U s a g e                                  */
+/******************************************************************************/
+
+void Usage(int rc)
+{
+   cerr <<"\nUsage: xrdmondump [-d] {-p <port> | <file> [<file> ...]}" <<endl;
+   exit(rc);
+}
+
+/******************************************************************************/
+/*                              d o F i l e                                   */
+/******************************************************************************/
+
+// A file holds a sequence of packets as written by "fstat ... file <path>".
+// Each packet's length is in its header.
+
+int doFile(XrdMonPkt &Pkt, const char *fn)
+{
+   XrdXrootdMonHeader hdr;
+   char *buff;
+   int fd, rc, plen, aOK = 0;
+
+   if ((fd = open(fn, O_RDONLY)) < 0)
+      {Say.Emsg(":", errno, "open", fn); return 0;}
+   buff = (char *)malloc(65536);
+
+   while(1)
+        {if ((rc = read(fd, &hdr, sizeof(hdr))) != (int)sizeof(hdr))
+            {if (rc < 0) Say.Emsg(":", errno, "read", fn);
+                else if (rc) Say.Emsg(":", "Truncated packet in", fn);
+                        else aOK = 1;
+             break;
+            }
+         plen = static_cast<unsigned short>(ntohs(hdr.plen));
+         if (plen < (int)sizeof(hdr))
+            {Say.Emsg(":", "Invalid packet length in", fn); break;}
+         memcpy(buff, &hdr, sizeof(hdr));
+         if ((rc = read(fd, buff+sizeof(hdr), plen-sizeof(hdr)))
+         != plen-(int)sizeof(hdr))
+            {if (rc < 0) Say.Emsg(":", errno, "read", fn);
+                else Say.Emsg(":", "Truncated packet in", fn);
+             break;
+            }
+         Pkt.Decode(buff, plen);
+        }
+
+   close(fd);
+   free(buff);
+   return aOK;
+}
+
+/******************************************************************************/
+/*                                  m a i n                                   */
+/******************************************************************************/
+
+int main(int argc, char *argv[])
+{
+   extern char *optarg;
+   extern int optind, opterr, optopt;
+   XrdNetSocket mySocket(&Say);
+   XrdMonPkt *pktP = new XrdMonPkt;
+   char *buff, eBuff[64], c;
+   int Port = 0, udpFD, rc, aOK = 1;
+
+// Process the options
+//
+   opterr = 0; Debug = 0;
+   while ((c = getopt(argc,argv,"dhp:")) && ((unsigned char)c != 0xff))
+     { switch(c)
+       {
+       case 'd': Debug = 1;
+                 break;
+       case 'h': Usage(0);
+                 break;
+       case 'p': if (!(Port = atoi(optarg)))
+                    {Say.Emsg(":", "Invalid port number - ", optarg); Usage(1);}
+                 break;
+       default:  sprintf(eBuff,"'%c'", optopt);
+                 if (c == ':') Say.Emsg(":", eBuff, "value not specified.");
+                    else Say.Emsg(0, eBuff, "option is invalid");
+                 Usage(1);
+       }
+     }
+
+// Either a port or files must be specified but not both
+//
+   if (!Port == (optind >= argc))
+      {Say.Emsg(":", "Specify either a port or one or more files.");
+       Usage(1);
+      }
+
+// Process files, if any
+//
+   if (!Port)
+      {while(optind < argc) aOK &= doFile(*pktP, argv[optind++]);
+       fflush(stdout);
+       exit(aOK ? 0 : 4);
+      }
+
+// Create a UDP socket and bind it to a port
+//
+   if (mySocket.Open(0, Port, XRDNET_SERVER|XRDNET_UDPSOCKET, 0) < 0)
+      {Say.Emsg(":", -mySocket.LastError(), "create udp socket"); exit(4);}
+   udpFD = mySocket.Detach();
+
+// Decode packets as they arrive
+//
+   buff = (char *)malloc(65536);
+   while(1)
+        {do {rc = recv(udpFD, buff, 65536, 0);} while(rc < 0 && errno == EINTR);
+         if (rc < 0) {Say.Emsg(":", errno, "recv udp"); exit(8);}
+         pktP->Decode(buff, rc);
+         fflush(stdout);
+        }
+
+// Should never get here
+//
+   return 0;
+}
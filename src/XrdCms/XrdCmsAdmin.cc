@@ -39,6 +39,7 @@
 #include "XProtocol/YProtocol.hh"
 
 #include "XrdCms/XrdCmsAdmin.hh"
+#include "XrdCms/XrdCmsBaseFS.hh"
 #include "XrdCms/XrdCmsConfig.hh"
 #include "XrdCms/XrdCmsManager.hh"
 #include "XrdCms/XrdCmsPrepare.hh"
@@ -627,12 +628,17 @@ void XrdCmsAdmin::do_RmDid(int isPfn)
 /******************************************************************************/
 /*                              d o _ R m D u d                               */
 /******************************************************************************/
+
+// Process: {have | newfn} <path> [p | c<pct>]
+//
+// The c option is used by disk caches (e.g. a caching proxy) to report the
+// percentage of the file that they hold. The file is online either way.
   
 void XrdCmsAdmin::do_RmDud(int isPfn)
 {
    const char *epname = "do_RmDud";
    char *tp, *pp, apath[XrdCmsMAX_PATH_LEN];
-   int   rc, Mods = kYR_raw;
+   int   rc, pct = -1, Mods = kYR_raw;
 
    if (!(tp = Stream.GetToken()))
       {Say.Emsg(epname,"added path not specified by",Stype,Sname);
@@ -640,7 +646,11 @@ void XrdCmsAdmin::do_RmDud(int isPfn)
       }
 
    if ((pp = Stream.GetToken()) && *pp == 'p') Mods |= CmsHaveRequest::Pending;
-      else Mods |= CmsHaveRequest::Online;
+      else {Mods |= CmsHaveRequest::Online;
+            if (pp && *pp == 'c'
+            &&  XrdOuca2x::a2i(Say, "cached percentage", pp+1, &pct, 0, 100))
+               return;
+           }
 
    if (isPfn && Config.lcl_N2N)
       {if ((rc = Config.lcl_N2N->pfn2lfn(tp, apath, sizeof(apath))))
@@ -649,6 +659,11 @@ void XrdCmsAdmin::do_RmDud(int isPfn)
           } else tp = apath;
       }
 
+   if (pct >= 0)
+      {baseFS.Cached(tp, pct);
+       Mods |= baseFS.CacheLvl(tp);
+      }
+
    DEBUG("sending managers have online " <<tp);
    XrdCmsManager::Inform(kYR_have, Mods, tp, strlen(tp)+1);
 }
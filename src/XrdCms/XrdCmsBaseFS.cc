@@ -108,6 +108,44 @@ int XrdCmsBaseFS::Bypass()
    return 0;
 }
   
+/******************************************************************************/
+/* Public:                        C a c h e d                                 */
+/******************************************************************************/
+
+// Only files that are at least half cached are recorded as anything else is
+// reported as a low cache level anyway.
+  
+void XrdCmsBaseFS::Cached(const char *Path, int pct)
+{
+   EPNAME("Cached");
+   static struct cLvl lvlHalf = {CmsHaveRequest::CacheHalf},
+                      lvlFull = {CmsHaveRequest::CacheFull};
+
+   fsCMutex.Lock();
+   Caching = 1;
+        if (pct >= 100) fsCached.Rep(Path, &lvlFull, 0, Hash_keepdata);
+   else if (pct >=  50) fsCached.Rep(Path, &lvlHalf, 0, Hash_keepdata);
+   else                 fsCached.Del(Path, Hash_keepdata);
+   fsCMutex.UnLock();
+   DEBUG(pct <<"% " <<Path);
+}
+
+/******************************************************************************/
+/* Public:                      C a c h e L v l                               */
+/******************************************************************************/
+  
+int XrdCmsBaseFS::CacheLvl(const char *Path)
+{
+   struct cLvl *lP;
+   int lvl;
+
+   if (!Caching) return 0;
+   fsCMutex.Lock();
+   lvl = ((lP = fsCached.Find(Path)) ? lP->Level : CmsHaveRequest::CacheLow);
+   fsCMutex.UnLock();
+   return lvl;
+}
+
 /******************************************************************************/
 /* Public:                        E x i s t s                                 */
 /******************************************************************************/
@@ -88,6 +88,15 @@ class XrdCmsBaseFS
 {
 public:
 
+// Cached() records how much of a file (in percent) is held in a local disk
+//          cache as reported by the cache itself (e.g. a caching proxy).
+//          CacheLvl() returns the corresponding CmsHaveRequest cache level,
+//          which is zero should no cache have ever reported.
+//
+       void             Cached(const char *Path, int pct);
+
+       int              CacheLvl(const char *Path);
+
 // Exists() returns a tri-logic state:
 // CmsHaveRequest::Online  -> File is known to exist and is available
 // CmsHaveRequest::Pending -> File is known to exist but is not available
@@ -134,12 +143,14 @@ inline int              Traverse() {return Punt;}
 
        XrdCmsBaseFS(void (*theCB)(XrdCmsBaseFR *, int))
                    : cBack(theCB), dmLife(0), dpLife(0), lclStat(0), preSel(1),
-                     dfsSys(0), Server(0), Fixed(0), Punt(0) {}
+                     dfsSys(0), Server(0), Fixed(0), Punt(0),
+                     Caching(0) {}
       ~XrdCmsBaseFS() {}
 
 private:
 
 struct dMoP {int        Present;};
+struct cLvl {int        Level;};
 
        int              Bypass();
        int              FStat( char *Path, int fnPos, int upat=0);
@@ -150,6 +161,8 @@ struct dMoP {int        Present;};
 
        XrdSysMutex      fsMutex;
        XrdOucHash<dMoP> fsDirMP;
+       XrdSysMutex      fsCMutex;
+       XrdOucHash<cLvl> fsCached; // Files mostly cached (fsCMutex)
        void             (*cBack)(XrdCmsBaseFR *, int);
 
 struct RequestQ
@@ -181,6 +194,7 @@ struct RequestQ
        char             Server;   // 1-> This is a data server
        char             Fixed;    // 1-> Use fixed rate processing
        char             Punt;     // 1-> Pass through any forwarding
+       char             Caching;  // 1-> A local cache reports its files
 };
 namespace XrdCms
 {
@@ -0,0 +1,140 @@
+/******************************************************************************/
+/*                                                                            */
+/*                        X r d C m s B l o o m . c c                         */
+/*                                                                            */
+/* (c) 2014 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                            All Rights Reserved                             */
+/*   Produced by Andrew Hanushevsky for Stanford University under contract    */
+/*              DE-AC02-76-SFO0515 with the Department of Energy              */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "XrdCms/XrdCmsBloom.hh"
+#include "XrdOuc/XrdOucCRC.hh"
+
+/******************************************************************************/
+/*                           C o n s t r u c t o r                            */
+/******************************************************************************/
+  
+XrdCmsBloom::XrdCmsBloom(unsigned int bytes, int hashes)
+{
+
+// The caller must have validated the geometry, but be safe anyway
+//
+   if (!Valid(bytes, hashes)) {bytes = minSize; hashes = 4;}
+
+   bitLen  = bytes;
+   bitMask = bytes*8 - 1;
+   numHash = hashes;
+   bitVec  = (char *)calloc(bitLen, 1);
+}
+
+/******************************************************************************/
+/*                                   A d d                                    */
+/******************************************************************************/
+  
+void XrdCmsBloom::Add(unsigned int h1, unsigned int h2)
+{
+   unsigned int bit;
+   int i;
+
+   for (i = 0; i < numHash; i++)
+       {bit = (h1 + i*h2) & bitMask;
+        bitVec[bit >> 3] |= (1 << (bit & 7));
+       }
+}
+
+/******************************************************************************/
+/*                                 A p p l y                                  */
+/******************************************************************************/
+  
+bool XrdCmsBloom::Apply(unsigned int offs, const char *bits, int blen)
+{
+
+// Make sure the segment fits
+//
+   if (blen < 0 || offs > bitLen || (unsigned int)blen > bitLen - offs)
+      return false;
+
+// Copy in the segment
+//
+   if (blen) memcpy(bitVec+offs, bits, blen);
+   return true;
+}
+
+/******************************************************************************/
+/*                                   H a s                                    */
+/******************************************************************************/
+  
+bool XrdCmsBloom::Has(unsigned int h1, unsigned int h2)
+{
+   unsigned int bit;
+   int i;
+
+   for (i = 0; i < numHash; i++)
+       {bit = (h1 + i*h2) & bitMask;
+        if (!(bitVec[bit >> 3] & (1 << (bit & 7)))) return false;
+       }
+   return true;
+}
+
+/******************************************************************************/
+/*                                  H a s h                                   */
+/******************************************************************************/
+  
+// We use double hashing (Kirsch & Mitzenmacher) so that only two independent
+// hashes are needed. The second is forced to be odd so that it is relatively
+// prime to the (power of two) filter size and all bits can be reached.
+//
+void XrdCmsBloom::Hash(const char *path, int plen,
+                       unsigned int &h1, unsigned int &h2)
+{
+   const unsigned char *pP = (const unsigned char *)path;
+   unsigned int fnv = 2166136261U;
+   int i;
+
+// Ignore the trailing null byte if it was included in the length
+//
+   if (plen > 0 && !path[plen-1]) plen--;
+
+// First hash is the crc32 of the path
+//
+   h1 = XrdOucCRC::CRC32(pP, plen);
+
+// Second hash is FNV-1a of the path
+//
+   for (i = 0; i < plen; i++) {fnv ^= pP[i]; fnv *= 16777619U;}
+   h2 = fnv | 1;
+}
+
+/******************************************************************************/
+/*                                 V a l i d                                  */
+/******************************************************************************/
+  
+bool XrdCmsBloom::Valid(unsigned int bytes, int hashes)
+{
+   return bytes >= minSize && bytes <= maxSize && !(bytes & (bytes-1))
+       && hashes > 0 && hashes <= maxHash;
+}
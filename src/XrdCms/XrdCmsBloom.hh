@@ -0,0 +1,108 @@
+#ifndef __CMS_BLOOM__H
+#define __CMS_BLOOM__H
+/******************************************************************************/
+/*                                                                            */
+/*                        X r d C m s B l o o m . h h                         */
+/*                                                                            */
+/* (c) 2014 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                            All Rights Reserved                             */
+/*   Produced by Andrew Hanushevsky for Stanford University under contract    */
+/*              DE-AC02-76-SFO0515 with the Department of Energy              */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+/******************************************************************************/
+/*                     C l a s s   X r d C m s B l o o m                      */
+/******************************************************************************/
+  
+// The XrdCmsBloom object is a fixed size Bloom filter of path names. Data
+// servers use it to summarize their namespace and managers use the summaries
+// to avoid asking servers about files that they cannot possibly have. The
+// filter size must be a power of two so that bit positions can be masked.
+//
+class XrdCmsBloom
+{
+public:
+
+// Add() records a path in the filter.
+//
+inline void  Add(const char *path, int plen)
+                {unsigned int h1, h2;
+                 Hash(path, plen, h1, h2);
+                 Add(h1, h2);
+                }
+
+       void  Add(unsigned int h1, unsigned int h2);
+
+// Apply() copies a segment of bits into the filter at the indicated offset.
+//         False is returned if the segment does not fit in the filter.
+//
+       bool  Apply(unsigned int offs, const char *bits, int blen);
+
+inline const
+       char *Bits() {return bitVec;}
+
+// Has() returns false if the path is definitely not in the filter and true
+//       if it may be present.
+//
+inline bool  Has(const char *path, int plen)
+                {unsigned int h1, h2;
+                 Hash(path, plen, h1, h2);
+                 return Has(h1, h2);
+                }
+
+       bool  Has(unsigned int h1, unsigned int h2);
+
+// Hash() computes the two base hashes from which all bit positions are derived.
+//        This allows a single computation to be used against many filters.
+//
+static void  Hash(const char *path, int plen, unsigned int &h1, unsigned int&h2);
+
+inline int   Hashes() {return numHash;}
+
+inline void  Reset() {memset(bitVec, 0, bitLen);}
+
+inline unsigned int Size() {return bitLen;}
+
+// Valid() returns true if the filter geometry is acceptable.
+//
+static bool  Valid(unsigned int bytes, int hashes);
+
+static const unsigned int minSize = 1024;       // Minimum filter size
+static const unsigned int maxSize = 64*1024*1024;// Maximum filter size
+static const int          maxHash = 16;         // Maximum hash functions
+static const int          SegSize = 8192;       // Bytes sent per message
+
+             XrdCmsBloom(unsigned int bytes, int hashes);
+            ~XrdCmsBloom() {if (bitVec) free(bitVec);}
+
+private:
+
+char         *bitVec;
+unsigned int  bitLen;
+unsigned int  bitMask;
+int           numHash;
+};
+#endif
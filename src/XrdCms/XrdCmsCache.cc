@@ -110,8 +110,12 @@ void *XrdCmsStartTickTock(void *carg)
 // Opts  Advisory: The call is ignored since we do not keep information about
 //                 paths that were never asked for.
 
+// Opts CacheLvl: The nodes in mask are recorded as caching the indicated
+//                 fraction of the file. Upon return, the CacheLvl bits hold
+//                 the highest level cached by any node.
+
 // Returns True    If this is the first time location information was added
-//                 to the entry.
+//                 to the entry or the highest cache level changed.
 // Returns False   Otherwise.
   
 int XrdCmsCache::AddFile(XrdCmsSelect &Sel, SMask_t mask)
@@ -119,6 +123,7 @@ int XrdCmsCache::AddFile(XrdCmsSelect &Sel, SMask_t mask)
    XrdCmsKeyItem *iP;
    SMask_t xmask;
    int isrw = (Sel.Opts & XrdCmsSelect::Write), isnew = 0;
+   int cLvl = (Sel.Opts & XrdCmsSelect::CacheLvl), xLvl;
 
 // Serialize processing
 //
@@ -136,13 +141,19 @@ int XrdCmsCache::AddFile(XrdCmsSelect &Sel, SMask_t mask)
       {if (!mask)
           {iP->Loc.deadline = QDelay + time(0);
            iP->Loc.hfvec = 0; iP->Loc.pfvec = 0; iP->Loc.qfvec = 0;
+           iP->Loc.hcvec = 0; iP->Loc.fcvec = 0;
            iP->Loc.TOD_B = BClock;
            iP->Key.TOD = Tock;
           } else {
            xmask = iP->Loc.pfvec;
            if (Sel.Opts & XrdCmsSelect::Pending) iP->Loc.pfvec |= mask;
               else iP->Loc.pfvec &= ~mask;
-           isnew = (iP->Loc.hfvec == 0) || (iP->Loc.pfvec != xmask);
+           isnew = !(iP->Loc.hfvec) || (iP->Loc.pfvec != xmask);
+           if (cLvl)
+              {xLvl = CacheLvl(iP->Loc);
+               setCached(iP->Loc, mask, cLvl);
+               if ((cLvl = CacheLvl(iP->Loc)) != xLvl) isnew = 1;
+              }
            iP->Loc.hfvec |=  mask;
            iP->Loc.qfvec &= ~mask;
            if (isrw) {iP->Loc.deadline = 0;
@@ -160,6 +171,9 @@ int XrdCmsCache::AddFile(XrdCmsSelect &Sel, SMask_t mask)
                      iP->Loc.hfvec    = mask;
                      iP->Loc.TOD_B    = BClock;
                      iP->Loc.qfvec    = 0;
+                     iP->Loc.hcvec    = 0;
+                     iP->Loc.fcvec    = 0;
+                     if (cLvl) setCached(iP->Loc, mask, cLvl);
                      iP->Loc.deadline = QDelay + time(0);
                      Sel.Path.Ref     = iP->Key.Ref;
                      Sel.Path.TODRef  = iP; isnew = 1;
@@ -169,6 +183,7 @@ int XrdCmsCache::AddFile(XrdCmsSelect &Sel, SMask_t mask)
 // All done
 //
    myMutex.UnLock();
+   if (cLvl) Sel.Opts = (Sel.Opts & ~XrdCmsSelect::CacheLvl) | cLvl;
    return isnew;
 }
   
@@ -200,7 +215,9 @@ int XrdCmsCache::DelFile(XrdCmsSelect &Sel, SMask_t mask)
    if ((iP = CTable.Find(Sel.Path)))
       {iP->Loc.hfvec &= ~mask;
        iP->Loc.pfvec &= ~mask;
-       if ((gone4good = (iP->Loc.hfvec == 0))
+       iP->Loc.hcvec &= ~mask;
+       iP->Loc.fcvec &= ~mask;
+       if ((gone4good = !(iP->Loc.hfvec))
        && (!(Sel.Opts & XrdCmsSelect::Advisory))
        && (XrdCmsKeyItem::Unload(iP) && !CTable.Recycle(iP)))
           Say.Emsg("DelFile", "Delete failed for", iP->Key.Val);
@@ -242,6 +259,8 @@ int  XrdCmsCache::GetFile(XrdCmsSelect &Sel, SMask_t mask)
                  ? getBVec(iP->Key.TOD, iP->Loc.TOD_B) & mask : 0)))
           {iP->Loc.hfvec &= ~bVec; 
            iP->Loc.pfvec &= ~bVec;
+           iP->Loc.hcvec &= ~bVec;
+           iP->Loc.fcvec &= ~bVec;
            iP->Loc.qfvec &= ~mask;
            iP->Loc.deadline = QDelay + time(0);
            retc = -1;
@@ -251,6 +270,8 @@ int  XrdCmsCache::GetFile(XrdCmsSelect &Sel, SMask_t mask)
                     else retc = 1;
        Sel.Vec.hf      = okVec & iP->Loc.hfvec;
        Sel.Vec.pf      = okVec & iP->Loc.pfvec;
+       Sel.Vec.hc      = okVec & iP->Loc.hfvec & iP->Loc.hcvec;
+       Sel.Vec.fc      = okVec & iP->Loc.hfvec & iP->Loc.fcvec;
        Sel.Vec.bf      = okVec & (bVec | iP->Loc.qfvec); iP->Loc.qfvec = 0;
        Sel.Path.Ref    = iP->Key.Ref;
       } else retc = 0;
@@ -448,6 +469,19 @@ void XrdCmsCache::Add2Q(XrdCmsRRQInfo *Info, XrdCmsKeyItem *iP, int selOpts)
                else  iP->Loc.roPend = Slot;
 }
 
+/******************************************************************************/
+/*                              C a c h e L v l                               */
+/******************************************************************************/
+
+// Returns the highest cache level reported by any node that has the file.
+  
+int XrdCmsCache::CacheLvl(XrdCmsKeyLoc &Loc)
+{
+   if (Loc.fcvec & Loc.hfvec) return XrdCmsSelect::CacheFull;
+   if (Loc.hcvec & Loc.hfvec) return XrdCmsSelect::CacheHalf;
+   return XrdCmsSelect::CacheLow;
+}
+
 /******************************************************************************/
 /*                              D i s p a t c h                               */
 /******************************************************************************/
@@ -498,7 +532,7 @@ SMask_t XrdCmsCache::getBVec(unsigned int TODa, unsigned int &TODb)
 // Calculate the new vector
 //
    for (i = 0; i <= vecHi; i++)
-       if (TODb < Bounced[i]) BVec |= 1ULL << i;
+       if (TODb < Bounced[i]) BVec.Set(i);
 
    Bhistory[TODa].Vec   = BVec;
    Bhistory[TODa].Start = TODb;
@@ -550,3 +584,21 @@ void XrdCmsCache::Recycle(XrdCmsKeyItem *theList)
            numRecycled, numHave, numFree);
    Say.Emsg("Recycle", msgBuff);
 }
+
+/******************************************************************************/
+/*                             s e t C a c h e d                              */
+/******************************************************************************/
+
+// Records the cache level reported by the nodes in mask.
+
+void XrdCmsCache::setCached(XrdCmsKeyLoc &Loc, SMask_t mask, int cLvl)
+{
+   switch(cLvl)
+         {case XrdCmsSelect::CacheFull: Loc.hcvec |=  mask; Loc.fcvec |=  mask;
+                                        break;
+          case XrdCmsSelect::CacheHalf: Loc.hcvec |=  mask; Loc.fcvec &= ~mask;
+                                        break;
+          default:                      Loc.hcvec &= ~mask; Loc.fcvec &= ~mask;
+                                        break;
+         }
+}
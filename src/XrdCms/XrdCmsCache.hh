@@ -82,17 +82,19 @@ void       *TickTock();
                             DLTime(5), QDelay(5), Bhits(0), Bmiss(0), vecHi(-1),
                             isDFS(0)
                           {memset(Bounced,  0, sizeof(Bounced));
-                           memset(Bhistory, 0, sizeof(Bhistory));
+                           memset((void *)Bhistory, 0, sizeof(Bhistory));
                           }
            ~XrdCmsCache() {}   // Never gets deleted
 
 private:
 
 void          Add2Q(XrdCmsRRQInfo *Info, XrdCmsKeyItem *cp, int selOpts);
+int           CacheLvl(XrdCmsKeyLoc &Loc);
 void          Dispatch(XrdCmsSelect &Sel, XrdCmsKeyItem *cinfo,
                        short roQ, short rwQ);
 SMask_t       getBVec(unsigned int todA, unsigned int &todB);
 void          Recycle(XrdCmsKeyItem *theList);
+void          setCached(XrdCmsKeyLoc &Loc, SMask_t mask, int cLvl);
 
 struct  {SMask_t      Vec;
          unsigned int Start;
@@ -127,6 +127,16 @@ public:
 
 virtual void   Added(const char *path, int Pend=0) { (void)path; (void)Pend; }
 
+//------------------------------------------------------------------------------
+//! Notify the cms how much of a file is held in a disk cache. It is only
+//! called on a caching data server node (e.g. a caching proxy).
+//!
+//! @param  path  The logical file name.
+//! @param  pct   The percentage of the file that is cached (0 to 100).
+//------------------------------------------------------------------------------
+
+virtual void   Cached(const char *path, int pct) { (void)path; (void)pct; }
+
 //------------------------------------------------------------------------------
 //! Configure the client object.
 //!
@@ -365,7 +375,8 @@ namespace XrdCms
 enum  {IsProxy  = 1, //!< The role is proxy  {plus one or more of the below}
        IsRedir  = 2, //!< The role is manager and will redirect users
        IsTarget = 4, //!< The role is server  and will be a redirection target
-       IsMeta   = 8  //!< The role is meta   {plus one or more of the above}
+       IsMeta   = 8, //!< The role is meta   {plus one or more of the above}
+       IsCache  = 16 //!< Only reports cached files {plus IsTarget}
       };
 }
 
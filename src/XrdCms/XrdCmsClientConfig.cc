@@ -427,12 +427,14 @@ int XrdCmsClientConfig::xmang(XrdOucStream &Config)
 
    Purpose:  To parse the directive: request [repwait <sec1>] [delay <sec2>]
                                              [noresp <cnt>] [prep <ms>]
-                                             [fwd <ms>]
+                                             [fwd <ms>] [async <ms>]
 
              <sec1>  max number of seconds to wait for a cmsd reply
              <sec2>  number of seconds to delay a retry upon failure
              <cnt>   number of no-responses before cms fault declared.
-             <ms>    milliseconds between prepare/forward requests
+             <ms>    milliseconds between prepare/forward requests. For async
+                     the milliseconds to wait for a cmsd reply before the
+                     request is parked and the client is called back later.
 
    Type: Remote server only, dynamic.
 
@@ -445,6 +447,7 @@ int XrdCmsClientConfig::xreqs(XrdOucStream &Config)
     static struct reqsopts {const char *opname; int istime; int *oploc;}
            rqopts[] =
        {
+        {"async",    0, &AsyncWait},
         {"delay",    1, &RepDelay},
         {"fwd",      0, &FwdWait},
         {"noresp",   0, &RepNone},
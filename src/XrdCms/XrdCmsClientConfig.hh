@@ -55,6 +55,7 @@ int           RepDelay;     // Seconds to delay before retrying manager
 int           RepNone;      // Max number of consecutive non-responses
 int           PrepWait;     // Millisecond wait between prepare requests
 int           FwdWait;      // Millisecond wait between foward  requests
+int           AsyncWait;    // Millisecond wait before parking a request
 int           haveMeta;     // Have a meta manager (only if we are a manager)
 
 char         *CMSPath;      // Path to the local cmsd for target nodes
@@ -70,7 +71,8 @@ enum {FailOver = 'f', RoundRob = 'r'};
 
       XrdCmsClientConfig() : ConWait(10), RepWait(3),  RepWaitMS(3000),
                              RepDelay(5), RepNone(8),  PrepWait(33),
-                             FwdWait(0),  haveMeta(0), CMSPath(0),
+                             FwdWait(0),  AsyncWait(0),
+                             haveMeta(0), CMSPath(0),
                              myHost(0),   myName(0),
                              ManList(0),  PanList(0),
                              SMode(FailOver), SModeP(FailOver),
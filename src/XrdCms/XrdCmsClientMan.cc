@@ -28,7 +28,9 @@
 /* specific prior written permission of the institution or contributor.       */
 /******************************************************************************/
 
+#include <string.h>
 #include <time.h>
+#include <netinet/in.h>
 
 #include "XrdCms/XrdCmsClientMan.hh"
 #include "XrdCms/XrdCmsClientMsg.hh"
@@ -80,6 +82,7 @@ XrdCmsClientMan::XrdCmsClientMan(char *host, int port,
    Active  = 0;
    Silent  = 0;
    Suspend = 1;
+   BulkPrep= 0;
    RecvCnt = 0;
    nrMax   = nr;
    NetBuff = BuffPool.Alloc(XrdOucEI::Max_Error_Len);
@@ -219,6 +222,7 @@ int XrdCmsClientMan::Send(const struct iovec *iov, int iovcnt, int iotot)
   
 void *XrdCmsClientMan::Start()
 {
+   XrdCmsResp *parkRP;
 
 // First step is to connect to the manager
 //
@@ -231,11 +235,16 @@ void *XrdCmsClientMan::Start()
        // respwait is synchronized during the callback phase since the client
        // must receive the respwait before the subsequent response.
        //
+       // Replies to parked requests are relayed to the waiting response object
+       // as nobody is waiting for them and we handle respwait here.
+       //
        while(Receive())
                  if (Response.modifier & CmsResponse::kYR_async) relayResp();
             else if (Response.rrCode == kYR_status) setStatus();
-            else if (XrdCmsClientMsg::Reply(HPfx, Response, NetBuff))
-                    {if (Response.rrCode == kYR_waitresp) syncResp.Wait();}
+            else if (XrdCmsClientMsg::Reply(HPfx, Response, NetBuff, parkRP))
+                    {     if (parkRP) relayPark(parkRP);
+                     else if (Response.rrCode == kYR_waitresp) syncResp.Wait();
+                    }
 
        // Tear down the connection
        //
@@ -350,6 +359,7 @@ int XrdCmsClientMan::Hookup()
    RecvCnt  = 1;
    SendCnt  = 1;
    Suspend  = (Data.Mode & CmsLoginData::kYR_suspend);
+   BulkPrep = (Data.Mode & CmsLoginData::kYR_bulkprep) != 0;
 
 // Calculate how long we will wait for replies before delaying the client.
 // This is computed dynamically based on the expected response window.
@@ -402,6 +412,47 @@ int XrdCmsClientMan::Receive()
    return 0;
 }
 
+/******************************************************************************/
+/*                             r e l a y P a r k                              */
+/******************************************************************************/
+  
+void XrdCmsClientMan::relayPark(XrdCmsResp *rp)
+{
+   kXR_unt32 uval;
+   int msgid = 0;
+
+// A respwait for a parked request is handled just like delayResp() does it
+// except that we can add the object to the queue without synchronization.
+//
+   if (Response.rrCode == kYR_waitresp)
+      {if (NetBuff->DataLen() >= (int)sizeof(uval))
+          {memcpy(&uval, NetBuff->Buffer(), sizeof(uval));
+           msgid = static_cast<int>(ntohl(uval));
+          }
+       if (msgid)
+          {rp->setID(msgid);
+           if (msgid < maxMsgID) RespQ.Purge();
+           maxMsgID = msgid;
+           RespQ.Add(rp);
+           return;
+          }
+       Say.Emsg("Manager", Host, "supplied invalid waitr msgid");
+       uval = htonl(kYR_EINVAL);
+       memcpy(NetBuff->Buffer(), &uval, sizeof(uval));
+       strcpy(NetBuff->Buffer()+sizeof(uval), "redirector protocol error");
+       NetBuff->SetLen(sizeof(uval) + strlen(NetBuff->Buffer()+sizeof(uval))+1);
+       Response.rrCode = kYR_error;
+      }
+
+// Queue the request for reply (this transfers the network buffer)
+//
+   rp->Reply(HPfx, Response, NetBuff);
+
+// Obtain a new network buffer
+//
+   NetBuff = BuffPool.Alloc(XrdOucEI::Max_Error_Len);
+}
+
 /******************************************************************************/
 /*                             r e l a y R e s p                              */
 /******************************************************************************/
@@ -49,6 +49,8 @@ public:
 
 static char          doDebug;
 
+inline int           bulkPrep() {return BulkPrep;}
+
 int                  delayResp(XrdOucErrInfo &Resp);
 
 inline int           isActive() {return Active;}
@@ -83,6 +85,7 @@ inline int           waitTime() {return repWait;}
 private:
 int   Hookup();
 int   Receive();
+void  relayPark(XrdCmsResp *rp);
 void  relayResp();
 void  chkStatus();
 void  setStatus();
@@ -107,6 +110,7 @@ int               dally;
 int               Active;
 int               Silent;
 int               Suspend;
+int               BulkPrep;     // Manager accepts batched prepadd requests
 int               RecvCnt;
 int               SendCnt;
 int               nrMax;
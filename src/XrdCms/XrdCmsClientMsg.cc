@@ -31,11 +31,14 @@
 #include <stdlib.h>
   
 #include "XProtocol/YProtocol.hh"
+#include "XrdCms/XrdCmsClientMan.hh"
 #include "XrdCms/XrdCmsClientMsg.hh"
 #include "XrdCms/XrdCmsParser.hh"
+#include "XrdCms/XrdCmsResp.hh"
 #include "XrdCms/XrdCmsTrace.hh"
 #include "XrdOuc/XrdOucBuffer.hh"
 #include "XrdOuc/XrdOucErrInfo.hh"
+#include "XrdSys/XrdSysTimer.hh"
 
 using namespace XrdCms;
  
@@ -45,6 +48,7 @@ using namespace XrdCms;
   
 int               XrdCmsClientMsg::nextid   =  0;
 int               XrdCmsClientMsg::numinQ   =  0;
+int               XrdCmsClientMsg::numParked=  0;
 
 XrdCmsClientMsg  *XrdCmsClientMsg::msgTab   =  0;
 XrdCmsClientMsg  *XrdCmsClientMsg::nextfree =  0;
@@ -109,6 +113,66 @@ int XrdCmsClientMsg::Init()
    return 0;
 }
 
+/******************************************************************************/
+/*                                  P a r k                                   */
+/******************************************************************************/
+  
+// Message object lock *must* be held by the caller upon entry and is released!
+
+void XrdCmsClientMsg::Park(XrdCmsResp *rp, XrdCmsClientMan *manp, int wtime)
+{
+
+// Record the object that will handle the reply and when we give up on it
+//
+   parkRP  = rp;
+   parkMan = manp;
+   parkEnd = time(0) + wtime;
+
+// Count it and let a reply (or the reaper) have at it
+//
+   FreeMsgQ.Lock(); numParked++; FreeMsgQ.UnLock();
+   Hold.UnLock();
+}
+
+/******************************************************************************/
+/*                                R e a p e r                                 */
+/******************************************************************************/
+
+// This static entry is started on a thread when requests may be parked. It
+// times out parked requests whose reply has not arrived in the allotted time.
+//
+void XrdCmsClientMsg::Reaper()
+{
+   CmsRRHdr         Stall = {0, kYR_wait, 0, 0};
+   XrdCmsClientMsg *mp;
+   XrdCmsClientMan *manP;
+   XrdCmsResp      *rP;
+   const char      *Path;
+   time_t           tNow;
+   int              i, theDelay;
+
+// Check for expired requests once a second (there are few message objects)
+//
+   while(1)
+        {XrdSysTimer::Snooze(1);
+         if (!numParked) continue;
+         tNow = time(0);
+         for (i = 0; i < MaxMsgs; i++)
+             {mp = &msgTab[i];
+              mp->Hold.Lock();
+              if (!mp->inwaitq || !mp->parkRP || mp->parkEnd > tNow)
+                 {mp->Hold.UnLock(); continue;}
+              rP = mp->parkRP; manP = mp->parkMan; Stall.streamid = mp->id;
+              mp->Unpark();
+              mp->Recycle();
+              if (!(Path = rP->getErrData())) Path = "";
+              theDelay = manP->whatsUp(rP->getErrUser(), Path);
+              rP->setErrInfo(theDelay, "");
+              rP->Reply(manP->NPfx(), Stall, 0);
+             }
+        }
+}
+
 /******************************************************************************/
 /*                               R e c y c l e                                */
 /******************************************************************************/
@@ -139,18 +203,30 @@ void XrdCmsClientMsg::Recycle()
 /*                                 R e p l y                                  */
 /******************************************************************************/
   
-int XrdCmsClientMsg::Reply(const char *Man, CmsRRHdr &hdr, XrdOucBuffer *buff)
+int XrdCmsClientMsg::Reply(const char *Man, CmsRRHdr &hdr, XrdOucBuffer *buff,
+                           XrdCmsResp *&parkRP)
 {
    EPNAME("Reply")
    XrdCmsClientMsg *mp;
 
 // Find the appropriate message
 //
+   parkRP = 0;
    if (!(mp = XrdCmsClientMsg::RemFromWaitQ(hdr.streamid)))
       {DEBUG("to non-existent message; id=" <<hdr.streamid);
        return 0;
       }
 
+// If the message was parked, nobody is waiting for it. The caller must pass
+// the reply on to the response object that the message was parked with.
+//
+   if (mp->parkRP)
+      {parkRP = mp->parkRP;
+       mp->Unpark();
+       mp->Recycle();
+       return 1;
+      }
+
 // Decode the response
 //
    mp->Result = XrdCmsParser::Decode(Man,hdr,buff,(XrdOucErrInfo *)(mp->Resp));
@@ -165,6 +241,19 @@ int XrdCmsClientMsg::Reply(const char *Man, CmsRRHdr &hdr, XrdOucBuffer *buff)
 /******************************************************************************/
 /*                       P r i v a t e   M e t h o d s                        */
 /******************************************************************************/
+/******************************************************************************/
+/*                                U n p a r k                                 */
+/******************************************************************************/
+
+// Message object lock *must* be held by the caller upon entry!
+
+void XrdCmsClientMsg::Unpark()
+{
+   parkRP  = 0;
+   parkMan = 0;
+   FreeMsgQ.Lock(); numParked--; FreeMsgQ.UnLock();
+}
+
 /******************************************************************************/
 /*                          R e m F r o m W a i t Q                           */
 /******************************************************************************/
@@ -30,10 +30,14 @@
 /* specific prior written permission of the institution or contributor.       */
 /******************************************************************************/
 
+#include <time.h>
+
 #include "XProtocol/YProtocol.hh"
 
 #include "XrdSys/XrdSysPthread.hh"
 
+class  XrdCmsClientMan;
+class  XrdCmsResp;
 class  XrdOucErrInfo;
 class  XrdOucBuffer;
 
@@ -51,17 +55,32 @@ static int       Init();
 
 static int       inQ() {return numinQ;}
 
+static int       inPark() {return numParked;}
+
        void      Lock() {Hold.Lock();}
 
+// Park() hands a locked message over to a response object so that the caller
+// need not wait. The reply is passed to the object by Reply() and if it does
+// not arrive within wtime seconds, Reaper() tells the client to retry.
+//
+       void      Park(XrdCmsResp *rp, XrdCmsClientMan *manp, int wtime);
+
+static void      Reaper();
+
        void      Recycle();
 
-static int       Reply(const char *Man,XrdCms::CmsRRHdr &hdr,XrdOucBuffer *buff);
+static int       Reply(const char *Man,XrdCms::CmsRRHdr &hdr,XrdOucBuffer *buff,
+                       XrdCmsResp *&parkRP);
 
        void      UnLock() {Hold.UnLock();}
 
        int       Wait4Reply(int wtime) {return Hold.Wait(wtime);}
 
-      XrdCmsClientMsg() : Hold(0) {next = 0; inwaitq = 0; Resp = 0; Result = 0;}
+       int       Wait4ReplyMS(int wtime) {return Hold.WaitMS(wtime);}
+
+      XrdCmsClientMsg() : Hold(0) {next = 0; inwaitq = 0; Resp = 0; Result = 0;
+                                   parkRP = 0; parkMan = 0; parkEnd = 0;
+                                  }
      ~XrdCmsClientMsg() {}
 
 private:
@@ -70,9 +89,11 @@ static const int          MaxMsgs = 1024;
 static const int          MidIncr = 1024;
 static const int          IncMask = 0x3ffffc00;
 static XrdCmsClientMsg   *RemFromWaitQ(int msgid);
+       void               Unpark();
 
 static int                nextid;
 static int                numinQ;
+static int                numParked;
 
 static XrdCmsClientMsg   *msgTab;
 static XrdCmsClientMsg   *nextfree;
@@ -84,5 +105,8 @@ int                       inwaitq;
 int                       id;
 XrdOucErrInfo            *Resp;
 int                       Result;
+XrdCmsResp               *parkRP;
+XrdCmsClientMan          *parkMan;
+time_t                    parkEnd;
 };
 #endif
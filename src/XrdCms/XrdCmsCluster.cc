@@ -33,7 +33,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <time.h>
 #include <netinet/in.h>
+#include <sys/time.h>
 #include <sys/types.h>
 
 #include "XProtocol/YProtocol.hh"
@@ -44,6 +46,7 @@
 
 #include "XrdCms/XrdCmsBaseFS.hh"
 #include "XrdCms/XrdCmsBlackList.hh"
+#include "XrdCms/XrdCmsBloom.hh"
 #include "XrdCms/XrdCmsCache.hh"
 #include "XrdCms/XrdCmsConfig.hh"
 #include "XrdCms/XrdCmsCluster.hh"
@@ -112,6 +115,8 @@ XrdCmsCluster::XrdCmsCluster()
      SelRcnt = 0;
      SelRtot = 0;
      SelTcnt = 0;
+     memset((void *)SelStat, 0, sizeof(SelStat));
+     P2CSeed = static_cast<unsigned int>(time(0) ^ (getpid() << 16)) | 1;
      doReset = 0;
      resetMask = 0;
      peerHost  = 0;
@@ -170,6 +175,7 @@ XrdCmsNode *XrdCmsCluster::Add(XrdLink *lp, int port, int Status, int sport,
            nP->isConn    = 1;
            nP->Instance++;
            nP->setName(lp, theIF, port);  // Just in case it changed
+           nP->setSummary();              // Will be resent if still valid
            act = "Reconnect ";
           }
       }
@@ -382,8 +388,8 @@ SMask_t XrdCmsCluster::Broadcast(SMask_t smask, const struct iovec *iod,
 
 // Run through the table looking for nodes to send messages to
 //
-   for (i = 0; i <= STHi; i++)
-       {if ((nP = NodeTab[i]) && nP->isNode(bmask))
+   for (i = bmask.First(); i >= 0 && i <= STHi; i = bmask.Next(i))
+       {if ((nP = NodeTab[i]))
            {nP->Lock();
             STMutex.UnLock();
             if (nP->Send(iod, iovcnt, iotot) < 0) 
@@ -533,8 +539,8 @@ XrdCmsSelected *XrdCmsCluster::List(SMask_t mask, CmsLSOpts opts, bool &oksel)
 //
    oksel = false;
    STMutex.Lock();
-   for (i = 0; i <= STHi; i++)
-        if ((nP=NodeTab[i]) && (nP->NodeMask & mask))
+   for (i = mask.First(); i >= 0 && i <= STHi; i = mask.Next(i))
+        if ((nP=NodeTab[i]))
            {oksel = true;
             if (retDest)
                {     if (nP->netIF.HasDest(ifType)) ifGet = ifType;
@@ -585,7 +591,7 @@ int XrdCmsCluster::Locate(XrdCmsSelect &Sel)
 {
    EPNAME("Locate");
    XrdCmsPInfo   pinfo;
-   SMask_t       qfVec(0);
+   SMask_t       qfVec(0), dfVec(0);
    char         *Path;
    int           retc = 0;
 
@@ -593,7 +599,7 @@ int XrdCmsCluster::Locate(XrdCmsSelect &Sel)
 //
    if (*Sel.Path.Val != '*') Path = Sel.Path.Val;
       else {if (*(Sel.Path.Val+1) == '\0')
-               {Sel.Vec.hf = ~0LL; Sel.Vec.pf = Sel.Vec.wf = 0;
+               {Sel.Vec.hf = FULLMASK; Sel.Vec.pf = Sel.Vec.wf = 0;
                 return 0;
                }
             Path = Sel.Path.Val+1;
@@ -647,6 +653,10 @@ int XrdCmsCluster::Locate(XrdCmsSelect &Sel)
        qfVec = pinfo.rovec; Sel.Vec.hf = 0;
       } else qfVec = Sel.Vec.bf;
 
+// Defer nodes whose namespace summary says they cannot have the file.
+//
+   if (qfVec) dfVec = Defer(Sel, qfVec);
+
 // Compute the delay, if any
 //
    if ((!qfVec && retc >= 0) || (Sel.Vec.hf && Sel.InfoP)) retc =  0;
@@ -661,8 +671,8 @@ int XrdCmsCluster::Locate(XrdCmsSelect &Sel)
        TRACE(Files, "seeking " <<Sel.Path.Val);
        qfVec = Cluster.Broadcast(qfVec, QReq.Hdr, 
                                  (void *)Sel.Path.Val, Sel.Path.Len+1);
-       if (qfVec) Cache.UnkFile(Sel, qfVec);
       }
+   if ((qfVec |= dfVec)) Cache.UnkFile(Sel, qfVec);
    return retc;
 }
   
@@ -676,7 +686,7 @@ void *XrdCmsCluster::MonPerf()
    struct iovec ioV[] = {{(char *)&Usage, sizeof(Usage)}};
    int ioVnum = sizeof(ioV)/sizeof(struct iovec);
    int ioVtot = sizeof(Usage);
-   SMask_t allNodes(~0);
+   SMask_t allNodes(FULLMASK);
    int uInterval = Config.AskPing*Config.AskPerf;
 
 // Sleep for the indicated amount of time, then ask for load on each server
@@ -905,7 +915,7 @@ int XrdCmsCluster::Select(XrdCmsSelect &Sel)
    XrdCmsPInfo  pinfo;
    const char  *Amode;
    int dowt = 0, retc = 0, isRW, fRD, noSel = (Sel.Opts & XrdCmsSelect::Defer);
-   SMask_t amask, smask, pmask;
+   SMask_t amask, smask, pmask, dmask(0);
 
 // Establish some local options
 //
@@ -921,7 +931,7 @@ int XrdCmsCluster::Select(XrdCmsSelect &Sel)
 // Find out who serves this path
 //
    if (!Cache.Paths.Find(Sel.Path.Val, pinfo)
-   || (amask = ((isRW ? pinfo.rwvec : pinfo.rovec) & ~Sel.nmask)) == 0)
+   || !(amask = ((isRW ? pinfo.rwvec : pinfo.rovec) & ~Sel.nmask)))
       {Sel.Resp.DLen = snprintf(Sel.Resp.Data, sizeof(Sel.Resp.Data)-1,
                        "No servers have %s access to the file", Amode)+1;
        return -1;
@@ -950,8 +960,20 @@ int XrdCmsCluster::Select(XrdCmsSelect &Sel)
 // meta-operation (e.g., remove) in which case the file itself remain unmodified
 // or a replica request, in which case we select a new target server.
 //
-   if (!(Sel.Opts & XrdCmsSelect::Refresh)
-   &&   (retc = Cache.GetFile(Sel, pinfo.rovec)))
+   if ((Sel.Opts & XrdCmsSelect::Refresh)
+   ||  !(retc = Cache.GetFile(Sel, pinfo.rovec)))
+      {Cache.AddFile(Sel, 0);
+       Sel.Vec.bf = pinfo.rovec;
+       Sel.Vec.hf = Sel.Vec.pf = Sel.Vec.hc = Sel.Vec.fc = 0;
+       retc = 0;
+      }
+
+// Defer nodes whose namespace summary says they cannot have the file. Writers
+// always ask everyone as only one writable copy may exist.
+//
+   if (Sel.Vec.bf && !isRW) dmask = Defer(Sel, Sel.Vec.bf);
+
+   if (retc)
       {if (isRW)
           {     if (retc<0) return Config.LUPDelay;
               else if (Sel.Opts & XrdCmsSelect::Replica)
@@ -976,12 +998,7 @@ int XrdCmsCluster::Select(XrdCmsSelect &Sel)
            else smask = (retc < 0 ? 0 : pinfo.ssvec & amask);
           }
        if (Sel.Vec.hf & Sel.nmask) Cache.UnkFile(Sel, Sel.nmask);
-      } else {
-       Cache.AddFile(Sel, 0); 
-       Sel.Vec.bf = pinfo.rovec; 
-       Sel.Vec.hf = Sel.Vec.pf = pmask = smask = 0;
-       retc = 0;
-      }
+      } else pmask = smask = 0;
 
 // A wait is required if we don't have any primary or seconday servers
 //
@@ -998,10 +1015,13 @@ int XrdCmsCluster::Select(XrdCmsSelect &Sel)
        TRACE(Files, "seeking " <<Sel.Path.Val);
        amask = Cluster.Broadcast(Sel.Vec.bf, QReq.Hdr,
                                  (void *)Sel.Path.Val,Sel.Path.Len+1);
-       if (amask) Cache.UnkFile(Sel, amask);
+       if ((amask |= dmask)) Cache.UnkFile(Sel, amask);
        if (dowt) return retc;
-      } else if (dowt && retc < 0 && !noSel)
-                return (fRD ? Cache.WT4File(Sel,Sel.Vec.hf) : Config.LUPDelay);
+      } else {
+       if (dmask) Cache.UnkFile(Sel, dmask);
+       if (dowt && retc < 0 && !noSel)
+          return (fRD ? Cache.WT4File(Sel,Sel.Vec.hf) : Config.LUPDelay);
+      }
 
 // Broadcast a freshen up request if wanted
 //
@@ -1025,11 +1045,9 @@ int XrdCmsCluster::Select(XrdCmsSelect &Sel)
 int XrdCmsCluster::Select(SMask_t pmask, int &port, char *hbuff, int &hlen,
                           int isrw, int isMulti, int ifWant)
 {
-   static const SMask_t smLow(255);
    XrdCmsSelector selR;
    XrdCmsNode *nP = 0;
-   SMask_t tmask;
-   int Snum = 0;
+   int Snum;
    XrdNetIF::ifType nType = static_cast<XrdNetIF::ifType>(ifWant);
 
 // If there is nothing to select from, return failure
@@ -1046,7 +1064,7 @@ int XrdCmsCluster::Select(SMask_t pmask, int &port, char *hbuff, int &hlen,
 //
    if (isMulti || baseFS.isDFS())
       {STMutex.Lock();
-       nP = (Config.sched_RR ? SelbyRef(pmask,selR) : SelbyLoad(pmask,selR));
+       nP = Selby(pmask, selR);
        STMutex.UnLock();
        if (!nP) return 0;
        hlen = nP->netIF.GetName(hbuff, port, nType) + 1;
@@ -1057,9 +1075,7 @@ int XrdCmsCluster::Select(SMask_t pmask, int &port, char *hbuff, int &hlen,
 // In shared-nothing systems the incomming mask will only have a single node.
 // Compute the a single node number that is contained in the mask.
 //
-   do {if (!(tmask = pmask & smLow)) Snum += 8;
-         else {while((tmask = tmask>>1)) Snum++; break;}
-      } while((pmask = pmask >> 8));
+   Snum = pmask.First();
 
 // See if the node passes muster
 //
@@ -1131,9 +1147,8 @@ void XrdCmsCluster::Space(SpaceData &sData, SMask_t smask)
 
 // Run through the table getting space information
 //
-   for (i = 0; i <= STHi; i++)
-       if ((nP = NodeTab[i]) && nP->isNode(bmask)
-       && !(nP->isOffline)   && nP->isRW)
+   for (i = bmask.First(); i >= 0 && i <= STHi; i = bmask.Next(i))
+       if ((nP = NodeTab[i]) && !(nP->isOffline) && nP->isRW)
           {sData.Total += nP->DiskTotal;
            sData.sNum++;
            if (sData.sFree < nP->DiskFree)
@@ -1189,14 +1204,18 @@ int XrdCmsCluster::Statt(char *bfr, int bln)
    static const char statfmt5[] =
           "<frq><add>%lld<d>%lld</d></add><rsp>%lld<m>%lld</m></rsp>"
           "<lf>%lld</lf><ls>%lld</ls><rf>%lld</rf><rs>%lld</rs></frq>";
+   static const char statfmt6[] =
+          "<pol><load>%lld<ns>%lld</ns></load><ref>%lld<ns>%lld</ns></ref>"
+          "<rand>%lld<ns>%lld</ns></rand><cost>%lld<ns>%lld</ns></cost></pol>";
 
    static int AddFrq = (Config.RepStats & XrdCmsConfig::RepStat_frq);
    static int AddShr = (Config.RepStats & XrdCmsConfig::RepStat_shr)
                        && Config.asMetaMan();
+   static int AddSel = (Config.RepStats & XrdCmsConfig::RepStat_sel);
 
    XrdCmsRRQ::Info Frq;
    XrdCmsSelected *sp;
-   long long SelRnum, SelWnum;
+   long long SelRnum, SelWnum, Pol[selNum][2];
    int mlen, tlen, n = 0;
    char shrBuff[80], stat[6], *stp;
    bool oksel;
@@ -1218,6 +1237,7 @@ int XrdCmsCluster::Statt(char *bfr, int bln)
           (sizeof(statfmt2) + 10*2 + 256 + 16) * STMax + sizeof(statfmt4);
        if (AddShr) n += sizeof(statfmt3) + 12;
        if (AddFrq) n += sizeof(statfmt4) + (10*8);
+       if (AddSel) n += sizeof(statfmt6) + (20*8);
        return n;
       }
 
@@ -1236,6 +1256,8 @@ int XrdCmsCluster::Statt(char *bfr, int bln)
    STMutex.Lock();
    SelRnum = SelRtot + SelRcnt;
    SelWnum = SelWtot + SelWcnt;
+   for (int i = 0; i < selNum; i++)
+       {Pol[i][0] = SelStat[i].Num; Pol[i][1] = SelStat[i].Time;}
    STMutex.UnLock();
 
 // Format the statistics
@@ -1274,6 +1296,15 @@ int XrdCmsCluster::Statt(char *bfr, int bln)
        bfr += mlen; bln -= mlen; tlen += mlen;
       }
 
+   if (AddSel && bln > 0)
+      {mlen = snprintf(bfr, bln, statfmt6,
+                       Pol[selLoad][0], Pol[selLoad][1],
+                       Pol[selRef ][0], Pol[selRef ][1],
+                       Pol[selP2C ][0], Pol[selP2C ][1],
+                       Pol[selCost][0], Pol[selCost][1]);
+       bfr += mlen; bln -= mlen; tlen += mlen;
+      }
+
 // See if we overflowed. otherwise finish up
 //
    if (sp || bln < (int)sizeof(statfmt0)) return 0;
@@ -1390,36 +1421,61 @@ int XrdCmsCluster::Drop(int sent, int sinst, XrdCmsDrop *djp)
    return 0;
 }
 
+/******************************************************************************/
+/*                                 D e f e r                                  */
+/******************************************************************************/
+
+// Removes from qmask the nodes whose namespace summary says they cannot have
+// the file and returns them. Nodes without a summary are always retained. A
+// summary only orders the queries: the removed nodes are left unqueried and
+// are asked once no other node has or may have the file. This trades freshness
+// for fewer queries: a summary misses files that arrived since the last scan
+// other than by a "have", so such a file and a file no one has cost another
+// query round. A miss is never inferred from a summary and a refresh ignores
+// them.
+//
+SMask_t XrdCmsCluster::Defer(XrdCmsSelect &Sel, SMask_t &qmask)
+{
+   EPNAME("Defer");
+   XrdCmsNode *nP;
+   SMask_t smask, xmask(0);
+   unsigned int h1, h2;
+   int i;
+
+// Check if there is anything to screen
+//
+   if (Sel.Opts & XrdCmsSelect::Refresh
+   || !(smask = qmask & XrdCmsNode::bfMask)) return SMask_t(0);
+
+// Compute the hash once and apply it to each node's summary
+//
+   XrdCmsBloom::Hash(Sel.Path.Val, Sel.Path.Len, h1, h2);
+   STMutex.Lock();
+   XrdCmsNode::bfMutex.Lock();
+   for (i = smask.First(); i >= 0 && i <= STHi; i = smask.Next(i))
+       {if ((nP = NodeTab[i]) && nP->bfActv && !(nP->bfActv->Has(h1, h2)))
+           xmask |= nP->NodeMask;
+       }
+   XrdCmsNode::bfMutex.UnLock();
+   STMutex.UnLock();
+
+// Defer the unlikely nodes unless they are the only ones left to ask and no
+// node is known to have the file
+//
+   if (!xmask || (xmask == qmask && !Sel.Vec.hf)) return SMask_t(0);
+   TRACE(Files, "summary defers " <<std::hex <<xmask <<std::dec
+                <<" for " <<Sel.Path.Val);
+   qmask &= ~xmask;
+   return xmask;
+}
+
 /******************************************************************************/
 /*                              M u l t i p l e                               */
 /******************************************************************************/
 
 int XrdCmsCluster::Multiple(SMask_t mVec)
 {
-   static const unsigned long long Left32  = 0xffffffff00000000LL;
-   static const unsigned long long Right32 = 0x00000000ffffffffLL;
-   static const unsigned long long Left16  = 0x00000000ffff0000LL;
-   static const unsigned long long Right16 = 0x000000000000ffffLL;
-   static const unsigned long long Left08  = 0x000000000000ff00LL;
-   static const unsigned long long Right08 = 0x00000000000000ffLL;
-   static const unsigned long long Left04  = 0x00000000000000f0LL;
-   static const unsigned long long Right04 = 0x000000000000000fLL;
-//                                0 1 2 3 4 5 6 7 8 9 A B C D E F
-   static const int isMult[16] = {0,0,0,1,0,1,1,1,0,1,1,1,1,1,1,1};
-
-   if (mVec & Left32) {if (mVec & Right32) return 1;
-                          else mVec = mVec >> 32LL;
-                      }
-   if (mVec & Left16) {if (mVec & Right16) return 1;
-                          else mVec = mVec >> 16LL;
-                      }
-   if (mVec & Left08) {if (mVec & Right08) return 1;
-                          else mVec = mVec >>  8LL;
-                      }
-   if (mVec & Left04) {if (mVec & Right04) return 1;
-                          else mVec = mVec >>  4LL;
-                      }
-   return isMult[mVec];
+   return mVec.Count() > 1;
 }
   
 /******************************************************************************/
@@ -1450,7 +1506,7 @@ int XrdCmsCluster::SelNode(XrdCmsSelect &Sel, SMask_t pmask, SMask_t amask)
     EPNAME("SelNode")
     const char *act=0;
     int isalt = 0, pass = 2;
-    SMask_t mask;
+    SMask_t mask, cmask;
     XrdCmsNode *nP = 0;
     XrdCmsSelector selR;
     XrdNetIF::ifType nType=(XrdNetIF::ifType)(Sel.Opts & XrdCmsSelect::ifWant);
@@ -1466,14 +1522,24 @@ int XrdCmsCluster::SelNode(XrdCmsSelect &Sel, SMask_t pmask, SMask_t amask)
       else selR.needSpace = (Sel.Opts & XrdCmsSelect::Write
                           ?  XrdCmsNode::allowsRW : 0);
 
-// Scan for a primary and alternate node (alternates do staging). At this
-// point we omit all peer nodes as they are our last resort.
+// For reads, first try the primary nodes that cache most of the file, the
+// ones holding the whole file first. Should none of them be usable we simply
+// fall back to the primary nodes as a whole.
 //
    STMutex.Lock();
    mask = pmask & peerMask;
+   if (!(Sel.Opts & XrdCmsSelect::Write) && (cmask = Sel.Vec.hc & mask))
+      {if (Sel.Vec.fc & cmask) nP = Selby(Sel.Vec.fc & cmask, selR);
+       if (!nP && (cmask != (Sel.Vec.fc & cmask))) nP = Selby(cmask, selR);
+       if (nP) {pass = 0; act = " serving cached ";}
+      }
+
+// Scan for a primary and alternate node (alternates do staging). At this
+// point we omit all peer nodes as they are our last resort.
+//
    while(pass--)
         {if (mask)
-            {nP=(Config.sched_RR ? SelbyRef(mask,selR) : SelbyLoad(mask,selR));
+            {nP = Selby(mask, selR);
              if (nP || (selR.nPick && selR.delay)
              ||  NodeCnt < Config.SUPCount) break;
             }
@@ -1497,7 +1563,7 @@ int XrdCmsCluster::SelNode(XrdCmsSelect &Sel, SMask_t pmask, SMask_t amask)
            if (Sel.iovN && Sel.iovP) 
               {nP->Send(Sel.iovP, Sel.iovN); act = " staging ";}
               else if (!act)                 act = " assigned ";
-          } else                             act = " serving ";
+          } else if (!act)                   act = " serving ";
        nP->UnLock();
        TRACE(Stage, Sel.Resp.Data <<act <<Sel.Path.Val);
        return 0;
@@ -1525,7 +1591,7 @@ int XrdCmsCluster::SelNode(XrdCmsSelect &Sel, SMask_t pmask, SMask_t amask)
        int delay1 = selR.delay;
        bool noNet = selR.xNoNet;
        STMutex.Lock();
-       if ((mask = (pmask | amask) & peerHost)) nP = SelbyCost(mask, selR);
+       if ((mask = (pmask | amask) & peerHost)) nP = Selby(mask, selR, true);
        STMutex.UnLock();
        if (nP)
           {Sel.Resp.DLen = nP->netIF.GetName(Sel.Resp.Data,Sel.Resp.Port,nType);
@@ -1568,6 +1634,50 @@ int XrdCmsCluster::SelNode(XrdCmsSelect &Sel, SMask_t pmask, SMask_t amask)
             sP->Shrem = sP->Share; sP->Shrin++;                \
            }
   
+/******************************************************************************/
+/*                                 S e l b y                                  */
+/******************************************************************************/
+
+// Selby() dispatches to the configured selection policy and accounts for the
+// time spent in it. The caller must hold the STMutex.
+
+namespace
+{
+long long selClock()
+{
+#if defined(__linux__)
+   struct timespec tNow;
+   clock_gettime(CLOCK_MONOTONIC, &tNow);
+   return tNow.tv_sec*1000000000LL + tNow.tv_nsec;
+#else
+   struct timeval  tNow;
+   gettimeofday(&tNow, 0);
+   return tNow.tv_sec*1000000000LL + tNow.tv_usec*1000LL;
+#endif
+}
+}
+
+XrdCmsNode *XrdCmsCluster::Selby(SMask_t mask, XrdCmsSelector &selR,
+                                 bool isPeer)
+{
+   XrdCmsNode *nP;
+   long long tBeg = selClock();
+   int pol;
+
+// Peers are always selected by cost, otherwise use the configured policy
+//
+        if (isPeer)                {pol = selCost; nP = SelbyCost(mask, selR);}
+   else if (Config.sched_P2C > 1)  {pol = selP2C;  nP = SelbyP2C (mask, selR);}
+   else if (Config.sched_RR)       {pol = selRef;  nP = SelbyRef (mask, selR);}
+   else                            {pol = selLoad; nP = SelbyLoad(mask, selR);}
+
+// Account for this selection
+//
+   SelStat[pol].Num++;
+   SelStat[pol].Time += selClock() - tBeg;
+   return nP;
+}
+  
 /******************************************************************************/
 /*                             S e l b y C o s t                              */
 /******************************************************************************/
@@ -1583,8 +1693,8 @@ XrdCmsNode *XrdCmsCluster::SelbyCost(SMask_t mask, XrdCmsSelector &selR)
 // Scan for a node (sp points to the selected one)
 //
    selR.Reset(); SelTcnt++;
-   for (int i = 0; i <= STHi; i++)
-       if ((np = NodeTab[i]) && (np->NodeMask & mask))
+   for (int i = mask.First(); i >= 0 && i <= STHi; i = mask.Next(i))
+       if ((np = NodeTab[i]))
           {if (!(selR.needNet &  np->hasNet))    {selR.xNoNet= true; continue;}
            selR.nPick++;
            if (np->isOffline)                    {selR.xOff  = true; continue;}
@@ -1623,8 +1733,8 @@ XrdCmsNode *XrdCmsCluster::SelbyLoad(SMask_t mask, XrdCmsSelector &selR)
 // Scan for a node (preset possible, suspended, overloaded, full, and dead)
 //
    selR.Reset(); SelTcnt++;
-   for (int i = 0; i <= STHi; i++)
-       if ((np = NodeTab[i]) && (np->NodeMask & mask))
+   for (int i = mask.First(); i >= 0 && i <= STHi; i = mask.Next(i))
+       if ((np = NodeTab[i]))
           {if (!(selR.needNet & np->hasNet))      {selR.xNoNet= true; continue;}
            selR.nPick++;
            if (np->isOffline)                     {selR.xOff  = true; continue;}
@@ -1655,6 +1765,70 @@ XrdCmsNode *XrdCmsCluster::SelbyLoad(SMask_t mask, XrdCmsSelector &selR)
    return sp;
 }
 
+/******************************************************************************/
+/*                              S e l b y P 2 C                               */
+/******************************************************************************/
+
+// Power of d choices selection: the usual eligibility tests are applied to all
+// of the nodes in the mask but, rather than relying on load reports that may
+// be seconds old, d eligible nodes are chosen at random and the one with the
+// fewest recent references weighted by its observed ping response time wins.
+// This spreads bursts of requests over the cluster instead of herding them
+// onto whichever node last reported the lowest load.
+
+XrdCmsNode *XrdCmsCluster::SelbyP2C(SMask_t mask, XrdCmsSelector &selR)
+{
+    static const long long minLat = 1000; // Latency floor in microseconds
+    XrdCmsNode *np, *sp = 0, *nTab[STMax];
+    long long sCost = 0, nCost;
+    bool reqSS = (selR.needSpace & XrdCmsNode::allowsSS) != 0;
+    int i, k, nNum = 0, nPick = Config.sched_P2C;
+
+// Collect the eligible nodes (preset possible, suspended, overloaded, full,
+// and dead) exactly as load based selection would.
+//
+   selR.Reset(); SelTcnt++;
+   for (i = mask.First(); i >= 0 && i <= STHi; i = mask.Next(i))
+       if ((np = NodeTab[i]))
+          {if (!(selR.needNet & np->hasNet))      {selR.xNoNet= true; continue;}
+           selR.nPick++;
+           if (np->isOffline)                     {selR.xOff  = true; continue;}
+           if (np->isBad)                         {selR.xSusp = true; continue;}
+           if (!Config.sched_RR && np->myLoad > Config.MaxLoad)
+                                                  {selR.xOvld = true; continue;}
+           if (selR.needSpace && (np->DiskFree < np->DiskMinF
+                                  || (reqSS && np->isNoStage)))
+              {selR.xFull = true; continue;}
+           nTab[nNum++] = np;
+          }
+
+// If nothing is eligible, tell the caller how long to wait
+//
+   if (!nNum) return calcDelay(selR);
+
+// Sample without replacement by moving each pick to the front of the table.
+// When we have no more than the sample size, every node is a candidate.
+//
+   if (nPick > nNum) nPick = nNum;
+   for (i = 0; i < nPick; i++)
+       {if (nNum > nPick)
+           {P2CSeed ^= P2CSeed << 13; P2CSeed ^= P2CSeed >> 17;
+            P2CSeed ^= P2CSeed << 5;
+            k = i + static_cast<int>(P2CSeed % (nNum - i));
+            np = nTab[k]; nTab[k] = nTab[i]; nTab[i] = np;
+           } else np = nTab[i];
+        nCost = static_cast<long long>(selR.needSpace ? np->RefW : np->RefR);
+        nCost = (nCost + 1) * (np->RespLat + minLat);
+        if (!sp || nCost < sCost) {sp = np; sCost = nCost;}
+       }
+
+// Return the chosen node locked
+//
+   sp->Lock();
+   RefCount(sp, (nNum > 1), selR.needSpace);
+   return sp;
+}
+
 /******************************************************************************/
 /*                              S e l b y R e f                               */
 /******************************************************************************/
@@ -1667,8 +1841,8 @@ XrdCmsNode *XrdCmsCluster::SelbyRef(SMask_t mask, XrdCmsSelector &selR)
 // Scan for a node (sp points to the selected one)
 //
    selR.Reset(); SelTcnt++;
-   for (int i = 0; i <= STHi; i++)
-       if ((np = NodeTab[i]) && (np->NodeMask & mask))
+   for (int i = mask.First(); i >= 0 && i <= STHi; i = mask.Next(i))
+       if ((np = NodeTab[i]))
           {if (!(selR.needNet & np->hasNet))    {selR.xNoNet= true; continue;}
            selR.nPick++;
            if (np->isOffline)                   {selR.xOff  = true; continue;}
@@ -1700,7 +1874,7 @@ int XrdCmsCluster::SelDFS(XrdCmsSelect &Sel, SMask_t amask,
                           SMask_t &pmask, SMask_t &smask, int isRW)
 {
    EPNAME("SelDFS");
-   static const SMask_t allNodes(~0);
+   static const SMask_t allNodes(FULLMASK);
    int oldOpts, rc;
 
 // The first task is to find out if the file exists somewhere. If we are doing
@@ -202,14 +202,17 @@ private:
 XrdCmsNode *AddAlt(XrdCmsClustID *cidP, XrdLink *lp, int port, int Status,
                    int sport, const char *theNID, const char *theIF);
 XrdCmsNode *calcDelay(XrdCmsSelector &selR);
+SMask_t     Defer(XrdCmsSelect &Sel, SMask_t &qmask);
 int         Drop(int sent, int sinst, XrdCmsDrop *djp=0);
 void        Record(char *path, const char *reason, bool force=false);
 int         Multiple(SMask_t mVec);
 enum        {eExists, eDups, eROfs, eNoRep, eNoEnt}; // Passed to SelFail
 int         SelFail(XrdCmsSelect &Sel, int rc);
 int         SelNode(XrdCmsSelect &Sel, SMask_t  pmask, SMask_t  amask);
+XrdCmsNode *Selby    (SMask_t, XrdCmsSelector &selR, bool isPeer=false);
 XrdCmsNode *SelbyCost(SMask_t, XrdCmsSelector &selR);
 XrdCmsNode *SelbyLoad(SMask_t, XrdCmsSelector &selR);
+XrdCmsNode *SelbyP2C (SMask_t, XrdCmsSelector &selR);
 XrdCmsNode *SelbyRef (SMask_t, XrdCmsSelector &selR);
 int         SelDFS(XrdCmsSelect &Sel, SMask_t amask,
                    SMask_t &pmask, SMask_t &smask, int isRW);
@@ -234,6 +237,12 @@ long long     SelRcnt;          // Curr  number of r/o selections (successful)
 long long     SelRtot;          // Total number of r/o selections (successful)
 long long     SelTcnt;          // Total number of all selections
 
+// Per-policy selection counts and elapsed nanoseconds (protected by STMutex)
+//
+enum          {selLoad = 0, selRef, selP2C, selCost, selNum};
+struct        {long long Num, Time;} SelStat[selNum];
+unsigned int  P2CSeed;          // Random sampling state (protected by STMutex)
+
 // The following is a list of IP:Port tokens that identify supervisor nodes.
 // The information is sent via the try request to redirect nodes; as needed.
 // The list is alays rotated by one entry each time it is sent.
@@ -49,6 +49,7 @@
 #include "XrdCms/XrdCmsAdmin.hh"
 #include "XrdCms/XrdCmsBaseFS.hh"
 #include "XrdCms/XrdCmsBlackList.hh"
+#include "XrdCms/XrdCmsBloom.hh"
 #include "XrdCms/XrdCmsCache.hh"
 #include "XrdCms/XrdCmsCluster.hh"
 #include "XrdCms/XrdCmsConfig.hh"
@@ -62,6 +63,7 @@
 #include "XrdCms/XrdCmsRRQ.hh"
 #include "XrdCms/XrdCmsSecurity.hh"
 #include "XrdCms/XrdCmsState.hh"
+#include "XrdCms/XrdCmsSummary.hh"
 #include "XrdCms/XrdCmsSupervisor.hh"
 #include "XrdCms/XrdCmsTrace.hh"
 #include "XrdCms/XrdCmsUtils.hh"
@@ -500,6 +502,7 @@ int XrdCmsConfig::ConfigXeq(char *var, XrdOucStream &CFile, XrdSysError *eDest)
    TS_Xeq("role",          xrole);   // Server,  non-dynamic
    TS_Xeq("seclib",        xsecl);   // Server,  non-dynamic
    TS_Xeq("subcluster",    xsubc);   // Manager, non-dynamic
+   TS_Xeq("summary",       xsumm);   // Server,  non-dynamic
    TS_Set("wait",          doWait);  // Server,  non-dynamic (backward compat)
    TS_unSet("nowait",      doWait);  // Server,  non-dynamic
    TS_Xer("whitelist",     xblk,true);//Manager, non-dynamic
@@ -672,6 +675,7 @@ void XrdCmsConfig::ConfigDefaults(void)
    myPaths  = (char *)""; // Default is 'r /'
    ConfigFN = 0;
    sched_RR = 0;
+   sched_P2C= 0;
    isManager= 0;
    isMeta   = 0;
    isPeer   = 0;
@@ -1034,8 +1038,13 @@ int XrdCmsConfig::setupManager()
 //
    sched_RR = (100 == P_fuzz) || !AskPerf
               || !(P_cpu || P_io || P_load || P_mem || P_pag);
-   if (sched_RR)
-      Say.Say("Config round robin scheduling in effect.");
+   if (sched_P2C > 1)
+      {char buff[8];
+       sprintf(buff, "%d", sched_P2C);
+       Say.Say("Config power of ", buff, " choices scheduling in effect.");
+      }
+      else if (sched_RR)
+              Say.Say("Config round robin scheduling in effect.");
 
 // Create statistical monitoring thread
 //
@@ -1116,6 +1125,10 @@ int XrdCmsConfig::setupServer()
    if (isProxy) return 0;
    DiskOK = 1; 
 
+// Start the namespace summary if so wanted
+//
+   if (Summary.isOn() && !Summary.Start()) return 1;
+
 // If this is a staging server then set up the Prepq object
 //
    if (DiskSS) PrepQ.Reset(myInsName, AdminPath, AdminMode);
@@ -2256,6 +2269,7 @@ int XrdCmsConfig::xreps(XrdSysError *eDest, XrdOucStream &CFile)
        {
         {"all",      RepStat_All},
         {"frq",      RepStat_frq},
+        {"sel",      RepStat_sel},
         {"shr",      RepStat_shr}
        };
     int i, neg, rsval = 0, numopts = sizeof(rsopts)/sizeof(struct repsopts);
@@ -2466,6 +2480,7 @@ int XrdCmsConfig::xrole(XrdSysError *eDest, XrdOucStream &CFile)
                                        [io <p>] [runq <p>]
                                        [mem <p>] [pag <p>] [space <p>]
                                        [fuzz <p>] [maxload <p>] [refreset <sec>]
+                                       [sample <n>]
 
              <p>      is the percentage to include in the load as a value
                       between 0 and 100. For fuzz this is the largest
@@ -2477,6 +2492,11 @@ int XrdCmsConfig::xrole(XrdSysError *eDest, XrdOucStream &CFile)
                       metamanager (i.e. global share). The gsdflt is the
                       default to be used by the metamanager.
 
+             <n>      the number of randomly chosen eligible servers to compare
+                      when selecting a server (2 to 8). The one with the fewest
+                      recent references weighted by its ping response time is
+                      selected. A value less than 2 disables random sampling.
+
    Type: Any, dynamic.
 
    Output: retc upon success or -EINVAL upon failure.
@@ -2499,7 +2519,8 @@ int XrdCmsConfig::xsched(XrdSysError *eDest, XrdOucStream &CFile)
         {"pag",      100, &P_pag},
         {"space",    100, &P_dsk},
         {"maxload",  100, &MaxLoad},
-        {"refreset", -1,  &RefReset}
+        {"refreset", -1,  &RefReset},
+        {"sample",     8, &sched_P2C}
        };
     int numopts = sizeof(scopts)/sizeof(struct schedopts);
 
@@ -2751,6 +2772,80 @@ int XrdCmsConfig::xsubc(XrdSysError *eDest, XrdOucStream &CFile)
    return (XrdCmsUtils::ParseMan(eDest, &SanList, hSpec, hPort) ? 0 : 1);
 }
   
+/******************************************************************************/
+/*                                 x s u m m                                  */
+/******************************************************************************/
+
+/* Function: xsumm
+
+   Purpose:  To parse the directive: summary [size <sz>] [hashes <n>]
+                                             [interval <t>]
+
+             <sz>  the size of the namespace summary (a Bloom filter) sent to
+                   each manager. It is rounded up to a power of two. The
+                   default is 1m (i.e. 8 million bits).
+             <n>   the number of hash functions used per file. The default
+                   is 4 and the maximum is 16.
+             <t>   the interval between namespace scans. Only the parts of the
+                   summary that changed are sent. The default is 30m.
+
+   Notes:   When specified, managers first ask the servers whose summary
+            says they may have a file and ask this server only if none of
+            them has it. As the summary is only as fresh as the last scan,
+            this trades an extra query round on misses for fewer queries.
+
+   Type: Server only, non-dynamic.
+
+   Output: 0 upon success or !0 upon failure.
+*/
+
+int XrdCmsConfig::xsumm(XrdSysError *eDest, XrdOucStream &CFile)
+{
+    char *val;
+    long long fSize = 1024*1024, bSize;
+    int fHash = 4, fIntv = 30*60;
+
+// If we are a manager, ignore this option
+//
+   if (isManager) return CFile.noEcho();
+
+// Process the options
+//
+   while((val = CFile.GetWord()))
+      {     if (!strcmp("size", val))
+               {if (!(val = CFile.GetWord()))
+                   {eDest->Emsg("Config", "summary size not specified"); return 1;}
+                if (XrdOuca2x::a2sz(*eDest, "summary size", val, &fSize,
+                                    XrdCmsBloom::minSize,
+                                    XrdCmsBloom::maxSize)) return 1;
+               }
+       else if (!strcmp("hashes", val))
+               {if (!(val = CFile.GetWord()))
+                   {eDest->Emsg("Config", "summary hashes not specified");
+                    return 1;
+                   }
+                if (XrdOuca2x::a2i(*eDest, "summary hashes", val, &fHash,
+                                   1, XrdCmsBloom::maxHash)) return 1;
+               }
+       else if (!strcmp("interval", val))
+               {if (!(val = CFile.GetWord()))
+                   {eDest->Emsg("Config", "summary interval not specified");
+                    return 1;
+                   }
+                if (XrdOuca2x::a2tm(*eDest,"summary interval",val,&fIntv,60))
+                   return 1;
+               }
+       else {eDest->Emsg("Config", "invalid summary option -", val); return 1;}
+      }
+
+// Round the size up to a power of two and set the values
+//
+   bSize = XrdCmsBloom::minSize;
+   while(bSize < fSize) bSize <<= 1;
+   Summary.Init(static_cast<int>(bSize), fHash, fIntv);
+   return 0;
+}
+  
 /******************************************************************************/
 /*                                x t r a c e                                 */
 /******************************************************************************/
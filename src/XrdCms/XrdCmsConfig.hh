@@ -116,6 +116,7 @@ int         DiskSS;       // This is a staging server
 int         DiskOK;       // This configuration has data
 
 int         sched_RR;     // 1 -> Simply do round robin scheduling
+int         sched_P2C;    // >1 -> Pick best of this many random servers
 int         doWait;       // 1 -> Wait for a data end-point
 
 int         adsPort;      // Alternate server port
@@ -175,6 +176,7 @@ XrdNetSecurity    *Police;
 //
 static const int RepStat_frq    = 0x0001; // Fast Response Queue
 static const int RepStat_shr    = 0x0002; // Share
+static const int RepStat_sel    = 0x0004; // Selection policy timing
 static const int RepStat_All    = 0xffff; // All
 
 private:
@@ -217,6 +219,7 @@ int  xsched(XrdSysError *edest, XrdOucStream &CFile);
 int  xsecl(XrdSysError *edest, XrdOucStream &CFile);
 int  xspace(XrdSysError *edest, XrdOucStream &CFile);
 int  xsubc(XrdSysError *edest, XrdOucStream &CFile);
+int  xsumm(XrdSysError *edest, XrdOucStream &CFile);
 int  xtrace(XrdSysError *edest, XrdOucStream &CFile);
 
 XrdInet          *NetTCPr;     // Network for supervisors
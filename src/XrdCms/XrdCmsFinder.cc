@@ -113,6 +113,7 @@ XrdCmsFinderRMT::XrdCmsFinderRMT(XrdSysLogger *lp, int whoami, int Port)
      isProxy     = whoami & IsProxy;
      isTarget    = whoami & IsTarget;
      savePath    = 0;
+     AsyncWait   = 0;
      Say.logger(lp);
 }
  
@@ -174,6 +175,7 @@ int XrdCmsFinderRMT::Configure(const char *cfn, char *Args, XrdOucEnv *envP)
    ConWait    = config.ConWait;
    FwdWait    = config.FwdWait;
    PrepWait   = config.PrepWait;
+   AsyncWait  = config.AsyncWait;
    if (isProxy)
            {SMode = config.SModeP;
             StartManagers(config.PanList);
@@ -502,11 +504,12 @@ int XrdCmsFinderRMT::Prepare(XrdOucErrInfo &Resp, XrdSfsPrep &pargs,
    static XrdSysMutex prepMutex;
 
    XrdCmsRRData       Data;
-   XrdOucTList       *tp, *op;
+   XrdOucTList       *tp, *op, *np;
    XrdCmsClientMan   *Manp = 0;
 
-   int                iovcnt = 0, NoteLen, n;
+   int                iovcnt = 0, NoteLen, n, bNum;
    char               Prty[1032], *NoteNum = 0, *colocp = 0;
+   char               Batch[XrdOucPup::MaxLen];
    char               Work[xNum*12];
    struct iovec       xmsg[xNum];
 
@@ -572,22 +575,32 @@ int XrdCmsFinderRMT::Prepare(XrdOucErrInfo &Resp, XrdSfsPrep &pargs,
       }
    Data.Prty = Prty;
 
-// Distribute out paths to the various managers
+// Distribute out paths to the various managers. When the manager accepts
+// batches and there is no per-path notification or co-location to be done,
+// we send as many paths as will fit in a single request.
 //
    Data.Request.rrCode = kYR_prepadd;
    op = pargs.oinfo;
    while(tp)
-        {if (NoteNum) sprintf(NoteNum, "%d", tp->val);
-         Data.Path = tp->text;
-         if (op) {Data.Opaque = op->text; op = op->next;}
-            else  Data.Opaque = 0;
+        {if (!(Manp = SelectManager(Resp, tp->text))) break;
+         if (!NoteNum && !colocp && tp->next && Manp->bulkPrep()
+         &&  (np = PrepBatch(tp, op, Batch, sizeof(Batch), bNum)) != tp)
+            {Data.Request.modifier |=  CmsPrepAddRequest::kYR_batch;
+             Data.Path = Batch; Data.Opaque = 0;
+            } else {
+             Data.Request.modifier &= ~CmsPrepAddRequest::kYR_batch;
+             if (NoteNum) sprintf(NoteNum, "%d", tp->val);
+             Data.Path = tp->text;
+             if (op) {Data.Opaque = op->text; op = op->next;}
+                else  Data.Opaque = 0;
+             np = tp->next; bNum = 1;
+            }
          if (!(iovcnt = Parser.Pack(kYR_prepadd, &xmsg[1], &xmsg[xNum],
                                    (char *)&Data, Work))) break;
-         if (!(Manp = SelectManager(Resp, tp->text))) break;
-         DEBUG("Finder: Sending " <<Manp->Name() <<' ' <<Data.Reqid
-                      <<' ' <<Data.Path);
+         DEBUG("Finder: Sending " <<Manp->Name() <<' ' <<Data.Reqid <<' '
+                      <<(bNum > 1 ? tp->text : Data.Path) <<' ' <<bNum);
          if (!Manp->Send((const struct iovec *)&xmsg, iovcnt+1)) break;
-         if ((tp = tp->next))
+         if ((tp = np))
             {prepMutex.Lock(); XrdSysTimer::Wait(PrepWait); prepMutex.UnLock();}
          if (colocp) {Data.Request.modifier |= CmsPrepAddRequest::kYR_coloc;
                       *colocp = ' '; colocp = 0;
@@ -615,6 +628,43 @@ int XrdCmsFinderRMT::Prepare(XrdOucErrInfo &Resp, XrdSfsPrep &pargs,
    return RepDelay;
 }
 
+/******************************************************************************/
+/*                             P r e p B a t c h                              */
+/******************************************************************************/
+
+// Pack as many <path>[?<cgi>] entries as will fit into bBuff, separated by
+// new-lines. Returns the first path not packed with opaque list advanced in
+// step. When not even one path fits, tp is returned and nothing is changed.
+//
+XrdOucTList *XrdCmsFinderRMT::PrepBatch(XrdOucTList *tp, XrdOucTList *&op,
+                                        char *bBuff, int bBlen, int &bNum)
+{
+   XrdOucTList *xp = op;
+   char *bP = bBuff;
+   int   plen, olen;
+
+// Pack in paths until we run out of room (we must leave room for the null)
+//
+   bNum = 0;
+   while(tp)
+        {plen = strlen(tp->text);
+         olen = (xp && xp->text && *(xp->text) ? strlen(xp->text)+1 : 0);
+         if (plen + olen + 1 >= bBlen - (bP - bBuff)
+         ||  index(tp->text, '\n') || (olen && index(xp->text, '\n'))) break;
+         if (bP != bBuff) *bP++ = '\n';
+         strcpy(bP, tp->text); bP += plen;
+         if (olen) {*bP++ = '?'; strcpy(bP, xp->text); bP += olen-1;}
+         if (xp) xp = xp->next;
+         tp = tp->next; bNum++;
+        }
+
+// Advance the opaque list if we packed anything
+//
+   if (bNum) op = xp;
+   *bP = 0;
+   return tp;
+}
+
 /******************************************************************************/
 /*                         S e l e c t M a n a g e r                          */
 /******************************************************************************/
@@ -682,6 +732,7 @@ int XrdCmsFinderRMT::send2Man(XrdOucErrInfo &Resp, const char *path,
    int              retc;
    XrdCmsClientMsg *mp;
    XrdCmsClientMan *Manp;
+   XrdCmsResp      *rp;
 
 // Select the right manager for this request
 //
@@ -703,9 +754,24 @@ int XrdCmsFinderRMT::send2Man(XrdOucErrInfo &Resp, const char *path,
    if (savePath) Resp.setErrData(path);
       else Resp.setErrData(0);
 
-// Send message and simply wait for the reply (msg object is locked via Alloc)
-//
-   if (!Manp->Send(xmsg, xnum) || (mp->Wait4Reply(Manp->waitTime())))
+// Send message and simply wait for the reply (msg object is locked via Alloc).
+// If the client can be called back, we only wait a short time and then park
+// the request to free this thread. The reply is relayed to the client later.
+//
+   if (!Manp->Send(xmsg, xnum)) retc = 1;
+      else if (AsyncWait <= 0 || !Resp.getErrCB())
+              retc = mp->Wait4Reply(Manp->waitTime());
+      else if ((retc = mp->Wait4ReplyMS(AsyncWait)))
+              {if ((rp = XrdCmsResp::Alloc(&Resp, 0)))
+                  {mp->Park(rp, Manp, Manp->waitTime());
+                   TRACE(Redirect, Resp.getErrUser() <<" parked; path=" <<path);
+                   Resp.setErrInfo(0, "");
+                   return SFS_STARTED;
+                  }
+               retc = mp->Wait4Reply(Manp->waitTime());
+              }
+
+   if (retc)
       {mp->Recycle();
        retc = Manp->whatsUp(Resp.getErrUser(), path);
        Resp.setErrInfo(retc, "");
@@ -738,6 +804,11 @@ void *XrdCmsStartResp(void *carg)
        return (void *)0;
       }
 
+void *XrdCmsStartReaper(void *carg)
+      {XrdCmsClientMsg::Reaper();
+       return (void *)0;
+      }
+
 int XrdCmsFinderRMT::StartManagers(XrdOucTList *theManList)
 {
    XrdOucTList *tp;
@@ -792,6 +863,14 @@ int XrdCmsFinderRMT::StartManagers(XrdOucTList *theManList)
         if (XrdSysThread::Run(&tid,XrdCmsStartResp,(void *)0,0,"async callback"))
             Say.Emsg("Finder", errno, "start callback manager");
 
+// If requests may be parked, start the thread that times them out
+//
+   if (AsyncWait > 0
+   &&  XrdSysThread::Run(&tid, XrdCmsStartReaper, (void *)0, 0, "parked reaper"))
+      {Say.Emsg("Finder", errno, "start parked request reaper");
+       AsyncWait = 0;
+      }
+
 // All done
 //
    return 0;
@@ -867,8 +946,11 @@ XrdCmsFinderTRG::XrdCmsFinderTRG(XrdSysLogger *lp, int whoami, int port,
    myPort  = port;
    resMax  = -1;
    resCur  = 0;
-   sprintf(buff, "login %c %d port %d\n",(isProxy ? 'P' : 'p'),
-                 static_cast<int>(getpid()), port);
+   if (whoami & IsCache)
+      sprintf(buff, "login u cache.%d\n", static_cast<int>(getpid()));
+      else
+      sprintf(buff, "login %c %d port %d\n",(isProxy ? 'P' : 'p'),
+                    static_cast<int>(getpid()), port);
    Login = strdup(buff);
    Say.logger(lp);
 }
@@ -914,6 +996,30 @@ void XrdCmsFinderTRG::Added(const char *path, int Pend)
    myData.UnLock();
 }
 
+/******************************************************************************/
+/*                                C a c h e d                                 */
+/******************************************************************************/
+  
+void XrdCmsFinderTRG::Cached(const char *path, int pct)
+{
+   char *data[4], pBuff[16];
+   int   dlen[4];
+
+// Set up to notify the cluster how much of the file is cached
+//
+   data[0] = (char *)"newfn ";   dlen[0] = 6;
+   data[1] = (char *)path;       dlen[1] = strlen(path);
+   data[2] = pBuff;              dlen[2] = sprintf(pBuff, " c%d\n", pct);
+   data[3] = 0;                  dlen[3] = 0;
+
+// Now send the notification
+//
+   myData.Lock();
+   if (Active && CMSp->Put((const char **)data, (const int *)dlen))
+      {CMSp->Close(); Active = 0;}
+   myData.UnLock();
+}
+
 /******************************************************************************/
 /*                             C o n f i g u r e                              */
 /******************************************************************************/
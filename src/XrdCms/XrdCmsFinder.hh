@@ -85,6 +85,8 @@ private:
 int              Decode(char **resp);
 void             Inform(XrdCmsClientMan *xman, struct iovec xmsg[], int xnum);
 int              LocLocal(XrdOucErrInfo &Resp, XrdOucEnv *Env);
+XrdOucTList     *PrepBatch(XrdOucTList *tp, XrdOucTList *&op,
+                           char *bBuff, int bBlen, int &bNum);
 XrdCmsClientMan *SelectManager(XrdOucErrInfo &Resp, const char *path);
 void             SelectManFail(XrdOucErrInfo &Resp);
 int              send2Man(XrdOucErrInfo &, const char *, struct iovec *, int);
@@ -102,6 +104,7 @@ int              RepNone;
 int              RepWait;
 int              FwdWait;
 int              PrepWait;
+int              AsyncWait;
 int              isMeta;
 int              isProxy;
 int              isTarget;
@@ -123,6 +126,8 @@ class XrdCmsFinderTRG : public XrdCmsClient
 public:
         void   Added(const char *path, int Pend=0);
 
+        void   Cached(const char *path, int pct);
+
         int    Configure(const char *cfn, char *Args, XrdOucEnv *EnvInfo);
 
         int    Locate(XrdOucErrInfo &Resp, const char *path, int flags,
@@ -92,6 +92,8 @@ public:
 SMask_t        hfvec;    // Servers that are staging or have the file
 SMask_t        pfvec;    // Servers that are staging         the file
 SMask_t        qfvec;    // Servers that are not yet queried
+SMask_t        hcvec;    // Servers that cache at least half of the file
+SMask_t        fcvec;    // Servers that cache the whole file
 unsigned int   TOD_B;    // Server currency clock
 unsigned int   Reserved;
 union {
@@ -104,6 +106,7 @@ short          rwPend;   // Redirectors waiting for R/W response
 inline 
 XrdCmsKeyLoc&  operator=(const XrdCmsKeyLoc &rhs)
                            {hfvec=rhs.hfvec; pfvec=rhs.pfvec; TOD_B=rhs.TOD_B;
+                            hcvec=rhs.hcvec; fcvec=rhs.fcvec;
                             deadline = rhs.deadline;
                             roPend = rhs.roPend; rwPend = rhs.rwPend;
                             return *this;
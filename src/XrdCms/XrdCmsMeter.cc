@@ -500,7 +500,7 @@ void XrdCmsMeter::SpaceMsg(int why)
   
 void XrdCmsMeter::UpdtSpace()
 {
-   static const SMask_t allNodes(~0);
+   static const SMask_t allNodes(FULLMASK);
    SpaceData mySpace;
 
 // Get new space values for the cluser
@@ -33,6 +33,7 @@
 #include <stdio.h>
 #include <time.h>
 #include <netinet/in.h>
+#include <sys/time.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 
@@ -42,6 +43,7 @@
 #include "XProtocol/YProtocol.hh"
 
 #include "XrdCms/XrdCmsBaseFS.hh"
+#include "XrdCms/XrdCmsBloom.hh"
 #include "XrdCms/XrdCmsCache.hh"
 #include "XrdCms/XrdCmsCluster.hh"
 #include "XrdCms/XrdCmsClustID.hh"
@@ -78,6 +80,9 @@ XrdSysMutex XrdCmsNode::mlMutex;
 
 int         XrdCmsNode::LastFree = 0;
 
+XrdSysMutex XrdCmsNode::bfMutex;
+SMask_t     XrdCmsNode::bfMask = 0;
+
 namespace
 {
 XrdNetIF::ifType ifVec[4] = {XrdNetIF::PublicV4, XrdNetIF::Public46,
@@ -92,11 +97,10 @@ XrdCmsNode::XrdCmsNode(XrdLink *lnkp, const char *theIF, const char *nid,
                        int port, int lvl, int id)
 {
     static XrdSysMutex   iMutex;
-    static const SMask_t smask_1(1);
     static int           iNum = 1;
 
     Link     =  lnkp;
-    NodeMask =  (id < 0 ? 0 : smask_1 << id);
+    NodeMask =  (id < 0 ? SMask_t(0) : SMask_t::Bit(id));
     NodeID   = id;
     cidP     =  0;
     hasNet   =  0;
@@ -123,12 +127,16 @@ XrdCmsNode::XrdCmsNode(XrdLink *lnkp, const char *theIF, const char *nid,
     RefTotW  =  0;
     RefR     =  0;
     RefTotR  =  0;
+    RespLat  =  0;
+    PingSent =  0;
     Share    =  0;
     Shrem    =  0;
     Shrin    =  0;
     logload  =  Config.LogPerf;
     DropTime =  0;
     DropJob  =  0;
+    bfActv   =  0;
+    bfPend   =  0;
     myName   =  0;
     myNlen   =  0;
     Ident    =  0;
@@ -166,6 +174,7 @@ XrdCmsNode::~XrdCmsNode()
    if (Ident) free(Ident);
    if (myNID) free(myNID);
    if (myName)free(myName);
+   if (bfActv || bfPend) setSummary();
 }
 
 /******************************************************************************/
@@ -322,7 +331,7 @@ const char *XrdCmsNode::do_Disc(XrdCmsRRData &Arg)
 const char *XrdCmsNode::do_Gone(XrdCmsRRData &Arg)
 {
    EPNAME("do_Gone")
-   static const SMask_t allNodes(~0);
+   static const SMask_t allNodes(FULLMASK);
    int newgone;
 
 // Do some debugging
@@ -359,12 +368,20 @@ const char *XrdCmsNode::do_Gone(XrdCmsRRData &Arg)
 /******************************************************************************/
   
 // When a manager receives a have request it is propogated if we are subscribed
-// and we have not sent a have request in the immediate past.
+// and we have not sent a have request in the immediate past. Have requests
+// that carry a cache level are also propagated when the highest cache level
+// in our cell changes; the propagated level is that highest level.
 //
 const char *XrdCmsNode::do_Have(XrdCmsRRData &Arg)
 {
    EPNAME("do_Have")
-   static const SMask_t allNodes(~0);
+   static const SMask_t allNodes(FULLMASK);
+   static const int cacheOpts[] = {0, XrdCmsSelect::CacheLow,
+                                      XrdCmsSelect::CacheHalf,
+                                      XrdCmsSelect::CacheFull};
+   static const int haveOpts[]  = {0, CmsHaveRequest::CacheLow,
+                                      CmsHaveRequest::CacheHalf,
+                                      CmsHaveRequest::CacheFull};
    XrdCmsPInfo  pinfo;
    int isnew, Opts;
 
@@ -379,6 +396,8 @@ const char *XrdCmsNode::do_Have(XrdCmsRRData &Arg)
         ? XrdCmsSelect::Write : 0);
    if (Arg.Request.modifier & CmsHaveRequest::Pending)
       Opts |= XrdCmsSelect::Pending;
+   if ((Arg.Request.modifier & CmsHaveRequest::CacheLvl) && !baseFS.isDFS())
+      Opts |= cacheOpts[(Arg.Request.modifier & CmsHaveRequest::CacheLvl)/4];
 
 // Update path information. If we are exporting a shared-everything file system
 // then we need to also provide the cache the current list of nodes and how
@@ -391,6 +410,16 @@ const char *XrdCmsNode::do_Have(XrdCmsRRData &Arg)
                {Sel.Vec.hf = pinfo.rovec; Sel.Vec.wf = pinfo.rwvec;
                 isnew       = Cache.AddFile(Sel, allNodes);
                } else isnew = Cache.AddFile(Sel, NodeMask);
+            if (Opts & XrdCmsSelect::CacheLvl)
+               {Arg.Request.modifier &= ~CmsHaveRequest::CacheLvl;
+                Arg.Request.modifier |=
+                   haveOpts[(Sel.Opts & XrdCmsSelect::CacheLvl) >> 16];
+               }
+            if (bfActv)
+               {bfMutex.Lock();
+                if (bfActv) bfActv->Add(Arg.Path, Arg.PathLen);
+                bfMutex.UnLock();
+               }
            }
 
 // Return if we have no managers or we already informed the managers
@@ -489,7 +518,7 @@ const char *XrdCmsNode::do_Locate(XrdCmsRRData &Arg)
    XrdCmsSelect    Sel(0, Arg.Path, Arg.PathLen-1);
    XrdCmsSelected *sP = 0;
    struct {kXR_unt32 Val; 
-           char outbuff[CmsLocateRequest::RHLen*STMax];} Resp;
+           char outbuff[XrdCmsMAX_LOC_LEN];} Resp;
    struct iovec ioV[2] = {{(char *)&Arg.Request, sizeof(Arg.Request)},
                           {(char *)&Resp,        0}};
    const char *Why;
@@ -607,15 +636,20 @@ int XrdCmsNode::do_LocFmt(char *buff, XrdCmsSelected *sP,
    static const int Hung = (XrdCmsSelected::Disable | XrdCmsSelected::Offline
                          |  XrdCmsSelected::Suspend);
    XrdCmsSelected *pP;
-   char *oP = buff;
+   char *oP = buff, *eP = buff + XrdCmsMAX_LOC_LEN - 1;
 
 // format out the request as follows:                   
 // 01234567810123456789212345678
 // xy[::123.123.123.123]:123456
 //
+// Entries that do not fit in the buffer are dropped as the response length
+// is limited (only possible with very large clusters and long host names).
+//
 if (lsall)
    while(sP)
-        {*oP = (sP->Status & XrdCmsSelected::isMangr ? 'M' : 'S');
+        {if (oP + sP->IdentLen + 3 >= eP)
+            {pP = sP; sP = sP->next; delete pP; continue;}
+         *oP = (sP->Status & XrdCmsSelected::isMangr ? 'M' : 'S');
          if (sP->Status & Hung) *oP = tolower(*oP);
          *(oP+1) = (sP->Mask   & wfVec               ? 'w' : 'r');
          strcpy(oP+2, sP->Ident); oP += sP->IdentLen + 2;
@@ -624,7 +658,7 @@ if (lsall)
         }
    else
    while(sP)
-        {if (!(sP->Status & Skip))
+        {if (!(sP->Status & Skip) && oP + sP->IdentLen + 3 < eP)
             {*oP     = (sP->Status & XrdCmsSelected::isMangr ? 'M' : 'S');
              if (sP->Mask & pfVec) *oP = tolower(*oP);
              *(oP+1) = (sP->Mask   & wfVec                   ? 'w' : 'r');
@@ -713,7 +747,7 @@ const char *XrdCmsNode::do_Mkpath(XrdCmsRRData &Arg)
 const char *XrdCmsNode::do_Mv(XrdCmsRRData &Arg)
 {
    EPNAME("do_Mv")
-   static const SMask_t allNodes(~0);
+   static const SMask_t allNodes(FULLMASK);
    int rc;
 
 // Do some debugging
@@ -786,9 +820,24 @@ const char *XrdCmsNode::do_Ping(XrdCmsRRData &Arg)
 //
 const char *XrdCmsNode::do_Pong(XrdCmsRRData &Arg)
 {
+   struct timeval tNow;
+   long long rTime;
+
 // Process: pong
 // Reponds: n/a
 
+// Fold the response time into the smoothed response latency used by the
+// power of d choices selection. Only the first pong after a ping counts.
+//
+   if (PingSent)
+      {gettimeofday(&tNow, 0);
+       rTime = tNow.tv_sec*1000000LL + tNow.tv_usec - PingSent;
+       if (rTime < 0) rTime = 0;
+          else if (rTime > 60000000LL) rTime = 60000000LL;
+       RespLat  = (RespLat ? (RespLat*7 + static_cast<int>(rTime)) / 8
+                           :  static_cast<int>(rTime));
+       PingSent = 0;
+      }
    return 0;
 }
   
@@ -800,6 +849,15 @@ const char *XrdCmsNode::do_PrepAdd(XrdCmsRRData &Arg)
 {
    EPNAME("do_PrepAdd")
 
+// Handle a batch of paths. Each one is queued as a separate request.
+//
+   if (Arg.Request.modifier & CmsPrepAddRequest::kYR_batch)
+      {int bNum = XrdCmsPrepArgs::Batch(Arg);
+       DEBUGR("parms: " <<Arg.Reqid <<' ' <<Arg.Notify <<' ' <<Arg.Prty <<' '
+                        <<Arg.Mode  <<' ' <<bNum <<" batched paths");
+       return 0;
+      }
+
 // Do some debugging
 //
    DEBUGR("parms: " <<Arg.Reqid <<' ' <<Arg.Notify <<' ' <<Arg.Prty <<' '
@@ -843,7 +901,7 @@ const char *XrdCmsNode::do_PrepDel(XrdCmsRRData &Arg)
 const char *XrdCmsNode::do_Rm(XrdCmsRRData &Arg)
 {
    EPNAME("do_Rm")
-   static const SMask_t allNodes(~0);
+   static const SMask_t allNodes(FULLMASK);
    int rc;
 
 // Do some debugging
@@ -878,7 +936,7 @@ const char *XrdCmsNode::do_Rm(XrdCmsRRData &Arg)
 const char *XrdCmsNode::do_Rmdir(XrdCmsRRData &Arg)
 {
    EPNAME("do_Rmdir")
-   static const SMask_t allNodes(~0);
+   static const SMask_t allNodes(FULLMASK);
    int rc;
 
 // Do some debugging
@@ -1153,6 +1211,11 @@ const char *XrdCmsNode::do_State(XrdCmsRRData &Arg)
                 Arg.Request.modifier = rc;
    else     return 0;
 
+// Servers fronting a disk cache also say how much of the file they cache
+//
+   if (!isMan && Arg.Request.modifier == CmsHaveRequest::Online)
+      Arg.Request.modifier |= baseFS.CacheLvl(Arg.Path);
+
 // Respond appropriately
 //
    if (Arg.Request.modifier && !noResp)
@@ -1174,7 +1237,7 @@ const char *XrdCmsNode::do_State(XrdCmsRRData &Arg)
 void XrdCmsNode::do_StateDFS(XrdCmsBaseFR *rP, int rc)
 {
    EPNAME("StateDFs");
-   static const SMask_t allNodes(~0);
+   static const SMask_t allNodes(FULLMASK);
    CmsRRHdr Request = {rP->Sid, 0, (kXR_char)(rP->Mod | kYR_raw), 0};
    XrdCmsSelect Sel(0, rP->Path, rP->PathLen);
    int isNew;
@@ -1227,14 +1290,14 @@ void XrdCmsNode::do_StateDFS(XrdCmsBaseFR *rP, int rc)
 int XrdCmsNode::do_StateFWD(XrdCmsRRData &Arg)
 {
    EPNAME("do_StateFWD");
-   static const SMask_t allNodes(~0);
+   static const SMask_t allNodes(FULLMASK);
    XrdCmsSelect Sel(0, Arg.Path, Arg.PathLen-1);
    XrdCmsPInfo  pinfo;
    int retc;
 
 // Find out who could serve this file
 //
-   if (!Cache.Paths.Find(Arg.Path, pinfo) || pinfo.rovec == 0)
+   if (!Cache.Paths.Find(Arg.Path, pinfo) || !pinfo.rovec)
       {DEBUGR("Path find failed for state " <<Arg.Path);
        return 0;
       }
@@ -1275,15 +1338,15 @@ int XrdCmsNode::do_StateFWD(XrdCmsRRData &Arg)
            Cache.AddFile(Sel, allNodes);
            return retc;
           }
-       if (Sel.Vec.pf != 0) return CmsHaveRequest::Pending;
-       if (Sel.Vec.hf != 0) return CmsHaveRequest::Online;
+       if (Sel.Vec.pf) return CmsHaveRequest::Pending;
+       if (Sel.Vec.hf) return CmsHaveRequest::Online;
        return 0;
       }
 
 // For shared-nothing setups, first check if we need to ask any unasked nodes
 // whether they have the file.
 //
-   if (!retc || Sel.Vec.bf != 0)
+   if (!retc || Sel.Vec.bf)
       {if (!retc) Cache.AddFile(Sel, 0);
        Cluster.Broadcast((retc ? Sel.Vec.bf : pinfo.rovec), Arg.Request,
                          (void *)Arg.Buff, Arg.Dlen);
@@ -1293,8 +1356,8 @@ int XrdCmsNode::do_StateFWD(XrdCmsRRData &Arg)
 // we are interested in some node has the file in non-pending status. This
 // differs from shared-everything because pending status applies to all nodes.
 //
-   if (Sel.Vec.hf != 0) return CmsHaveRequest::Online;
-   if (Sel.Vec.pf != 0) return CmsHaveRequest::Pending;
+   if (Sel.Vec.hf) return CmsHaveRequest::Online;
+   if (Sel.Vec.pf) return CmsHaveRequest::Pending;
                         return 0;
 }
 
@@ -1468,6 +1531,59 @@ const char *XrdCmsNode::do_Status(XrdCmsRRData &Arg)
    return 0;
 }
 
+/******************************************************************************/
+/*                            d o _ S u m m a r y                             */
+/******************************************************************************/
+  
+// Summary requests carry segments of a Bloom filter describing the server's
+// namespace. A new filter is built up on the side and only replaces the
+// active one once the last segment arrives. Unmarked segments belong to the
+// filter being built, if any, and otherwise update the active one in place. These are never forwarded; a supervisor answers
+// for its subtree by keeping none of its own (i.e. it always may have a file).
+//
+const char *XrdCmsNode::do_Summary(XrdCmsRRData &Arg)
+{
+   EPNAME("do_Summary")
+   static const int hdrLen = sizeof(CmsSummaryRequest) - sizeof(CmsRRHdr);
+   CmsSummaryRequest sReq;
+   XrdCmsBloom *bfP;
+   unsigned int bfSize, bfOffs;
+   int bfHash, blen, Begin, End;
+
+// Extract out the filter geometry and validate it
+//
+   if (Arg.Dlen < hdrLen) return "invalid summary request";
+   memcpy(&sReq.Size, Arg.Buff, hdrLen);
+   bfSize = ntohl(sReq.Size);
+   bfOffs = ntohl(sReq.Offset);
+   bfHash = static_cast<int>(sReq.Hashes);
+   blen   = Arg.Dlen - hdrLen;
+   Begin  = Arg.Request.modifier & CmsSummaryRequest::kYR_begin;
+   End    = Arg.Request.modifier & CmsSummaryRequest::kYR_end;
+   if (!XrdCmsBloom::Valid(bfSize, bfHash) || bfOffs >= bfSize
+   ||  static_cast<unsigned int>(blen) > bfSize - bfOffs)
+      return "invalid summary geometry";
+
+// Apply the segment to the appropriate filter
+//
+   bfMutex.Lock();
+   if (Begin)
+      {if (bfPend) delete bfPend;
+       bfPend = new XrdCmsBloom(bfSize, bfHash);
+      }
+   bfP = (bfPend ? bfPend : bfActv);
+   if (bfP && bfP->Size() == bfSize && bfP->Hashes() == bfHash)
+      bfP->Apply(bfOffs, Arg.Buff+hdrLen, blen);
+   if (End && bfPend)
+      {if (bfActv) delete bfActv;
+       bfActv = bfPend; bfPend = 0;
+       bfMask |= NodeMask;
+       DEBUGR("namespace summary of " <<bfSize <<" bytes now active");
+      }
+   bfMutex.UnLock();
+   return 0;
+}
+
 /******************************************************************************/
 /*                              d o _ T r u n c                               */
 /******************************************************************************/
@@ -1555,6 +1671,22 @@ const char *XrdCmsNode::do_Usage(XrdCmsRRData &Arg)
    return 0;
 }
 
+/******************************************************************************/
+/*                                P i n g e d                                 */
+/******************************************************************************/
+  
+void XrdCmsNode::Pinged()
+{
+   struct timeval tNow;
+
+// Record the time only if we are not already timing a ping
+//
+   if (!PingSent)
+      {gettimeofday(&tNow, 0);
+       PingSent = tNow.tv_sec*1000000LL + tNow.tv_usec;
+      }
+}
+
 /******************************************************************************/
 /*                          R e p o r t _ U s a g e                           */
 /******************************************************************************/
@@ -1596,6 +1728,23 @@ void XrdCmsNode::Report_Usage(XrdLink *lp)   // Static!
       <<" mem=" <<pmem <<" pag=" <<ppag <<" dsk=" <<pdsk <<' ' <<maxfr);
 }
   
+/******************************************************************************/
+/*                            s e t S u m m a r y                             */
+/******************************************************************************/
+
+void XrdCmsNode::setSummary(XrdCmsBloom *bfP)
+{
+
+// Replace the active summary and discard any partial one (nil means none)
+//
+   bfMutex.Lock();
+   if (bfActv) delete bfActv;
+   if (bfPend) {delete bfPend; bfPend = 0;}
+   if ((bfActv = bfP)) bfMask |=  NodeMask;
+      else             bfMask &= ~NodeMask;
+   bfMutex.UnLock();
+}
+  
 /******************************************************************************/
 /*                             S y n c S p a c e                              */
 /******************************************************************************/
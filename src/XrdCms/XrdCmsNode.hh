@@ -44,6 +44,7 @@
 
 class XrdCmsBaseFR;
 class XrdCmsBaseFS;
+class XrdCmsBloom;
 class XrdCmsClustID;
 class XrdCmsDrop;
 class XrdCmsManager;
@@ -116,6 +117,7 @@ static void   do_StateDFS(XrdCmsBaseFR *rP, int rc);
 const  char  *do_StatFS(XrdCmsRRData &Arg);
 const  char  *do_Stats(XrdCmsRRData &Arg);
 const  char  *do_Status(XrdCmsRRData &Arg);
+const  char  *do_Summary(XrdCmsRRData &Arg);
 const  char  *do_Trunc(XrdCmsRRData &Arg);
 const  char  *do_Try(XrdCmsRRData &Arg);
 const  char  *do_Update(XrdCmsRRData &Arg);
@@ -127,7 +129,8 @@ inline int    ID(int &INum) {INum = Instance; return NodeID;}
 
 inline int    Inst() {return Instance;}
 
-inline int    isNode(SMask_t smask) {return (smask & NodeMask) != 0;}
+inline int    isNode(const SMask_t &smask)
+                     {return NodeID >= 0 && smask.Has(NodeID);}
 inline int    isNode(const char *hn)
                     {return Link && !strcmp(Link->Host(), hn);}
 inline int    isNode(const XrdNetAddr *addr)
@@ -143,6 +146,10 @@ inline SMask_t Mask() {return NodeMask;}
 inline void    Lock() {myMutex.Lock(); isLocked = 1;}
 inline void  UnLock() {isLocked = 0; myMutex.UnLock();}
 
+// Pinged() records when a ping was sent so that the response can be timed.
+//
+       void  Pinged();
+
 static void  Report_Usage(XrdLink *lp);
 
 inline int   Send(const char *buff, int blen=0)
@@ -175,6 +182,8 @@ inline void  ShowIF() {netIF.Display("=====> ");}
 
        void  SyncSpace();
 
+       void  setSummary(XrdCmsBloom *bfP=0);
+
              XrdCmsNode(XrdLink *lnkp, const char *theIF=0, const char *sid=0,
                         int port=0, int lvl=0, int id=-1);
             ~XrdCmsNode();
@@ -217,6 +226,10 @@ int                RefW;         // Number of times used for writing
 int                RefTotW;
 int                RefR;         // Number of times used for redirection
 int                RefTotR;
+int                RespLat;      // Smoothed ping response time (microseconds)
+long long          PingSent;     // When the last ping was sent (microseconds)
+XrdCmsBloom       *bfActv;       // Active   namespace summary (bfMutex)
+XrdCmsBloom       *bfPend;       // Incoming namespace summary (bfMutex)
 short              RSlot;
 char               isLocked;
 char               Share;        // Share of requests for this node (0 -> n/a)
@@ -229,5 +242,11 @@ int                Shrin;        // Share intervals used
 //
 static XrdSysMutex mlMutex;
 static int         LastFree;
+
+// The following serializes access to the namespace summaries of all nodes.
+// The mask of nodes having an active summary may be inspected without a lock.
+//
+static XrdSysMutex bfMutex;
+static SMask_t     bfMask;
 };
 #endif
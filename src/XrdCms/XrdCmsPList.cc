@@ -195,7 +195,7 @@ const char *XrdCmsPList_Anchor::Type(const char *pname)
 // Find matching entry
 //
    while(p) if (p->pathlen <= plen && !strncmp(p->pathname, pname, p->pathlen)) 
-               {isrw = (p->pathmask.rwvec != 0); break;}
+               {isrw = p->pathmask.rwvec.Any(); break;}
                else p = p->next;
 
 // All done
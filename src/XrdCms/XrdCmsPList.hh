@@ -49,7 +49,7 @@ public:
    SMask_t ssvec;
 
 inline int  And(const SMask_t mask)
-               {return ((rovec &= mask)|(rwvec &= mask)|(ssvec &= mask)) != 0;}
+               {return ((rovec &= mask)|(rwvec &= mask)|(ssvec &= mask)).Any();}
 
 inline void Or(const XrdCmsPInfo *pi)
                {rovec |=  pi->rovec; rwvec |=  pi->rwvec; ssvec |=  pi->ssvec;}
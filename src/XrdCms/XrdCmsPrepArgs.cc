@@ -30,9 +30,12 @@
   
 #include <unistd.h>
 #include <stdlib.h>
+#include <string.h>
+#include <netinet/in.h>
 #include <sys/types.h>
 
 #include "XrdCms/XrdCmsConfig.hh"
+#include "XrdCms/XrdCmsParser.hh"
 #include "XrdCms/XrdCmsPrepare.hh"
 #include "XrdCms/XrdCmsPrepArgs.hh"
 
@@ -87,6 +90,81 @@ XrdCmsPrepArgs::XrdCmsPrepArgs(XrdCmsRRData &Arg) : XrdJob("prepare")
    ioV[1].iov_len  = Arg.Dlen;
 }
 
+/******************************************************************************/
+/*                                 B a t c h                                  */
+/******************************************************************************/
+
+// A batched prepadd carries a newline separated list of <path>[?<cgi>] entries
+// in its path argument. Each entry is repacked as an ordinary prepadd, with a
+// header length to match, so that it can be forwarded to a server as is. The
+// whole batch is queued at once.
+//
+int XrdCmsPrepArgs::Batch(XrdCmsRRData &Arg) // Static
+{
+   static const int xNum = 16;
+   XrdCmsPrepArgs *aP, *bFirst = 0, *bLast = 0;
+   XrdCmsRRData    eArg;
+   struct iovec    xmsg[xNum];
+   char            Work[xNum*12], *ePath, *eNext, *eCgi, *bP;
+   int             i, iovcnt, dlen, bNum = 0;
+
+// Each entry inherits everything but the path and opaque information
+//
+   eArg = Arg;
+   eArg.Request.modifier &= ~CmsPrepAddRequest::kYR_batch;
+
+// Split the path list and create a request for each entry
+//
+   ePath = Arg.Path;
+   while(ePath && *ePath)
+        {if ((eNext = index(ePath, '\n'))) *eNext++ = 0;
+         if ((eCgi  = index(ePath, '?')))  *eCgi++  = 0;
+         if (*ePath)
+            {eArg.Path   = ePath;
+             eArg.Opaque = (eCgi && *eCgi ? eCgi : 0);
+             if (!(iovcnt = Parser.Pack(kYR_prepadd, xmsg, &xmsg[xNum],
+                                        (char *)&eArg, Work))) break;
+             for (dlen = 0, i = 0; i < iovcnt; i++) dlen += xmsg[i].iov_len;
+             if (!(bP = (char *)malloc(dlen))) break;
+             eArg.Buff = bP; eArg.Blen = eArg.Dlen = dlen;
+             eArg.Request.datalen = htons(static_cast<unsigned short>(dlen));
+             for (i = 0; i < iovcnt; i++)
+                 {memcpy(bP, xmsg[i].iov_base, xmsg[i].iov_len);
+                  bP += xmsg[i].iov_len;
+                 }
+             if (!Parser.Parse(kYR_prepadd,eArg.Buff,eArg.Buff+dlen,&eArg))
+                {free(eArg.Buff); break;}
+             aP = new XrdCmsPrepArgs(eArg);
+             if (bLast) bLast->Next = aP;
+                else    bFirst      = aP;
+             bLast = aP; bNum++;
+            }
+         ePath = eNext;
+        }
+
+// Queue whatever we have
+//
+   if (bFirst) Enqueue(bFirst, bLast);
+   return bNum;
+}
+
+/******************************************************************************/
+/*                               E n q u e u e                                */
+/******************************************************************************/
+  
+void XrdCmsPrepArgs::Enqueue(XrdCmsPrepArgs *aFirst, XrdCmsPrepArgs *aLast)
+{
+
+// Lock the queue and add the elements and post the waiter
+//
+   PAQueue.Lock();
+   if (First) Last->Next = aFirst;
+      else    First      = aFirst;
+   Last = aLast;
+   if (isIdle) PAReady.Post();
+   PAQueue.UnLock();
+}
+
 /******************************************************************************/
 /*                            g e t R e q u e s t                             */
 /******************************************************************************/
@@ -139,12 +217,7 @@ void XrdCmsPrepArgs::Process()
 void XrdCmsPrepArgs::Queue()
 {
 
-// Lock the queue and add the element and post the waiter
+// Add just this element to the queue
 //
-   PAQueue.Lock();
-   if (First) Last->Next = this;
-      else    First      = this;
-   Last = this;
-   if (isIdle) PAReady.Post();
-   PAQueue.UnLock();
+   Enqueue(this, this);
 }
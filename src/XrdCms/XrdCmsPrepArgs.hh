@@ -58,6 +58,8 @@ XrdCms::CmsRRHdr        Request;
 
         void            DoIt() {if (!XrdCmsNode::do_SelPrep(*this)) delete this;}
 
+static  int             Batch(XrdCmsRRData &Arg);
+
 static  void            Process();
 
         void            Queue();
@@ -70,6 +72,8 @@ static  XrdCmsPrepArgs *getRequest();
 
 private:
 
+static void             Enqueue(XrdCmsPrepArgs *aFirst, XrdCmsPrepArgs *aLast);
+
 static XrdSysMutex      PAQueue;
 static XrdSysSemaphore  PAReady;
        XrdCmsPrepArgs  *Next;
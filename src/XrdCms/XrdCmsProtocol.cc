@@ -59,6 +59,7 @@
 #include "XrdCms/XrdCmsRouting.hh"
 #include "XrdCms/XrdCmsRTable.hh"
 #include "XrdCms/XrdCmsState.hh"
+#include "XrdCms/XrdCmsSummary.hh"
 #include "XrdCms/XrdCmsTrace.hh"
 
 #include "XrdOuc/XrdOucCRC.hh"
@@ -395,6 +396,7 @@ void XrdCmsProtocol::Pander(const char *manager, int mport)
                    Say.Emsg("Protocol", "Logged into", sname, Link->Name());
                    if (Data.SID)
                       Manager->Verify(Link, (const char *)Data.SID, sname);
+                   if (Config.DiskOK) Summary.Refresh();
                    Reason = Dispatch(isUp, TimeOut, 2);
                    rc = 0;
                    loginData.fSpace= Meter.FreeSpace(fsUtil);
@@ -562,7 +564,7 @@ XrdCmsRouting *XrdCmsProtocol::Admit()
 
 // Establish outgoing mode
 //
-   Data.Mode = 0;
+   Data.Mode = CmsLoginData::kYR_bulkprep;
    if (Trace.What & TRACE_Debug) Data.Mode |= CmsLoginData::kYR_debug;
    if (CmsState.Suspended)      {Data.Mode |= CmsLoginData::kYR_suspend;
                                  wasSuspended = 1;
@@ -882,6 +884,7 @@ do{if ((rc = Link->RecvAll((char *)&Data->Request, ReqSize, maxWait)) < 0)
               return "server blacklisted w/ redirect";
            if (Link->Send((char *)&Ping, sizeof(Ping)) < 0)
               return "server unreachable";
+           myNode->Pinged();
            lastPing = Config.PingTick;
           }
        continue;
@@ -894,6 +897,7 @@ do{if ((rc = Link->RecvAll((char *)&Data->Request, ReqSize, maxWait)) < 0)
           return "server blacklisted w/ redirect";
        if (Link->Send((char *)&Ping, sizeof(Ping)) < 0)
           return "server unreachable";
+       myNode->Pinged();
        lastPing = Config.PingTick;
       }
 
@@ -1053,7 +1057,7 @@ void XrdCmsProtocol::Reissue(XrdCmsRRData &Data)
 // Find all the nodes that might be able to do somthing on this path
 //
    if (!Cache.Paths.Find(Data.Path, pinfo)
-   || (amask = pinfo.rwvec | pinfo.rovec) == 0)
+   || !(amask = pinfo.rwvec | pinfo.rovec))
       {Say.Emsg("Job", Router.getName(Data.Request.rrCode),
                        "aborted; no servers handling", Data.Path);
        return;
@@ -158,8 +158,7 @@ static   const int                     iov_cnt = 2;
          XrdCms::CmsResponse           redrResp;
          XrdCms::CmsResponse           waitResp;
 union   {char                          hostbuff[288];
-         char                          databuff[XrdCms::CmsLocateRequest::RHLen
-                                               *STMax];
+         char                          databuff[XrdCmsMAX_LOC_LEN];
         };
          Info                          Stats;
          int                           luFast;
@@ -198,9 +198,12 @@ void XrdCmsResp::ReplyXeq()
        return;
       }
 
-// Get the values for the callback.
+// Get the values for the callback. There is no buffer when a parked request
+// timed out; the delay has already been set and the client must retry.
 //
-   Result = XrdCmsParser::Decode(theMan,myRRHdr,myBuff,(XrdOucErrInfo *)this);
+   if (!myBuff) Result = SFS_STALL;
+      else Result = XrdCmsParser::Decode(theMan, myRRHdr, myBuff,
+                                         (XrdOucErrInfo *)this);
 
 // Translate the return code to what the caller's caller wanst to see. We
 // should only receive the indicated codes at this point.
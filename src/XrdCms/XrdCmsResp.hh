@@ -88,6 +88,8 @@ static void        Reply();
 
 static void        setDelay(int repdly) {RepDelay = repdly;}
 
+inline void        setID(int msgid) {myID = msgid;}
+
        XrdCmsResp() : XrdOucErrInfo(UserID) {next = 0; myBuff = 0;}
       ~XrdCmsResp() {}
 
@@ -64,6 +64,10 @@ enum {Write   = 0x00010, // File will be open in write mode     (select & cache)
       isMeta  = 0x02000, // Only inode information being changed(select   only)
       Freshen = 0x04000, // Freshen access times                (prep     only)
       Replica = 0x08000, // File will be replicated (w/ Create) (select   only)
+      CacheLow= 0x10000, // Less than half of file cached       (have   & cache)
+      CacheHalf=0x20000, // At least half of file cached        (have   & cache)
+      CacheFull=0x30000, // Whole file cached                   (have   & cache)
+      CacheLvl= 0x30000, // Mask for the above
       Advisory= 0x40000, // Cache A/D is advisory (no delay)    (have   & cache)
       Pending = 0x80000, // File being staged                   (have   & cache)
       ifWant  = 0x0000f  // XrdNetIF::ifType encoding location
@@ -73,6 +77,8 @@ struct {SMask_t wf;     // Out: Writable locations
         SMask_t hf;     // Out: Existing locations
         SMask_t pf;     // Out: Pending  locations
         SMask_t bf;     // Out: Bounced  locations
+        SMask_t hc;     // Out: Locations caching at least half the file
+        SMask_t fc;     // Out: Locations caching the whole file
        }        Vec;
 
 struct {int  Port;      // Out: Target node port number
@@ -0,0 +1,286 @@
+/******************************************************************************/
+/*                                                                            */
+/*                      X r d C m s S u m m a r y . c c                       */
+/*                                                                            */
+/* (c) 2014 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                            All Rights Reserved                             */
+/*   Produced by Andrew Hanushevsky for Stanford University under contract    */
+/*              DE-AC02-76-SFO0515 with the Department of Energy              */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <netinet/in.h>
+#include <sys/uio.h>
+
+#include "XProtocol/YProtocol.hh"
+
+#include "XrdCms/XrdCmsBloom.hh"
+#include "XrdCms/XrdCmsConfig.hh"
+#include "XrdCms/XrdCmsManager.hh"
+#include "XrdCms/XrdCmsPList.hh"
+#include "XrdCms/XrdCmsSummary.hh"
+#include "XrdCms/XrdCmsTrace.hh"
+#include "XrdCms/XrdCmsTypes.hh"
+
+#include "XrdOuc/XrdOucName2Name.hh"
+#include "XrdOuc/XrdOucNSWalk.hh"
+#include "XrdOuc/XrdOucTList.hh"
+
+#include "XrdSys/XrdSysPthread.hh"
+
+using namespace XrdCms;
+
+/******************************************************************************/
+/*                        G l o b a l   O b j e c t s                         */
+/******************************************************************************/
+
+       XrdCmsSummary   XrdCms::Summary;
+
+/******************************************************************************/
+/*            E x t e r n a l   T h r e a d   I n t e r f a c e s             */
+/******************************************************************************/
+
+void *XrdCmsStartSummary(void *carg)
+      {XrdCmsSummary *sP = (XrdCmsSummary *)carg;
+       return sP->Run();
+      }
+  
+/******************************************************************************/
+/*                               R e f r e s h                                */
+/******************************************************************************/
+  
+void XrdCmsSummary::Refresh()
+{
+   if (!sumSize) return;
+   sumCond.Lock();
+   doFull = true;
+   sumCond.Signal();
+   sumCond.UnLock();
+}
+
+/******************************************************************************/
+/*                                   R u n                                    */
+/******************************************************************************/
+  
+void *XrdCmsSummary::Run()
+{
+   EPNAME("Summary");
+   XrdCmsBloom *newBF;
+   time_t nextWalk = 0, tNow;
+   int numFiles, wTime;
+   bool resend;
+
+// Rebuild the summary every interval and send any changes. In between we
+// may be asked to resend the whole summary because a manager reconnected.
+//
+   while(1)
+        {if ((tNow = time(0)) >= nextWalk)
+            {newBF    = new XrdCmsBloom(sumSize, sumHash);
+             numFiles = Build(*newBF);
+             nextWalk = time(0) + sumIntv;
+             DEBUG(numFiles <<" files summarized in "
+                   <<(time(0) - tNow) <<" seconds");
+            } else newBF = 0;
+
+         sumCond.Lock();
+         resend = doFull; doFull = false;
+         sumCond.UnLock();
+
+         if (newBF)
+            {Send(*newBF, (resend ? 0 : lastBF));
+             if (lastBF) delete lastBF;
+             lastBF = newBF;
+            } else if (resend && lastBF) Send(*lastBF, 0);
+
+         sumCond.Lock();
+         if (!doFull && (wTime = nextWalk - time(0)) > 0) sumCond.Wait(wTime);
+         sumCond.UnLock();
+        }
+   return (void *)0;
+}
+
+/******************************************************************************/
+/*                                 S t a r t                                  */
+/******************************************************************************/
+  
+bool XrdCmsSummary::Start()
+{
+   pthread_t tid;
+   int rc;
+
+// Validate the filter geometry
+//
+   if (!XrdCmsBloom::Valid(sumSize, sumHash))
+      {Say.Emsg("Summary", "Invalid summary size or hash count.");
+       return false;
+      }
+
+// Start the summary thread
+//
+   if ((rc = XrdSysThread::Run(&tid, XrdCmsStartSummary, (void *)this,
+                               0, "Namespace summary")))
+      {Say.Emsg("Summary", rc, "start namespace summary thread");
+       return false;
+      }
+   return true;
+}
+  
+/******************************************************************************/
+/*                       P r i v a t e   M e t h o d s                        */
+/******************************************************************************/
+/******************************************************************************/
+/*                                 B u i l d                                  */
+/******************************************************************************/
+  
+int XrdCmsSummary::Build(XrdCmsBloom &bf)
+{
+   XrdOucTList *tP, *pList = 0;
+   XrdCmsPList *pP;
+   int numFiles = 0;
+
+// Copy the exported paths so we do not hold the lock during the walk
+//
+   Config.PathList.Lock();
+   pP = Config.PathList.First();
+   while(pP) {pList = new XrdOucTList(pP->Path(), 0, pList); pP = pP->Next();}
+   Config.PathList.UnLock();
+
+// Walk each exported path adding every file we find
+//
+   if (!pList) numFiles = Walk(bf, "/");
+      else while((tP = pList))
+                {numFiles += Walk(bf, tP->text);
+                 pList = tP->next;
+                 delete tP;
+                }
+   return numFiles;
+}
+
+/******************************************************************************/
+/*                                  S e n d                                   */
+/******************************************************************************/
+  
+// When obP is nil, a complete filter is sent and only non-zero segments need
+// to be sent as the manager starts out with an empty filter. Otherwise, only
+// segments that differ from the previously sent filter are sent.
+//
+void XrdCmsSummary::Send(XrdCmsBloom &bf, XrdCmsBloom *obP)
+{
+   EPNAME("Send");
+   static char zeroSeg[XrdCmsBloom::SegSize] = {0};
+   const char *bits = bf.Bits(), *obits = (obP ? obP->Bits() : 0);
+   unsigned int offs, bSize = bf.Size();
+   int n, pend = -1, numSent = 0;
+   int mods = (obP ? 0 : CmsSummaryRequest::kYR_begin);
+
+// Run through all of the segments deferring the send by one segment so that
+// we can mark the last one of a complete filter.
+//
+   for (offs = 0; offs < bSize; offs += XrdCmsBloom::SegSize)
+       {n = (bSize - offs < (unsigned int)XrdCmsBloom::SegSize
+          ?  bSize - offs : XrdCmsBloom::SegSize);
+        if (obP) {if (!memcmp(bits+offs, obits+offs, n)) continue;}
+           else   if (!memcmp(bits+offs, zeroSeg,    n)) continue;
+        if (pend >= 0)
+           {Send(bf, pend, XrdCmsBloom::SegSize, mods);
+            mods = 0; numSent++;
+           }
+        pend = offs;
+       }
+
+// Send the last pending segment. A complete filter always has an ending one.
+//
+   if (!obP) {if (pend < 0) pend = 0; mods |= CmsSummaryRequest::kYR_end;}
+   if (pend >= 0)
+      {n = (bSize - pend < (unsigned int)XrdCmsBloom::SegSize
+         ?  bSize - pend : XrdCmsBloom::SegSize);
+       Send(bf, pend, n, mods); numSent++;
+      }
+   DEBUG((obP ? "updated " : "complete ") <<numSent <<" segment(s) sent");
+}
+
+/******************************************************************************/
+
+void XrdCmsSummary::Send(XrdCmsBloom &bf, unsigned int offs, int blen, int mods)
+{
+   CmsSummaryRequest sReq;
+   struct iovec ioV[2];
+   int dlen = sizeof(sReq) - sizeof(sReq.Hdr) + blen;
+
+// Construct the request
+//
+   memset(&sReq, 0, sizeof(sReq));
+   sReq.Hdr.rrCode   = kYR_summary;
+   sReq.Hdr.modifier = mods;
+   sReq.Hdr.datalen  = htons(static_cast<unsigned short>(dlen));
+   sReq.Size         = htonl(bf.Size());
+   sReq.Offset       = htonl(offs);
+   sReq.Hashes       = static_cast<kXR_char>(bf.Hashes());
+
+// Send it off to all of our managers
+//
+   ioV[0].iov_base = (char *)&sReq;            ioV[0].iov_len = sizeof(sReq);
+   ioV[1].iov_base = (char *)bf.Bits()+offs;   ioV[1].iov_len = blen;
+   XrdCmsManager::Inform("summary", ioV, 2, sizeof(sReq) + blen);
+}
+
+/******************************************************************************/
+/*                                  W a l k                                   */
+/******************************************************************************/
+  
+int XrdCmsSummary::Walk(XrdCmsBloom &bf, const char *lfn)
+{
+   static const int wOpts = XrdOucNSWalk::retFile | XrdOucNSWalk::retLink
+                          | XrdOucNSWalk::Recurse | XrdOucNSWalk::skpErrs;
+   XrdOucNSWalk::NSEnt *nP, *eP;
+   char pfn[XrdCmsMAX_PATH_LEN+1], lfnBuff[XrdCmsMAX_PATH_LEN+1];
+   const char *theLfn;
+   int rc, numFiles = 0;
+
+// Convert the logical path to the physical path
+//
+   if (Config.GenLocalPath(lfn, pfn)) return 0;
+
+// Index the tree. Each file is recorded by its logical name as that is what
+// the manager will be asking about.
+//
+   XrdOucNSWalk nsWalk(0, pfn, 0, wOpts);
+   while((nP = nsWalk.Index(rc)))
+        {while((eP = nP))
+              {nP = eP->Next;
+               if (eP->Type == XrdOucNSWalk::NSEnt::isFile
+               ||  eP->Type == XrdOucNSWalk::NSEnt::isLink)
+                  {if (!Config.lcl_N2N) theLfn = eP->Path;
+                      else if (Config.lcl_N2N->pfn2lfn(eP->Path, lfnBuff,
+                                                       sizeof(lfnBuff))) theLfn=0;
+                              else theLfn = lfnBuff;
+                   if (theLfn) {bf.Add(theLfn, strlen(theLfn)); numFiles++;}
+                  }
+               delete eP;
+              }
+         if (rc) break;
+        }
+   return numFiles;
+}
@@ -0,0 +1,89 @@
+#ifndef __CMS_SUMMARY__H
+#define __CMS_SUMMARY__H
+/******************************************************************************/
+/*                                                                            */
+/*                      X r d C m s S u m m a r y . h h                       */
+/*                                                                            */
+/* (c) 2014 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                            All Rights Reserved                             */
+/*   Produced by Andrew Hanushevsky for Stanford University under contract    */
+/*              DE-AC02-76-SFO0515 with the Department of Energy              */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include "XrdSys/XrdSysPthread.hh"
+
+class XrdCmsBloom;
+
+/******************************************************************************/
+/*                   C l a s s   X r d C m s S u m m a r y                    */
+/******************************************************************************/
+  
+// This a single-instance global class used by data servers. When enabled via
+// the cms.summary directive, it periodically walks the exported namespace,
+// builds a Bloom filter of the files present and sends it to all managers.
+// Only segments that changed since the last summary are sent.
+//
+class XrdCmsSummary
+{
+public:
+
+// Init() sets the summary parameters, it is called at configuration time.
+//
+       void  Init(int fSize, int fHash, int fIntv)
+                 {sumSize = fSize; sumHash = fHash; sumIntv = fIntv;}
+
+inline bool  isOn() {return sumSize != 0;}
+
+// Refresh() causes the complete summary to be resent to all managers. It is
+//           called whenever we login to a manager as it has no summary for us.
+//
+       void  Refresh();
+
+       void *Run();
+
+       bool  Start();
+
+             XrdCmsSummary() : sumCond(0), lastBF(0), sumSize(0), sumHash(4),
+                               sumIntv(30*60), doFull(false) {}
+            ~XrdCmsSummary() {} // This object should never be deleted
+
+private:
+
+       int   Build(XrdCmsBloom &bf);
+       void  Send(XrdCmsBloom &bf, XrdCmsBloom *obP);
+       void  Send(XrdCmsBloom &bf, unsigned int offs, int blen, int mods);
+       int   Walk(XrdCmsBloom &bf, const char *lfn);
+
+XrdSysCondVar  sumCond;
+XrdCmsBloom   *lastBF;
+int            sumSize;
+int            sumHash;
+int            sumIntv;
+bool           doFull;
+};
+
+namespace XrdCms
+{
+extern    XrdCmsSummary Summary;
+}
+#endif
@@ -30,13 +30,177 @@
 /* specific prior written permission of the institution or contributor.       */
 /******************************************************************************/
   
-typedef unsigned long long SMask_t;
+#include <stdio.h>
+#include <ostream>
 
-#define FULLMASK 0xFFFFFFFFFFFFFFFFULL
+// The following defines our cell size (maximum subscribers). It may be set at
+// compile time but should be a multiple of 64.
+//
+#ifndef STMax
+#define STMax 256
+#endif
+
+/******************************************************************************/
+/*                    C l a s s   X r d C m s S M a s k                       */
+/******************************************************************************/
+
+// The XrdCmsSMask object is a fixed size bit vector with one bit per node slot.
+// It behaves like the unsigned integer it replaces but is not limited to 64
+// nodes. All operations loop over a compile-time number of words so that the
+// compiler can unroll and vectorize them. Set bits may be iterated using
+// First() and Next() which skip over empty words.
+//
+class XrdCmsSMask
+{
+public:
+
+static const int wBits = 64;
+static const int wNum  = (STMax + wBits - 1) / wBits;
+
+// All() returns a mask with every node slot set.
+//
+static XrdCmsSMask All() {XrdCmsSMask m;
+                          for (int i = 0; i < wNum; i++) m.Vec[i] = ~0ULL;
+                          return m.Trim();
+                         }
+
+// Bit() returns a mask with only the indicated node slot set.
+//
+static XrdCmsSMask Bit(int n)
+                      {XrdCmsSMask m; m.Vec[n/wBits] = 1ULL << (n%wBits);
+                       return m;
+                      }
 
-// The following defines our cell size (maximum subscribers)
+inline bool   Any() const {unsigned long long v = 0;
+                           for (int i = 0; i < wNum; i++) v |= Vec[i];
+                           return v != 0;
+                          }
+
+inline XrdCmsSMask &Clr(int n) {Vec[n/wBits] &= ~(1ULL << (n%wBits));
+                                return *this;
+                               }
+
+inline int    Count() const {int n = 0;
+                             for (int i = 0; i < wNum; i++) n += Pop(Vec[i]);
+                             return n;
+                            }
+
+// First() returns the lowest set slot number or -1 if the mask is empty.
+//
+inline int    First() const {return Next(-1);}
+
+inline bool   Has(int n) const {return (Vec[n/wBits] >> (n%wBits)) & 1ULL;}
+
+// Next() returns the next set slot number after n or -1 if there is none.
 //
-#define STMax 64
+inline int    Next(int n) const
+                  {if (++n >= STMax) return -1;
+                   int w = n / wBits;
+                   unsigned long long v = Vec[w] & (~0ULL << (n%wBits));
+                   while(!v) {if (++w >= wNum) return -1; v = Vec[w];}
+                   return w*wBits + Ctz(v);
+                  }
+
+inline XrdCmsSMask &Set(int n) {Vec[n/wBits] |=  (1ULL << (n%wBits));
+                                return *this;
+                               }
+
+// Text() formats the mask in hex for messages, most significant word first.
+//
+       char  *Text(char *buff, int blen) const
+                  {int i = wNum-1, n;
+                   while(i > 0 && !Vec[i]) i--;
+                   n = snprintf(buff, blen, "%llx", Vec[i]);
+                   while(--i >= 0 && n < blen)
+                        n += snprintf(buff+n, blen-n, "%016llx", Vec[i]);
+                   return buff;
+                  }
+
+// Operators that allow this object to be used like an integer bit mask
+//
+typedef void (XrdCmsSMask::*isTrue)() const;
+
+inline operator isTrue() const {return (Any() ? &XrdCmsSMask::True : 0);}
+
+inline bool   operator!() const {return !Any();}
+
+inline XrdCmsSMask  operator~() const
+                  {XrdCmsSMask m;
+                   for (int i = 0; i < wNum; i++) m.Vec[i] = ~Vec[i];
+                   return m.Trim();
+                  }
+
+inline XrdCmsSMask &operator&=(const XrdCmsSMask &rhs)
+                  {for (int i = 0; i < wNum; i++) Vec[i] &= rhs.Vec[i];
+                   return *this;
+                  }
+
+inline XrdCmsSMask &operator|=(const XrdCmsSMask &rhs)
+                  {for (int i = 0; i < wNum; i++) Vec[i] |= rhs.Vec[i];
+                   return *this;
+                  }
+
+inline XrdCmsSMask  operator&(const XrdCmsSMask &rhs) const
+                  {XrdCmsSMask m(*this); return m &= rhs;}
+
+inline XrdCmsSMask  operator|(const XrdCmsSMask &rhs) const
+                  {XrdCmsSMask m(*this); return m |= rhs;}
+
+inline bool   operator==(const XrdCmsSMask &rhs) const
+                  {unsigned long long v = 0;
+                   for (int i = 0; i < wNum; i++) v |= Vec[i] ^ rhs.Vec[i];
+                   return v == 0;
+                  }
+
+inline bool   operator!=(const XrdCmsSMask &rhs) const {return !(*this == rhs);}
+
+// The integer constructor sets the mask for the first 64 node slots
+//
+              XrdCmsSMask(unsigned long long v=0)
+                         {Vec[0] = v;
+                          for (int i = 1; i < wNum; i++) Vec[i] = 0;
+                         }
+             ~XrdCmsSMask() {}
+
+private:
+
+static int    Ctz(unsigned long long v)
+                 {
+#if defined(__GNUC__)
+                  return __builtin_ctzll(v);
+#else
+                  int n = 0; while(!(v & 1ULL)) {v >>= 1; n++;} return n;
+#endif
+                 }
+
+static int    Pop(unsigned long long v)
+                 {
+#if defined(__GNUC__)
+                  return __builtin_popcountll(v);
+#else
+                  int n = 0; while(v) {v &= v - 1; n++;} return n;
+#endif
+                 }
+
+inline XrdCmsSMask &Trim()
+                 {if (STMax % wBits)
+                     Vec[wNum-1] &= ~0ULL >> ((wBits - STMax%wBits) % wBits);
+                  return *this;
+                 }
+
+       void   True() const {}
+
+unsigned long long Vec[wNum];
+};
+
+inline std::ostream &operator<<(std::ostream &os, const XrdCmsSMask &m)
+                    {char buff[XrdCmsSMask::wNum*16+1];
+                     return os <<m.Text(buff, sizeof(buff));
+                    }
+
+typedef XrdCmsSMask SMask_t;
+
+#define FULLMASK XrdCmsSMask::All()
 
 // The following defines the maximum number of redirectors. It is one greater
 // than the actual maximum as the zeroth is never used.
@@ -45,5 +209,10 @@ typedef unsigned long long SMask_t;
 
 #define XrdCmsMAX_PATH_LEN 1024
 
+// The following defines the maximum size of a locate response. It must fit in
+// the 16-bit data length of a response and bounds the list of servers.
+//
+#define XrdCmsMAX_LOC_LEN 32768
+
 #define XrdCmsVERSION "1.0.0"
 #endif
@@ -265,6 +265,171 @@ void XrdFfsDent_cache_destroy()
         XrdFfsDent_dentcache_free(&XrdFfsDentCaches[i]);
 }
 
+/* 
+   managing caches for attributes of single entries
+
+   Entries are filled from directory listings that carry the stat information
+   (kXR_dstat) and from stat() results. A stat() that found the entry on no
+   data server is remembered as a negative entry with its own (short) life.
+   The cache is keyed by the path under the mount point and is disabled until
+   XrdFfsDent_attr_init() is called with a non zero ttl.
+ */
+
+struct XrdFfsDentattr {
+    char *path;
+    time_t t1;      /* expiration time */
+    short neg;      /* entry does not exist */
+    struct stat st;
+    struct XrdFfsDentattr *next;
+};
+
+#define XrdFfsDent_NATTRBUCKETS 16384
+struct XrdFfsDentattr *XrdFfsDentAttrs[XrdFfsDent_NATTRBUCKETS];
+pthread_mutex_t XrdFfsDentAttrs_mutex = PTHREAD_MUTEX_INITIALIZER;
+int XrdFfsDentAttr_ttl = 0, XrdFfsDentAttr_negttl = 0;
+int XrdFfsDentAttr_max = 0, XrdFfsDentAttr_nents = 0;
+time_t XrdFfsDentAttr_purged = 0;
+
+void XrdFfsDent_attr_init(int ttl, int negttl, int maxents)
+{
+    XrdFfsDentAttr_ttl = (ttl < 0 ? 0 : ttl);
+    XrdFfsDentAttr_negttl = (negttl < 0 ? 0 : negttl);
+    XrdFfsDentAttr_max = (maxents < 0 ? 0 : maxents);
+}
+
+int XrdFfsDent_attr_enabled()
+{
+    return (XrdFfsDentAttr_ttl > 0 && XrdFfsDentAttr_max > 0);
+}
+
+unsigned int XrdFfsDent_attr_hash(const char *path)
+{
+    unsigned int h = 2166136261U;
+
+    while (*path != '\0')
+        h = (h ^ (unsigned char)*path++) * 16777619U;
+    return h % XrdFfsDent_NATTRBUCKETS;
+}
+
+/* find the entry of path, unlinking and freeing it if it expired (or del is set) */
+struct XrdFfsDentattr *XrdFfsDent_attr_find(const char *path, time_t t1, int del)
+{
+    struct XrdFfsDentattr **pp, *p;
+
+    pp = &XrdFfsDentAttrs[XrdFfsDent_attr_hash(path)];
+    while ((p = *pp) != NULL)
+    {
+        if (strcmp(p->path, path) == 0)
+        {
+            if (!del && p->t1 > t1)
+                return p;
+            *pp = p->next;
+            free(p->path);
+            free(p);
+            XrdFfsDentAttr_nents--;
+            return NULL;
+        }
+        pp = &p->next;
+    }
+    return NULL;
+}
+
+/* drop all expired entries, at most once a second */
+void XrdFfsDent_attr_purge(time_t t1)
+{
+    struct XrdFfsDentattr **pp, *p;
+    int i;
+
+    if (t1 == XrdFfsDentAttr_purged)
+        return;
+    XrdFfsDentAttr_purged = t1;
+
+    for (i = 0; i < XrdFfsDent_NATTRBUCKETS; i++)
+    {
+        pp = &XrdFfsDentAttrs[i];
+        while ((p = *pp) != NULL)
+            if (p->t1 <= t1)
+            {
+                *pp = p->next;
+                free(p->path);
+                free(p);
+                XrdFfsDentAttr_nents--;
+            }
+            else
+                pp = &p->next;
+    }
+}
+
+/* add (or refresh) the attributes of path. stbuf == NULL adds a negative entry */
+void XrdFfsDent_attr_add(const char *path, struct stat *stbuf)
+{
+    struct XrdFfsDentattr *p;
+    unsigned int h;
+    time_t t1 = time(NULL);
+    int life = (stbuf != NULL ? XrdFfsDentAttr_ttl : XrdFfsDentAttr_negttl);
+
+    if (life <= 0 || !XrdFfsDent_attr_enabled())
+        return;
+
+    pthread_mutex_lock(&XrdFfsDentAttrs_mutex);
+    if ((p = XrdFfsDent_attr_find(path, t1, 0)) == NULL)
+    {
+        if (XrdFfsDentAttr_nents >= XrdFfsDentAttr_max)
+            XrdFfsDent_attr_purge(t1);
+        if (XrdFfsDentAttr_nents >= XrdFfsDentAttr_max)
+        {
+            pthread_mutex_unlock(&XrdFfsDentAttrs_mutex);
+            return;
+        }
+        p = (struct XrdFfsDentattr*) malloc(sizeof(struct XrdFfsDentattr));
+        p->path = strdup(path);
+        h = XrdFfsDent_attr_hash(path);
+        p->next = XrdFfsDentAttrs[h];
+        XrdFfsDentAttrs[h] = p;
+        XrdFfsDentAttr_nents++;
+    }
+    p->t1 = t1 + life;
+    p->neg = (stbuf == NULL);
+    if (stbuf != NULL)
+        p->st = *stbuf;
+    pthread_mutex_unlock(&XrdFfsDentAttrs_mutex);
+}
+
+/* returns 1 (and *stbuf) if path is cached, -1 if path is known not to exist, 0 otherwise */
+int XrdFfsDent_attr_get(const char *path, struct stat *stbuf)
+{
+    struct XrdFfsDentattr *p;
+    int rval = 0;
+
+    if (!XrdFfsDent_attr_enabled())
+        return 0;
+
+    pthread_mutex_lock(&XrdFfsDentAttrs_mutex);
+    if ((p = XrdFfsDent_attr_find(path, time(NULL), 0)) != NULL)
+    {
+        if (p->neg)
+            rval = -1;
+        else
+        {
+            *stbuf = p->st;
+            rval = 1;
+        }
+    }
+    pthread_mutex_unlock(&XrdFfsDentAttrs_mutex);
+    return rval;
+}
+
+/* forget path, to be called whenever the entry is changed through us */
+void XrdFfsDent_attr_del(const char *path)
+{
+    if (!XrdFfsDent_attr_enabled())
+        return;
+
+    pthread_mutex_lock(&XrdFfsDentAttrs_mutex);
+    XrdFfsDent_attr_find(path, 0, 1);
+    pthread_mutex_unlock(&XrdFfsDentAttrs_mutex);
+}
+
 /*
 #include <stdio.h>
 
@@ -31,6 +31,7 @@
 #include <stdlib.h>
 #include <time.h>
 #include <pthread.h>
+#include <sys/stat.h>
 
 #ifdef __cplusplus
   extern "C" {
@@ -51,6 +52,12 @@ void XrdFfsDent_cache_destroy();
 int  XrdFfsDent_cache_fill(char *dname, char ***dnarray, int nents);
 int  XrdFfsDent_cache_search(char *dname, char *dentname);
 
+void XrdFfsDent_attr_init(int ttl, int negttl, int maxents);
+int  XrdFfsDent_attr_enabled();
+void XrdFfsDent_attr_add(const char *path, struct stat *stbuf);
+int  XrdFfsDent_attr_get(const char *path, struct stat *stbuf);
+void XrdFfsDent_attr_del(const char *path);
+
 #ifdef __cplusplus
   }
 #endif
@@ -47,6 +47,8 @@
 #include <stdlib.h>
 #include <syslog.h>
 #include "XrdFfs/XrdFfsPosix.hh"
+#include "XrdPosix/XrdPosixAdmin.hh"
+#include "XrdPosix/XrdPosixMap.hh"
 #include "XrdPosix/XrdPosixXrootd.hh"
 #include "XrdFfs/XrdFfsMisc.hh"
 #include "XrdFfs/XrdFfsDent.hh"
@@ -58,19 +60,25 @@
 
 #define MAXROOTURLLEN 1024 // this is also defined in other files
 
-int XrdFfsPosix_stat(const char *path, struct stat *buf)
+void XrdFfsPosix_fixmode(struct stat *buf)
 {
-    int rc; 
-    errno = 0;
-    rc = XrdPosixXrootd::Stat(path, buf);
-    if (rc == 0 && S_ISBLK(buf->st_mode)) /* If 'buf' come from HPSS, xrootd will return it as a block device! */
-    {                                     /* So we re-mark it to a regular file */
+    if (S_ISBLK(buf->st_mode))  /* If 'buf' come from HPSS, xrootd will return it as a block device! */
+    {                           /* So we re-mark it to a regular file */
         buf->st_mode &= 0007777;
         if ( buf->st_mode & S_IXUSR )
             buf->st_mode |= 0040000;   /* a directory */
         else
             buf->st_mode |= 0100000;   /* a file */
     }
+}
+
+int XrdFfsPosix_stat(const char *path, struct stat *buf)
+{
+    int rc; 
+    errno = 0;
+    rc = XrdPosixXrootd::Stat(path, buf);
+    if (rc == 0)
+        XrdFfsPosix_fixmode(buf);
     return rc;
 }
 
@@ -253,7 +261,6 @@ int XrdFfsPosix_deleteall(const char *rdrurl, const char *path, uid_t user_uid,
     int res_i[XrdFfs_MAX_NUM_NODES];
     int errno_i[XrdFfs_MAX_NUM_NODES];
     struct XrdFfsPosixX_deleteall_args args[XrdFfs_MAX_NUM_NODES];
-    struct XrdFfsQueueTasks *jobs[XrdFfs_MAX_NUM_NODES];
 
     nurls = XrdFfsMisc_get_all_urls(rdrurl, newurls, XrdFfs_MAX_NUM_NODES);
 
@@ -266,18 +273,8 @@ int XrdFfsPosix_deleteall(const char *rdrurl, const char *path, uid_t user_uid,
         args[i].err = &errno_i[i];
         args[i].res = &res_i[i];
         args[i].st_mode = st_mode;
-#ifdef NOUSE_QUEUE
-        XrdFfsPosix_x_deleteall((void*) &args[i]);
     }
-#else
-        jobs[i] = XrdFfsQueue_create_task(XrdFfsPosix_x_deleteall, (void**)(&args[i]), 0);
-    }
-    for (i = 0; i < nurls; i++)
-    {
-        XrdFfsQueue_wait_task(jobs[i]);
-        XrdFfsQueue_free_task(jobs[i]);
-    }
-#endif
+    XrdFfsQueue_fanout(XrdFfsPosix_x_deleteall, (void*)args, sizeof(args[0]), nurls);
     res = -1;
     errno = ENOENT;
     for (i = 0; i < nurls; i++)
@@ -409,10 +406,76 @@ int XrdFfsPosix_truncateall(const char *rdrurl, const char *path, off_t size, ui
 
 struct XrdFfsPosixX_readdirall_args {
     char *url;
+    const char *path;
     int *res;
     int *err;
     struct XrdFfsDentnames **dents;
 };
+
+/*
+   List the directory with kXR_dstat so that the data server returns the stat
+   information of all entries along with their names, and put the attributes
+   into the dentry attribute cache. This is where the stat() calls that follow
+   a readdir() (e.g. "ls -l") will find them, instead of each going to all data
+   servers. Servers that do not support kXR_dstat return the names only.
+ */
+void XrdFfsPosix_x_readdirstat(struct XrdFfsPosixX_readdirall_args *args)
+{
+    XrdPosixAdmin admin(args->url);
+    XrdCl::DirectoryList *dlist = 0;
+    XrdCl::StatInfo *sinfo;
+    struct stat stbuf;
+    char path[MAXROOTURLLEN];
+    const char *name;
+    size_t plen;
+    dev_t rdev;
+    uint32_t i;
+
+    if (!admin.isOK() ||
+        XrdPosixMap::Result(admin.Xrd.DirList(admin.Url.GetPathWithParams(),
+                                              XrdCl::DirListFlags::Stat,
+                                              dlist, (uint16_t)0)))
+    {
+        *(args->err) = errno;
+        *(args->res) = -1;
+        return;
+    }
+
+    path[0] = '\0';
+    strncat(path, args->path, MAXROOTURLLEN - 2);
+    plen = strlen(path);
+    if (plen == 0 || path[plen-1] != '/')
+    {
+        path[plen++] = '/';
+        path[plen] = '\0';
+    }
+
+    for (i = 0; i < dlist->GetSize(); i++)
+    {
+        name = dlist->At(i)->GetName().c_str();
+        XrdFfsDent_names_add(args->dents, (char*)name);
+        if ((sinfo = dlist->At(i)->GetStatInfo()) == NULL || plen + strlen(name) >= MAXROOTURLLEN)
+            continue;
+
+        memset(&stbuf, 0, sizeof(stbuf));
+        stbuf.st_mode = XrdPosixMap::Flags2Mode(&rdev, sinfo->GetFlags());
+        stbuf.st_rdev = rdev;
+        stbuf.st_size = static_cast<off_t>(sinfo->GetSize());
+        stbuf.st_blocks = stbuf.st_size/512+1;
+        stbuf.st_atime = stbuf.st_mtime = stbuf.st_ctime = static_cast<time_t>(sinfo->GetModTime());
+        stbuf.st_ino = static_cast<ino_t>(strtoll(sinfo->GetId().c_str(), 0, 10));
+        stbuf.st_nlink = 1;
+        stbuf.st_blksize = 64*1024;
+        stbuf.st_uid = getuid();
+        stbuf.st_gid = getgid();
+        XrdFfsPosix_fixmode(&stbuf);
+
+        strcpy(path + plen, name);
+        XrdFfsDent_attr_add(path, &stbuf);
+    }
+    *(args->res) = 0;
+    delete dlist;
+}
  
 /*
    It seems xrootd posix return dp[i] != NULL even if the dir
@@ -429,6 +492,12 @@ void* XrdFfsPosix_x_readdirall(void* x)
     DIR *dp;
     struct dirent *de;
 
+    if (args->path != NULL && XrdFfsDent_attr_enabled())
+    {
+        XrdFfsPosix_x_readdirstat(args);
+        return NULL;
+    }
+
 /*
    Xrootd's Opendir will not return NULL even under some error. For instance,
    when it is supposed to return ENOENT or ENOTDIR, it actually returns 
@@ -462,7 +531,6 @@ int XrdFfsPosix_readdirall(const char *rdrurl, const char *path, char*** direnta
     int errno_i[XrdFfs_MAX_NUM_NODES];
     struct XrdFfsDentnames *dir_i[XrdFfs_MAX_NUM_NODES] = {0};
     struct XrdFfsPosixX_readdirall_args args[XrdFfs_MAX_NUM_NODES];
-    struct XrdFfsQueueTasks *jobs[XrdFfs_MAX_NUM_NODES];
 
 //    for (i = 0; i < XrdFfs_MAX_NUM_NODES; i++)
 //        dir_i[i] = NULL;
@@ -491,21 +559,12 @@ int XrdFfsPosix_readdirall(const char *rdrurl, const char *path, char*** direnta
         strncat(newurls[i], path,  MAXROOTURLLEN - strlen(newurls[i]) -1);
         XrdFfsMisc_xrd_secsss_editurl(newurls[i], user_uid, 0);
         args[i].url = newurls[i];
+        args[i].path = (path[0] != '\0' ? path : NULL);
         args[i].err = &errno_i[i];
         args[i].res = &res_i[i];
         args[i].dents = &dir_i[i];
-#ifdef NOUSE_QUEUE
-        XrdFfsPosix_x_readdirall((void*) &args[i]);
-    }   
-#else
-        jobs[i] = XrdFfsQueue_create_task(XrdFfsPosix_x_readdirall, (void**)(&args[i]), 0);
     }
-    for (i = 0; i < nurls; i++)
-    {
-        XrdFfsQueue_wait_task(jobs[i]);
-        XrdFfsQueue_free_task(jobs[i]);
-    }
-#endif
+    XrdFfsQueue_fanout(XrdFfsPosix_x_readdirall, (void*)args, sizeof(args[0]), nurls);
 
     errno = 0;
     for (i = 0; i < nurls; i++)
@@ -665,7 +724,6 @@ int XrdFfsPosix_statvfsall(const char *rdrurl, const char *path, struct statvfs
     int errno_i[XrdFfs_MAX_NUM_NODES];
     struct statvfs stbuf_i[XrdFfs_MAX_NUM_NODES];
     struct XrdFfsPosixX_statvfsall_args args[XrdFfs_MAX_NUM_NODES];
-    struct XrdFfsQueueTasks *jobs[XrdFfs_MAX_NUM_NODES];
 
     nurls = XrdFfsMisc_get_all_urls(rdrurl, newurls, XrdFfs_MAX_NUM_NODES);
     if (nurls < 0)
@@ -688,18 +746,8 @@ int XrdFfsPosix_statvfsall(const char *rdrurl, const char *path, struct statvfs
         stbuf_i[i].f_bsize = stbuf->f_bsize;
         args[i].stbuf = &(stbuf_i[i]);
         args[i].osscgroup = osscgroup;
-#ifdef NOUSE_QUEUE
-        XrdFfsPosix_x_statvfsall((void*) &args[i]);
-    }
-#else
-        jobs[i] = XrdFfsQueue_create_task(XrdFfsPosix_x_statvfsall, (void**)(&args[i]), 0);
     }
-    for (i = 0; i < nurls; i++)
-    {
-        XrdFfsQueue_wait_task(jobs[i]);
-        XrdFfsQueue_free_task(jobs[i]);
-    }
-#endif
+    XrdFfsQueue_fanout(XrdFfsPosix_x_statvfsall, (void*)args, sizeof(args[0]), nurls);
  /*
    for statfs call, we don't care about return code and errno 
   */
@@ -746,10 +794,19 @@ int XrdFfsPosix_statall(const char *rdrurl, const char *path, struct stat *stbuf
     int errno_i[XrdFfs_MAX_NUM_NODES];
     struct stat stbuf_i[XrdFfs_MAX_NUM_NODES];
     struct XrdFfsPosixX_statall_args args[XrdFfs_MAX_NUM_NODES];
-    struct XrdFfsQueueTasks *jobs[XrdFfs_MAX_NUM_NODES];
 
     char *p1, *p2, *dir, *file, rootpath[MAXROOTURLLEN];
 
+/* attributes from a recent listing or stat(), or a recent failed lookup */
+    switch (XrdFfsDent_attr_get(path, stbuf))
+    {
+        case 1:
+            return 0;
+        case -1:
+            errno = ENOENT;
+            return -1;
+    }
+
     rootpath[0] = '\0';
     strncat(rootpath,rdrurl, MAXROOTURLLEN - strlen(rootpath) -1);
     strncat(rootpath,path,  MAXROOTURLLEN - strlen(rootpath) -1);
@@ -770,6 +827,7 @@ int XrdFfsPosix_statall(const char *rdrurl, const char *path, struct stat *stbuf
          {
              free(p1);
              free(p2);
+             XrdFfsDent_attr_add(path, stbuf);
              return 0;
          }
     }
@@ -786,18 +844,8 @@ int XrdFfsPosix_statall(const char *rdrurl, const char *path, struct stat *stbuf
         args[i].res = &res_i[i];
         args[i].err = &errno_i[i];
         args[i].stbuf = &(stbuf_i[i]);
-#ifdef NOUSE_QUEUE
-        XrdFfsPosix_x_statall((void*) &args[i]);
     }
-#else
-        jobs[i] = XrdFfsQueue_create_task(XrdFfsPosix_x_statall, (void**)(&args[i]), 0);
-    }
-    for (i = 0; i < nurls; i++)
-    {
-        XrdFfsQueue_wait_task(jobs[i]);
-        XrdFfsQueue_free_task(jobs[i]);
-    }
-#endif
+    XrdFfsQueue_fanout(XrdFfsPosix_x_statall, (void*)args, sizeof(args[0]), nurls);
     res = -1;
     errno = ENOENT;
     for (i = 0; i < nurls; i++)
@@ -818,6 +866,12 @@ int XrdFfsPosix_statall(const char *rdrurl, const char *path, struct stat *stbuf
     for (i = 0; i < nurls; i++)
         free(newurls[i]);
 
+/* remember the result; a lookup that failed everywhere (but nowhere timed out) as well */
+    if (res == 0)
+        XrdFfsDent_attr_add(path, stbuf);
+    else if (nurls > 0 && errno == ENOENT)
+        XrdFfsDent_attr_add(path, NULL);
+
     return res;
 }
 
@@ -148,6 +148,59 @@ unsigned int XrdFfsQueue_count_tasks()
     return que_len;
 }
 
+/* 
+   run func() on each of the n elements (of argsize bytes) of args and wait
+   for all of them. At most XrdFfsQueueFanout of these tasks are queued at any
+   time so that a single fan-out to many data servers does not monopolize the
+   workers. Zero (the default) means no limit.
+*/
+
+int XrdFfsQueueFanout = 0;
+
+void XrdFfsQueue_fanout(void* (*func)(void*), void *args, size_t argsize, int n)
+{
+    int i;
+#ifdef NOUSE_QUEUE
+    for (i = 0; i < n; i++)
+        (func)((void*)((char*)args + i * argsize));
+#else
+    int w, fanout = XrdFfsQueueFanout;
+    struct XrdFfsQueueTasks **jobs;
+
+    if (n <= 0)
+        return;
+    if (fanout <= 0 || fanout > n)
+        fanout = n;
+    jobs = (struct XrdFfsQueueTasks**) malloc(sizeof(struct XrdFfsQueueTasks*) * n);
+
+    for (i = 0, w = 0; i < n; i++)
+    {
+        if (i - w == fanout)
+        {
+            XrdFfsQueue_wait_task(jobs[w]);
+            XrdFfsQueue_free_task(jobs[w++]);
+        }
+        jobs[i] = XrdFfsQueue_create_task(func, (void**)((char*)args + i * argsize), 0);
+    }
+    for (; w < n; w++)
+    {
+        XrdFfsQueue_wait_task(jobs[w]);
+        XrdFfsQueue_free_task(jobs[w]);
+    }
+    free(jobs);
+#endif
+}
+
+void XrdFfsQueue_set_fanout(int n)
+{
+    XrdFfsQueueFanout = (n < 0 ? 0 : n);
+}
+
+int XrdFfsQueue_get_fanout()
+{
+    return XrdFfsQueueFanout;
+}
+
 /* workers */
 
 void *XrdFfsQueue_worker(void* x)
@@ -51,6 +51,10 @@ void XrdFfsQueue_free_task(struct XrdFfsQueueTasks *task);
 void XrdFfsQueue_wait_task(struct XrdFfsQueueTasks *task);
 unsigned int XrdFfsQueue_count_tasks();
 
+void XrdFfsQueue_fanout(void* (*func)(void*), void *args, size_t argsize, int n);
+void XrdFfsQueue_set_fanout(int n);
+int XrdFfsQueue_get_fanout();
+
 int XrdFfsQueue_create_workers(int n);
 int XrdFfsQueue_remove_workers(int n);
 int XrdFfsQueue_count_workers();
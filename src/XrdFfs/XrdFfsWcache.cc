@@ -1,5 +1,5 @@
 /******************************************************************************/
-/* XrdFfsWcache.cc simple write cache that captures consecutive small writes  */
+/* XrdFfsWcache.cc write-behind cache that aggregates small writes            */
 /*                                                                            */
 /* (c) 2010 by the Board of Trustees of the Leland Stanford, Jr., University  */
 /*                            All Rights Reserved                             */
@@ -27,16 +27,28 @@
 /* specific prior written permission of the institution or contributor.       */
 /******************************************************************************/
 
-/* 
-   When direct_io is not used, kernel will break large write to 4Kbyte  
-   writes. This significantly reduces the writting performance. This 
-   simple cache mechanism is to improve the performace on small writes. 
+/*
+   When direct_io is not used, kernel will break large write to 4Kbyte
+   writes. This significantly reduces the writting performance. This
+   cache mechanism is to improve the performace on small writes.
+
+   Writes are aggregated into a few ranges per file. A range's buffer grows as
+   the range is extended, up to XrdFfsWcacheBufsize. A range that is full, or
+   that has to make room for a new range, is written to the data server
+   asynchronously, so a file may have several remote writes outstanding. All
+   buffers come from a memory budget shared by all open files; a writer waits
+   for outstanding writes to free memory when the budget is used up. Errors
+   of asynchronous writes are reported by the next write or flush. Flush
+   writes out all ranges and waits for all outstanding writes of the file.
 
    Note that fuse 2.8.0 pre2 or above and kernel 2.6.27 or above provide
-   a big_writes option to allow > 4KByte writing. It will make this 
-   smiple write caching obsolete. 
+   a big_writes option to allow > 4KByte writing. Such writes are still
+   written behind but are never aggregated.
 */
 #define XrdFfsWcacheBufsize 131072
+#define XrdFfsWcacheMinsize 16384    /* ranges start small and grow */
+#define XrdFfsWcacheNranges 4    /* ranges aggregated per file */
+#define XrdFfsWcacheMaxio   16   /* outstanding remote writes per file */
 
 #if defined(__linux__)
 /* For pread()/pwrite() */
@@ -57,28 +69,90 @@
 #include "XrdFfs/XrdFfsWcache.hh"
 #ifndef NOXRD
     #include "XrdFfs/XrdFfsPosix.hh"
+    #include "XrdPosix/XrdPosixCallBack.hh"
+    #include "XrdPosix/XrdPosixXrootd.hh"
 #endif
 
 #ifdef __cplusplus
   extern "C" {
 #endif
 
-struct XrdFfsWcacheFilebuf {
+struct XrdFfsWcacheRange {
     off_t offset;
     size_t len;
+    size_t size;
     char *buf;
+};
+
+struct XrdFfsWcacheFilebuf {
+    struct XrdFfsWcacheRange r[XrdFfsWcacheNranges];
+    int nio;           /* number of outstanding remote writes */
+    int error;         /* first error of an asynchronous write */
+    off_t iolo, iohi;  /* extent covered by the outstanding writes */
     pthread_mutex_t *mlock;
+    pthread_cond_t *iodone;
 };
 
 struct XrdFfsWcacheFilebuf *XrdFfsWcacheFbufs;
 
+/* the memory budget shared by all files */
+size_t XrdFfsWcacheMaxmem, XrdFfsWcacheInuse, XrdFfsWcacheInflight;
+pthread_mutex_t XrdFfsWcacheMemlock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t XrdFfsWcacheMemfree = PTHREAD_COND_INITIALIZER;
+
+#ifdef __cplusplus
+  }
+#endif
+
+/*
+   The callback of an asynchronous write. The memory is returned to the budget
+   first so that writers waiting for memory never wait for a file lock.
+*/
+class XrdFfsWcacheIO : public XrdPosixCallBackIO
+{
+public:
+
+void Done(int Result)
+{
+    pthread_mutex_lock(&XrdFfsWcacheMemlock);
+    XrdFfsWcacheInuse -= range.size;
+    XrdFfsWcacheInflight -= range.size;
+    pthread_cond_broadcast(&XrdFfsWcacheMemfree);
+    pthread_mutex_unlock(&XrdFfsWcacheMemlock);
+    free(range.buf);
+
+    pthread_mutex_lock(fbuf->mlock);
+    if (Result != (int)range.len && fbuf->error == 0)
+        fbuf->error = (Result < 0 ? -Result : EIO);
+    if (--fbuf->nio == 0)
+    {
+        fbuf->iolo = fbuf->iohi = 0;
+        pthread_cond_broadcast(fbuf->iodone);
+    }
+    else if (fbuf->nio == XrdFfsWcacheMaxio)
+        pthread_cond_broadcast(fbuf->iodone);
+    pthread_mutex_unlock(fbuf->mlock);
+    delete this;
+}
+
+     XrdFfsWcacheIO(struct XrdFfsWcacheFilebuf *fb, struct XrdFfsWcacheRange *rp)
+                   : fbuf(fb), range(*rp) {}
+    ~XrdFfsWcacheIO() {}
+
+struct XrdFfsWcacheFilebuf *fbuf;
+struct XrdFfsWcacheRange range;
+};
+
+#ifdef __cplusplus
+  extern "C" {
+#endif
+
 /* #include "xrdposix.h" */
 
 int XrdFfsPosix_baseFD, XrdFfsWcacheNFILES;
-void XrdFfsWcache_init(int basefd, int maxfd)
+void XrdFfsWcache_init(int basefd, int maxfd, size_t maxmem)
 {
-    int fd;
-/* We are now using virtual file descriptors (from Xrootd Posix interface) in XrdFfsXrootdfs.cc so we need to set 
+/* We are now using virtual file descriptors (from Xrootd Posix interface) in XrdFfsXrootdfs.cc so we need to set
  * base (lowest) file descriptor, and max number of file descriptors..
  *
     struct rlimit rlp;
@@ -89,113 +163,404 @@ void XrdFfsWcache_init(int basefd, int maxfd)
  */
 
    XrdFfsPosix_baseFD = basefd;
-   XrdFfsWcacheNFILES = maxfd; 
-   
+   XrdFfsWcacheNFILES = maxfd;
+   XrdFfsWcacheMaxmem = (maxmem < XrdFfsWcacheBufsize ? XrdFfsWcacheBufsize : maxmem);
+
 /*    printf("%d %d\n", XrdFfsWcacheNFILES, sizeof(struct XrdFfsWcacheFilebuf)); */
-    XrdFfsWcacheFbufs = (struct XrdFfsWcacheFilebuf*)malloc(sizeof(struct XrdFfsWcacheFilebuf) * XrdFfsWcacheNFILES);
-    for (fd = 0; fd < XrdFfsWcacheNFILES; fd++)
-    {
-        XrdFfsWcacheFbufs[fd].offset = 0;
-        XrdFfsWcacheFbufs[fd].len = 0;
-        XrdFfsWcacheFbufs[fd].buf = NULL;
-        XrdFfsWcacheFbufs[fd].mlock = NULL;
-    }
+    XrdFfsWcacheFbufs = (struct XrdFfsWcacheFilebuf*)calloc(XrdFfsWcacheNFILES, sizeof(struct XrdFfsWcacheFilebuf));
 }
 
-int XrdFfsWcache_create(int fd) 
+int XrdFfsWcache_create(int fd)
 {
+    struct XrdFfsWcacheFilebuf *fb;
+
     XrdFfsWcache_destroy(fd);
     fd -= XrdFfsPosix_baseFD;
+    fb = &XrdFfsWcacheFbufs[fd];
 
-    XrdFfsWcacheFbufs[fd].offset = 0;
-    XrdFfsWcacheFbufs[fd].len = 0;
-    XrdFfsWcacheFbufs[fd].buf = (char*)malloc(XrdFfsWcacheBufsize);
-    if (XrdFfsWcacheFbufs[fd].buf == NULL)
-        return 0;
-    XrdFfsWcacheFbufs[fd].mlock = (pthread_mutex_t*)malloc(sizeof(pthread_mutex_t));
-    if (XrdFfsWcacheFbufs[fd].mlock == NULL)
+    memset(fb->r, 0, sizeof(fb->r));
+    fb->nio = 0;
+    fb->error = 0;
+    fb->iolo = fb->iohi = 0;
+    fb->mlock = (pthread_mutex_t*)malloc(sizeof(pthread_mutex_t));
+    fb->iodone = (pthread_cond_t*)malloc(sizeof(pthread_cond_t));
+    if (fb->mlock == NULL || fb->iodone == NULL)
+    {
+        free(fb->mlock);
+        free(fb->iodone);
+        fb->mlock = NULL;
+        fb->iodone = NULL;
         return 0;
-    else
-        pthread_mutex_init(XrdFfsWcacheFbufs[fd].mlock, NULL);
+    }
+    pthread_mutex_init(fb->mlock, NULL);
+    pthread_cond_init(fb->iodone, NULL);
     return 1;
 }
 
 void XrdFfsWcache_destroy(int fd)
 {
+    struct XrdFfsWcacheFilebuf *fb;
+    int i;
+
 /*  XrdFfsWcache_flush(fd); */
     fd -= XrdFfsPosix_baseFD;
+    fb = &XrdFfsWcacheFbufs[fd];
+
+    if (fb->mlock == NULL)
+        return;
+
+/* outstanding writes refer to this entry, wait for them to complete */
+    pthread_mutex_lock(fb->mlock);
+    while (fb->nio > 0)
+        pthread_cond_wait(fb->iodone, fb->mlock);
+    pthread_mutex_unlock(fb->mlock);
+
+    pthread_mutex_lock(&XrdFfsWcacheMemlock);
+    for (i = 0; i < XrdFfsWcacheNranges; i++)
+        if (fb->r[i].buf != NULL)
+        {
+            XrdFfsWcacheInuse -= fb->r[i].size;
+            free(fb->r[i].buf);
+            fb->r[i].buf = NULL;
+        }
+    pthread_cond_broadcast(&XrdFfsWcacheMemfree);
+    pthread_mutex_unlock(&XrdFfsWcacheMemlock);
+
+    pthread_mutex_destroy(fb->mlock);
+    pthread_cond_destroy(fb->iodone);
+    free(fb->mlock);
+    free(fb->iodone);
+    fb->mlock = NULL;
+    fb->iodone = NULL;
+}
+
+/*
+   While the memory budget is used up and writes are outstanding, wait for them
+   to return memory. This must be done without holding a file lock: callbacks
+   may be delivered by a single thread, and one callback waiting for the lock
+   would keep all other writes from ever returning their memory.
+*/
+static void XrdFfsWcache_throttle(size_t size)
+{
+    pthread_mutex_lock(&XrdFfsWcacheMemlock);
+    while (XrdFfsWcacheInuse + size > XrdFfsWcacheMaxmem && XrdFfsWcacheInflight > 0)
+        pthread_cond_wait(&XrdFfsWcacheMemfree, &XrdFfsWcacheMemlock);
+    pthread_mutex_unlock(&XrdFfsWcacheMemlock);
+}
 
-    XrdFfsWcacheFbufs[fd].offset = 0;
-    XrdFfsWcacheFbufs[fd].len = 0;
-    if (XrdFfsWcacheFbufs[fd].buf != NULL) 
-        free(XrdFfsWcacheFbufs[fd].buf);
-    XrdFfsWcacheFbufs[fd].buf = NULL;
-    if (XrdFfsWcacheFbufs[fd].mlock != NULL)
+/*
+   Get a buffer from the memory budget. If the budget is used up (e.g. all of
+   it sits in ranges that have not been written yet), return NULL and let the
+   caller write through.
+*/
+static char *XrdFfsWcache_getbuf(size_t size)
+{
+    char *buf = NULL;
+
+    pthread_mutex_lock(&XrdFfsWcacheMemlock);
+    if (XrdFfsWcacheInuse + size <= XrdFfsWcacheMaxmem && (buf = (char*)malloc(size)) != NULL)
+        XrdFfsWcacheInuse += size;
+    pthread_mutex_unlock(&XrdFfsWcacheMemlock);
+    return buf;
+}
+
+/*
+   Grow the buffer of a range so that it holds at least need bytes. Returns 0
+   when the memory budget does not allow it.
+*/
+static int XrdFfsWcache_grow(struct XrdFfsWcacheRange *rp, size_t need)
+{
+    size_t size = rp->size;
+    char *buf;
+
+    while (size < need)
+        size *= 2;
+    if (size > XrdFfsWcacheBufsize)
+        size = XrdFfsWcacheBufsize;
+
+    pthread_mutex_lock(&XrdFfsWcacheMemlock);
+    if (XrdFfsWcacheInuse + size - rp->size > XrdFfsWcacheMaxmem
+        || (buf = (char*)realloc(rp->buf, size)) == NULL)
     {
-        pthread_mutex_destroy(XrdFfsWcacheFbufs[fd].mlock);
-        free(XrdFfsWcacheFbufs[fd].mlock);
+        pthread_mutex_unlock(&XrdFfsWcacheMemlock);
+        return 0;
     }
-    XrdFfsWcacheFbufs[fd].mlock = NULL;
+    XrdFfsWcacheInuse += size - rp->size;
+    pthread_mutex_unlock(&XrdFfsWcacheMemlock);
+
+    rp->buf = buf;
+    rp->size = size;
+    return 1;
 }
 
-ssize_t XrdFfsWcache_flush(int fd)
+/*
+   Move a range to the list of writes to be started and account for it as an
+   outstanding write. The caller holds the file lock.
+*/
+static void XrdFfsWcache_queue(struct XrdFfsWcacheFilebuf *fb, struct XrdFfsWcacheRange *rp,
+                               struct XrdFfsWcacheRange *out, int *nout)
+{
+    if (fb->nio == 0 || rp->offset < fb->iolo)
+        fb->iolo = rp->offset;
+    if (fb->nio == 0 || (off_t)(rp->offset + rp->len) > fb->iohi)
+        fb->iohi = rp->offset + rp->len;
+    fb->nio++;
+
+    out[(*nout)++] = *rp;
+    rp->buf = NULL;
+    rp->offset = 0;
+    rp->len = 0;
+}
+
+/*
+   Start the queued writes. This must be done without holding the file lock as
+   the callback may be invoked before XrdPosixXrootd::Pwrite() returns. Memory
+   counts as in flight only once its write is started, so that nobody waits for
+   memory held by writes that are still queued.
+*/
+static void XrdFfsWcache_start(int fd, struct XrdFfsWcacheFilebuf *fb,
+                               struct XrdFfsWcacheRange *out, int nout)
 {
-    ssize_t rc;
+    int i;
+
+    pthread_mutex_lock(&XrdFfsWcacheMemlock);
+    for (i = 0; i < nout; i++)
+        XrdFfsWcacheInflight += out[i].size;
+    pthread_mutex_unlock(&XrdFfsWcacheMemlock);
+
+    for (i = 0; i < nout; i++)
+        XrdPosixXrootd::Pwrite(fd, out[i].buf, out[i].len, out[i].offset,
+                               new XrdFfsWcacheIO(fb, &out[i]));
+}
+
+/*
+   Write out all ranges and wait for all outstanding writes. The file lock is
+   held on entry and on return. Returns the first error seen, if any. The error
+   stays pending until it is reported by a write, flush or fsync.
+*/
+static int XrdFfsWcache_drain(int fd, struct XrdFfsWcacheFilebuf *fb)
+{
+    struct XrdFfsWcacheRange out[XrdFfsWcacheNranges];
+    int i, nout = 0;
+
+    for (i = 0; i < XrdFfsWcacheNranges; i++)
+        if (fb->r[i].buf != NULL)
+            XrdFfsWcache_queue(fb, &fb->r[i], out, &nout);
+
+    if (nout > 0)
+    {
+        pthread_mutex_unlock(fb->mlock);
+        XrdFfsWcache_start(fd, fb, out, nout);
+        pthread_mutex_lock(fb->mlock);
+    }
+    while (fb->nio > 0)
+        pthread_cond_wait(fb->iodone, fb->mlock);
+
+    return fb->error;
+}
+
+/*
+   Write out the cached data. A pending error is only returned, in errno, and
+   cleared when report is set. Reads and truncates just need the data written
+   out; a write error is not theirs to report and is left for flush or fsync.
+*/
+static ssize_t XrdFfsWcache_writeout(int fd, int report)
+{
+    struct XrdFfsWcacheFilebuf *fb;
+    int err;
     fd -= XrdFfsPosix_baseFD;
 
-    if (XrdFfsWcacheFbufs[fd].len == 0 || XrdFfsWcacheFbufs[fd].buf == NULL )
+    if (fd < 0 || fd >= XrdFfsWcacheNFILES || XrdFfsWcacheFbufs[fd].mlock == NULL)
         return 0;
+    fb = &XrdFfsWcacheFbufs[fd];
+
+    pthread_mutex_lock(fb->mlock);
+    err = XrdFfsWcache_drain(fd + XrdFfsPosix_baseFD, fb);
+    if (report)
+        fb->error = 0;
+    else
+        err = 0;
+    pthread_mutex_unlock(fb->mlock);
 
-    rc = XrdFfsPosix_pwrite(fd + XrdFfsPosix_baseFD, 
-                            XrdFfsWcacheFbufs[fd].buf, XrdFfsWcacheFbufs[fd].len, XrdFfsWcacheFbufs[fd].offset);
-    if (rc > 0)
+    if (err)
     {
-        XrdFfsWcacheFbufs[fd].offset = 0;
-        XrdFfsWcacheFbufs[fd].len = 0;
+        errno = err;
+        return -1;
     }
-    return rc;
+    return 0;
+}
+
+ssize_t XrdFfsWcache_flush(int fd)
+{
+    return XrdFfsWcache_writeout(fd, 1);
+}
+
+ssize_t XrdFfsWcache_sync(int fd)
+{
+    return XrdFfsWcache_writeout(fd, 0);  /* never fails, see above */
 }
 
 ssize_t XrdFfsWcache_pwrite(int fd, char *buf, size_t len, off_t offset)
 {
-    ssize_t rc;
-    char *bufptr;
+    struct XrdFfsWcacheFilebuf *fb;
+    struct XrdFfsWcacheRange *rp, *xp, out[XrdFfsWcacheNranges+1], big;
+    off_t end = offset + len, xend;
+    int i, err, nout = 0;
     fd -= XrdFfsPosix_baseFD;
 
 /* do not use caching under these cases */
-    if (len > XrdFfsWcacheBufsize/2 || fd >= XrdFfsWcacheNFILES)
+    if (fd < 0 || fd >= XrdFfsWcacheNFILES || XrdFfsWcacheFbufs[fd].mlock == NULL)
+        return XrdFfsPosix_pwrite(fd + XrdFfsPosix_baseFD, buf, len, offset);
+    fb = &XrdFfsWcacheFbufs[fd];
+
+    XrdFfsWcache_throttle(len > XrdFfsWcacheBufsize/2 ? len : XrdFfsWcacheBufsize);
+    pthread_mutex_lock(fb->mlock);
+    if (fb->error)
     {
-        rc = XrdFfsPosix_pwrite(fd + XrdFfsPosix_baseFD, buf, len, offset);
-        return rc;
+        errno = fb->error;
+        fb->error = 0;
+        pthread_mutex_unlock(fb->mlock);
+        return -1;
     }
 
-    pthread_mutex_lock(XrdFfsWcacheFbufs[fd].mlock);
-    rc = XrdFfsWcacheFbufs[fd].len;
-/* 
-   in the following two cases, a XrdFfsWcache_flush is required:
-   1. current offset isnn't pointing to the tail of data in buffer
-   2. adding new data will exceed the current buffer 
-*/ 
-    if (offset != (off_t)(XrdFfsWcacheFbufs[fd].offset + XrdFfsWcacheFbufs[fd].len) ||
-        (off_t)(offset + len) > (XrdFfsWcacheFbufs[fd].offset + XrdFfsWcacheBufsize))
-        rc = XrdFfsWcache_flush(fd + XrdFfsPosix_baseFD);
-
-    errno = 0;
-    if (rc < 0) 
+/*
+   Data that overlaps an outstanding write must not overtake it, so wait for
+   those writes first. Then add the data to a range when it extends the range
+   at either end or rewrites data already in it. Any other overlap with the
+   ranges must not be reordered either, so then write everything out first.
+*/
+    if (fb->nio > 0 && offset < fb->iohi && end > fb->iolo)
+        if ((err = XrdFfsWcache_drain(fd + XrdFfsPosix_baseFD, fb)))
+            goto failed;
+
+    rp = NULL;
+    for (i = 0; i < XrdFfsWcacheNranges; i++)
     {
-        errno = ENOSPC;
-        pthread_mutex_unlock(XrdFfsWcacheFbufs[fd].mlock);
-        return -1;
+        xp = &fb->r[i];
+        if (xp->buf == NULL)
+            continue;
+        xend = xp->offset + xp->len;
+        if ((offset >= xp->offset && end <= xend)
+            || (offset == xend && xp->len + len <= XrdFfsWcacheBufsize)
+            || (end == xp->offset && xp->len + len <= XrdFfsWcacheBufsize))
+        {
+            if (rp == NULL)
+            {
+                rp = xp;
+                continue;
+            }
+        }
+        else if (offset >= xend || end <= xp->offset)
+            continue;
+        if ((err = XrdFfsWcache_drain(fd + XrdFfsPosix_baseFD, fb)))
+            goto failed;
+        rp = NULL;
+        break;
+    }
+
+/*
+   Merge the data into the range, a full range is written out right away. If
+   the range cannot grow, write it out and start a new one.
+*/
+    if (rp != NULL && rp->len + len > rp->size
+        && !(offset >= rp->offset && end <= (off_t)(rp->offset + rp->len))
+        && !XrdFfsWcache_grow(rp, rp->len + len))
+    {
+        XrdFfsWcache_queue(fb, rp, out, &nout);
+        rp = NULL;
+    }
+    if (rp != NULL)
+    {
+        if (offset >= rp->offset && end <= (off_t)(rp->offset + rp->len))
+            memcpy(rp->buf + (offset - rp->offset), buf, len);
+        else if (offset == (off_t)(rp->offset + rp->len))
+        {
+            memcpy(rp->buf + rp->len, buf, len);
+            rp->len += len;
+        }
+        else
+        {
+            memmove(rp->buf + len, rp->buf, rp->len);
+            memcpy(rp->buf, buf, len);
+            rp->offset = offset;
+            rp->len += len;
+        }
+        if (rp->len == XrdFfsWcacheBufsize)
+            XrdFfsWcache_queue(fb, rp, out, &nout);
+    }
+
+/* Large writes are not aggregated, they are simply written behind */
+    else if (len > XrdFfsWcacheBufsize/2)
+    {
+        if ((big.buf = XrdFfsWcache_getbuf(len)) == NULL)
+            goto writethrough;
+        memcpy(big.buf, buf, len);
+        big.offset = offset;
+        big.len = big.size = len;
+        XrdFfsWcache_queue(fb, &big, out, &nout);
     }
 
-    bufptr = &XrdFfsWcacheFbufs[fd].buf[XrdFfsWcacheFbufs[fd].len];
-    memcpy(bufptr, buf, len);
-    if (XrdFfsWcacheFbufs[fd].len == 0)
-        XrdFfsWcacheFbufs[fd].offset = offset;
-    XrdFfsWcacheFbufs[fd].len += len;
+/* Otherwise start a new range, making room by writing out the fullest one */
+    else
+    {
+        for (i = 0; i < XrdFfsWcacheNranges; i++)
+        {
+            if (fb->r[i].buf == NULL)
+            {
+                rp = &fb->r[i];
+                break;
+            }
+            if (rp == NULL || fb->r[i].len > rp->len)
+                rp = &fb->r[i];
+        }
+        if (rp->buf != NULL)
+            XrdFfsWcache_queue(fb, rp, out, &nout);
+        rp->size = XrdFfsWcacheMinsize;
+        while (rp->size < len)
+            rp->size *= 2;
+        if ((rp->buf = XrdFfsWcache_getbuf(rp->size)) == NULL)
+            goto writethrough;
+        memcpy(rp->buf, buf, len);
+        rp->offset = offset;
+        rp->len = len;
+    }
+
+    pthread_mutex_unlock(fb->mlock);
+    XrdFfsWcache_start(fd + XrdFfsPosix_baseFD, fb, out, nout);
 
-    pthread_mutex_unlock(XrdFfsWcacheFbufs[fd].mlock);
+/* Do not let a single file have too many writes outstanding */
+    if (nout > 0)
+    {
+        pthread_mutex_lock(fb->mlock);
+        while (fb->nio > XrdFfsWcacheMaxio)
+            pthread_cond_wait(fb->iodone, fb->mlock);
+        pthread_mutex_unlock(fb->mlock);
+    }
     return (ssize_t)len;
+
+/*
+   No memory is available for this write. Write everything out, including what
+   was queued above, and then do this write synchronously.
+*/
+writethrough:
+    pthread_mutex_unlock(fb->mlock);
+    XrdFfsWcache_start(fd + XrdFfsPosix_baseFD, fb, out, nout);
+    pthread_mutex_lock(fb->mlock);
+    err = XrdFfsWcache_drain(fd + XrdFfsPosix_baseFD, fb);
+    fb->error = 0;
+    pthread_mutex_unlock(fb->mlock);
+    if (err)
+    {
+        errno = err;
+        return -1;
+    }
+    return XrdFfsPosix_pwrite(fd + XrdFfsPosix_baseFD, buf, len, offset);
+
+failed:
+    fb->error = 0;
+    pthread_mutex_unlock(fb->mlock);
+    errno = err;
+    return -1;
 }
 
 #ifdef __cplusplus
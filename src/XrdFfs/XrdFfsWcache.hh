@@ -1,5 +1,5 @@
 /******************************************************************************/
-/* XrdFfsWcache.hh simple write cache that captures consecutive small writes  */
+/* XrdFfsWcache.hh write-behind cache that aggregates small writes            */
 /*                                                                            */
 /* (c) 2010 by the Board of Trustees of the Leland Stanford, Jr., University  */
 /*                            All Rights Reserved                             */
@@ -31,10 +31,11 @@
   extern "C" {
 #endif
 
-void    XrdFfsWcache_init(int basefd, int maxfd);
+void    XrdFfsWcache_init(int basefd, int maxfd, size_t maxmem);
 int     XrdFfsWcache_create(int fd);
 void    XrdFfsWcache_destroy(int fd);
 ssize_t  XrdFfsWcache_flush(int fd);
+ssize_t  XrdFfsWcache_sync(int fd);
 ssize_t  XrdFfsWcache_pwrite(int fd, char *buf, size_t len, off_t offset);
 
 #ifdef __cplusplus
@@ -64,7 +64,7 @@
 #include "XrdFfs/XrdFfsMisc.hh"
 #include "XrdFfs/XrdFfsWcache.hh"
 #include "XrdFfs/XrdFfsQueue.hh"
-//#include "XrdFfs/XrdFfsDent.hh"
+#include "XrdFfs/XrdFfsDent.hh"
 #include "XrdFfs/XrdFfsFsinfo.hh"
 #include "XrdPosix/XrdPosixXrootd.hh"
 
@@ -80,12 +80,16 @@ struct XROOTDFS {
     bool ofsfwd;
     int  nworkers;
     int  maxfd;
+    int  wcachesz;
+    int  attrttl;
+    int  negttl;
+    int  fanout;
 };
 
 int cwdfd; // File descript of the initial working dir
 
 struct XROOTDFS xrootdfs;
-static struct fuse_opt xrootdfs_opts[14];
+static struct fuse_opt xrootdfs_opts[18];
 
 enum { OPT_KEY_HELP, OPT_KEY_SECSSS, };
 
@@ -127,7 +131,9 @@ static void* xrootdfs_init(struct fuse_conn_info *conn)
 /* put Xrootd related initialization calls here, after fuse daemonize itself. */
     XrdPosixXrootd *abc = new XrdPosixXrootd(-xrootdfs.maxfd);
     XrdFfsMisc_xrd_init(xrootdfs.rdr,xrootdfs.urlcachelife,0);
-    XrdFfsWcache_init(abc->fdOrigin(), xrootdfs.maxfd);
+    XrdFfsWcache_init(abc->fdOrigin(), xrootdfs.maxfd, (size_t)xrootdfs.wcachesz * 1024 * 1024);
+    XrdFfsDent_attr_init(xrootdfs.attrttl, xrootdfs.negttl, 131072);
+    XrdFfsQueue_set_fanout(xrootdfs.fanout);
 /*
    From FAQ:
       Miscellaneous threads should be started from the init() method.
@@ -384,6 +390,7 @@ static int xrootdfs_mknod(const char *path, mode_t mode, dev_t rdev)
         res = XrdFfsPosix_open(rootpath, O_CREAT | O_EXCL | O_WRONLY, S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH); 
 */
         res = XrdFfsPosix_open(rootpath, O_CREAT | O_WRONLY, S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH); 
+        XrdFfsDent_attr_del(path);  /* e.g. a cached failed lookup */
         if (res == -1)
             return -errno;
         XrdFfsPosix_close(res);
@@ -428,6 +435,7 @@ static int xrootdfs_mkdir(const char *path, mode_t mode)
     XrdFfsMisc_xrd_secsss_editurl(rootpath, fuse_get_context()->uid, 0);
 
     res = XrdFfsPosix_mkdir(rootpath, mode);
+    XrdFfsDent_attr_del(path);
     if (res == 0) return 0;
 /* 
    now we are here either because there is either a race to create the directory, or the redirector 
@@ -460,6 +468,7 @@ static int xrootdfs_unlink(const char *path)
     else
         res = XrdFfsPosix_unlinkall(xrootdfs.rdr, path, fuse_get_context()->uid);
 
+    XrdFfsDent_attr_del(path);
     if (res == -1)
         return -errno;
 
@@ -496,6 +505,7 @@ static int xrootdfs_rmdir(const char *path)
     else
         res = XrdFfsPosix_rmdirall(xrootdfs.rdr, path, fuse_get_context()->uid);
 
+    XrdFfsDent_attr_del(path);
     if (res == -1)
         return -errno;
 
@@ -569,6 +579,8 @@ static int xrootdfs_rename(const char *from, const char *to)
     else
         res = XrdFfsPosix_renameall(xrootdfs.rdr, from, to, fuse_get_context()->uid);
 
+    XrdFfsDent_attr_del(from);
+    XrdFfsDent_attr_del(to);
     if (res == -1)
         return -errno;
     
@@ -638,8 +650,9 @@ static int xrootdfs_ftruncate(const char *path, off_t size,
 //  char rootpath[1024];
                                                                                                                                            
     fd = (int) fi->fh;
-    XrdFfsWcache_flush(fd);
+    XrdFfsWcache_sync(fd);
     res = XrdFfsPosix_ftruncate(fd, size);
+    XrdFfsDent_attr_del(path);
     if (res == -1)
         return -errno;
                                                                                                                               
@@ -679,6 +692,7 @@ static int xrootdfs_truncate(const char *path, off_t size)
     else
         res = XrdFfsPosix_truncateall(xrootdfs.rdr, path, size, fuse_get_context()->uid);
 
+    XrdFfsDent_attr_del(path);
     if (res == -1)
         return -errno;
 
@@ -724,6 +738,8 @@ static int xrootdfs_open(const char *path, struct fuse_file_info *fi)
     XrdFfsMisc_xrd_secsss_register(fuse_get_context()->uid, fuse_get_context()->gid, &lid);
     XrdFfsMisc_xrd_secsss_editurl(rootpath, fuse_get_context()->uid, &lid);
     res = XrdFfsPosix_open(rootpath, fi->flags, S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH);
+    if ((fi->flags & O_ACCMODE) != O_RDONLY)
+        XrdFfsDent_attr_del(path);
     if (res == -1)
         return -errno;
 
@@ -739,7 +755,7 @@ static int xrootdfs_read(const char *path, char *buf, size_t size, off_t offset,
     int res;
 
     fd = (int) fi->fh;
-    XrdFfsWcache_flush(fd);  /* in case is the file is reading/writing */
+    XrdFfsWcache_sync(fd);  /* in case is the file is reading/writing */
     res = XrdFfsPosix_pread(fd, buf, size, offset);
     if (res == -1)
         res = -errno;
@@ -843,9 +859,11 @@ static int xrootdfs_release(const char *path, struct fuse_file_info *fi)
     char rootpath[MAXROOTURLLEN];
 
     fd = (int) fi->fh;
-    XrdFfsWcache_flush(fd);
+    XrdFfsWcache_flush(fd);  /* errors were reported by flush(), FUSE ignores ours */
     XrdFfsWcache_destroy(fd);
     XrdFfsPosix_close(fd);
+    if ((fi->flags & O_ACCMODE) != O_RDONLY)
+        XrdFfsDent_attr_del(path);
     fi->fh = 0;
 /* 
    Return at here because the current version of Cluster Name Space daemon 
@@ -928,14 +946,30 @@ static int xrootdfs_release(const char *path, struct fuse_file_info *fi)
     return 0;
 }
 
+/*
+   Writes are cached and written behind, so flush() (called on every close of
+   the file) and fsync() must report errors of those writes.
+*/
+static int xrootdfs_flush(const char *path, struct fuse_file_info *fi)
+{
+    int fd;
+
+    fd = (int) fi->fh;
+    if (XrdFfsWcache_flush(fd) == -1)
+        return -errno;
+    return 0;
+}
+
 static int xrootdfs_fsync(const char *path, int isdatasync,
                      struct fuse_file_info *fi)
 {
     int fd;
 
     fd = (int) fi->fh;
-    XrdFfsWcache_flush(fd);
-    XrdFfsPosix_fsync(fd);
+    if (XrdFfsWcache_flush(fd) == -1)
+        return -errno;
+    if (XrdFfsPosix_fsync(fd) == -1)
+        return -errno;
     return 0;
 }
 
@@ -1168,6 +1202,10 @@ static void xrootdfs_usage(const char *progname)
 "                                 Absents of this option will disable automatically refreshing\n"
 "    -o maxfd=N               number of virtual file descriptors for posix requests, default 8192 (min 2048)\n"
 "    -o nworkers=N            number of workers to handle parallel requests to data servers, default 4\n"
+"    -o wcachesz=N            memory in MB for writes that are cached and written behind, default 64\n"
+"    -o attrttl=N             seconds to cache file attributes from directory listings and stat, default 10 (0 disables)\n"
+"    -o negttl=N              seconds to cache failed lookups, default 5 (0 disables)\n"
+"    -o fanout=N              max parallel requests of one operation to the data servers, default 0 (all at once)\n"
 "    -o fastls=RDR            set to RDR when CNS is presented will cause stat() to go to redirector\n"
 "\n", progname);
 }
@@ -1220,6 +1258,7 @@ int main(int argc, char *argv[])
     xrootdfs_oper.read		= xrootdfs_read;
     xrootdfs_oper.write		= xrootdfs_write;
     xrootdfs_oper.statfs	= xrootdfs_statfs;
+    xrootdfs_oper.flush		= xrootdfs_flush;
     xrootdfs_oper.release	= xrootdfs_release;
     xrootdfs_oper.fsync		= xrootdfs_fsync;
     xrootdfs_oper.setxattr	= xrootdfs_setxattr;
@@ -1300,7 +1339,26 @@ int main(int argc, char *argv[])
     xrootdfs_opts[12].offset = offsetof(struct XROOTDFS, maxfd);
     xrootdfs_opts[12].value = 0;
 
-    xrootdfs_opts[13].templ = NULL;
+/* memory (in MB) for the write-behind cache */
+    xrootdfs_opts[13].templ = "wcachesz=%d";
+    xrootdfs_opts[13].offset = offsetof(struct XROOTDFS, wcachesz);
+    xrootdfs_opts[13].value = 0;
+
+/* life time of cached attributes and failed lookups */
+    xrootdfs_opts[14].templ = "attrttl=%d";
+    xrootdfs_opts[14].offset = offsetof(struct XROOTDFS, attrttl);
+    xrootdfs_opts[14].value = 0;
+
+    xrootdfs_opts[15].templ = "negttl=%d";
+    xrootdfs_opts[15].offset = offsetof(struct XROOTDFS, negttl);
+    xrootdfs_opts[15].value = 0;
+
+/* max number of parallel requests to data servers by one operation */
+    xrootdfs_opts[16].templ = "fanout=%d";
+    xrootdfs_opts[16].offset = offsetof(struct XROOTDFS, fanout);
+    xrootdfs_opts[16].value = 0;
+
+    xrootdfs_opts[17].templ = NULL;
 
 /* initialize struct xrootdfs */
 //    memset(&xrootdfs, 0, sizeof(xrootdfs));
@@ -1313,6 +1371,10 @@ int main(int argc, char *argv[])
     xrootdfs.urlcachelife = strdup("3650d"); /* 10 years */
     xrootdfs.nworkers = 4;
     xrootdfs.maxfd = 8192;
+    xrootdfs.wcachesz = 64;
+    xrootdfs.attrttl = 10;
+    xrootdfs.negttl = 5;
+    xrootdfs.fanout = 0;
 
 /* Get options from environment variables first */
     xrootdfs.rdr = getenv("XROOTDFS_RDRURL");
@@ -1323,6 +1385,10 @@ int main(int argc, char *argv[])
     if (getenv("XROOTDFS_OFSFWD") != NULL && ! strcmp(getenv("XROOTDFS_OFSFWD"),"1")) xrootdfs.ofsfwd = true;
     if (getenv("XROOTDFS_NWORKERS") != NULL) sscanf(getenv("XROOTDFS_NWORKERS"), "%d", &xrootdfs.nworkers);
     if (getenv("XROOTDFS_MAXFD") != NULL) sscanf(getenv("XROOTDFS_MAXFD"), "%d", &xrootdfs.maxfd);
+    if (getenv("XROOTDFS_WCACHESZ") != NULL) sscanf(getenv("XROOTDFS_WCACHESZ"), "%d", &xrootdfs.wcachesz);
+    if (getenv("XROOTDFS_ATTRTTL") != NULL) sscanf(getenv("XROOTDFS_ATTRTTL"), "%d", &xrootdfs.attrttl);
+    if (getenv("XROOTDFS_NEGTTL") != NULL) sscanf(getenv("XROOTDFS_NEGTTL"), "%d", &xrootdfs.negttl);
+    if (getenv("XROOTDFS_FANOUT") != NULL) sscanf(getenv("XROOTDFS_FANOUT"), "%d", &xrootdfs.fanout);
 
 /* Parse XrootdFS options, will overwrite those defined in environment variables */
     fuse_opt_parse(&args, &xrootdfs, xrootdfs_opts, xrootdfs_opt_proc);
@@ -1356,6 +1422,7 @@ int main(int argc, char *argv[])
     }
 
     if (xrootdfs.maxfd < 2048) xrootdfs.maxfd = 2048;
+    if (xrootdfs.wcachesz < 1) xrootdfs.wcachesz = 1;
 
     signal(SIGUSR1,xrootdfs_sigusr1_handler);
 
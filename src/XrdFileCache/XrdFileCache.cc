@@ -31,10 +31,11 @@
 #include "XrdFileCacheIOEntireFile.hh"
 #include "XrdFileCacheIOFileBlock.hh"
 #include "XrdFileCacheFactory.hh"
-#include "XrdFileCachePrefetch.hh"
+#include "XrdFileCacheStats.hh"
 
 
 XrdFileCache::Cache::WriteQ XrdFileCache::Cache::s_writeQ;
+XrdFileCache::Cache::RamPool XrdFileCache::Cache::s_ramPool;
 
 using namespace XrdFileCache;
 void *ProcessWriteTaskThread(void* c)
@@ -55,6 +56,18 @@ Cache::Cache(XrdOucCacheStats & stats)
 
 XrdOucCacheIO *Cache::Attach(XrdOucCacheIO *io, int Options)
 {
+   // Files opened for update are cached only with write-through of the whole
+   // file. New files have nothing to cache yet.
+   if (Options & XrdOucCache::optRW)
+   {
+      const Configuration &conf = Factory::GetInstance().RefConfiguration();
+      if (!conf.m_writethrough || conf.m_hdfsmode || io->FSize() <= 0)
+      {
+         clLog()->Info(XrdCl::AppMsg, "Cache::Attach() write-through not possible %s", io->Path());
+         return io;
+      }
+   }
+
    if (Factory::GetInstance().Decide(io))
    {
       clLog()->Info(XrdCl::AppMsg, "Cache::Attach() %s", io->Path());
@@ -172,3 +185,98 @@ Cache::ProcessWriteTasks()
       t.prefetch->DecRamBlockRefCount(t.ramBlockIdx);
    }
 }
+
+//______________________________________________________________________________
+long long
+Cache::RamBlockClass(long long size)
+{
+   // Full blocks get buffers of exact size. Smaller blocks, e.g. the last
+   // block of a file, are rounded up to a power of two.
+   long long bs = Factory::GetInstance().RefConfiguration().m_bufferSize;
+   if (size >= bs) return size;
+
+   long long c = 64*1024;
+   while (c < size) c <<= 1;
+   return c < bs ? c : bs;
+}
+
+//______________________________________________________________________________
+char*
+Cache::RequestRamBlock(long long size, long long fileUsed, bool prefetch)
+{
+   const Configuration &conf = Factory::GetInstance().RefConfiguration();
+   long long cls = RamBlockClass(size);
+   char     *buff = 0;
+
+   XrdSysMutexHelper _lck(&s_ramPool.mutex);
+
+   long long limit = conf.m_ramPoolSize;
+   if (prefetch) limit -= conf.m_ramPoolSize / 10;
+
+   int       nActive = s_ramPool.nActive + (fileUsed ? 0 : 1);
+   long long share   = conf.m_ramPoolSize / nActive;
+   if (share < cls) share = cls;
+
+   if (s_ramPool.usedBytes + cls > limit || fileUsed + cls > share)
+   {
+      s_ramPool.nDenied++;
+      return 0;
+   }
+
+   std::vector<char*> &fl = s_ramPool.freeLists[cls];
+   if ( ! fl.empty())
+   {
+      buff = fl.back();
+      fl.pop_back();
+   }
+   else
+   {
+      // make room by releasing free buffers of other size classes
+      std::map<long long, std::vector<char*> >::iterator i = s_ramPool.freeLists.begin();
+      while (s_ramPool.allocBytes + cls > conf.m_ramPoolSize && i != s_ramPool.freeLists.end())
+      {
+         while ( ! i->second.empty() && s_ramPool.allocBytes + cls > conf.m_ramPoolSize)
+         {
+            free(i->second.back());
+            i->second.pop_back();
+            s_ramPool.allocBytes -= i->first;
+         }
+         ++i;
+      }
+      buff = (char*) malloc(cls);
+      if ( ! buff) return 0;
+      s_ramPool.allocBytes += cls;
+   }
+
+   if ( ! fileUsed) s_ramPool.nActive++;
+   s_ramPool.usedBytes += cls;
+   if (s_ramPool.usedBytes > s_ramPool.peakBytes) s_ramPool.peakBytes = s_ramPool.usedBytes;
+
+   return buff;
+}
+
+//______________________________________________________________________________
+void
+Cache::ReleaseRamBlock(char* buff, long long size, long long fileUsed)
+{
+   long long cls = RamBlockClass(size);
+
+   XrdSysMutexHelper _lck(&s_ramPool.mutex);
+
+   s_ramPool.freeLists[cls].push_back(buff);
+   s_ramPool.usedBytes -= cls;
+   if ( ! fileUsed) s_ramPool.nActive--;
+}
+
+//______________________________________________________________________________
+void
+Cache::GetRamPoolStats(XrdFileCache::Stats& stats)
+{
+   XrdSysMutexHelper _lck(&s_ramPool.mutex);
+
+   stats.m_RamPoolSize   = Factory::GetInstance().RefConfiguration().m_ramPoolSize;
+   stats.m_RamPoolUsed   = s_ramPool.usedBytes;
+   stats.m_RamPoolPeak   = s_ramPool.peakBytes;
+   stats.m_RamPoolFiles  = s_ramPool.nActive;
+   stats.m_RamPoolDenied = s_ramPool.nDenied;
+}
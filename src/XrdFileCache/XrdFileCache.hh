@@ -19,6 +19,8 @@
 //----------------------------------------------------------------------------------
 #include <string>
 #include <list>
+#include <map>
+#include <vector>
 
 #include "XrdSys/XrdSysPthread.hh"
 #include "XrdOuc/XrdOucCache.hh"
@@ -29,6 +31,7 @@ namespace XrdCl {
 }
 namespace XrdFileCache {
 class Prefetch;
+class Stats;
 }
 
 namespace XrdFileCache
@@ -85,6 +88,41 @@ namespace XrdFileCache
          //---------------------------------------------------------------------
          static void ProcessWriteTasks();
 
+         //---------------------------------------------------------------------
+         //! \brief Get a buffer for a RAM block from the pool shared by all
+         //! files.
+         //!
+         //! A file may use up to its fair share of the pool, the pool size
+         //! divided by the number of files holding blocks. Prefetching may
+         //! not use the part of the pool reserved for client reads.
+         //!
+         //! @param size     block size
+         //! @param fileUsed bytes of the pool currently held by the file
+         //! @param prefetch request is for prefetching
+         //!
+         //! @return buffer or 0 if the pool or file share is exhausted
+         //---------------------------------------------------------------------
+         static char* RequestRamBlock(long long size, long long fileUsed, bool prefetch);
+
+         //---------------------------------------------------------------------
+         //! \brief Return buffer obtained with RequestRamBlock() to the pool.
+         //!
+         //! @param buff     buffer
+         //! @param size     block size used in the request
+         //! @param fileUsed bytes of the pool held by the file after release
+         //---------------------------------------------------------------------
+         static void ReleaseRamBlock(char* buff, long long size, long long fileUsed);
+
+         //---------------------------------------------------------------------
+         //! Size of pool buffer used for a block of given size.
+         //---------------------------------------------------------------------
+         static long long RamBlockClass(long long size);
+
+         //---------------------------------------------------------------------
+         //! Fill RAM block pool occupancy into statistics.
+         //---------------------------------------------------------------------
+         static void GetRamPoolStats(XrdFileCache::Stats& stats);
+
       private:
          //! Decrease attached count. Called from IO::Detach().
          void Detach(XrdOucCacheIO *);
@@ -117,6 +155,20 @@ namespace XrdFileCache
 
          static WriteQ s_writeQ;
 
+         struct RamPool
+         {
+            RamPool() : usedBytes(0), allocBytes(0), peakBytes(0), nActive(0), nDenied(0) {}
+            XrdSysMutex  mutex;        //!< pool lock
+            long long    usedBytes;    //!< bytes of buffers handed out
+            long long    allocBytes;   //!< bytes of buffers in use or on free lists
+            long long    peakBytes;    //!< highest value of usedBytes
+            int          nActive;      //!< number of files holding buffers
+            long long    nDenied;      //!< number of refused requests
+            std::map<long long, std::vector<char*> > freeLists; //!< free buffers by size class
+         };
+
+         static RamPool s_ramPool;
+
    };
 
    //----------------------------------------------------------------------------
@@ -17,6 +17,7 @@
 //----------------------------------------------------------------------------------
 
 #include <sstream>
+#include <algorithm>
 #include <string>
 #include <fcntl.h>
 #include <stdio.h>
@@ -39,10 +40,12 @@
 #include "XrdVersion.hh"
 #include "XrdPosix/XrdPosixXrootd.hh"
 #include "XrdCl/XrdClConstants.hh"
+#include "XrdCms/XrdCmsFinder.hh"
 
 #include "XrdFileCache.hh"
 #include "XrdFileCacheFactory.hh"
 #include "XrdFileCachePrefetch.hh"
+#include "XrdFileCacheInfo.hh"
 
 
 using namespace XrdFileCache;
@@ -61,9 +64,16 @@ void *CacheDirCleanupThread(void* cache_void)
    return NULL;
 }
 
+void *CmsReportThread(void* cache_void)
+{
+   Factory::GetInstance().CmsReport();
+   return NULL;
+}
+
 
 Factory::Factory()
-   : m_log(0, "XrdFileCache_")
+   : m_log(0, "XrdFileCache_"),
+     m_cmsClient(0)
 {}
 
 extern "C"
@@ -86,6 +96,8 @@ XrdOucCache *XrdOucGetCache(XrdSysLogger *logger,
 
    pthread_t tid;
    XrdSysThread::Run(&tid, CacheDirCleanupThread, NULL, 0, "XrdFileCache CacheDirCleanup");
+   if (factory.RefConfiguration().m_cmsReport)
+      XrdSysThread::Run(&tid, CmsReportThread, NULL, 0, "XrdFileCache CmsReport");
    return &factory;
 }
 }
@@ -184,10 +196,6 @@ bool Factory::Config(XrdSysLogger *logger, const char *config_filename, const ch
 {
    m_log.logger(logger);
 
-   const char * cache_env;
-   if (!(cache_env = getenv("XRDPOSIX_CACHE")) || !*cache_env)
-      XrdOucEnv::Export("XRDPOSIX_CACHE", "mode=s&optwr=0");
-
    XrdOucEnv myEnv;
    XrdOucStream Config(&m_log, getenv("XRDINSTANCE"), &myEnv, "=====> ");
 
@@ -240,6 +248,11 @@ bool Factory::Config(XrdSysLogger *logger, const char *config_filename, const ch
 
    Config.Close();
 
+   // Files opened for update are only given to the cache in write-through mode.
+   const char * cache_env;
+   if (!(cache_env = getenv("XRDPOSIX_CACHE")) || !*cache_env)
+      XrdOucEnv::Export("XRDPOSIX_CACHE", m_configuration.m_writethrough ? "mode=s&optwr=1" : "mode=s&optwr=0");
+
 
    if (retval)
    {
@@ -255,16 +268,38 @@ bool Factory::Config(XrdSysLogger *logger, const char *config_filename, const ch
          m_output_fs = 0;
       }
 
+      if (m_configuration.m_cmsReport && m_configuration.m_hdfsmode)
+      {
+         m_log.Emsg("Config", "pfc.cmsreport is not supported in hdfsmode, ignored");
+         m_configuration.m_cmsReport = false;
+      }
+      // Only the server reports, the cmsd may load this plugin too via pss.
+      const char *prog = getenv("XRDPROG");
+      if (prog && !strcmp(prog, "cmsd")) m_configuration.m_cmsReport = false;
+      if (retval && m_configuration.m_cmsReport)
+      {
+         m_cmsClient = new XrdCmsFinderTRG(logger, XrdCms::IsTarget | XrdCms::IsCache, 0);
+         if (!m_cmsClient->Configure(config_filename, 0, 0))
+         {
+            clLog()->Error(XrdCl::AppMsg, "Factory::Config() Unable to configure cms reporting");
+            retval = false;
+            delete m_cmsClient;
+            m_cmsClient = 0;
+         }
+      }
+
   
       int loff = 0;
       char buff[2048];
       loff = snprintf(buff, sizeof(buff), "result\n"
                "\tpfc.cachedir %s\n"
                "\tpfc.blocksize %lld\n"
-               "\tpfc.nramread %d\n\tpfc.nramprefetch %d\n",
+               "\tpfc.nramread %d\n\tpfc.nramprefetch %d\n"
+               "\tpfc.ram %lld\n",
                m_configuration.m_cache_dir.c_str() , 
                m_configuration.m_bufferSize, 
-               m_configuration.m_NRamBuffersRead, m_configuration.m_NRamBuffersPrefetch );
+               m_configuration.m_NRamBuffersRead, m_configuration.m_NRamBuffersPrefetch,
+               m_configuration.m_ramPoolSize );
 
       if (m_configuration.m_hdfsmode)
       {
@@ -273,6 +308,15 @@ bool Factory::Config(XrdSysLogger *logger, const char *config_filename, const ch
          loff += snprintf(&buff[loff], strlen(buff2), buff2);
       } 
 
+      if (m_configuration.m_writethrough)
+      {
+         loff += snprintf(&buff[loff], sizeof(buff) - loff, "\tpfc.writethrough uploads %d\n", m_configuration.m_wtUploads);
+      }
+
+      if (m_configuration.m_cmsReport)
+      {
+         loff += snprintf(&buff[loff], sizeof(buff) - loff, "\tpfc.cmsreport refresh %d\n", m_configuration.m_cmsRefresh);
+      }
 
       char  unameBuff[256];
       if (m_configuration.m_username.empty()) {
@@ -330,6 +374,14 @@ bool Factory::ConfigParameters(std::string part, XrdOucStream& config )
          return false;
       }
    }
+   else if ( part == "ram" )
+   {
+      long long minRSize = 16 * 1024 * 1024;
+      if ( XrdOuca2x::a2sz(m_log, "get RAM pool size", config.GetWord(), &m_configuration.m_ramPoolSize, minRSize))
+      {
+         return false;
+      }
+   }
    else if (part == "nramread")
    {
       m_configuration.m_NRamBuffersRead = ::atoi(config.GetWord());
@@ -359,6 +411,46 @@ bool Factory::ConfigParameters(std::string part, XrdOucStream& config )
          }
       }         
    }
+   else if ( part == "writethrough" )
+   {
+      m_configuration.m_writethrough = true;
+
+      const char* params =  config.GetWord();
+      if (params) {
+         if (!strcmp("uploads", params)) {
+            int n;
+            params = config.GetWord();
+            if ( XrdOuca2x::a2i(m_log, "Error getting number of uploads", params, &n, 1, 1024))
+            {
+               return false;
+            }
+            m_configuration.m_wtUploads = n;
+         }
+         else {
+            m_log.Emsg("Config", "Error setting the write-through parameter name");
+            return false;
+         }
+      }
+   }
+   else if ( part == "cmsreport" )
+   {
+      m_configuration.m_cmsReport = true;
+
+      const char* params =  config.GetWord();
+      if (params) {
+         if (!strcmp("refresh", params)) {
+            params = config.GetWord();
+            if ( XrdOuca2x::a2tm(m_log, "Error getting cms report refresh interval", params, &m_configuration.m_cmsRefresh, 60))
+            {
+               return false;
+            }
+         }
+         else {
+            m_log.Emsg("Config", "Error setting the cms report parameter name");
+            return false;
+         }
+      }
+   }
    else
    {
       m_log.Emsg("Factory::ConfigParameters() unmatched pfc parameter", part.c_str());
@@ -489,6 +581,11 @@ void Factory::CacheDirCleanup()
       {
          float oc = 1 - float(sP.Free)/(sP.Total);
          clLog()->Debug(XrdCl::AppMsg, "Factory::CacheDirCleanup() occupates disk space == %f", oc);
+
+         XrdFileCache::Stats rs;
+         Cache::GetRamPoolStats(rs);
+         clLog()->Info(XrdCl::AppMsg, "Factory::CacheDirCleanup() RAM pool used %lld of %lld bytes, peak %lld, files %d, refused %lld",
+                       rs.m_RamPoolUsed, rs.m_RamPoolSize, rs.m_RamPoolPeak, rs.m_RamPoolFiles, rs.m_RamPoolDenied);
          if (oc > m_configuration.m_hwm)
          {
             long long bytesToRemoveLong = static_cast<long long> ((oc - m_configuration.m_lwm) * static_cast<float>(s_diskSpacePrecisionFactor));
@@ -530,6 +627,7 @@ void Factory::CacheDirCleanup()
                      oss->Unlink(path.c_str());
                      clLog()->Info(XrdCl::AppMsg, "Factory::CacheDirCleanup() removed %s size %lld ", path.c_str(), fstat.st_size);
                   }
+                  ReportCached(path, 0);
                }
                if (bytesToRemove <= 0)
                   break;
@@ -542,3 +640,93 @@ void Factory::CacheDirCleanup()
    }
 }
 
+//______________________________________________________________________________
+int ReportCachedRecurse(XrdOssDF* iOssDF, const std::string& path)
+{
+   char buff[256];
+   XrdOucEnv env;
+   int rdr, nFiles = 0;
+   const size_t InfoExtLen = strlen(XrdFileCache::Info::m_infoExtension);
+
+   Factory& factory = Factory::GetInstance();
+   while ( (rdr = iOssDF->Readdir(&buff[0], 256)) >= 0)
+   {
+      size_t fname_len = strlen(&buff[0]);
+      if (fname_len == 0) break;
+      if (!strncmp("..", &buff[0], 2) || !strncmp(".", &buff[0], 1)) continue;
+
+      std::string np = path + "/" + std::string(buff);
+      if (fname_len > InfoExtLen && strncmp(&buff[fname_len - InfoExtLen ], XrdFileCache::Info::m_infoExtension, InfoExtLen) == 0)
+      {
+         XrdOssDF* fh = factory.GetOss()->newFile(factory.RefConfiguration().m_username.c_str());
+         if (fh->Open(np.c_str(), O_RDONLY, 0600, env) == XrdOssOK)
+         {
+            Info cinfo;
+            if (cinfo.Read(fh) > 0)
+            {
+               factory.ReportCached(np.substr(0, np.size() - InfoExtLen), &cinfo);
+               nFiles++;
+            }
+            fh->Close();
+         }
+         delete fh;
+      }
+      else
+      {
+         XrdOssDF* dh = factory.GetOss()->newDir(factory.RefConfiguration().m_username.c_str());
+         if (dh->Opendir(np.c_str(), env) >= 0)
+         {
+            nFiles += ReportCachedRecurse(dh, np);
+            dh->Close();
+         }
+         delete dh;
+      }
+   }
+   return nFiles;
+}
+
+//______________________________________________________________________________
+void Factory::CmsReport()
+{
+   // Give the cms interface time to connect before the first report. All
+   // files are reported again every refresh interval as the managers forget
+   // about files and the cmsd may have been restarted in the meantime.
+   sleep(30);
+
+   XrdOucEnv env;
+   while (1)
+   {
+      XrdOssDF* dh = m_output_fs->newDir(m_configuration.m_username.c_str());
+      if (dh->Opendir(m_configuration.m_cache_dir.c_str(), env) >= 0)
+      {
+         int nFiles = ReportCachedRecurse(dh, m_configuration.m_cache_dir);
+         dh->Close();
+         clLog()->Info(XrdCl::AppMsg, "Factory::CmsReport() reported %d cached files", nFiles);
+      }
+      delete dh;
+      sleep(m_configuration.m_cmsRefresh);
+   }
+}
+
+//______________________________________________________________________________
+void Factory::ReportCached(const std::string& path, const Info* cinfo)
+{
+   if (!m_cmsClient) return;
+
+   const std::string& dir = m_configuration.m_cache_dir;
+   if (path.compare(0, dir.size(), dir)) return;
+   std::string lfn = path.substr(dir.size());
+   if (lfn.empty() || lfn[0] != '/') lfn.insert(0, "/");
+
+   int pct = 0;
+   if (cinfo && cinfo->GetSizeInBits() > 0)
+   {
+      if (cinfo->IsComplete())
+         pct = 100;
+      else
+         pct = std::min(99, int((100LL * cinfo->GetNDownloadedBlocks()) / cinfo->GetSizeInBits()));
+   }
+
+   clLog()->Debug(XrdCl::AppMsg, "Factory::ReportCached() %s %d%%", lfn.c_str(), pct);
+   m_cmsClient->Cached(lfn.c_str(), pct);
+}
@@ -31,6 +31,7 @@
 
 class XrdOucStream;
 class XrdSysError;
+class XrdCmsClient;
 
 namespace XrdCl
 {
@@ -39,6 +40,8 @@ namespace XrdCl
 
 namespace XrdFileCache
 {
+   class Info;
+
    //----------------------------------------------------------------------------
    //! Contains parameters configurable from the xrootd config file.
    //----------------------------------------------------------------------------
@@ -51,7 +54,12 @@ namespace XrdFileCache
          m_bufferSize(1024*1024),
 	 m_NRamBuffersRead(8),
 	 m_NRamBuffersPrefetch(1),
-         m_hdfsbsize(128*1024*1024) {}
+         m_hdfsbsize(128*1024*1024),
+         m_writethrough(false),
+         m_wtUploads(16),
+         m_ramPoolSize(512*1024*1024),
+         m_cmsReport(false),
+         m_cmsRefresh(30*60) {}
 
       bool m_hdfsmode;      //!< flag for enabling block-level operation
       std::string m_cache_dir;        //!< path of disk cache
@@ -64,6 +72,11 @@ namespace XrdFileCache
       int  m_NRamBuffersRead;         //!< number of read in-memory cache blocks
       int  m_NRamBuffersPrefetch;     //!< number of prefetch in-memory cache blocks
       long long m_hdfsbsize;          //!< used with m_hdfsmode, default 128MB
+      bool m_writethrough;            //!< cache files opened for update, write through to origin
+      int  m_wtUploads;               //!< max number of uploads in flight per file, default 16
+      long long m_ramPoolSize;        //!< RAM block pool shared by all files, default 512MB
+      bool m_cmsReport;               //!< report cached fraction of files to the local cmsd
+      int  m_cmsRefresh;              //!< interval for reporting all cached files again, default 30m
    };
 
 
@@ -143,6 +156,19 @@ namespace XrdFileCache
          //---------------------------------------------------------------------
          void CacheDirCleanup();
 
+         //---------------------------------------------------------------------
+         //! Thread function reporting all cached files to the cmsd periodically.
+         //---------------------------------------------------------------------
+         void CmsReport();
+
+         //---------------------------------------------------------------------
+         //! \brief Report how much of a file is cached to the local cmsd.
+         //!
+         //! @param path   path of the data file in the disk cache
+         //! @param cinfo  download status of the file, 0 if the file was purged
+         //---------------------------------------------------------------------
+         void ReportCached(const std::string& path, const Info* cinfo);
+
       private:
          bool ConfigParameters(std::string, XrdOucStream&);
          bool ConfigXeq(char *, XrdOucStream &);
@@ -155,6 +181,7 @@ namespace XrdFileCache
          XrdSysError       m_log;       //!< XrdFileCache namespace logger
          XrdOucCacheStats  m_stats;     //!< passed to cache, currently not used
          XrdOss           *m_output_fs; //!< disk cache file system
+         XrdCmsClient     *m_cmsClient; //!< reports cached files to the cmsd
 
          std::vector<XrdFileCache::Decision*> m_decisionpoints; //!< decision plugins
 
@@ -103,7 +103,6 @@ int IOEntireFile::Read (char *buff, long long off, int size)
    if ((size > 0))
    {
       clLog()->Debug(XrdCl::AppMsg, "IO::Read() missed %d bytes %s", size, m_io.Path());
-      if (retval > 0) bytes_read += retval;
    }
 
    if (retval < 0)
@@ -126,3 +125,19 @@ int IOEntireFile::ReadV (const XrdOucIOVec *readV, int n)
 
    return m_prefetch->ReadV(readV, n);
 }
+
+//______________________________________________________________________________
+int IOEntireFile::Write(char *buff, long long off, int size)
+{
+   clLog()->Debug(XrdCl::AppMsg, "IO::Write() [%p]  %lld@%d %s", this, off, size, m_io.Path());
+
+   return m_prefetch->Write(buff, off, size);
+}
+
+//______________________________________________________________________________
+int IOEntireFile::Sync()
+{
+   clLog()->Debug(XrdCl::AppMsg, "IO::Sync() [%p] %s", this, m_io.Path());
+
+   return m_prefetch->SyncWrites();
+}
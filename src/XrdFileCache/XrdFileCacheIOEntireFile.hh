@@ -70,6 +70,28 @@ namespace XrdFileCache
          //---------------------------------------------------------------------
          virtual int ReadV(const XrdOucIOVec *readV, int n);
 
+         //---------------------------------------------------------------------
+         //! \brief Pass Write request to the corresponding Prefetch object.
+         //!
+         //! Data is stored in the disk cache and uploaded to the origin
+         //! asynchronously. Upload errors are reported by following writes
+         //! and Sync().
+         //!
+         //! @param Buffer
+         //! @param Offset
+         //! @param Length
+         //!
+         //! @return number of bytes written
+         //---------------------------------------------------------------------
+         virtual int Write(char *Buffer, long long Offset, int Length);
+
+         //---------------------------------------------------------------------
+         //! Wait for uploads to complete and sync the original data source.
+         //!
+         //! @return 0 on success, -1 with errno on failure
+         //---------------------------------------------------------------------
+         virtual int Sync();
+
          //---------------------------------------------------------------------
          //! Detach itself from Cache. Note: this will delete the object.
          //!
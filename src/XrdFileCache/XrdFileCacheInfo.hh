@@ -65,6 +65,17 @@ namespace XrdFileCache
          void SetBitWriteCalled(int i);
          void SetBitFetched(int i);
 
+         //---------------------------------------------------------------------
+         //! \brief Mark block as not downloaded
+         //!
+         //! Used when locally written data is not yet known to be at the
+         //! origin or when writing the block to disk failed.
+         //!
+         //! @param i block index
+         //---------------------------------------------------------------------
+         void ResetBitWriteCalled(int i);
+         void ResetBitFetched(int i);
+
          //---------------------------------------------------------------------
          //! \brief Reserve buffer for fileSize/bufferSize bytes
          //!
@@ -126,6 +137,11 @@ namespace XrdFileCache
          //---------------------------------------------------------------------
          bool TestBit(int i) const;
 
+         //---------------------------------------------------------------------
+         //! Test if block at the given index is marked downloaded in cinfo file
+         //---------------------------------------------------------------------
+         bool TestBitWriteCalled(int i) const;
+
          //---------------------------------------------------------------------
          //! Get complete status
          //---------------------------------------------------------------------
@@ -177,6 +193,15 @@ namespace XrdFileCache
    }
 
 
+   inline bool Info::TestBitWriteCalled(int i) const
+   {
+      int cn = i/8;
+      assert(cn < GetSizeInBytes());
+
+      int off = i - cn*8;
+      return (m_buff_write_called[cn] & cfiBIT(off)) == cfiBIT(off);
+   }
+
    inline int Info::GetNDownloadedBlocks() const
    {
       int cntd = 0;
@@ -232,6 +257,25 @@ namespace XrdFileCache
       m_buff_fetched[cn] |= cfiBIT(off);
    }
 
+   inline void Info::ResetBitWriteCalled(int i)
+   {
+      int cn = i/8;
+      assert(cn < GetSizeInBytes());
+
+      int off = i - cn*8;
+      m_buff_write_called[cn] &= ~cfiBIT(off);
+   }
+
+   inline void Info::ResetBitFetched(int i)
+   {
+      int cn = i/8;
+      assert(cn < GetSizeInBytes());
+
+      int off = i - cn*8;
+      m_buff_fetched[cn] &= ~cfiBIT(off);
+      m_complete = false;
+   }
+
    inline long long Info::GetBufferSize() const
    {
       return m_bufferSize;
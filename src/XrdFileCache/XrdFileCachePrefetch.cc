@@ -17,7 +17,10 @@
 //----------------------------------------------------------------------------------
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <sstream>
+#include <algorithm>
 #include <fcntl.h>
 
 #include "XrdCl/XrdClLog.hh"
@@ -31,6 +34,7 @@
 
 #include "XrdSfs/XrdSfsInterface.hh"
 #include "XrdPosix/XrdPosixFile.hh"
+#include "XrdPosix/XrdPosixMap.hh"
 
 #include "XrdFileCachePrefetch.hh"
 #include "XrdFileCacheFactory.hh"
@@ -65,17 +69,54 @@ namespace
    };
 }
 
+//______________________________________________________________________________
+// Write of a copy of client data to the origin, deletes itself when done.
+struct Prefetch::Upload : public XrdCl::ResponseHandler
+{
+   Prefetch  *m_prefetch;
+   char      *m_buff;
+   long long  m_offset;
+   int        m_size;
+
+   Upload(Prefetch *p, const char *buff, long long off, int size) :
+      m_prefetch(p), m_buff((char*)malloc(size)), m_offset(off), m_size(size)
+   {
+      memcpy(m_buff, buff, size);
+   }
+
+   ~Upload() { free(m_buff); }
+
+   bool Overlaps(long long off, long long size) const
+   {
+      return off < m_offset + m_size && m_offset < off + size;
+   }
 
-Prefetch::RAM::RAM():m_numBlocks(0),m_buffer(0), m_blockStates(0), m_writeMutex(0)
+   void HandleResponse(XrdCl::XRootDStatus *status, XrdCl::AnyObject *response)
+   {
+      int errNo = 0;
+      if (!status->IsOK())
+      {
+         XrdPosixMap::Result(*status);
+         errNo = errno;
+      }
+      delete status;
+      delete response;
+
+      m_prefetch->UploadDone(this, errNo);
+      delete this;
+   }
+};
+
+
+Prefetch::RAM::RAM():m_numBlocks(0),m_usedBytes(0), m_blockStates(0), m_writeMutex(0)
 {
+   // buffers are taken from Cache RAM pool when blocks are used
    m_numBlocks = Factory::GetInstance().RefConfiguration().m_NRamBuffersRead + Factory::GetInstance().RefConfiguration().m_NRamBuffersPrefetch;
-   m_buffer = (char*)malloc(m_numBlocks * Factory::GetInstance().RefConfiguration().m_bufferSize);
    m_blockStates = new RAMBlock[m_numBlocks];
 }
 
 Prefetch::RAM::~RAM()
 {
-   free(m_buffer);
    delete [] m_blockStates;
 }
 
@@ -94,7 +135,11 @@ Prefetch::Prefetch(XrdOucCacheIO &inputIO, std::string& disk_file_path, long lon
    m_queueCond(0),
    m_syncer(new DiskSyncer(this, "XrdFileCache::DiskSyncer")),
    m_non_flushed_cnt(0),
-   m_in_sync(false)
+   m_in_sync(false),
+   m_uploadCond(0),
+   m_uploadsReserved(0),
+   m_uploadErrno(0),
+   m_uploadsUnsynced(false)
 {
    assert(m_fileSize > 0);
    clLog()->Debug(XrdCl::AppMsg, "Prefetch::Prefetch() %p %s", (void*)&m_input, lPath());
@@ -164,6 +209,12 @@ Prefetch::~Prefetch()
    }
    clLog()->Debug(XrdCl::AppMsg, "Prefetch::~Prefetch finished with writing %s",lPath() );
 
+   // uploads reference this object, written blocks can be marked clean
+   if (SyncWrites() < 0)
+   {
+      clLog()->Error(XrdCl::AppMsg, "Prefetch::~Prefetch write-through failed %s %s", strerror(errno), lPath());
+   }
+
    bool do_sync = false;
    {
       XrdSysMutexHelper _lck(&m_syncStatusMutex);
@@ -183,6 +234,12 @@ Prefetch::~Prefetch()
    // write statistics in *cinfo file
    AppendIOStatToFileInfo();
 
+   // let the cms know how much of the file is here now
+   if (m_infoFile)
+   {
+      Factory::GetInstance().ReportCached(m_temp_filename, &m_cfi);
+   }
+
    clLog()->Info(XrdCl::AppMsg, "Prefetch::~Prefetch close data file %p",(void*)this , lPath());
 
    if (m_output)
@@ -325,9 +382,27 @@ Prefetch::Run()
 
    m_cfi.CheckComplete();
 
+   // Reads of blocks whose disk write failed after the file was complete may
+   // have queued tasks after the loop ended. Fail them so that they are read
+   // from the origin, and stop any more from being queued.
+   m_queueCond.Lock();
    m_stateCond.Lock();
    m_stopped = true;
    m_stateCond.UnLock();
+   while ( ! m_tasks_queue.empty())
+   {
+      task = m_tasks_queue.front();
+      m_tasks_queue.pop_front();
+      CancelTask(task);
+
+      if (task->condVar)
+      {
+         XrdSysCondVarHelper tmph(task->condVar);
+         task->condVar->Signal();
+      }
+      delete task;
+   }
+   m_queueCond.UnLock();
 } // end Run()
 
 
@@ -373,12 +448,10 @@ Prefetch::CreateTaskForFirstUndownloadedBlock()
 
             if (m_ram.m_blockStates[r].refCount == 0 )
             {
-               t.ramBlockIdx = r;
-
                assert(m_ram.m_blockStates[r].fileBlockIdx == -1);
-               m_ram.m_blockStates[r].refCount = 1;
-               m_ram.m_blockStates[r].fileBlockIdx = fileBlockIdx;
-               m_ram.m_blockStates[r].status = kReadWait;
+               // RAM pool exhausted, prefetching is retried later
+               if (ClaimRamBlock(r, fileBlockIdx, false))
+                  t.ramBlockIdx = r;
                break;
             }
          }
@@ -469,8 +542,10 @@ Prefetch::DoTask(Task* task)
    }
    int   missing = rw_size;
    int   cnt  = 0;
-   char* buff = m_ram.m_buffer;
-   buff += task->ramBlockIdx * m_cfi.GetBufferSize();
+   char* buff = m_ram.m_blockStates[task->ramBlockIdx].buffer;
+
+   // origin must have client writes before the block is downloaded
+   WaitUploads(offset, rw_size);
    while (missing)
    {
       clLog()->Dump(XrdCl::AppMsg, "Prefetch::DoTask() for block f = %d r = %dsingal = %p  %s", fileBlockIdx, task->ramBlockIdx, task->condVar,  lPath());
@@ -510,7 +585,7 @@ Prefetch::DoTask(Task* task)
       if (!m_stopping) { Cache::AddWriteTask(this, task->ramBlockIdx, rw_size, task->condVar ? true : false );
       }
       else {
-         m_ram.m_blockStates[task->ramBlockIdx].refCount--;
+         DecRamBlockRefCount(task->ramBlockIdx);
       }
 
    }
@@ -521,16 +596,28 @@ Prefetch::DoTask(Task* task)
    }
 }
 
+//_________________________________________________________________________________________________
+void
+Prefetch::CancelTask(Task* task)
+{
+   // readers waiting on the block see a failure and go to the origin
+   m_ram.m_writeMutex.Lock();
+   m_ram.m_blockStates[task->ramBlockIdx].status = kReadFailed;
+   m_ram.m_blockStates[task->ramBlockIdx].readErrno = ECANCELED;
+   m_ram.m_writeMutex.Broadcast();
+   m_ram.m_writeMutex.UnLock();
+   DecRamBlockRefCount(task->ramBlockIdx);
+}
+
 //_________________________________________________________________________________________________
 void
 Prefetch::WriteBlockToDisk(int ramIdx, size_t size)
 {
    // called from XrdFileCache::Cache when process queue
 
-   int fileIdx = m_ram.m_blockStates[ramIdx].fileBlockIdx;
-   char* buff = m_ram.m_buffer;
-   buff += ramIdx*m_cfi.GetBufferSize();
    assert(ramIdx >=0 && ramIdx < m_ram.m_numBlocks);
+   int fileIdx = m_ram.m_blockStates[ramIdx].fileBlockIdx;
+   char* buff = m_ram.m_blockStates[ramIdx].buffer;
    int retval = 0;
 
    // write block buffer into disk file
@@ -602,7 +689,10 @@ void Prefetch::Sync()
 
    m_output->Fsync();
 
-   m_cfi.WriteHeader(m_infoFile);
+   {
+      XrdSysMutexHelper _lck(&m_infoMutex);
+      m_cfi.WriteHeader(m_infoFile);
+   }
 
    int written_while_in_sync;
    {
@@ -636,18 +726,58 @@ void Prefetch::DecRamBlockRefCount(int ramIdx)
    m_ram.m_blockStates[ramIdx].refCount --;
    if (m_ram.m_blockStates[ramIdx].refCount == 0) {
        m_ram.m_blockStates[ramIdx].fileBlockIdx = -1;
+       // return buffer to the pool
+       m_ram.m_usedBytes -= Cache::RamBlockClass(m_ram.m_blockStates[ramIdx].size);
+       Cache::ReleaseRamBlock(m_ram.m_blockStates[ramIdx].buffer, m_ram.m_blockStates[ramIdx].size, m_ram.m_usedBytes);
+       m_ram.m_blockStates[ramIdx].buffer = 0;
+       // wake up writes waiting for the block to be released
+       m_ram.m_writeMutex.Broadcast();
    }
    m_ram.m_writeMutex.UnLock();
 }
 
+//______________________________________________________________________________
+long long Prefetch::BlockSize(int fileBlockIdx) const
+{
+   long long offset  = fileBlockIdx * m_cfi.GetBufferSize();
+   long long size    = m_cfi.GetBufferSize();
+   // fix size if this is the last file block
+   if ( offset + size - m_offset > m_fileSize )
+      size = m_fileSize + m_offset - offset;
+   return size;
+}
+
+//______________________________________________________________________________
+bool Prefetch::ClaimRamBlock(int ramIdx, int fileBlockIdx, bool fromRead)
+{
+   RAMBlock &rb = m_ram.m_blockStates[ramIdx];
+   long long size = BlockSize(fileBlockIdx);
+
+   rb.buffer = Cache::RequestRamBlock(size, m_ram.m_usedBytes, !fromRead);
+   if ( ! rb.buffer)
+   {
+      clLog()->Dump(XrdCl::AppMsg, "Prefetch::ClaimRamBlock RAM pool exhausted, block %d %s", fileBlockIdx, lPath());
+      return false;
+   }
+   m_ram.m_usedBytes += Cache::RamBlockClass(size);
+
+   rb.size         = size;
+   rb.refCount     = 1;
+   rb.fileBlockIdx = fileBlockIdx;
+   rb.fromRead     = fromRead;
+   rb.status       = kReadWait;
+   return true;
+}
+
 //______________________________________________________________________________
 bool Prefetch::ReadFromTask(int iFileBlockIdx, char* iBuff, long long iOff, size_t iSize)
 {
    // offs == offset inside the block, size  read size in block
    clLog()->Dump(XrdCl::AppMsg, "Prefetch::ReadFromTask fileIdx= %d begin", iFileBlockIdx);
 
+   // once Run() has exited nobody would take the task, read from the origin
    m_stateCond.Lock();
-   bool doExit = m_stopping;
+   bool doExit = m_stopping || m_stopped;
    m_stateCond.UnLock();
    if (doExit) return false;
 
@@ -667,11 +797,12 @@ bool Prefetch::ReadFromTask(int iFileBlockIdx, char* iBuff, long long iOff, size
             if (m_ram.m_blockStates[i].refCount == 0)
             {
                assert(m_ram.m_blockStates[i].fileBlockIdx == -1);
-               ramIdx = i;
-               m_ram.m_blockStates[i].refCount = 1;
-               m_ram.m_blockStates[i].fileBlockIdx = iFileBlockIdx;
-               m_ram.m_blockStates[i].fromRead = true;
-               m_ram.m_blockStates[i].status = kReadWait;
+               if (ClaimRamBlock(i, iFileBlockIdx, true))
+               {
+                  // reader keeps a reference until the data is copied out
+                  ramIdx = i;
+                  m_ram.m_blockStates[i].refCount = 2;
+               }
                break;
             }
          }
@@ -688,27 +819,39 @@ bool Prefetch::ReadFromTask(int iFileBlockIdx, char* iBuff, long long iOff, size
             Task* task = new Task(ramIdx, &newTaskCond);
 
             m_queueCond.Lock();
-            m_tasks_queue.push_front(task);
-            m_queueCond.Signal();
-            m_queueCond.UnLock();
+            if (m_stopped)
+            {
+               // Run() exited after the check above
+               CancelTask(task);
+               m_queueCond.UnLock();
+               delete task;
+            }
+            else
+            {
+               m_tasks_queue.push_front(task);
+               m_queueCond.Signal();
+               m_queueCond.UnLock();
 
-            clLog()->Dump(XrdCl::AppMsg, "Prefetch::ReadFromTask wait task %p confvar %p",  task, task->condVar);
+               clLog()->Dump(XrdCl::AppMsg, "Prefetch::ReadFromTask wait task %p confvar %p",  task, task->condVar);
 
-            newTaskCond.Wait();
+               newTaskCond.Wait();
+            }
          }
-         if (m_ram.m_blockStates[ramIdx].status == kReadSuccess)
+         bool ok = m_ram.m_blockStates[ramIdx].status == kReadSuccess;
+         if (ok)
          {
             clLog()->Dump(XrdCl::AppMsg, "Prefetch::ReadFromTask memcpy from RAM to IO::buffer fileIdx=%d ", iFileBlockIdx);
             long long inBlockOff = iOff - iFileBlockIdx * m_cfi.GetBufferSize();
-            char* srcBuff = m_ram.m_buffer + ramIdx*m_cfi.GetBufferSize();
+            char* srcBuff = m_ram.m_blockStates[ramIdx].buffer;
             memcpy(iBuff, srcBuff + inBlockOff, iSize);
          }
          else
          {
             clLog()->Error(XrdCl::AppMsg, "Prefetch::ReadFromTask client fileIdx=%d failed", iFileBlockIdx);
          }
+         DecRamBlockRefCount(ramIdx);
 
-         return m_ram.m_blockStates[ramIdx].status == kReadSuccess;
+         return ok;
       }
       else {
          clLog()->Debug(XrdCl::AppMsg, "Prefetch::ReadFromTask can't get free ram, not enough resources");
@@ -794,7 +937,7 @@ ssize_t Prefetch::ReadInBlocks(char *buff, off_t off, size_t size)
              if ( m_ram.m_blockStates[RamIdx].status == kReadSuccess) {
                  clLog()->Dump(XrdCl::AppMsg, "Prefetch::ReadInBlocks  ram = %d file block = %d", RamIdx, blockIdx);
                  int in_block_off = off - m_ram.m_blockStates[RamIdx].fileBlockIdx *m_cfi.GetBufferSize();
-                 char *rbuff = m_ram.m_buffer + RamIdx*m_cfi.GetBufferSize() + in_block_off;
+                 char *rbuff = m_ram.m_blockStates[RamIdx].buffer + in_block_off;
                  memcpy(buff, rbuff, readBlockSize);
                  DecRamBlockRefCount(RamIdx);
                  retvalBlock = readBlockSize;
@@ -815,6 +958,7 @@ ssize_t Prefetch::ReadInBlocks(char *buff, off_t off, size_t size)
             }
             else
             {
+               WaitUploads(off, readBlockSize);
                retvalBlock = m_input.Read(buff, off, readBlockSize);
                clLog()->Dump(XrdCl::AppMsg, "Prefetch::ReadInBlocks [%d]  client = %d", blockIdx, retvalBlock);
                m_stats.m_BytesMissed += retvalBlock;
@@ -898,6 +1042,7 @@ int Prefetch::ReadV (const XrdOucIOVec *readV, int n)
       else
       {
          clLog()->Debug(XrdCl::AppMsg, "Prefetch::ReadV %d add back to client vector read ", i);
+         WaitUploads(readV[i].offset, readV[i].size);
          chunkVec.push_back(XrdCl::ChunkInfo((uint64_t)readV[i].offset,
                                              (uint32_t)readV[i].size,
                                              (void *)readV[i].data
@@ -936,6 +1081,21 @@ Prefetch::Read(char *buff, off_t off, size_t size)
 
    clLog()->Dump(XrdCl::AppMsg, "Prefetch::Read()  off = %lld size = %lld. %s", off, size, lPath());
 
+   // the file can grow past the cached size with write-through
+   long long cacheEnd = m_offset + m_fileSize;
+   if (off + (long long)size > cacheEnd)
+   {
+      size_t inCache = (off < cacheEnd) ? cacheEnd - off : 0;
+      ssize_t res = inCache ? Read(buff, off, inCache) : 0;
+      if (res < (ssize_t)inCache) return res;
+
+      WaitUploads(off + inCache, size - inCache);
+      int tail = m_input.Read(buff + inCache, off + inCache, size - inCache);
+      if (tail < 0) return res ? res : tail;
+      m_stats.m_BytesMissed += tail;
+      return res + tail;
+   }
+
    bool fileComplete;
    m_downloadStatusMutex.Lock();
    fileComplete = m_cfi.IsComplete();
@@ -972,3 +1132,281 @@ void Prefetch::AppendIOStatToFileInfo()
 
 
 
+
+//______________________________________________________________________________
+int Prefetch::Write(char *buff, long long off, int size)
+{
+   {
+      XrdSysCondVarHelper monitor(m_stateCond);
+
+      if ( ! m_started)
+      {
+         m_stateCond.Wait();
+      }
+      // without disk file write directly to origin
+      if (m_failed) return m_input.Write(buff, off, size);
+   }
+
+   clLog()->Dump(XrdCl::AppMsg, "Prefetch::Write()  off = %lld size = %d. %s", off, size, lPath());
+
+   Upload *upload = new Upload(this, buff, off, size);
+
+   // reserve place in the upload pipeline, without the RAM lock as this waits
+   // for uploads to the origin to complete
+   {
+      XrdSysCondVarHelper _lck(m_uploadCond);
+      while ((int)m_uploads.size() + m_uploadsReserved >= Factory::GetInstance().RefConfiguration().m_wtUploads && !m_uploadErrno)
+      {
+         m_uploadCond.Wait();
+      }
+      if (m_uploadErrno)
+      {
+         delete upload;
+         errno = m_uploadErrno;
+         return -1;
+      }
+      ++m_uploadsReserved;
+   }
+
+   // Blocks being downloaded must not overwrite the written data. Holding the
+   // RAM lock until the upload is registered prevents new downloads of these
+   // blocks, and later ones wait for the upload in DoTask().
+   long long bs       = m_cfi.GetBufferSize();
+   long long cacheEnd = m_offset + m_fileSize;
+   long long end      = std::min(off + size, cacheEnd);
+   int idx_first = off / bs;
+   int idx_last  = (end - 1) / bs;
+
+   m_ram.m_writeMutex.Lock();
+   bool busy = true;
+   while (busy && off < cacheEnd)
+   {
+      busy = false;
+      for (int r = 0; r < m_ram.m_numBlocks; ++r)
+      {
+         int fbi = m_ram.m_blockStates[r].fileBlockIdx;
+         if (m_ram.m_blockStates[r].refCount > 0 && fbi >= idx_first && fbi <= idx_last)
+         {
+            busy = true;
+            break;
+         }
+      }
+      if (busy) m_ram.m_writeMutex.Wait();
+   }
+   {
+      XrdSysCondVarHelper _lck(m_uploadCond);
+      --m_uploadsReserved;
+      m_uploads.push_back(upload);
+      m_uploadsUnsynced = true;
+   }
+   m_ram.m_writeMutex.UnLock();
+
+   // The upload is only sent once the data is on disk, so downloads of these
+   // blocks cannot fetch older data from the origin in the meantime.
+   if (off < cacheEnd) StoreWrite(buff, off, end - off);
+
+   XrdCl::File& clFile = ((XrdPosixFile&)m_input).clFile;
+   XrdCl::XRootDStatus st = clFile.Write((uint64_t)off, (uint32_t)size, upload->m_buff, upload);
+   if (!st.IsOK())
+   {
+      XrdPosixMap::Result(st);
+      int rc = errno;
+      UploadDone(upload, rc);
+      delete upload;
+      errno = rc;
+      return -1;
+   }
+
+   m_stats.BytesWrite += size;
+   return size;
+}
+
+//______________________________________________________________________________
+void Prefetch::StoreWrite(char *buff, long long off, int size)
+{
+   // called from Write() after the upload is registered, without the RAM lock
+
+   long long bs = m_cfi.GetBufferSize();
+   int pf_first = (off - m_offset) / bs;
+   int pf_last  = (off - m_offset + size - 1) / bs;
+
+   // Written blocks may not be marked downloaded in the cinfo file until the
+   // data is at the origin, so that the cache is consistent after a crash.
+   {
+      XrdSysMutexHelper _ilck(&m_infoMutex);
+
+      bool writeHeader = false;
+      {
+         XrdSysMutexHelper _lck(&m_syncStatusMutex);
+         for (int i = pf_first; i <= pf_last; ++i)
+         {
+            if (m_cfi.TestBitWriteCalled(i))
+            {
+               m_cfi.ResetBitWriteCalled(i);
+               writeHeader = true;
+            }
+            m_writes_during_sync.erase(std::remove(m_writes_during_sync.begin(), m_writes_during_sync.end(), i),
+                                       m_writes_during_sync.end());
+            m_dirtyBlocks.insert(i);
+         }
+      }
+      if (writeHeader)
+      {
+         m_cfi.WriteHeader(m_infoFile);
+         m_infoFile->Fsync();
+      }
+   }
+
+   int buffer_remaining = size;
+   int buffer_offset = 0;
+   int cnt = 0;
+   int retval;
+   while (buffer_remaining > 0)
+   {
+      retval = m_output->Write(buff + buffer_offset, off - m_offset + buffer_offset, buffer_remaining);
+      if (retval < 0 && errno != EINTR) break;
+      if (retval > 0)
+      {
+         buffer_remaining -= retval;
+         buffer_offset    += retval;
+      }
+      if (++cnt > PREFETCH_MAX_ATTEMPTS) break;
+   }
+
+   XrdSysMutexHelper _lck(&m_downloadStatusMutex);
+   for (int i = pf_first; i <= pf_last; ++i)
+   {
+      if (buffer_remaining)
+      {
+         // disk content is undefined, block has to be downloaded again
+         m_cfi.ResetBitFetched(i);
+         continue;
+      }
+      long long blk_beg = m_offset + i * bs;
+      long long blk_end = std::min(blk_beg + bs, m_offset + m_fileSize);
+      if (blk_beg >= off && blk_end <= off + size)
+         m_cfi.SetBitFetched(i);
+   }
+
+   if (buffer_remaining == 0)
+   {
+      m_stats.BytesPut += size;
+   }
+   else
+   {
+      clLog()->Error(XrdCl::AppMsg, "Prefetch::StoreWrite() failed writing %d bytes at %lld %s", size, off, lPath());
+   }
+}
+
+//______________________________________________________________________________
+void Prefetch::WaitUploads(long long off, long long size)
+{
+   XrdSysCondVarHelper _lck(m_uploadCond);
+   bool busy = true;
+   while (busy)
+   {
+      busy = false;
+      for (std::list<Upload*>::iterator i = m_uploads.begin(); i != m_uploads.end(); ++i)
+      {
+         if ((*i)->Overlaps(off, size))
+         {
+            busy = true;
+            break;
+         }
+      }
+      if (busy) m_uploadCond.Wait();
+   }
+}
+
+//______________________________________________________________________________
+void Prefetch::UploadDone(Upload *upload, int errNo)
+{
+   XrdSysCondVarHelper _lck(m_uploadCond);
+
+   if (errNo)
+   {
+      clLog()->Error(XrdCl::AppMsg, "Prefetch::UploadDone() %d@%lld failed %s %s", upload->m_size, upload->m_offset, strerror(errNo), lPath());
+      if (!m_uploadErrno) m_uploadErrno = errNo;
+   }
+   m_uploads.remove(upload);
+   m_uploadCond.Broadcast();
+}
+
+//______________________________________________________________________________
+int Prefetch::SyncWrites()
+{
+   // Blocks dirtied before all uploads completed are at the origin. Take them
+   // out of the dirty set, later writes dirty them again.
+   std::set<int> written;
+   {
+      XrdSysCondVarHelper _lck(m_uploadCond);
+      while ( ! m_uploads.empty())
+      {
+         m_uploadCond.Wait();
+      }
+      if (m_uploadErrno)
+      {
+         errno = m_uploadErrno;
+         return -1;
+      }
+      if ( ! m_uploadsUnsynced) return 0;
+      m_uploadsUnsynced = false;
+
+      XrdSysMutexHelper _slck(&m_syncStatusMutex);
+      written.swap(m_dirtyBlocks);
+   }
+
+   clLog()->Debug(XrdCl::AppMsg, "Prefetch::SyncWrites() %d blocks %s", (int)written.size(), lPath());
+
+   if (m_input.Sync() < 0)
+   {
+      int rc = errno;
+      {
+         XrdSysCondVarHelper _lck(m_uploadCond);
+         m_uploadsUnsynced = true;
+      }
+      XrdSysMutexHelper _slck(&m_syncStatusMutex);
+      m_dirtyBlocks.insert(written.begin(), written.end());
+      errno = rc;
+      return -1;
+   }
+
+   // mark clean blocks that are complete on disk
+   std::vector<int> clean;
+   m_downloadStatusMutex.Lock();
+   for (std::set<int>::iterator i = written.begin(); i != written.end(); ++i)
+   {
+      if (m_cfi.TestBit(*i)) clean.push_back(*i);
+   }
+   m_downloadStatusMutex.UnLock();
+
+   bool do_sync = false;
+   {
+      XrdSysMutexHelper _lck(&m_syncStatusMutex);
+      for (std::vector<int>::iterator i = clean.begin(); i != clean.end(); ++i)
+      {
+         if (m_dirtyBlocks.count(*i)) continue;
+
+         if (m_in_sync)
+         {
+            m_writes_during_sync.push_back(*i);
+         }
+         else
+         {
+            m_cfi.SetBitWriteCalled(*i);
+            ++m_non_flushed_cnt;
+         }
+      }
+      if ( ! m_in_sync && m_non_flushed_cnt > 0)
+      {
+         do_sync   = true;
+         m_in_sync = true;
+      }
+   }
+   if (do_sync)
+   {
+      Sync();
+   }
+
+   return 0;
+}
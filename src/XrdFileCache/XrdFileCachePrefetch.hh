@@ -20,6 +20,8 @@
 
 #include <string>
 #include <queue>
+#include <list>
+#include <set>
 
 #include "XrdCl/XrdClDefaultEnv.hh"
 
@@ -46,6 +48,7 @@ namespace XrdFileCache
       enum ReadRamState_t { kReadWait, kReadSuccess, kReadFailed};
 
       struct Task;
+      struct Upload;
       public:
          //------------------------------------------------------------------------
          //! Constructor.
@@ -89,6 +92,11 @@ namespace XrdFileCache
          //----------------------------------------------------------------------
          void Sync();
 
+         //----------------------------------------------------------------------
+         //! Called from upload response handler when a write to origin is done.
+         //----------------------------------------------------------------------
+         void UploadDone(Upload *upload, int errNo);
+
 
       protected:
          //! Read from disk, RAM, task, or client.
@@ -97,6 +105,12 @@ namespace XrdFileCache
          //! Vector read from disk if block is already downloaded, else ReadV from client.
          int ReadV (const XrdOucIOVec *readV, int n);
 
+         //! Write into disk file and upload to the origin asynchronously.
+         int Write(char *buff, long long offset, int size);
+
+         //! Wait for uploads, sync the origin and mark written blocks clean.
+         int SyncWrites();
+
          //! Write cache statistics in *cinfo file.
          void AppendIOStatToFileInfo();
 
@@ -121,14 +135,16 @@ namespace XrdFileCache
              bool fromRead;     //!< is ram requested from prefetch or read
              ReadRamState_t status;       //!< read from client status
              int readErrno; //!< posix error on read fail
+             char*     buffer;  //!< block data, owned by Cache RAM pool while refCount > 0
+             long long size;    //!< block size
 
-             RAMBlock():fileBlockIdx(-1), refCount(0), fromRead(false), status(kReadWait) {}
+             RAMBlock():fileBlockIdx(-1), refCount(0), fromRead(false), status(kReadWait), buffer(0), size(0) {}
          };
 
          struct RAM
          {
            int         m_numBlocks;    //!< number of in memory blocks
-           char*       m_buffer;       //!< buffer m_numBlocks x size_of_block
+           long long   m_usedBytes;    //!< bytes of Cache RAM pool held
            RAMBlock*   m_blockStates;  //!< referenced structure
            XrdSysCondVar m_writeMutex;   //!< write mutex
 
@@ -154,12 +170,27 @@ namespace XrdFileCache
          //! Prefetch block.
          Task*   CreateTaskForFirstUndownloadedBlock();
 
+         //! Size of given file block.
+         long long BlockSize(int fileBlockIdx) const;
+
+         //! Get buffer from Cache RAM pool for a free RAM block, called with RAM lock held.
+         bool    ClaimRamBlock(int ramIdx, int fileBlockIdx, bool fromRead);
+
          //! Create task from read request and wait its completed.
          bool    ReadFromTask(int bIdx, char* buff, long long off, size_t size);
 
          //! Read from client into in memory cache, queue ram buffer for disk write.
          void    DoTask(Task* task);
 
+         //! Fail a task nobody will run and release its RAM block, called with queue lock held.
+         void    CancelTask(Task* task);
+
+         //! Store written data in disk file and update download status.
+         void    StoreWrite(char* buff, long long offset, int size);
+
+         //! Wait for uploads overlapping given range to complete.
+         void    WaitUploads(long long offset, long long size);
+
          //! Log path
          const char* lPath() const;
           
@@ -194,6 +225,15 @@ namespace XrdFileCache
          std::vector<int>  m_writes_during_sync;
          int               m_non_flushed_cnt;
          bool              m_in_sync;
+         XrdSysMutex       m_infoMutex;       //!< serializes writes of cinfo header
+
+         // write-through
+         XrdSysCondVar      m_uploadCond;     //!< upload state condition variable
+         std::list<Upload*> m_uploads;        //!< uploads to origin in flight
+         int                m_uploadsReserved;//!< upload slots held by writes not yet registered
+         int                m_uploadErrno;    //!< errno of first failed upload
+         bool               m_uploadsUnsynced;//!< origin has to be synced
+         std::set<int>      m_dirtyBlocks;    //!< written blocks not known to be at origin, locked with m_syncStatusMutex
    };
 }
 #endif
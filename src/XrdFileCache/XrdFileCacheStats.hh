@@ -35,12 +35,21 @@ namespace XrdFileCache
          //----------------------------------------------------------------------
          Stats() {
             m_BytesDisk = m_BytesRam = m_BytesMissed = 0;
+            m_RamPoolSize = m_RamPoolUsed = m_RamPoolPeak = m_RamPoolDenied = 0;
+            m_RamPoolFiles = 0;
          }
 
          long long m_BytesDisk;   //!< number of bytes served from disk cache
          long long m_BytesRam;    //!< number of bytes served from RAM cache
          long long m_BytesMissed; //!< number of bytes served directly from XrdCl
 
+         // RAM block pool occupancy, filled by Cache::GetRamPoolStats()
+         long long m_RamPoolSize;   //!< size of RAM block pool
+         long long m_RamPoolUsed;   //!< bytes of RAM blocks in use
+         long long m_RamPoolPeak;   //!< highest number of bytes in use
+         long long m_RamPoolDenied; //!< number of refused RAM block requests
+         int       m_RamPoolFiles;  //!< number of files holding RAM blocks
+
          inline void AddStat(Stats &Src)
          {
             XrdOucCacheStats::Add(Src);
@@ -97,6 +97,7 @@ set( XROOTD_PUBLIC_HEADERS
   XrdSys/XrdSysXAttr.hh
   XrdSys/XrdSysXSLock.hh
   XrdXrootd/XrdXrootdMonData.hh
+  XrdXrootd/XrdXrootdMonPack.hh
   XrdXrootd/XrdXrootdBridge.hh
   XrdHttp/XrdHttpSecXtractor.hh
 )
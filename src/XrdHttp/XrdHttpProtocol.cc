@@ -26,9 +26,11 @@
 #include "Xrd/XrdBuffer.hh"
 #include "Xrd/XrdLink.hh"
 #include "XProtocol/XProtocol.hh"
+#include "XrdOuc/XrdOuca2x.hh"
 #include "XrdOuc/XrdOucStream.hh"
 #include "XrdOuc/XrdOucEnv.hh"
 #include "XrdOuc/XrdOucGMap.hh"
+#include "XrdSys/XrdSysAtomics.hh"
 #include "XrdSys/XrdSysTimer.hh"
 #include "XrdOuc/XrdOucPinLoader.hh"
 
@@ -86,6 +88,11 @@ char *XrdHttpProtocol::gridmap = 0;
 XrdOucGMap *XrdHttpProtocol::servGMap = 0;  // Grid mapping service
    
 int XrdHttpProtocol::sslverifydepth = 9;
+int XrdHttpProtocol::readRsz = 8*1024*1024;
+bool XrdHttpProtocol::usektls = false;
+long long XrdHttpProtocol::ktlsTotal = 0;
+long long XrdHttpProtocol::utlsTotal = 0;
+XrdSysMutex XrdHttpProtocol::tlsStatMutex;
 SSL_CTX *XrdHttpProtocol::sslctx = 0;
 BIO *XrdHttpProtocol::sslbio_err = 0;
 XrdCryptoFactory *XrdHttpProtocol::myCryptoFactory = 0;
@@ -363,9 +370,26 @@ char *XrdHttpProtocol::GetClientIPStr() {
 #define TRACELINK Link
 
 int XrdHttpProtocol::Process(XrdLink *lp) // We ignore the argument here
+{
+  bool more;
+  int rc;
+
+  // Requests pipelined behind the one just served are processed one after
+  // the other in this loop. A client can pipeline any number of them, so
+  // we must not recurse for each one
+  do {
+    rc = ProcessReq(lp, more);
+    lp = 0;
+  } while (more);
+
+  return rc;
+}
+
+int XrdHttpProtocol::ProcessReq(XrdLink *lp, bool &more)
 {
   int rc = 0;
 
+  more = false;
   TRACEI(DEBUG, " Process. lp:" << lp << " reqstate: " << CurrentReq.reqstate);
 
   if (!myBuff || !myBuff->buff || !myBuff->bsize) {
@@ -440,6 +464,18 @@ int XrdHttpProtocol::Process(XrdLink *lp) // We ignore the argument here
 
       if (res != X509_V_OK) return -1;
       ssldone = true;
+
+#ifdef SSL_OP_ENABLE_KTLS
+      // Openssl may have handed the send keys to the kernel during the
+      // handshake. This only happens if the negotiated cipher is one that
+      // the kernel supports, otherwise we keep encrypting in user space.
+      //
+      if (usektls) {
+        ktlsTx = (BIO_get_ktls_send(SSL_get_wbio(ssl)) != 0);
+        TRACEI(DEBUG, " Kernel tls send " << (ktlsTx ? "enabled" : "not available")
+               << " for cipher " << SSL_get_cipher_name(ssl));
+      }
+#endif
     }
 
 
@@ -460,22 +496,35 @@ int XrdHttpProtocol::Process(XrdLink *lp) // We ignore the argument here
       if (BuffUsed() < ResumeBytes) return 1;
 
 
-    } else
+    } else if (CurrentReq.request != XrdHttpReq::rtUnknown) {
+      // The bridge finished a step of the current request. If we only
+      // asked for this to look for pipelined requests, then the current
+      // one is still waiting for data from the socket
+      if (pipeWait) {
+        pipeWait = false;
+        return 1;
+      }
       CurrentReq.reqstate++;
+    }
+    // Otherwise the request is over and we go for the next one, if any
   }
   DoingLogin = false;
+  pipeWait = false;
 
 
   // Read the next request header, that is, read until a double CRLF is found
 
 
   if (!CurrentReq.headerok) {
+    char *hdrline;
     
     // Read as many lines as possible into the buffer. An empty line breaks
-    while ((rc = BuffgetLine(tmpline)) > 0) {
-      TRACE(DEBUG, " rc:" << rc << " got hdr line: " << tmpline);
+    // Lines are parsed in place unless they wrap around the buffer
+    while ((rc = BuffgetLine(hdrline, tmpline)) > 0) {
+      TRACE(DEBUG, " rc:" << rc << " got hdr line: " << hdrline);
 
-      if ((rc == 2) && (tmpline[rc - 1] == '\n')) {
+      if ((rc == 2) && (hdrline[rc - 1] == '\n')) {
+        BuffputBack();
         CurrentReq.headerok = true;
         TRACE(DEBUG, " rc:" << rc << " detected header end.");
         break;
@@ -483,10 +532,11 @@ int XrdHttpProtocol::Process(XrdLink *lp) // We ignore the argument here
 
 
       if (CurrentReq.request == CurrentReq.rtUnknown)
-        CurrentReq.parseFirstLine((char *)tmpline.c_str(), rc);
+        CurrentReq.parseFirstLine(hdrline, rc);
       else
-        CurrentReq.parseLine((char *)tmpline.c_str(), rc);
+        CurrentReq.parseLine(hdrline, rc);
 
+      BuffputBack();
 
     }
 
@@ -635,6 +685,18 @@ int XrdHttpProtocol::Process(XrdLink *lp) // We ignore the argument here
   rc = CurrentReq.ProcessHTTPReq();
   if (rc < 0)
     CurrentReq.reset();
+  else if (rc > 0 && BuffUsed() > 0) {
+    // The client pipelined more requests that we already read. The socket
+    // will not tell us about them, so we must go for them ourselves: now if
+    // this request is already over, else once the bridge has completed it
+    if (CurrentReq.request == XrdHttpReq::rtUnknown) {
+      TRACEI(REQ, " Processing pipelined request.");
+      more = true;
+      return rc;
+    }
+    pipeWait = true;
+    rc = 0;
+  }
 
 
 
@@ -693,7 +755,28 @@ int XrdHttpProtocol::Stats(char *buff, int blen, int do_sync) {
   //  //
   //  return SI->Stats(buff, blen, do_sync);
 
-  return 0;
+  // Report the TLS payload bytes sent by the kernel and by openssl
+  //
+  static const char statfmt[] = "<stats id=\"http\"><tls>"
+  "<ktls>%lld</ktls><utls>%lld</utls></tls></stats>";
+  static const long long LLMax = 0x7fffffffffffffffLL;
+  long long ktls, utls;
+  int len;
+
+  // If no buffer, caller wants the maximum size we will generate
+  //
+  if (!buff) {
+    char dummy[256];
+    return snprintf(dummy, sizeof(dummy), statfmt, LLMax, LLMax);
+  }
+
+  AtomicBeg(tlsStatMutex);
+  ktls = AtomicGet(ktlsTotal);
+  utls = AtomicGet(utlsTotal);
+  AtomicEnd(tlsStatMutex);
+
+  len = snprintf(buff, blen, statfmt, ktls, utls);
+  return (len < blen ? len : 0);
 }
 
 
@@ -742,6 +825,8 @@ int XrdHttpProtocol::Config(const char *ConfigFN) {
       else if TS_Xeq("staticredir", xstaticredir);
       else if TS_Xeq("staticpreload", xstaticpreload);
       else if TS_Xeq("listingdeny", xlistdeny);
+      else if TS_Xeq("readsize", xreadsize);
+      else if TS_Xeq("ktls", xktls);
       else {
         eDest.Say("Config warning: ignoring unknown directive '", var, "'.");
         Config.Echo();
@@ -773,6 +858,35 @@ int XrdHttpProtocol::Config(const char *ConfigFN) {
 
 /******************************************************************************/
 
+/// Get a full line of text from the buffer without copying it, unless it wraps
+/// around the end of the buffer. Zero if no line can be found in the buffer
+
+int XrdHttpProtocol::BuffgetLine(char *&line, XrdOucString &dest) {
+  char *lim, *nl;
+  int l;
+
+  lineTerm = 0;
+  lim = (myBuffEnd >= myBuffStart ? myBuffEnd : myBuff->buff + myBuff->bsize);
+
+  // The terminator goes right after the newline, which must still be in the buffer
+  if (myBuffStart < lim
+      && (nl = (char *)memchr(myBuffStart, '\n', lim - myBuffStart))
+      && nl + 1 < myBuff->buff + myBuff->bsize) {
+    l = nl + 1 - myBuffStart;
+    line = myBuffStart;
+    lineTerm = nl + 1;
+    lineSave = *lineTerm;
+    *lineTerm = '\0';
+    BuffConsume(l);
+    return l;
+  }
+
+  // Wrapped or incomplete line, let the copying version deal with it
+  l = BuffgetLine(dest);
+  line = (char *)dest.c_str();
+  return l;
+}
+
 /// Copy a full line of text from the buffer into dest. Zero if no line can be found in the buffer
 
 int XrdHttpProtocol::BuffgetLine(XrdOucString &dest) {
@@ -1045,17 +1159,46 @@ int XrdHttpProtocol::SendData(char *body, int bodylen) {
 
   if (body && bodylen) {
     TRACE(REQ, "Sending " << bodylen << " bytes");
-    if (ishttps) {
+    if (ishttps && !ktlsTx) {
       r = SSL_write(ssl, body, bodylen);
       if (r <= 0) {
         ERR_print_errors(sslbio_err);
         return -1;
       }
+      utlsBytes += bodylen;
 
     } else {
       r = Link->Send(body, bodylen);
       if (r <= 0) return -1;
+      if (ktlsTx) ktlsBytes += bodylen;
+    }
+  }
+
+  return 0;
+}
+
+/// Send a set of buffers to the client. Unless openssl has to encrypt them
+/// they go out with a single writev
+
+int XrdHttpProtocol::SendData(const struct iovec *iov, int iovcnt) {
+  int bytes = 0;
+
+  for (int i = 0; i < iovcnt; i++) bytes += iov[i].iov_len;
+  if (!bytes) return 0;
+
+  TRACE(REQ, "Sending " << bytes << " bytes in " << iovcnt << " buffers");
+  if (ishttps && !ktlsTx) {
+    for (int i = 0; i < iovcnt; i++) {
+      if (iov[i].iov_len && SSL_write(ssl, iov[i].iov_base, iov[i].iov_len) <= 0) {
+        ERR_print_errors(sslbio_err);
+        return -1;
+      }
     }
+    utlsBytes += bytes;
+
+  } else {
+    if (Link->Send(iov, iovcnt, bytes) <= 0) return -1;
+    if (ktlsTx) ktlsBytes += bytes;
   }
 
   return 0;
@@ -1324,6 +1467,9 @@ int XrdHttpProtocol::InitSecurity() {
   sslctx = SSL_CTX_new((SSL_METHOD *)meth);
   SSL_CTX_set_options(sslctx, SSL_OP_NO_SSLv2);
   SSL_CTX_set_session_cache_mode(sslctx, SSL_SESS_CACHE_SERVER);
+#ifdef SSL_OP_ENABLE_KTLS
+  if (usektls) SSL_CTX_set_options(sslctx, SSL_OP_ENABLE_KTLS);
+#endif
   SSL_CTX_set_session_id_context(sslctx, s_server_session_id_context,
           s_server_session_id_context_len);
 
@@ -1429,6 +1575,19 @@ void XrdHttpProtocol::Cleanup() {
     myBuff = 0;
   }
 
+  if (ktlsBytes || utlsBytes) {
+    long long ktls, utls;
+    AtomicBeg(tlsStatMutex);
+    AtomicAdd(ktlsTotal, ktlsBytes);
+    AtomicAdd(utlsTotal, utlsBytes);
+    ktls = AtomicGet(ktlsTotal);
+    utls = AtomicGet(utlsTotal);
+    AtomicEnd(tlsStatMutex);
+    TRACE(DEBUG, " TLS bytes sent kernel:" << ktlsBytes << " user:" << utlsBytes
+          << " totals kernel:" << ktls << " user:" << utls);
+    ktlsBytes = utlsBytes = 0;
+  }
+
   if (ssl) {
     if (SSL_shutdown(ssl) != 1) {
       TRACE(ALL, " SSL_shutdown failed");
@@ -1467,6 +1626,8 @@ void XrdHttpProtocol::Reset() {
 
   ResumeBytes = 0;
   Resume = 0;
+  pipeWait = false;
+  lineTerm = 0;
 
   //
   //  numReads = 0;
@@ -1485,6 +1646,8 @@ void XrdHttpProtocol::Reset() {
 
   ishttps = false;
   ssldone = false;
+  ktlsTx = false;
+  ktlsBytes = utlsBytes = 0;
 
   Bridge = 0;
   ssl = 0;
@@ -1534,6 +1697,85 @@ int XrdHttpProtocol::xsslverifydepth(XrdOucStream & Config) {
   return 0;
 }
 
+/******************************************************************************/
+/*                               x r e a d s i z e                            */
+/******************************************************************************/
+
+/* Function: xreadsize
+
+   Purpose:  To parse the directive: readsize <bytes>
+
+             <bytes>  the maximum number of bytes requested from the file in
+                      a single read while serving a GET. Larger reads need
+                      fewer bridge round trips and, for plain http, are sent
+                      with sendfile. A GET has only one read outstanding at a
+                      time. The default is 8m.
+
+  Output: 0 upon success or !0 upon failure.
+ */
+
+int XrdHttpProtocol::xreadsize(XrdOucStream & Config) {
+  char *val;
+  long long rsz;
+
+  // Get the val
+  //
+  val = Config.GetWord();
+  if (!val || !val[0]) {
+    eDest.Emsg("Config", "readsize value not specified");
+    return 1;
+  }
+
+  // Record the val
+  //
+  if (XrdOuca2x::a2sz(eDest, "readsize value", val, &rsz, 64*1024, 1024*1024*1024))
+    return 1;
+  readRsz = static_cast<int>(rsz);
+
+  return 0;
+}
+
+/******************************************************************************/
+/*                                   x k t l s                                */
+/******************************************************************************/
+
+/* Function: xktls
+
+   Purpose:  To parse the directive: ktls <yes|no|0|1>
+
+             <val>    when true, https links whose cipher is supported by the
+                      kernel have their send path encrypted by the kernel so
+                      that responses go out through plain writes and sendfile.
+                      Other links keep using openssl. The default is no.
+
+   Output: 0 upon success or !0 upon failure.
+ */
+
+int XrdHttpProtocol::xktls(XrdOucStream & Config) {
+  char *val;
+
+  // Get the flag
+  //
+  val = Config.GetWord();
+  if (!val || !val[0]) {
+    eDest.Emsg("Config", "ktls flag not specified");
+    return 1;
+  }
+
+  // Record the value
+  //
+  usektls = (!strcasecmp(val, "true") || !strcasecmp(val, "yes") || !strcmp(val, "1"));
+
+#ifndef SSL_OP_ENABLE_KTLS
+  if (usektls) {
+    eDest.Say("Config warning: kernel tls not supported by this openssl; ktls ignored.");
+    usektls = false;
+  }
+#endif
+
+  return 0;
+}
+
 /******************************************************************************/
 /*                                 x s s l c e r t                            */
 /******************************************************************************/
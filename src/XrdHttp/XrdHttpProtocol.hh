@@ -134,6 +134,9 @@ private:
   /// Send some generic data to the client
   int SendData(char *body, int bodylen);
 
+  /// Send a set of buffers to the client, in one gathered write when possible
+  int SendData(const struct iovec *iov, int iovcnt);
+
   /// Deallocate resources, in order to reutilize an object of this class
   void Cleanup();
 
@@ -167,6 +170,8 @@ private:
   static int xsslcafile(XrdOucStream &Config);
   static int xsslverifydepth(XrdOucStream &Config);
   static int xsecretkey(XrdOucStream &Config);
+  static int xreadsize(XrdOucStream &Config);
+  static int xktls(XrdOucStream &Config);
 
   static XrdHttpSecXtractor *secxtractor;
   // Loads the SecXtractor plugin, if available
@@ -194,6 +199,15 @@ private:
   int BuffgetData(int blen, char **data, bool wait);
   /// Copy a full line of text from the buffer into dest. Zero if no line can be found in the buffer
   int BuffgetLine(XrdOucString &dest);
+  /// Get a full line of text, null terminated in place if it is contiguous in the buffer,
+  /// else copied into dest. BuffputBack() must be called once the line has been parsed
+  int BuffgetLine(char *&line, XrdOucString &dest);
+  /// Restore the byte overwritten by the null terminator of the last in place line
+  void BuffputBack() {if (lineTerm) {*lineTerm = lineSave; lineTerm = 0;}}
+  
+  /// Where the last in place line was terminated and the byte that was there
+  char *lineTerm;
+  char lineSave;
 
   
   /// Gets a string that represents the IP address of the client. Must be freed
@@ -204,6 +218,14 @@ private:
   
   /// Tells that we are just waiting to have N bytes in the buffer
   long ResumeBytes;
+
+  /// Tells that we asked the bridge to reinvoke us only to pick up pipelined
+  /// requests that are already sitting in our buffer
+  bool pipeWait;
+
+  /// Process one request. Sets more when a pipelined request that follows it
+  /// is already in the buffer and can be processed right away
+  int ProcessReq(XrdLink *lp, bool &more);
   
   /// Global, static SSL context
   static SSL_CTX *sslctx;
@@ -224,6 +246,18 @@ private:
   /// connection being established
   bool ssldone;
 
+  /// True if the kernel encrypts what we send on this link (kernel TLS), in
+  /// which case plain socket writes and sendfile can be used
+  bool ktlsTx;
+
+  /// Bytes of payload sent on this link encrypted by the kernel or by openssl
+  long long ktlsBytes, utlsBytes;
+
+  /// The same totals over all the links, updated at cleanup time and
+  /// reported by Stats()
+  static long long ktlsTotal, utlsTotal;
+  static XrdSysMutex tlsStatMutex;
+
   static XrdCryptoFactory *myCryptoFactory;
 protected:
 
@@ -304,6 +338,12 @@ protected:
   /// Depth of verification of a certificate chain
   static int sslverifydepth;
 
+  /// Max number of bytes asked to the bridge in a single GET read
+  static int readRsz;
+
+  /// If true, try to hand the TLS send path to the kernel after the handshake
+  static bool usektls;
+
   /// True if the redirections must be towards https targets
   static bool isdesthttps;
   
@@ -407,27 +407,41 @@ int XrdHttpReq::ReqReadV() {
 
 
   kXR_int64 total_len = 0;
-  rwOpPartialDone = 0;
   // Now we build the protocol-ready read ahead list
   //  and also put the correct placeholders inside the cache
+  // Segments that are adjacent in the file are coalesced into one, and
+  // no more than READV_MAXCHUNKS segments go into a single readv. What
+  // does not fit is asked in the next one.
   int n = rwOps_split.size();
   if (!ralist) ralist = (readahead_list *) malloc(n * sizeof (readahead_list));
 
-  int j = 0;
-  for (int i = 0; i < n; i++) {
+  int i, j = 0;
+  for (i = rwOpSplitDone; i < n; i++) {
 
     // We can suppose that we know the length of the file
     // Hence we can sort out requests that are out of boundary or trim them
     if (rwOps_split[i].bytestart > filesize) continue;
     if (rwOps_split[i].byteend > filesize - 1) rwOps_split[i].byteend = filesize - 1;
 
+    long long len = rwOps_split[i].byteend - rwOps_split[i].bytestart + 1;
+
+    if (j > 0 && ralist[j-1].offset + ralist[j-1].rlen == rwOps_split[i].bytestart
+        && ralist[j-1].rlen + len <= READV_MAXCHUNKSIZE) {
+      ralist[j-1].rlen += len;
+      total_len += len;
+      continue;
+    }
+
+    if (j >= READV_MAXCHUNKS) break;
+
     memcpy(&(ralist[j].fhandle), this->fhandle, 4);
 
     ralist[j].offset = rwOps_split[i].bytestart;
-    ralist[j].rlen = rwOps_split[i].byteend - rwOps_split[i].bytestart + 1;
+    ralist[j].rlen = len;
     total_len += ralist[j].rlen;
     j++;
   }
+  rwOpSplitDone = i;
 
   if (j > 0) {
 
@@ -496,6 +510,7 @@ int XrdHttpReq::File(XrdXrootd::Bridge::Context &info, //!< the result context
   TRACE(REQ, " XrdHttpReq::File dlen:" << dlen << " send rc:" << rc);
   if (rc) return false;
   writtenbytes += dlen;
+  if (prot->ktlsTx) prot->ktlsBytes += dlen;
   
     
   return true;
@@ -829,9 +844,9 @@ int XrdHttpReq::ProcessHTTPReq() {
         default: // Read() or Close()
         {
 
-	  if ( ((reqstate == 3) && (rwOps.size() > 1)) ||
+	  if ( ((rwOps.size() > 1) && (rwOpSplitDone >= rwOps_split.size())) ||
 	      (writtenbytes >= filesize) ) {
-	    // Close() if this was a readv or we have finished, otherwise read the next chunk
+	    // Close() if all the readv batches were done or we have finished, otherwise read the next chunk
  	  
 	      // --------- CLOSE
 	      memset(&xrdreq, 0, sizeof (ClientRequest));
@@ -850,7 +865,10 @@ int XrdHttpReq::ProcessHTTPReq() {
 	  
           if (rwOps.size() <= 1) {
             // No chunks or one chunk... Request the whole file or single read
-	    // 
+	    //
+	    // The bridge runs a single request at a time, so only one read is
+	    // ever outstanding here. Reads are neither pipelined nor double
+	    // buffered; GETs gain only from fewer, larger reads and sendfile.
 	    long l;
             // --------- READ
             memset(&xrdreq, 0, sizeof (xrdreq));
@@ -859,20 +877,21 @@ int XrdHttpReq::ProcessHTTPReq() {
             xrdreq.read.dlen = 0;
 	    
             if (rwOps.size() == 0) {
-	      l = (long)min(filesize-writtenbytes, (long long)1024*1024);
+	      l = (long)min(filesize-writtenbytes, (long long)XrdHttpProtocol::readRsz);
               xrdreq.read.offset = htonll(writtenbytes);
               xrdreq.read.rlen = htonl(l);
             } else {
-	      l = min(rwOps[0].byteend - rwOps[0].bytestart + 1 - writtenbytes, (long long)1024*1024);
+	      l = min(rwOps[0].byteend - rwOps[0].bytestart + 1 - writtenbytes, (long long)XrdHttpProtocol::readRsz);
               xrdreq.read.offset = htonll(rwOps[0].bytestart + writtenbytes);
               xrdreq.read.rlen = htonl(l);
             }
 
-	    if (prot->ishttps) {
-              if (!prot->Bridge->setSF((kXR_char *) fhandle, false)) {
-                TRACE(REQ, " XrdBridge::SetSF(false) failed.");
-
-              }
+	    // Plain http and https with kernel tls can have the data spliced
+	    // straight from the file to the socket, otherwise it must go
+	    // through the ssl layer
+	    bool usesf = !prot->ishttps || prot->ktlsTx;
+	    if (prot->Bridge->setSF((kXR_char *) fhandle, usesf)) {
+              TRACE(REQ, " XrdBridge::SetSF(" << usesf << ") failed.");
             }
 
             if (l <= 0) {
@@ -956,16 +975,18 @@ int XrdHttpReq::ProcessHTTPReq() {
           memcpy(xrdreq.write.fhandle, fhandle, 4);
 
 
+          // Never write past the body, what follows may be a pipelined request
+          long long wlen = min((long long)prot->BuffUsed(), length - writtenbytes);
           xrdreq.write.offset = htonll(writtenbytes);
-          xrdreq.write.dlen = htonl(prot->BuffUsed());
+          xrdreq.write.dlen = htonl(wlen);
 
-          TRACEI(REQ, "Writing " << prot->BuffUsed());
-          if (!prot->Bridge->Run((char *) &xrdreq, prot->myBuffStart, prot->BuffUsed())) {
+          TRACEI(REQ, "Writing " << wlen);
+          if (!prot->Bridge->Run((char *) &xrdreq, prot->myBuffStart, wlen)) {
             prot->SendSimpleResp(404, NULL, NULL, (char *) "Could not run write request.", 0);
             return -1;
           }
 
-          if (writtenbytes + prot->BuffUsed() >= length)
+          if (writtenbytes + wlen >= length)
             // Trigger an immediate recall after this request has finished
             return 0;
           else
@@ -1567,20 +1588,29 @@ int XrdHttpReq::PostProcessHTTPReq(bool final_) {
               return -1;
             }
           }
-          default: //read or readv
+          default: //read, readv or close
           {
-	    // Close() if this was the third state of a readv, otherwise read the next chunk
-	    if ((reqstate == 3) && (ntohs(xrdreq.header.requestid) == kXR_readv)) return 1;
-	    
             // If we are here it's too late to send a proper error message...
             if (xrdresp == kXR_error) return -1;
 
+            // The file was closed, the request is over. Say so, otherwise a
+            // following request on this link would resume this one
+            if (ntohs(xrdreq.header.requestid) == kXR_close) return 1;
+
             TRACEI(REQ, "Got data vectors to send:" << iovN);
             if (ntohs(xrdreq.header.requestid) == kXR_readv) {
               // Readv case, we must take out each individual header and format it according to the http rules
+              // The part headers and the data are gathered and sent together, without copying the data
+              static const int sendVMax = 256;
+              struct iovec sendV[sendVMax];
+              std::vector<std::string> hdrs;
+              int sendN = 0;
               readahead_list *l;
               char *p;
-              int len;
+              long long len, n;
+
+              // The headers must not move while they are referenced by sendV
+              hdrs.reserve(sendVMax);
 
               // Cycle on all the data that is coming from the server
               for (int i = 0; i < iovN; i++) {
@@ -1588,41 +1618,73 @@ int XrdHttpReq::PostProcessHTTPReq(bool final_) {
                 for (p = (char *) iovP[i].iov_base; p < (char *) iovP[i].iov_base + iovP[i].iov_len;) {
                   l = (readahead_list *) p;
                   len = ntohl(l->rlen);
+                  p += sizeof (readahead_list);
 
                   // Now we have a chunk coming from the server. This may be a partial chunk
+                  // or, if adjacent ranges were coalesced, it may span several of them
+                  while (len > 0 && rwOpDone < rwOps.size()) {
+                    if (rwOps[rwOpDone].bytestart > filesize) {
+                      rwOpDone++;
+                      continue;
+                    }
 
-                  if (rwOpPartialDone == 0) {
-                    string s = buildPartialHdr(rwOps[rwOpDone].bytestart,
-                            rwOps[rwOpDone].byteend,
-                            filesize,
-                            (char *) "123456");
+                    if (sendN > sendVMax - 2) {
+                      if (prot->SendData(sendV, sendN)) return -1;
+                      sendN = 0;
+                      hdrs.clear();
+                    }
 
-                    TRACEI(REQ, "Sending multipart: " << rwOps[rwOpDone].bytestart << "-" << rwOps[rwOpDone].byteend);
-                    if (prot->SendData((char *) s.c_str(), s.size())) return -1;
-                  }
+                    if (rwOpPartialDone == 0) {
+                      hdrs.push_back(buildPartialHdr(rwOps[rwOpDone].bytestart,
+                              rwOps[rwOpDone].byteend,
+                              filesize,
+                              (char *) "123456"));
 
-                  // Send all the data we have
-                  if (prot->SendData(p + sizeof (readahead_list), len)) return -1;
+                      TRACEI(REQ, "Sending multipart: " << rwOps[rwOpDone].bytestart << "-" << rwOps[rwOpDone].byteend);
+                      sendV[sendN].iov_base = (char *) hdrs.back().c_str();
+                      sendV[sendN].iov_len = hdrs.back().size();
+                      sendN++;
+                    }
 
-                  // If we sent all the data relative to the current original chunk request
-                  // then pass to the next chunk, otherwise wait for more data
-                  rwOpPartialDone += len;
-                  if (rwOpPartialDone >= rwOps[rwOpDone].byteend - rwOps[rwOpDone].bytestart + 1) {
-                    rwOpDone++;
-                    rwOpPartialDone = 0;
+                    // Send the data relative to the current original chunk request
+                    n = min(len, rwOps[rwOpDone].byteend - rwOps[rwOpDone].bytestart + 1 - rwOpPartialDone);
+                    sendV[sendN].iov_base = p;
+                    sendV[sendN].iov_len = n;
+                    sendN++;
+                    p += n;
+                    len -= n;
+
+                    // If we sent all the data relative to the current original chunk request
+                    // then pass to the next chunk, otherwise wait for more data
+                    rwOpPartialDone += n;
+                    if (rwOpPartialDone >= rwOps[rwOpDone].byteend - rwOps[rwOpDone].bytestart + 1) {
+                      rwOpDone++;
+                      rwOpPartialDone = 0;
+                    }
                   }
 
-                  p += sizeof (readahead_list);
                   p += len;
 
                 }
               }
 
+              while (rwOpDone < rwOps.size() && rwOps[rwOpDone].bytestart > filesize)
+                rwOpDone++;
+
               if (rwOpDone == rwOps.size()) {
-                string s = buildPartialHdrEnd((char *) "123456");
-                if (prot->SendData((char *) s.c_str(), s.size())) return -1;
+                if (sendN >= sendVMax) {
+                  if (prot->SendData(sendV, sendN)) return -1;
+                  sendN = 0;
+                  hdrs.clear();
+                }
+                hdrs.push_back(buildPartialHdrEnd((char *) "123456"));
+                sendV[sendN].iov_base = (char *) hdrs.back().c_str();
+                sendV[sendN].iov_len = hdrs.back().size();
+                sendN++;
               }
 
+              if (prot->SendData(sendV, sendN)) return -1;
+
             } else
               for (int i = 0; i < iovN; i++) {
 		if (prot->SendData((char *) iovP[i].iov_base, iovP[i].iov_len)) return -1;
@@ -2018,6 +2080,7 @@ void XrdHttpReq::reset() {
   rwOps_split.clear();
   rwOpDone = 0;
   rwOpPartialDone = 0;
+  rwOpSplitDone = 0;
   writtenbytes = 0;
   etext.clear();
   redirdest = "";
@@ -193,6 +193,9 @@ public:
   /// To coordinate multipart responses across multiple calls
   unsigned int rwOpDone, rwOpPartialDone;
 
+  /// How many entries of rwOps_split have already been asked to the bridge
+  unsigned int rwOpSplitDone;
+
   /// The last issued xrd request, often pending
   ClientRequest xrdreq;
 
@@ -112,6 +112,52 @@ int XrdNetMsg::Send(const struct iovec iov[], int iovcnt,
    return Send(buff, (int)(bp-buff), dest, -1);
 }
   
+/******************************************************************************/
+/*                             S e n d B a t c h                              */
+/******************************************************************************/
+  
+int XrdNetMsg::SendBatch(const struct iovec msgv[], int msgc, int tmo)
+{
+   int i, retc;
+
+   if (!destOK)
+      {eDest->Emsg("Msg", "Destination not specified."); return -1;}
+
+   if (tmo >= 0 && !OK2Send(tmo, dfltDest.Name("unknown"))) return 1;
+
+#ifdef HAVE_SENDMMSG
+   static const int mmMax = 64;
+   struct mmsghdr mmVec[mmMax];
+   int n, done = 0;
+
+// Send the messages in chunks using as few system calls as possible. The
+// kernel may accept fewer than we offer, in which case we simply go again.
+//
+   while(done < msgc)
+        {n = (msgc - done > mmMax ? mmMax : msgc - done);
+         memset(mmVec, 0, n*sizeof(struct mmsghdr));
+         for (i = 0; i < n; i++)
+             {mmVec[i].msg_hdr.msg_name    = (void *)dfltDest.SockAddr();
+              mmVec[i].msg_hdr.msg_namelen = dfltDest.SockSize();
+              mmVec[i].msg_hdr.msg_iov     = (struct iovec *)&msgv[done+i];
+              mmVec[i].msg_hdr.msg_iovlen  = 1;
+             }
+         do {retc = sendmmsg(FD, mmVec, n, 0);}
+            while(retc < 0 && errno == EINTR);
+         if (retc <= 0) return retErr((retc ? errno : EAGAIN), &dfltDest);
+         done += retc;
+        }
+#else
+   for (i = 0; i < msgc; i++)
+       {if (!msgv[i].iov_len) continue;
+        if ((retc = Send((const char *)msgv[i].iov_base,
+                         (int)msgv[i].iov_len, 0, -1))) return retc;
+       }
+#endif
+
+   return 0;
+}
+  
 /******************************************************************************/
 /*                       P r i v a t e   M e t h o d s                        */
 /******************************************************************************/
@@ -88,6 +88,24 @@ int           Send(const struct  iovec iov[], // Remaining parms as above
                    const char   *dest=0,      // Hostname to send UDP datagram
                          int     tmo=-1);     // Timeout in ms (-1 = none)
 //------------------------------------------------------------------------------
+//! Send a batch of UDP messages to the default endpoint. Each element of the
+//! vector is sent as a separate datagram. Where the platform supports it the
+//! whole batch is handed to the kernel using as few system calls as possible.
+//!
+//! @param  msgv     The vector of messages, one datagram per element.
+//! @param  msgc     The number of elements in the vector.
+//! @param  timeout  maximum seconds to wait for a idle socket. When negative,
+//!                  the default, no time limit applies.
+//! @return <0       Some messages not sent due to error.
+//! @return =0       All messages sent (well as defined by UDP)
+//! @return >0       Some messages not sent, timeout occured.
+//------------------------------------------------------------------------------
+
+int           SendBatch(const struct iovec msgv[], // Messages to send
+                              int          msgc,   // Number of messages
+                              int          tmo=-1);// Timeout in ms (-1 = none)
+
+//------------------------------------------------------------------------------
 //! Constructor
 //!
 //! @param  erp      The error message object for routing error messages.
@@ -103,24 +103,27 @@ int          Hits;       // Number of times wanted data was in the cache
 int          Miss;       // Number of times wanted data was *not* in the cache
 int          HitsPR;     // Number of pages wanted data was just preread
 int          MissPR;     // Number of pages wanted data was just    read
+int          WastePR;    // Number of pages preread but never referenced
 
 inline void Get(XrdOucCacheStats &Dst)
                {sMutex.Lock();
-                Dst.BytesRead   = BytesPead;  Dst.BytesGet    = BytesRead;
-                Dst.BytesPass   = BytesPass;
+                Dst.BytesPead   = BytesPead;  Dst.BytesRead   = BytesRead;
+                Dst.BytesGet    = BytesGet;   Dst.BytesPass   = BytesPass;
                 Dst.BytesWrite  = BytesWrite; Dst.BytesPut    = BytesPut;
                 Dst.Hits        = Hits;       Dst.Miss        = Miss;
                 Dst.HitsPR      = HitsPR;     Dst.MissPR      = MissPR;
+                Dst.WastePR     = WastePR;
                 sMutex.UnLock();
                }
 
 inline void Add(XrdOucCacheStats &Src)
                {sMutex.Lock();
-                BytesRead  += Src.BytesPead;  BytesGet   += Src.BytesRead;
-                BytesPass  += Src.BytesPass;
+                BytesPead  += Src.BytesPead;  BytesRead  += Src.BytesRead;
+                BytesGet   += Src.BytesGet;   BytesPass  += Src.BytesPass;
                 BytesWrite += Src.BytesWrite; BytesPut   += Src.BytesPut;
                 Hits       += Src.Hits;       Miss       += Src.Miss;
                 HitsPR     += Src.HitsPR;     MissPR     += Src.MissPR;
+                WastePR    += Src.WastePR;
                 sMutex.UnLock();
                }
 
@@ -133,7 +136,7 @@ inline void  UnLock() {sMutex.UnLock();}
              XrdOucCacheStats() : BytesPead(0), BytesRead(0),  BytesGet(0),
                                   BytesPass(0), BytesWrite(0), BytesPut(0),
                                   Hits(0),      Miss(0),
-                                  HitsPR(0),    MissPR(0) {}
+                                  HitsPR(0),    MissPR(0),    WastePR(0) {}
             ~XrdOucCacheStats() {}
 private:
 XrdSysMutex sMutex;
@@ -376,6 +379,9 @@ canPreRead   = 0x0040; // Enable pre-read operations (o/w ignored)
 static const int
 logStats     = 0x0080; // Display statistics upon detach
 
+static const int
+hugePages    = 0x0100; // Allocate cache memory from huge pages when possible
+
 static const int
 Serialized   = 0x0004; // Caller ensures MRSW semantics
 
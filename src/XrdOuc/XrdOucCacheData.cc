@@ -37,6 +37,7 @@
 
 #include "XrdOuc/XrdOucCacheData.hh"
 #include "XrdSys/XrdSysHeaders.hh"
+#include "XrdSys/XrdSysTimer.hh"
 
 /******************************************************************************/
 /*                        X r d O u c C a c h e Z I O                         */
@@ -89,6 +90,11 @@ XrdOucCacheData::XrdOucCacheData(XrdOucCacheReal *cP, XrdOucCacheIO *ioP,
    memset(prOpt,  0, sizeof(prOpt));
 
    prNSS      =-1;
+   prLast     =-1;
+   prStride   = 0;
+   prSeen     = 0;
+   prBW       = 0;
+   prWMax     = Cache->SegCnt/16;
    prRRNow    = 0;
    prStop     = 0;
    prNext     = prFree = 0;
@@ -115,6 +121,74 @@ XrdOucCacheData::XrdOucCacheData(XrdOucCacheReal *cP, XrdOucCacheIO *ioP,
                 rPLock = pPLock = wPLock = &rwLock;
 }
   
+/******************************************************************************/
+/*                                A u t o P R                                 */
+/******************************************************************************/
+
+void XrdOucCacheData::AutoPR(long long segBeg, long long segEnd, int rLen)
+{
+   long long segLo, segHi, segMax = XrdOucCacheReal::MaxFO >> SegShft;
+   long long rSegs = segEnd - segBeg, theStride;
+   int pWin, n;
+
+// Until a pattern emerges we simply preread whatever follows this read
+//
+   DMutex.Lock();
+   if (!prSeen || !prStride)
+      {DMutex.UnLock();
+       QueuePR(segEnd, rLen, prLRU, 1);
+       return;
+      }
+
+// The window is what the source delivered in the last 1/prLead seconds
+//
+   pWin = prBW/prLead/SegSize;
+   if (pWin > prWMax)       pWin = prWMax;
+   if (pWin < Apr.minPages) pWin = Apr.minPages;
+   if (pWin < 1)            pWin = 1;
+   theStride = prStride;
+
+// For a reverse scan preread the window below this read. For a sequential
+// scan preread the window above it. In either case we only queue more once
+// less than half of the window is left so that prereads are not fragmented.
+//
+   if (theStride < 0)
+      {segHi = (prNSS >= 0 && prNSS < segBeg ? prNSS : segBeg);
+       segLo = (segBeg > pWin ? segBeg - pWin : 0);
+       if (segHi - segLo > pWin/2) prNSS = segLo;
+          else segHi = segLo;
+      } else if (theStride <= rSegs)
+      {segLo = (prNSS > segEnd && prNSS <= segEnd+pWin ? prNSS : segEnd);
+       segHi = segEnd + pWin;
+       if (segHi > segMax) segHi = segMax;
+       if (segHi - segLo > pWin/2) prNSS = segHi;
+          else segHi = segLo;
+      } else {
+
+// For a strided scan preread as many of the next strides as fit the window,
+// skipping those that were already queued.
+//
+       if ((n = pWin/rSegs) >= prMax) n = prMax-1;
+          else if (n < 1) n = 1;
+       segLo = segBeg + theStride;
+       segHi = segBeg + theStride*(n+1);
+       if (prNSS > segLo && prNSS < segHi && !((prNSS-segBeg) % theStride))
+          segLo = prNSS;
+       prNSS = segHi;
+       DMutex.UnLock();
+       while(segLo < segHi && segLo < segMax)
+            {QueuePR(segLo, rSegs*SegSize, prLRU, 1);
+             segLo += theStride;
+            }
+       return;
+      }
+   DMutex.UnLock();
+
+// Queue the contiguous preread, if any
+//
+   if (segHi > segLo) QueuePR(segLo, (segHi-segLo)*SegSize, prLRU, 1);
+}
+
 /******************************************************************************/
 /*                                D e t a c h                                 */
 /******************************************************************************/
@@ -152,14 +226,15 @@ XrdOucCacheIO *XrdOucCacheData::Detach()
           {char sBuff[2048];
            sprintf(sBuff, "Cache: Stats: %lld Read; %lld Get; %lld Pass; "
                           "%lld Write; %lld Put; %d Hits; %d Miss; "
-                          "%lld pead; %d HitsPR; %d MissPR; Path %s\n",
+                          "%lld pead; %d HitsPR; %d MissPR; %d WastePR; "
+                          "Path %s\n",
                           Statistics.BytesRead, Statistics.BytesGet,
                           Statistics.BytesPass, Statistics.BytesWrite,
                           Statistics.BytesPut,
                           Statistics.Hits,      Statistics.Miss,
                           Statistics.BytesPead,
                           Statistics.HitsPR,    Statistics.MissPR,
-                          ioObj->Path());
+                          Statistics.WastePR,   ioObj->Path());
            cerr <<sBuff;
           }
        if (isADB) {delete ioObj; RetVal = 0;}
@@ -175,7 +250,9 @@ XrdOucCacheIO *XrdOucCacheData::Detach()
 void XrdOucCacheData::Preread()
 {
    MrSw EnforceMrSw(pPLock, pPLopt);
-   long long segBeg, segEnd;
+   XrdSysTimer prTime;
+   struct timeval prDur;
+   long long segBeg, segEnd, prUsec;
    int       oVal, pVal, rLen, noIO, bPead = 0, prPages = 0;
    char *cBuff;
 
@@ -204,6 +281,7 @@ do{if ((oVal = prOpt[prNext]))
        oVal = (oVal == prSUSE ? XrdOucCacheSlot::isSUSE : 0)
             | XrdOucCacheSlot::isNew;
        segBeg |= VNum; segEnd |= VNum;
+       prTime.Reset(); bPead = prPages = 0; prUsec = 0;
        do {if ((cBuff = Cache->Get(ioObj, segBeg, rLen, noIO)))
               {if (noIO)  pVal = 0;
                   else   {pVal = oVal; bPead += rLen; prPages++;}
@@ -216,8 +294,14 @@ do{if ((oVal = prOpt[prNext]))
            Statistics.BytesPead += bPead;
            Statistics.MissPR    += prPages;
            Statistics.UnLock();
+           prDur.tv_sec = prDur.tv_usec = 0; prTime.Report(prDur);
+           prUsec = prDur.tv_sec*1000000LL + prDur.tv_usec;
           }
        DMutex.Lock();
+       if (bPead && prUsec > 0)
+          {long long nowBW = bPead*1000000LL/prUsec;
+           prBW = (prBW ? (prBW*3 + nowBW)/4 : nowBW);
+          }
       }
    } while(oVal);
 
@@ -359,7 +443,7 @@ int XrdOucCacheData::Read(char *Buff, long long Offs, int rLen)
    MrSw EnforceMrSw(rPLock, rPLopt);
    XrdOucCacheStats Now;
    char *cBuff, *Dest = Buff;
-   long long segOff, segNum = (Offs >> SegShft);
+   long long segOff, segNum = (Offs >> SegShft), segBeg = segNum;
    int noIO, rAmt, rGot, doPR = prAuto, rLeft = rLen;
 
 // Verify read length and offset
@@ -393,6 +477,12 @@ int XrdOucCacheData::Read(char *Buff, long long Offs, int rLen)
           {DMutex.Lock();
            prRR[prRRNow] = segNum;
            prRRNow = (prRRNow+1)%prRRMax;
+           if (prLast >= 0 && segNum - prLast == prStride)
+              {if (prSeen < 2) prSeen++;}
+              else {prStride = (prLast >= 0 ? segNum - prLast : 0);
+                    prSeen = 0; prNSS = -1;
+                   }
+           prLast = segNum;
            DMutex.UnLock();
           }
       }
@@ -428,7 +518,7 @@ int XrdOucCacheData::Read(char *Buff, long long Offs, int rLen)
 //
    if (doPR && cBuff)
       {EnforceMrSw.UnLock();
-       QueuePR(segNum, rLen, prLRU, 1);
+       AutoPR(segBeg, segNum & XrdOucCacheReal::Strip, rLen);
       }
 
 // All done, if we ended fine, return amount read. If there is no page buffer
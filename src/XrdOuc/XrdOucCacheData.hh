@@ -76,6 +76,7 @@ int            Write(char  *Buffer, long long  Offset,  int  Length);
 
 private:
               ~XrdOucCacheData() {}
+void           AutoPR(long long segBeg, long long segEnd, int rLen);
 void           QueuePR(long long SegOffs, int rLen, int prHow, int isAuto=0);
 int            Read (XrdOucCacheStats &Now,
                       char *Buffer, long long Offs, int Length);
@@ -126,7 +127,10 @@ static const int xqRW   = 2;
 XrdOucCacheReal::prTask prReq;
 XrdSysSemaphore *prStop;
 
-long long        prNSS;          // Next Sequential Segment for maxi prereads
+long long        prNSS;          // Next segment not yet queued for preread
+long long        prLast;         // First segment of the last auto preread read
+long long        prStride;       // Segment distance between the last two reads
+long long        prBW;           // Observed preread bandwidth in bytes/second
 
 static const int prRRMax= 5;
 long long        prRR[prRRMax];  // Recent reads
@@ -140,6 +144,8 @@ static const int prLRU  = 1;     // Status in prOpt    (set LRU)
 static const int prSUSE = 2;     // Status in prOpt    (set Single Use)
 static const int prSKIP = 3;     // Status in prOpt    (skip entry)
 
+static const int prLead = 10;    // Window holds 1/prLead seconds of prereads
+
 aprParms         Apr;
 long long        prCalc;
 long long        prBeg[prMax];
@@ -147,9 +153,11 @@ long long        prEnd[prMax];
 int              prNext;
 int              prFree;
 int              prPerf;
+int              prWMax;         // Largest preread window in pages
 char             prOpt[prMax];
 char             prOK;
 char             prActive;
 char             prAuto;
+char             prSeen;         // Times in a row prStride was seen
 };
 #endif
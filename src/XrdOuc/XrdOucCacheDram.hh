@@ -121,10 +121,9 @@ int            isAttached() {return 0;}
 */
 XrdOucCache   *Create(Parms &Params, XrdOucCacheIO::aprParms *aprP=0);
 
-/* The following holds statistics for the cache itself. It is updated as
-   associated cacheIO objects are deleted and their statistics are added.
+/* Statistics for the cache itself are kept in XrdOucCache::Stats. They are
+   updated as associated cacheIO objects are deleted.
 */
-XrdOucCacheStats Stats;
 
                XrdOucCacheDram() {}
 virtual       ~XrdOucCacheDram() {}
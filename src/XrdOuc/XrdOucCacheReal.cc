@@ -44,6 +44,8 @@
 #define MAP_ANONYMOUS MAP_ANON
 #endif
 #endif
+
+namespace {const size_t hugeSize = 2*1024*1024;} // Usual huge page size
   
 /******************************************************************************/
 /*                           C o n s t r u c t o r                            */
@@ -57,7 +59,8 @@ void *XrdOucCacheRealPRXeq(void *parg)
   
 XrdOucCacheReal::XrdOucCacheReal(int &rc, XrdOucCache::Parms      &ParmV,
                                           XrdOucCacheIO::aprParms *aprP)
-                : Slots(0), Slash(0), Base((char *)MAP_FAILED), Dbg(0), Lgs(0),
+                : Slots(0), Slash(0), Base((char *)MAP_FAILED), BaseLen(0),
+                  Dbg(0), Lgs(0),
                   AZero(0), Attached(0), prFirst(0), prLast(0),
                   prReady(0), prStop(0), prNum(0)
 {
@@ -97,19 +100,42 @@ XrdOucCacheReal::XrdOucCacheReal(int &rc, XrdOucCache::Parms      &ParmV,
       else maxCache = ParmV.Max2Cache/SegSize*SegSize;
    SegFull = (Options & isServer ? XrdOucCacheSlot::lenMask : SegSize);
 
-// Allocate the cache plus the cache hash table
+// Split the cache into stripes, each one having atleast 256 slots
+//
+   nStripe = SegCnt/256;
+   if (nStripe > maxStripe) nStripe = maxStripe;
+      else if (nStripe < 1) nStripe = 1;
+
+// Allocate the cache plus the cache hash table. When asked, we first try to
+// get huge pages and, failing that, ask that the area be backed by them.
 //
    Bytes = static_cast<size_t>(SegSize)*SegCnt;
-   Base = (char *)mmap(0, Bytes + SegCnt*sizeof(int), PROT_READ|PROT_WRITE,
-                       MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
-   if (Base == MAP_FAILED) {rc = errno; return;}
+   BaseLen = Bytes + SegCnt*sizeof(int);
+#ifdef MAP_HUGETLB
+   if (Options & hugePages)
+      {size_t hLen = (BaseLen + hugeSize - 1) & ~(hugeSize - 1);
+       Base = (char *)mmap(0, hLen, PROT_READ|PROT_WRITE,
+                           MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB, -1, 0);
+       if (Base != MAP_FAILED) BaseLen = hLen;
+      }
+#endif
+   if (Base == MAP_FAILED)
+      {Base = (char *)mmap(0, BaseLen, PROT_READ|PROT_WRITE,
+                           MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+       if (Base == MAP_FAILED) {rc = errno; return;}
+#ifdef MADV_HUGEPAGE
+       if (Options & hugePages) madvise(Base, BaseLen, MADV_HUGEPAGE);
+#endif
+      }
    Slash = (int *)(Base + Bytes); HNum = SegCnt/2*2-1;
 
 // Now allocate the actual slots. We add additional slots to map files. These
 // do not have any memory backing but serve as anchors for memory mappings.
+// The stripe LRU anchors follow the file slots.
 //
-   if (!(Slots = new XrdOucCacheSlot[SegCnt+maxFiles])) return;
-   XrdOucCacheSlot::Init(Slots, SegCnt);
+   aBeg = SegCnt + maxFiles;
+   if (!(Slots = new XrdOucCacheSlot[aBeg+nStripe])) return;
+   XrdOucCacheSlot::Init(Slots, SegCnt, aBeg, nStripe);
 
 // Set pointers to be able to keep track of CacheIO objects and map them to
 // CacheData objects. The hash table will be the first page of slot memory.
@@ -176,12 +202,12 @@ XrdOucCacheReal::~XrdOucCacheReal()
 
 // Delete the slots
 //
-   delete Slots; Slots = 0;
+   delete [] Slots; Slots = 0;
 
 // Unmap cache memory and associated hash table
 //
    if (Base != MAP_FAILED)
-      {munmap(Base, static_cast<size_t>(SegSize)*SegCnt);
+      {munmap(Base, BaseLen);
        Base = (char *)(MAP_FAILED);
       }
 
@@ -257,17 +283,20 @@ int XrdOucCacheReal::Detach(XrdOucCacheIO *ioP)
 
 // We will be deleting the CacheData object. So, we need to recycle its slots.
 //
+   LockAll(); OMutex.Lock();
    oP = &Slots[Fnum];
    while(oP->Own.Next != Fnum)
         {sP = &Slots[oP->Own.Next];
          sP->Owner(Slots);
          if (sP->Contents < 0 || sP->Status.LRU.Next < 0) Faults++;
-            else {sP->Hide(Slots, Slash, sP->Contents%HNum);
+            else {Waste(sP);
+                  sP->Hide(Slots, Slash, sP->Contents%HNum);
                   sP->Pull(Slots);
-                  sP->unRef(Slots);
+                  sP->unRef(Slots, Anchor(sP-Slots));
                   Free++;
                  }
         }
+   OMutex.UnLock(); UnLockAll();
 
 // Reduce attach count and check if the cache is being deleted
 //
@@ -308,10 +337,11 @@ void XrdOucCacheReal::eMsg(const char *Path, const char *What, long long xOff,
 char *XrdOucCacheReal::Get(XrdOucCacheIO *ioP, long long lAddr,
                        int &rAmt, int &noIO)
 {
-   XrdSysMutexHelper Monitor(CMutex);
    XrdOucCacheSlot::ioQ *Waiter;
    XrdOucCacheSlot *sP;
-   int nUse, Fnum, Slot, segHash = lAddr%HNum;
+   int nUse, Fnum, Slot, segHash = lAddr%HNum, aNum = Anchor(segHash);
+   XrdSysMutex &sMutex = SMutex[segHash%nStripe];
+   XrdSysMutexHelper Monitor(sMutex);
    char *cBuff;
 
 // See if we have this logical address in the cache. Check if the page is in
@@ -326,7 +356,7 @@ char *XrdOucCacheReal::Get(XrdOucCacheIO *ioP, long long lAddr,
            XrdOucCacheSlot::ioQ ioTrans(sP->Status.waitQ, &ioSem);
            sP->Status.waitQ = &ioTrans;
            if (Dbg > 1) cerr <<"Cache: Wait slot " <<Slot <<endl;
-           CMutex.UnLock(); ioSem.Wait(); CMutex.Lock();
+           sMutex.UnLock(); ioSem.Wait(); sMutex.Lock();
            if (sP->Contents != lAddr) {rAmt = -EIO; return 0;}
           } else {
             if (sP->Status.inUse < 0) sP->Status.inUse--;
@@ -341,16 +371,20 @@ char *XrdOucCacheReal::Get(XrdOucCacheIO *ioP, long long lAddr,
       }
 
 // Page is not here. If no allocation wanted or we cannot obtain a free slot
-// return and indicate there is no associated cache page.
+// from our stripe return and indicate there is no associated cache page.
 //
-   if (!ioP || !(Slot = Slots[Slots->Status.LRU.Next].Pull(Slots)))
+   if (!ioP || (Slot = Slots[aNum].Status.LRU.Next) == aNum)
       {rAmt = -ENOMEM; return 0;}
+   sP = &Slots[Slot];
+   sP->Pull(Slots);
 
 // Remove ownership over this slot and remove it from the hash table
 //
-   sP = &Slots[Slot];
    if (sP->Contents >= 0)
-      {if (sP->Own.Next != Slot) sP->Owner(Slots);
+      {Waste(sP);
+       OMutex.Lock();
+       if (sP->Own.Next != Slot) sP->Owner(Slots);
+       OMutex.UnLock();
        sP->Hide(Slots, Slash, sP->Contents%HNum);
       }
 
@@ -358,13 +392,13 @@ char *XrdOucCacheReal::Get(XrdOucCacheIO *ioP, long long lAddr,
 //
    sP->Count |= XrdOucCacheSlot::inTrans;
    sP->Status.waitQ = 0;
-   CMutex.UnLock();
+   sMutex.UnLock();
    cBuff = Base+(static_cast<long long>(Slot)*SegSize);
    rAmt = ioP->Read(cBuff, (lAddr & Strip) << SegShft, SegSize);
-   CMutex.Lock();
+   sMutex.Lock();
 
-// Post anybody waiting for this slot. We hold the cache lock which will give us
-// time to complete the slot definition before the waiting thread looks at it.
+// Post anybody waiting for this slot. We hold the stripe lock which will give
+// us time to complete the slot definition before the waiting thread sees it.
 //
    nUse = -1;
    while((Waiter = sP->Status.waitQ))
@@ -381,7 +415,9 @@ char *XrdOucCacheReal::Get(XrdOucCacheIO *ioP, long long lAddr,
        sP->HLink      = Slash[segHash];
        Slash[segHash] = Slot;
        Fnum = (lAddr >> Shift) + SegCnt;
+       OMutex.Lock();
        Slots[Fnum].Owner(Slots, sP);
+       OMutex.UnLock();
        sP->Count = (rAmt == SegSize ? SegFull : rAmt|XrdOucCacheSlot::isShort);
        sP->Status.inUse = nUse;
        if (Dbg > 2) cerr <<"Cache: Miss slot " <<Slot <<" sz "
@@ -390,7 +426,7 @@ char *XrdOucCacheReal::Get(XrdOucCacheIO *ioP, long long lAddr,
        eMsg(ioP->Path(), "reading", (lAddr & Strip) << SegShft, SegSize, rAmt);
        cBuff = 0;
        sP->Contents = -1;
-       sP->unRef(Slots);
+       sP->unRef(Slots, aNum);
       }
 
 // Return the associated buffer or zero, as per above
@@ -504,12 +540,14 @@ void XrdOucCacheReal::PreRead(XrdOucCacheReal::prTask *prReq)
   
 int XrdOucCacheReal::Ref(char *Addr, int rAmt, int sFlags)
 {
-    XrdOucCacheSlot *sP = &Slots[(Addr-Base)>>SegShft];
+    int Slot = (Addr-Base)>>SegShft, aNum = Anchor(Slot);
+    XrdOucCacheSlot *sP = &Slots[Slot];
+    XrdSysMutex &sMutex = SMutex[Slot%nStripe];
     int eof = 0;
 
 // Indicate how much data was not yet referenced
 //
-   CMutex.Lock();
+   sMutex.Lock();
    if (sP->Contents >= 0)
       {if (sP->Count < 0) eof = 1;
        sP->Status.inUse++;
@@ -517,11 +555,12 @@ int XrdOucCacheReal::Ref(char *Addr, int rAmt, int sFlags)
           {if (sFlags) sP->Count |= sFlags;
               else if (!eof && (sP->Count -= rAmt) < 0) sP->Count = 0;
           } else {
-           if (sFlags) {sP->Count |= sFlags;                 sP->reRef(Slots);}
+           if (sFlags) {sP->Count |= sFlags;   sP->reRef(Slots, aNum);}
               else {     if (sP->Count & XrdOucCacheSlot::isSUSE)
-                                                             sP->unRef(Slots);
-                    else if (eof || (sP->Count -= rAmt) > 0) sP->reRef(Slots);
-                    else   {sP->Count = SegSize/2;           sP->unRef(Slots);}
+                                               sP->unRef(Slots, aNum);
+                    else if (eof || (sP->Count -= rAmt) > 0)
+                                               sP->reRef(Slots, aNum);
+                    else   {sP->Count = SegSize/2; sP->unRef(Slots, aNum);}
                    }
           }
       } else eof = 1;
@@ -529,10 +568,10 @@ int XrdOucCacheReal::Ref(char *Addr, int rAmt, int sFlags)
 // All done
 //
    if (Dbg > 2) cerr <<"Cache: Ref " <<std::hex <<sP->Contents <<std::dec
-                     << " slot " <<((Addr-Base)>>SegShft)
+                     << " slot " <<Slot
                      <<" sz " <<(sP->Count & XrdOucCacheSlot::lenMask)
                      <<" uc " <<sP->Status.inUse <<endl;
-   CMutex.UnLock();
+   sMutex.UnLock();
    return !eof;
 }
 
@@ -542,12 +581,12 @@ int XrdOucCacheReal::Ref(char *Addr, int rAmt, int sFlags)
 
 void XrdOucCacheReal::Trunc(XrdOucCacheIO *ioP, long long lAddr)
 {
-   XrdSysMutexHelper Monitor(CMutex);
    XrdOucCacheSlot  *sP, *oP;
    int sNum, Free = 0, Left = 0, Fnum = (lAddr >> Shift) + SegCnt;
 
 // We will be truncating CacheData pages. So, we need to recycle those slots.
 //
+   LockAll(); OMutex.Lock();
    oP = &Slots[Fnum]; sP = &Slots[oP->Own.Next];
    while(oP != sP)
         {sNum = sP->Own.Next;
@@ -555,11 +594,12 @@ void XrdOucCacheReal::Trunc(XrdOucCacheIO *ioP, long long lAddr)
             else {sP->Owner(Slots);
                   sP->Hide(Slots, Slash, sP->Contents%HNum);
                   sP->Pull(Slots);
-                  sP->unRef(Slots);
+                  sP->unRef(Slots, Anchor(sP-Slots));
                   Free++;
                  }
          sP = &Slots[sNum];
         }
+   OMutex.UnLock(); UnLockAll();
 
 // Issue debugging message
 //
@@ -574,11 +614,13 @@ void XrdOucCacheReal::Trunc(XrdOucCacheIO *ioP, long long lAddr)
   
 void XrdOucCacheReal::Upd(char *Addr, int wLen, int wOff)
 {
-    XrdOucCacheSlot *sP = &Slots[(Addr-Base)>>SegShft];
+    int Slot = (Addr-Base)>>SegShft;
+    XrdOucCacheSlot *sP = &Slots[Slot];
+    XrdSysMutex &sMutex = SMutex[Slot%nStripe];
 
 // Check if we extended a short page
 //
-   CMutex.Lock();
+   sMutex.Lock();
    if (sP->Count < 0)
       {int theLen = sP->Count & XrdOucCacheSlot::lenMask;
        if (wLen + wOff > theLen)
@@ -588,13 +630,32 @@ void XrdOucCacheReal::Upd(char *Addr, int wLen, int wOff)
 // Adjust the reference counter and if no references, place on the LRU chain
 //
    sP->Status.inUse++;
-   if (sP->Status.inUse >= 0) sP->reRef(Slots);
+   if (sP->Status.inUse >= 0) sP->reRef(Slots, Anchor(Slot));
 
 // All done
 //
    if (Dbg > 2) cerr <<"Cache: Upd " <<std::hex <<sP->Contents <<std::dec
-                     << " slot " <<((Addr-Base)>>SegShft)
+                     << " slot " <<Slot
                      <<" sz " <<(sP->Count & XrdOucCacheSlot::lenMask)
                      <<" uc " <<sP->Status.inUse <<endl;
-   CMutex.UnLock();
+   sMutex.UnLock();
+}
+
+/******************************************************************************/
+/*                                 W a s t e                                  */
+/******************************************************************************/
+
+void XrdOucCacheReal::Waste(XrdOucCacheSlot *sP)
+{
+   XrdOucCacheData *dP;
+
+// A page that was preread but never referenced is charged to its file. The
+// caller holds the stripe lock so the file cannot be detached under us.
+//
+   if (sP->Count & XrdOucCacheSlot::isNew
+   &&  (dP = Slots[(sP->Contents >> Shift) + SegCnt].Status.Data))
+      {dP->Statistics.Lock();
+       dP->Statistics.WastePR++;
+       dP->Statistics.UnLock();
+      }
 }
@@ -83,6 +83,18 @@ int       ioLookup(int &pip, int hip, void *kval)
 int       Ref(char *Addr, int rAmt, int sFlags=0);
 void      Trunc(XrdOucCacheIO *ioP, long long lAddr);
 void      Upd(char *Addr, int wAmt, int wOff);
+void      Waste(XrdOucCacheSlot *sP);
+
+// The cache is split into stripes. Each stripe has its own lock, LRU chain and
+// slice of the hash table. Slot n and hash bucket n belong to stripe n%nStripe
+// so a page is always cached in a slot of the stripe its hash bucket is in.
+//
+inline
+int       Anchor(int n) {return aBeg + n%nStripe;}
+inline
+void      LockAll()   {for (int i = 0; i < nStripe; i++) SMutex[i].Lock();}
+inline
+void      UnLockAll() {for (int i = nStripe-1; i >= 0; i--) SMutex[i].UnLock();}
 
 static const long long Shift = 48;
 static const long long Strip = 0x00000000ffffffffLL;  //
@@ -90,10 +102,15 @@ static const long long MaxFO = 0x000007ffffffffffLL;  // Min 4K page -> 8TB-1
 
 XrdOucCacheIO::aprParms aprDefault; // Default automatic preread
 
-XrdSysMutex      CMutex;
+static const int maxStripe = 16;
+
+XrdSysMutex      CMutex;      // Serializes the file table and attach count
+XrdSysMutex      OMutex;      // Serializes the slot ownership chains
+XrdSysMutex      SMutex[maxStripe]; // Serializes each stripe of the cache
 XrdOucCacheSlot *Slots;       // 1-to-1 slot to memory map
 int             *Slash;       // Slot hash table
 char            *Base;        // Base of memory cache
+size_t           BaseLen;     // Length of the memory map
 long long        HNum;
 long long        SegCnt;
 long long        SegSize;
@@ -103,6 +120,8 @@ int              SegFull;     // SegSize to mark
 int              maxCache;    // Maximum read to cache
 int              maxFiles;    // Maximum number of files to support
 int              Options;
+int              nStripe;     // Number of stripes
+int              aBeg;        // Index of the first stripe's LRU anchor slot
 
 // The following supports CacheIO object tracking
 //
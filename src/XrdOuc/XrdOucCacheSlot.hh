@@ -60,14 +60,18 @@ inline void       Hide(XrdOucCacheSlot *Base, int *hTab, int hI)
                        Count = 0; Contents = -1;
                       }
 
-static void       Init(XrdOucCacheSlot *Base, int Num)
+static void       Init(XrdOucCacheSlot *Base, int Num, int aBeg, int aNum)
                      {int i;
+                      for (i = aBeg; i < aBeg+aNum; i++)
+                          {Base[i].Status.LRU.Next = Base[i].Status.LRU.Prev=i;
+                           Base[i].Own.Next        = Base[i].Own.Prev       =i;
+                          }
                       Base->Status.LRU.Next = Base->Status.LRU.Prev = 0;
                       Base->Own.Next        = Base->Own.Prev = 0;
                       for (i = 1; i < Num; i++)
                           {Base[i].Status.LRU.Next = Base[i].Status.LRU.Prev = i;
                            Base[i].Own.Next = Base[i].Own.Prev = i;
-                           Base->Push(Base, &Base[i]);
+                           Base[aBeg+i%aNum].Push(Base, &Base[i]);
                           }
                      }
 
@@ -99,18 +103,18 @@ inline void       Owner(XrdOucCacheSlot *Base, XrdOucCacheSlot *sP)
                        Base[Own.Prev].Own.Next = UrNum; Own.Prev = UrNum;
                       }
 
-inline void       reRef(XrdOucCacheSlot *Base)
-                      {      Status.LRU.Prev           = Base->Status.LRU.Prev;
+inline void       reRef(XrdOucCacheSlot *Base, int aNum)
+                      {      Status.LRU.Prev  = Base[aNum].Status.LRU.Prev;
                        Base[ Status.LRU.Prev].Status.LRU.Next = this-Base;
-                       Base->Status.LRU.Prev           = this-Base;
-                             Status.LRU.Next           = 0;
+                       Base[aNum].Status.LRU.Prev      = this-Base;
+                             Status.LRU.Next           = aNum;
                       }
 
-inline void       unRef(XrdOucCacheSlot *Base)
-                      {      Status.LRU.Next           = Base->Status.LRU.Next;
+inline void       unRef(XrdOucCacheSlot *Base, int aNum)
+                      {      Status.LRU.Next  = Base[aNum].Status.LRU.Next;
                        Base [Status.LRU.Next].Status.LRU.Prev = this-Base;
-                       Base->Status.LRU.Next           = this-Base;
-                             Status.LRU.Prev           = 0;
+                       Base[aNum].Status.LRU.Next      = this-Base;
+                             Status.LRU.Prev           = aNum;
                       }
 
 struct SlotList
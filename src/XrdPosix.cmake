@@ -18,6 +18,7 @@ add_library(
   XrdPosix/XrdPosixAdmin.cc        XrdPosix/XrdPosixAdmin.hh
   XrdPosix/XrdPosixDir.cc          XrdPosix/XrdPosixDir.hh
   XrdPosix/XrdPosixFile.cc         XrdPosix/XrdPosixFile.hh
+  XrdPosix/XrdPosixFileRH.cc       XrdPosix/XrdPosixFileRH.hh
   XrdPosix/XrdPosixMap.cc          XrdPosix/XrdPosixMap.hh
   XrdPosix/XrdPosixObject.cc       XrdPosix/XrdPosixObject.hh
   XrdPosix/XrdPosixXrootd.cc       XrdPosix/XrdPosixXrootd.hh
@@ -49,6 +50,7 @@ add_library(
   XrdPosix/XrdPosixPreload.cc
   XrdPosix/XrdPosix.cc           XrdPosix/XrdPosix.hh
   XrdPosix/XrdPosixLinkage.cc    XrdPosix/XrdPosixLinkage.hh
+  XrdPosix/XrdPosixPrefetch.cc   XrdPosix/XrdPosixPrefetch.hh
                                  XrdPosix/XrdPosixExtern.hh
                                  XrdPosix/XrdPosixOsDep.hh )
 
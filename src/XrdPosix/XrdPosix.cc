@@ -40,6 +40,7 @@
 
 #include "XrdSys/XrdSysHeaders.hh"
 #include "XrdPosix/XrdPosixLinkage.hh"
+#include "XrdPosix/XrdPosixPrefetch.hh"
 #include "XrdPosix/XrdPosixXrootd.hh"
 #include "XrdPosix/XrdPosixXrootdPath.hh"
 
@@ -122,7 +123,9 @@ int XrdPosix_Close(int fildes)
 
 // Return result of the close
 //
-   return (Xroot.myFD(fildes) ? Xroot.Close(fildes) : Xunix.Close(fildes));
+   if (!Xroot.myFD(fildes)) return Xunix.Close(fildes);
+   XrdPosixPrefetch::Close(fildes);
+   return Xroot.Close(fildes);
 }
 }
 
@@ -166,7 +169,10 @@ int XrdPosix_Fclose(FILE *stream)
 
 // Close the associated file
 //
-   if (Xroot.myFD(nullfd)) Xroot.Close(nullfd);
+   if (Xroot.myFD(nullfd))
+      {XrdPosixPrefetch::Close(nullfd);
+       Xroot.Close(nullfd);
+      }
 
 // Now close the stream
 //
@@ -278,11 +284,12 @@ FILE *XrdPosix_Fopen(const char *path, const char *mode)
 //
    if ((fd = Xroot.Open(myPath, omode | XrdPosixXrootd::isStream , 0)) < 0)
       return 0;
+   XrdPosixPrefetch::Open(fd, omode);
 
 // First obtain a free stream
 //
    if (!(stream = fdopen(fd, mode))) 
-      {erc = errno; Xroot.Close(fd); errno = erc;}
+      {erc = errno; XrdPosixPrefetch::Close(fd); Xroot.Close(fd); errno = erc;}
 
 // All done
 //
@@ -304,7 +311,7 @@ size_t XrdPosix_Fread(void *ptr, size_t size, size_t nitems, FILE *stream)
 
    if (!Xroot.myFD(fd)) return Xunix.Fread(ptr, size, nitems, stream);
 
-   bytes = Xroot.Read(fd, ptr, size*nitems);
+   bytes = XrdPosixPrefetch::Read(fd, ptr, size*nitems);
 
 // Get the right return code. Note that we cannot emulate the flags in sunx86
 //
@@ -603,7 +610,7 @@ int XrdPosix_Open(const char *path, int oflag, ...)
 {
    char *myPath, buff[2048];
    va_list ap;
-   int mode;
+   int fd, mode;
 
 // Make sure a path was passed
 //
@@ -621,11 +628,14 @@ int XrdPosix_Open(const char *path, int oflag, ...)
 
 // Return the results of an open of an xrootd file
 //
-   if (!(oflag & O_CREAT)) return Xroot.Open(myPath, oflag);
-   va_start(ap, oflag);
-   mode = va_arg(ap, int);
-   va_end(ap);
-   return Xroot.Open(myPath, oflag, (mode_t)mode);
+   if (!(oflag & O_CREAT)) fd = Xroot.Open(myPath, oflag);
+      else {va_start(ap, oflag);
+            mode = va_arg(ap, int);
+            va_end(ap);
+            fd = Xroot.Open(myPath, oflag, (mode_t)mode);
+           }
+   if (fd >= 0) XrdPosixPrefetch::Open(fd, oflag);
+   return fd;
 }
 }
 
@@ -681,8 +691,27 @@ long long XrdPosix_Pread(int fildes, void *buf, unsigned long long nbyte,
 
 // Return the results of the read
 //
-   return (Xroot.myFD(fildes) ? Xroot.Pread  (fildes, buf, nbyte, offset)
-                              : Xunix.Pread64(fildes, buf, nbyte, offset));
+   return (Xroot.myFD(fildes)
+          ? XrdPosixPrefetch::Pread(fildes, buf, nbyte, offset)
+          : Xunix.Pread64(          fildes, buf, nbyte, offset));
+}
+}
+
+/******************************************************************************/
+/*                       X r d P o s i x _ P r e a d v                        */
+/******************************************************************************/
+  
+extern "C"
+{
+long long XrdPosix_Preadv(int fildes, const struct iovec *iov, int iovcnt,
+                          long long offset)
+{
+
+// Return the results of the read
+//
+   return (Xroot.myFD(fildes)
+          ? XrdPosixPrefetch::Preadv(fildes, iov, iovcnt, offset)
+          : Xunix.Preadv64(          fildes, iov, iovcnt, offset));
 }
 }
 
@@ -714,8 +743,8 @@ long long XrdPosix_Read(int fildes, void *buf, unsigned long long nbyte)
 
 // Return the results of the read
 //
-   return (Xroot.myFD(fildes) ? Xroot.Read(fildes, buf, nbyte)
-                              : Xunix.Read(fildes, buf, nbyte));
+   return (Xroot.myFD(fildes) ? XrdPosixPrefetch::Read(fildes, buf, nbyte)
+                              : Xunix.Read(           fildes, buf, nbyte));
 }
 }
  
@@ -730,8 +759,8 @@ long long XrdPosix_Readv(int fildes, const struct iovec *iov, int iovcnt)
 
 // Return results of the readv
 //
-   return (Xroot.myFD(fildes) ? Xroot.Readv(fildes, iov, iovcnt)
-                              : Xunix.Readv(fildes, iov, iovcnt));
+   return (Xroot.myFD(fildes) ? XrdPosixPrefetch::Readv(fildes, iov, iovcnt)
+                              : Xunix.Readv(           fildes, iov, iovcnt));
 }
 }
 
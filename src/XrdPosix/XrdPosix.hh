@@ -74,6 +74,8 @@
   
 #define pread(a,b,c,d)   XrdPosix_Pread(a,b,c,d)
 
+#define preadv(a,b,c,d)  XrdPosix_Preadv(a,b,c,d)
+
 #define read(a,b,c)      XrdPosix_Read(a,b,c)
   
 #define readv(a,b,c)     XrdPosix_Readv(a,b,c)
@@ -56,4 +56,27 @@ virtual void Complete(int Result) = 0;
              XrdPosixCallBack() {}
 virtual     ~XrdPosixCallBack() {}
 };
+
+// This abstract class defines the callback interface for asynchronous file
+// I/O (i.e. Pread(), Pwrite(), VRead(), and Fsync() calls that are passed a
+// callback object). The object is also the caller's context for the request;
+// derive from this class to carry whatever the completion needs. Such calls
+// always return immediately and the callback's Done() method is invoked when
+// the operation completes. The Result is either the number of bytes
+// transferred (zero for Fsync()) or -errno indicating that the operation
+// failed. Done() may be invoked before the initiating call returns (e.g. the
+// request could not be started or the file is cached) but is otherwise
+// invoked on one of the client's response threads. Hence, Done() should do as
+// little as possible and must never wait for another I/O request on the same
+// file to complete. The callback object is owned by the caller.
+
+class XrdPosixCallBackIO
+{
+public:
+
+virtual void Done(int Result) = 0;
+
+             XrdPosixCallBackIO() {}
+virtual     ~XrdPosixCallBackIO() {}
+};
 #endif
@@ -152,6 +152,9 @@ extern long       XrdPosix_Pathconf(const char *path, int name);
 extern long long  XrdPosix_Pread(int fildes, void *buf, unsigned long long nbyte,
                                  long long offset);
 
+extern long long  XrdPosix_Preadv(int fildes, const struct iovec *iov, int iovcnt,
+                                  long long offset);
+
 extern long long  XrdPosix_Read(int fildes, void *buf, unsigned long long nbyte);
   
 extern long long  XrdPosix_Readv(int fildes, const struct iovec *iov, int iovcnt);
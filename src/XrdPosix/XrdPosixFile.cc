@@ -35,8 +35,20 @@
 #include <sys/resource.h>
 #include <sys/uio.h>
 
+#include "Xrd/XrdScheduler.hh"
 #include "XrdPosix/XrdPosixCallBack.hh"
 #include "XrdPosix/XrdPosixFile.hh"
+#include "XrdPosix/XrdPosixFileRH.hh"
+#include "XrdSys/XrdSysTimer.hh"
+
+/******************************************************************************/
+/*                               G l o b a l s                                */
+/******************************************************************************/
+
+namespace XrdPosixGlobals
+{
+extern XrdScheduler *schedP;
+};
 
 /******************************************************************************/
 /*                        S t a t i c   M e m b e r s                         */
@@ -56,6 +68,7 @@ XrdPosixFile::XrdPosixFile(const char *path, XrdPosixCallBack *cbP, int Opts)
                mySize(0), myMtime(0), myInode(0), myMode(0),
                theCB(cbP),
                fPath(0),
+               numRefs(0),
                cOpt(0),
                isStream(Opts & isStrm ? 1 : 0)
 {
@@ -101,7 +114,10 @@ void* XrdPosixFile::DelayedDestroy(void* vpf)
 // Static function.
 // Called within a dedicated thread if XrdOucCacheIO is io-active.
 
+// Wait for any outstanding asynchronous requests to complete.
+
    XrdPosixFile* pf = (XrdPosixFile*)vpf;
+   while(pf->Refs()) XrdSysTimer::Wait(10);
    delete pf;
 
    return 0;
@@ -204,6 +220,41 @@ int XrdPosixFile::Read (char *Buff, long long Offs, int Len)
    return (Status.IsOK() ? (int)bytes : XrdPosixMap::Result(Status));
 }
   
+/******************************************************************************/
+/*                                  R e a d                                   */
+/******************************************************************************/
+
+void XrdPosixFile::Read(XrdPosixCallBackIO *cbp, char *Buff,
+                        long long Offs, int Len)
+{
+   XrdCl::XRootDStatus Status;
+   XrdPosixFileRH *rhP;
+   int rc;
+
+// A cache, if present, is synchronous. So, do the read via the cache and
+// complete the request in-line.
+//
+   if (XCio != (XrdOucCacheIO *)this)
+      {rc = XCio->Read(Buff, Offs, Len);
+       cbp->Done(rc < 0 ? -errno : rc);
+       return;
+      }
+
+// Issue the read. The file is kept around until the read completes.
+//
+   rhP = XrdPosixFileRH::Alloc(cbp, this, Offs, Len, XrdPosixFileRH::isRead);
+   Ref();
+   Status = clFile.Read((uint64_t)Offs, (uint32_t)Len, Buff, rhP);
+
+// If the read could not be started, then complete the request in-line
+//
+   if (!Status.IsOK())
+      {rhP->Recycle(); unRef();
+       XrdPosixMap::Result(Status);
+       cbp->Done(-errno);
+      }
+}
+  
 /******************************************************************************/
 /*                                 R e a d V                                  */
 /******************************************************************************/
@@ -237,6 +288,53 @@ int XrdPosixFile::ReadV (const XrdOucIOVec *readV, int n)
    return (Status.IsOK() ? nbytes : XrdPosixMap::Result(Status));
 }
 
+/******************************************************************************/
+/*                                 R e a d V                                  */
+/******************************************************************************/
+
+void XrdPosixFile::ReadV(XrdPosixCallBackIO *cbp,
+                         const XrdOucIOVec *readV, int n)
+{
+   XrdCl::XRootDStatus    Status;
+   XrdCl::ChunkList       chunkVec;
+   XrdPosixFileRH        *rhP;
+   int i, nbytes = 0;
+
+// A cache, if present, is synchronous. So, do the readv via the cache and
+// complete the request in-line.
+//
+   if (XCio != (XrdOucCacheIO *)this)
+      {i = XCio->ReadV(readV, n);
+       cbp->Done(i < 0 ? -errno : i);
+       return;
+      }
+
+// Copy in the vector (the client makes its own copy when the request is sent)
+//
+   chunkVec.reserve(n);
+   for (i = 0; i < n; i++)
+       {nbytes += readV[i].size;
+        chunkVec.push_back(XrdCl::ChunkInfo((uint64_t)readV[i].offset,
+                                            (uint32_t)readV[i].size,
+                                            (void   *)readV[i].data
+                                           ));
+       }
+
+// Issue the readv. The file is kept around until the readv completes.
+//
+   rhP = XrdPosixFileRH::Alloc(cbp, this, 0, nbytes, XrdPosixFileRH::isReadV);
+   Ref();
+   Status = clFile.VectorRead(chunkVec, (void *)0, rhP);
+
+// If the readv could not be started, then complete the request in-line
+//
+   if (!Status.IsOK())
+      {rhP->Recycle(); unRef();
+       XrdPosixMap::Result(Status);
+       cbp->Done(-errno);
+      }
+}
+
 /******************************************************************************/
 /*                                  S t a t                                   */
 /******************************************************************************/
@@ -266,13 +364,83 @@ bool XrdPosixFile::Stat(XrdCl::XRootDStatus &Status, bool force)
    return true;
 }
 
+/******************************************************************************/
+/*                                  S y n c                                   */
+/******************************************************************************/
+
+void XrdPosixFile::Sync(XrdPosixCallBackIO *cbp)
+{
+   XrdCl::XRootDStatus Status;
+   XrdPosixFileRH *rhP;
+
+// A cache, if present, is synchronous. So, do the sync via the cache and
+// complete the request in-line.
+//
+   if (XCio != (XrdOucCacheIO *)this)
+      {cbp->Done(XCio->Sync() < 0 ? -errno : 0);
+       return;
+      }
+
+// Issue the sync. The file is kept around until the sync completes.
+//
+   rhP = XrdPosixFileRH::Alloc(cbp, this, 0, 0, XrdPosixFileRH::isSync);
+   Ref();
+   Status = clFile.Sync(rhP);
+
+// If the sync could not be started, then complete the request in-line
+//
+   if (!Status.IsOK())
+      {rhP->Recycle(); unRef();
+       XrdPosixMap::Result(Status);
+       cbp->Done(-errno);
+      }
+}
+
+/******************************************************************************/
+/*                                 W r i t e                                  */
+/******************************************************************************/
+
+void XrdPosixFile::Write(XrdPosixCallBackIO *cbp, char *Buff,
+                         long long Offs, int Len)
+{
+   XrdCl::XRootDStatus Status;
+   XrdPosixFileRH *rhP;
+
+// A cache, if present, is synchronous. So, do the write via the cache and
+// complete the request in-line.
+//
+   if (XCio != (XrdOucCacheIO *)this)
+      {if (XCio->Write(Buff, Offs, Len) < 0) cbp->Done(-errno);
+          else {if (Offs+Len > (long long)mySize) mySize = Offs + Len;
+                cbp->Done(Len);
+               }
+       return;
+      }
+
+// Issue the write. The file is kept around until the write completes.
+//
+   rhP = XrdPosixFileRH::Alloc(cbp, this, Offs, Len, XrdPosixFileRH::isWrite);
+   Ref();
+   Status = clFile.Write((uint64_t)Offs, (uint32_t)Len, Buff, rhP);
+
+// If the write could not be started, then complete the request in-line
+//
+   if (!Status.IsOK())
+      {rhP->Recycle(); unRef();
+       XrdPosixMap::Result(Status);
+       cbp->Done(-errno);
+      }
+}
+
 /******************************************************************************/
 /*                                  D o I t                                   */
 /******************************************************************************/
 void XrdPosixFile::DoIt()
 {
 // Virtual function of XrdJob.
-// Called from XrdPosixXrootd::Close if the file is still IO active.
+// Called from XrdPosixXrootd::Close if the file is still IO active. When
+// asynchronous requests are still outstanding we simply try again later.
 
-   delete this;
+   if (Refs()) XrdPosixGlobals::schedP->Schedule((XrdJob *)this, time(0)+1);
+      else delete this;
 }
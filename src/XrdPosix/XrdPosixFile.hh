@@ -48,11 +48,13 @@
 #include "XrdPosix/XrdPosixObject.hh"
 
 #include "Xrd/XrdJob.hh"
+#include "XrdSys/XrdSysAtomics.hh"
 /******************************************************************************/
 /*                    X r d P o s i x F i l e   C l a s s                     */
 /******************************************************************************/
 
 class XrdPosixCallBack;
+class XrdPosixCallBackIO;
 
 class XrdPosixFile : public XrdPosixObject, 
                      public XrdOucCacheIO,
@@ -92,8 +94,26 @@ static void*         DelayedDestroy(void*);
 
        int           Read (char *Buff, long long Offs, int Len);
 
+       void          Read (XrdPosixCallBackIO *cbp, char *Buff,
+                           long long Offs, int Len);
+
        int           ReadV (const XrdOucIOVec *readV, int n);
 
+       void          ReadV (XrdPosixCallBackIO *cbp,
+                            const XrdOucIOVec *readV, int n);
+
+       void          Ref()   {AtomicBeg(updMutex);
+                              AtomicInc(numRefs);
+                              AtomicEnd(updMutex);
+                             }
+
+       int           Refs()  {int n;
+                              AtomicBeg(updMutex);
+                              n = AtomicGet(numRefs);
+                              AtomicEnd(updMutex);
+                              return n;
+                             }
+
        long long     setOffset(long long offs)
                               {currOffset = offs;
                                return currOffset;
@@ -103,9 +123,16 @@ static void*         DelayedDestroy(void*);
 
        int           Sync() {return XrdPosixMap::Result(clFile.Sync());}
 
+       void          Sync(XrdPosixCallBackIO *cbp);
+
        int           Trunc(long long Offset)
                           {return XrdPosixMap::Result(clFile.Truncate((uint64_t)Offset));}
 
+       void          unRef() {AtomicBeg(updMutex);
+                              AtomicDec(numRefs);
+                              AtomicEnd(updMutex);
+                             }
+
        using         XrdPosixObject::Who;
 
        bool          Who(XrdPosixFile **fileP)
@@ -116,6 +143,9 @@ static void*         DelayedDestroy(void*);
                                                          (uint32_t)Len, Buff));
                           }
 
+       void          Write(XrdPosixCallBackIO *cbp, char *Buff,
+                           long long Offs, int Len);
+
        void          DoIt();
 
        size_t        mySize;
@@ -142,7 +172,9 @@ union {long long         currOffset;
        XrdPosixCallBack *theCB;
       };
 
+XrdSysMutex updMutex;
 char       *fPath;
+int         numRefs;
 int         cOpt;
 char        isStream;
 };
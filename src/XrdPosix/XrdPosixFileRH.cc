@@ -0,0 +1,132 @@
+/******************************************************************************/
+/*                                                                            */
+/*                     X r d P o s i x F i l e R H . c c                      */
+/*                                                                            */
+/* (c) 2014 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                            All Rights Reserved                             */
+/*   Produced by Andrew Hanushevsky for Stanford University under contract    */
+/*              DE-AC02-76-SFO0515 with the Department of Energy              */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <errno.h>
+
+#include "XrdPosix/XrdPosixCallBack.hh"
+#include "XrdPosix/XrdPosixFile.hh"
+#include "XrdPosix/XrdPosixFileRH.hh"
+#include "XrdPosix/XrdPosixMap.hh"
+
+/******************************************************************************/
+/*                        S t a t i c   M e m b e r s                         */
+/******************************************************************************/
+
+XrdSysMutex     XrdPosixFileRH::myMutex;
+XrdPosixFileRH *XrdPosixFileRH::freeRH   =   0;
+int             XrdPosixFileRH::numFree  =   0;
+int             XrdPosixFileRH::maxFree  = 100;
+
+/******************************************************************************/
+/*                                 A l l o c                                  */
+/******************************************************************************/
+
+XrdPosixFileRH *XrdPosixFileRH::Alloc(XrdPosixCallBackIO *cbp,
+                                      XrdPosixFile       *fp,
+                                      long long           offs,
+                                      int                 xResult,
+                                      ioType              typeIO)
+{
+   XrdPosixFileRH *newCB;
+
+// Try to allocate an prexisting object otherwise get a new one
+//
+   myMutex.Lock();
+   if ((newCB = freeRH)) {freeRH = freeRH->next; numFree--;}
+      else newCB = new XrdPosixFileRH;
+   myMutex.UnLock();
+
+// Initialize the callback and return it
+//
+   newCB->theCB   = cbp;
+   newCB->theFile = fp;
+   newCB->offset  = offs;
+   newCB->result  = xResult;
+   newCB->typeIO  = typeIO;
+   return newCB;
+}
+
+/******************************************************************************/
+/*                        H a n d l e R e s p o n s e                         */
+/******************************************************************************/
+  
+void XrdPosixFileRH::HandleResponse(XrdCl::XRootDStatus *status,
+                                    XrdCl::AnyObject    *response)
+{
+   XrdPosixCallBackIO *xeqCB = theCB;
+   XrdPosixFile       *fP    = theFile;
+   int rc = result;
+
+// Determine the result. A read returns the amount actually read while a write
+// or vector read returns the amount requested when it succeeds (a vector read
+// either reads everything or fails). A sync returns zero.
+//
+   if (!(status->IsOK()))
+      {XrdPosixMap::Result(*status);
+       rc = -errno;
+      } else if (typeIO == isRead)
+                {XrdCl::ChunkInfo *cInfo = 0;
+                 if (response) response->Get(cInfo);
+                 rc = (cInfo ? (int)cInfo->length : 0);
+                } else if (typeIO == isWrite)
+                          {if (offset+rc > (long long)fP->mySize)
+                              fP->mySize = offset + rc;
+                          }
+
+// Get rid of things we don't need and recycle ourselves before invoking the
+// callback as the callback may well start another request.
+//
+   delete status;
+   delete response;
+   Recycle();
+
+// Invoke the callback and indicate that the I/O is no longer pending. This
+// must be last as the file object may be deleted once nothing is pending.
+//
+   xeqCB->Done(rc);
+   fP->unRef();
+}
+
+/******************************************************************************/
+/*                               R e c y c l e                                */
+/******************************************************************************/
+  
+void XrdPosixFileRH::Recycle()
+{
+// Perform recycling
+//
+   myMutex.Lock();
+   if (numFree >= maxFree) delete this;
+      else {next = freeRH;
+            freeRH = this;
+            numFree++;
+           }
+   myMutex.UnLock();
+}
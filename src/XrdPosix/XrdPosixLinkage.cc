@@ -146,6 +146,10 @@ XrdPosixLinkage Xunix;
                          {return (Retv_Pread)Xunix.Load_Error("pread");}
       Retv_Pread64     Xrd_U_Pread64(Args_Pread64)
                          {return (Retv_Pread64)Xunix.Load_Error("pread");}
+      Retv_Preadv      Xrd_U_Preadv(Args_Preadv)
+                         {return (Retv_Preadv)Xunix.Load_Error("preadv");}
+      Retv_Preadv64    Xrd_U_Preadv64(Args_Preadv64)
+                         {return (Retv_Preadv64)Xunix.Load_Error("preadv");}
       Retv_Pwrite      Xrd_U_Pwrite(Args_Pwrite) 
                          {return (Retv_Pwrite)Xunix.Load_Error("pwrite");}
       Retv_Pwrite64    Xrd_U_Pwrite64(Args_Pwrite64)
@@ -241,6 +245,8 @@ int XrdPosixLinkage::Resolve()
   LOOKUP_UNIX(Pathconf)
   LOOKUP_UNIX(Pread)
   LOOKUP_UNIX(Pread64)
+  LOOKUP_UNIX(Preadv)
+  LOOKUP_UNIX(Preadv64)
   LOOKUP_UNIX(Pwrite)
   LOOKUP_UNIX(Pwrite64)
   LOOKUP_UNIX(Read)
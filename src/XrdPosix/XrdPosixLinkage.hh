@@ -232,6 +232,14 @@
 #define Retv_Pread64 ssize_t
 #define Args_Pread64 int, void *, size_t, off64_t
 
+#define Symb_Preadv UNIX_PFX "preadv"
+#define Retv_Preadv ssize_t
+#define Args_Preadv int, const struct iovec *, int, off_t
+
+#define Symb_Preadv64 UNIX_PFX "preadv64"
+#define Retv_Preadv64 ssize_t
+#define Args_Preadv64 int, const struct iovec *, int, off64_t
+
 #define Symb_Pwrite UNIX_PFX "pwrite"
 #define Retv_Pwrite ssize_t
 #define Args_Pwrite int, const void *, size_t, off_t
@@ -387,6 +395,8 @@ class XrdPosixLinkage
       Retv_Pathconf    (*Pathconf)(Args_Pathconf);
       Retv_Pread       (*Pread)(Args_Pread);
       Retv_Pread64     (*Pread64)(Args_Pread64);
+      Retv_Preadv      (*Preadv)(Args_Preadv);
+      Retv_Preadv64    (*Preadv64)(Args_Preadv64);
       Retv_Pwrite      (*Pwrite)(Args_Pwrite);
       Retv_Pwrite64    (*Pwrite64)(Args_Pwrite64);
       Retv_Read        (*Read)(Args_Read);
@@ -42,6 +42,7 @@
 /******************************************************************************/
 
 XrdSysMutex      XrdPosixObject::fdMutex;
+XrdSysMutex      XrdPosixObject::fdShard[XrdPosixObject::fdShards];
 XrdPosixObject **XrdPosixObject::myFiles  =  0;
 int              XrdPosixObject::highFD   = -1;
 int              XrdPosixObject::lastFD   = -1;
@@ -76,12 +77,15 @@ bool XrdPosixObject::AssignFD(bool isStream)
           } while(1);
       }
 
-// Enter object in out vector of objects and assign it the FD
+// Enter object in out vector of objects and assign it the FD. Lookups only
+// use the shard lock so we must hold it while updating the vector.
 //
+   Shard(fd).Lock();
    myFiles[fd] = this;
+   Shard(fd).UnLock();
    if (fd > highFD) highFD = fd;
    fdNum  = fd + baseFD;
-   fdMutex.UnLock();
+   fdHelper.UnLock();
 
 // All done.
 //
@@ -104,21 +108,25 @@ XrdPosixDir *XrdPosixObject::Dir(int fd, bool glk)
 do{if (fd >= lastFD || fd < baseFD)
       {errno = EBADF; return (XrdPosixDir *)0;}
 
-// Obtain the file object, if any
+// Obtain the object, if any. Lookups only need the lock for the shard the
+// descriptor is in. However, a call to destroy the object also needs the
+// global lock as it will change the vector (the global lock is always
+// obtained before a shard lock).
 //
-   fdMutex.Lock();
+   if (glk) fdMutex.Lock();
+   Shard(fd - baseFD).Lock();
    if (!(oP = myFiles[fd - baseFD]) || !(oP->Who(&dP)))
-      {fdMutex.UnLock(); errno = EBADF; return (XrdPosixDir *)0;}
+      {fdUnLock(fd, glk); errno = EBADF; return (XrdPosixDir *)0;}
 
 // Attempt to lock the object in the appropriate mode. If we fail, then we need
-// to retry this after dropping the global lock. We pause a bit to let the
+// to retry this after dropping the shard lock. We pause a bit to let the
 // current lock holder a chance to unlock the lock. We only do this a limited
 // amount of time (1 minute) so that we don't get stuck here forever.
 //
    if (glk) haveLock = oP->objMutex.CondWriteLock();
       else  haveLock = oP->objMutex.CondReadLock();
    if (!haveLock)
-      {fdMutex.UnLock();
+      {fdUnLock(fd, glk);
        waitCount++;
        if (waitCount > 120) break;
        XrdSysTimer::Wait(500); // We wait 500 milliseconds
@@ -127,9 +135,10 @@ do{if (fd >= lastFD || fd < baseFD)
 
 // If the global lock is to be held, then release the object lock as this
 // is a call to destroy the object and there is no need for the local lock.
+// The shard lock is kept as well so that no one can find the object.
 //
    if (glk) oP->UnLock();
-      else  fdMutex.UnLock();
+      else  Shard(fd - baseFD).UnLock();
    return dP;
   } while(1);
 
@@ -155,21 +164,25 @@ XrdPosixFile *XrdPosixObject::File(int fd, bool glk)
 do{if (fd >= lastFD || fd < baseFD)
       {errno = EBADF; return (XrdPosixFile *)0;}
 
-// Obtain the file object, if any
+// Obtain the object, if any. Lookups only need the lock for the shard the
+// descriptor is in. However, a call to destroy the object also needs the
+// global lock as it will change the vector (the global lock is always
+// obtained before a shard lock).
 //
-   fdMutex.Lock();
+   if (glk) fdMutex.Lock();
+   Shard(fd - baseFD).Lock();
    if (!(oP = myFiles[fd - baseFD]) || !(oP->Who(&fP)))
-      {fdMutex.UnLock(); errno = EBADF; return (XrdPosixFile *)0;}
+      {fdUnLock(fd, glk); errno = EBADF; return (XrdPosixFile *)0;}
 
 // Attempt to lock the object in the appropriate mode. If we fail, then we need
-// to retry this after dropping the global lock. We pause a bit to let the
+// to retry this after dropping the shard lock. We pause a bit to let the
 // current lock holder a chance to unlock the lock. We only do this a limited
 // amount of time (1 minute) so that we don't get stuck here forever.
 //
    if (glk) haveLock = oP->objMutex.CondWriteLock();
       else  haveLock = oP->objMutex.CondReadLock();
    if (!haveLock)
-      {fdMutex.UnLock();
+      {fdUnLock(fd, glk);
        waitCount++;
        if (waitCount > 120) break;
        XrdSysTimer::Wait(500); // We wait 500 milliseconds
@@ -178,9 +191,10 @@ do{if (fd >= lastFD || fd < baseFD)
 
 // If the global lock is to be held, then release the object lock as this
 // is a call to destroy the object and there is no need for the local lock.
+// The shard lock is kept as well so that no one can find the object.
 //
    if (glk) oP->UnLock();
-      else  fdMutex.UnLock();
+      else  Shard(fd - baseFD).UnLock();
    return fP;
   } while(1);
 
@@ -242,25 +256,26 @@ int XrdPosixObject::Init(int fdnum)
   
 void XrdPosixObject::Release(XrdPosixObject *oP, bool needlk)
 {
-// Get the lock if need be
+   int myFD = oP->fdNum - baseFD;
+
+// Get the locks if need be (otherwise the caller has both of them)
 //
-   if (needlk) fdMutex.Lock();
+   if (needlk) {fdMutex.Lock(); Shard(myFD).Lock();}
 
 // Remove the object from the table
 //
    if (baseFD)
-      {int myFD = oP->fdNum - baseFD;
-       if (myFD < freeFD) freeFD = myFD;
+      {if (myFD < freeFD) freeFD = myFD;
        myFiles[myFD] = 0;
       } else {
        myFiles[oP->fdNum] = 0;
        close(oP->fdNum);
       }
 
-// Zorch the object fd and relese the global lock (object lock still held)
+// Zorch the object fd and relese the locks (object lock still held)
 //
    oP->fdNum = -1;
-   fdMutex.UnLock();
+   fdUnLock(myFD + baseFD, true);
 }
 
 /******************************************************************************/
@@ -314,7 +329,7 @@ void XrdPosixObject::Shutdown()
    if (myFiles)
       {for (i = 0; i <= highFD; i++) 
            if ((oP = myFiles[i]))
-              {myFiles[i] = 0;
+              {Shard(i).Lock(); myFiles[i] = 0; Shard(i).UnLock();
                if (oP->fdNum >= 0) close(oP->fdNum);
                oP->fdNum = -1;
                delete oP;
@@ -80,7 +80,16 @@ protected:
 
 private:
 
-static XrdSysMutex      fdMutex;
+static void             fdUnLock(int fd, bool glk)
+                                {Shard(fd - baseFD).UnLock();
+                                 if (glk) fdMutex.UnLock();
+                                }
+static XrdSysMutex     &Shard(int fx) {return fdShard[fx & (fdShards-1)];}
+
+static const int        fdShards = 64; // Must be a power of two
+
+static XrdSysMutex      fdMutex;       // Serializes changes to the table
+static XrdSysMutex      fdShard[fdShards]; // Serializes table lookups
 static XrdPosixObject **myFiles;
 static int              lastFD;
 static int              highFD;
@@ -0,0 +1,635 @@
+/******************************************************************************/
+/*                                                                            */
+/*                   X r d P o s i x P r e f e t c h . c c                    */
+/*                                                                            */
+/* (c) 2015 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                            All Rights Reserved                             */
+/*   Produced by Andrew Hanushevsky for Stanford University under contract    */
+/*              DE-AC02-76-SFO0515 with the Department of Energy              */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+
+#include "XrdOuc/XrdOucEnv.hh"
+#include "XrdOuc/XrdOucIOVec.hh"
+#include "XrdPosix/XrdPosixCallBack.hh"
+#include "XrdPosix/XrdPosixPrefetch.hh"
+#include "XrdPosix/XrdPosixXrootd.hh"
+#include "XrdSys/XrdSysHeaders.hh"
+
+/******************************************************************************/
+/*                        L o c a l   S e t t i n g s                         */
+/******************************************************************************/
+
+// These are set from the XRDPOSIX_PREFETCH environmental variable
+//
+namespace
+{
+long long   blkSize  = 1024*1024;       // Size of a prefetch block
+int         blkNum   = 4;               // Blocks per file (at most blkMax)
+int         raTrigger= 2;               // Sequential reads before prefetching
+long long   maxMem   = 64*1024*1024;    // Memory for all prefetch blocks
+
+XrdSysMutex memMutex;
+long long   memUsed  = 0;
+
+static const int blkMax = 64;           // Maximum blocks per file
+static const int vecMax = 1024;         // Maximum readv elements (server)
+static const int segMax = 512*1024;     // Maximum readv element length
+}
+
+/******************************************************************************/
+/*             X r d P o s i x P r e f e t c h B l k   C l a s s              */
+/******************************************************************************/
+
+class XrdPosixPrefetchBlk : public XrdPosixCallBackIO
+{
+public:
+
+enum  blkState {isFree = 0, inFlight, isReady};
+
+void  Done(int result);
+
+XrdPosixPrefetchFile *fileP;
+char                 *buff;
+long long             offset;
+int                   rlen;   // Bytes requested
+int                   dlen;   // Bytes actually read or -errno
+blkState              state;
+
+      XrdPosixPrefetchBlk() : fileP(0), buff(0), offset(0), rlen(0), dlen(0),
+                              state(isFree) {}
+     ~XrdPosixPrefetchBlk() {}
+};
+
+/******************************************************************************/
+/*            X r d P o s i x P r e f e t c h F i l e   C l a s s             */
+/******************************************************************************/
+
+class XrdPosixPrefetchFile
+{
+public:
+
+XrdPosixPrefetchBlk *Find(long long offs);
+
+ssize_t              Read(char *buff, size_t blen, long long offs);
+
+ssize_t              ReadV(const struct iovec *iov, int iovcnt, long long offs);
+
+int                  Schedule(long long offs, XrdPosixPrefetchBlk **toDo);
+
+XrdSysCondVar        fCV;      // Protects everything below
+XrdSysMutex          rdMutex;  // Serializes Read() for the file offset
+XrdPosixPrefetchBlk *blkTab;
+long long            fSize;
+long long            nextOff;  // Offset at which a sequential read starts
+long long            raNext;   // Offset of the next block to prefetch
+int                  fdNum;
+int                  seqCnt;
+int                  inFlight;
+int                  users;
+
+                     XrdPosixPrefetchFile(int fd, long long size);
+                    ~XrdPosixPrefetchFile();
+};
+
+/******************************************************************************/
+/*                        S t a t i c   M e m b e r s                         */
+/******************************************************************************/
+
+XrdSysMutex            XrdPosixPrefetch::tabMutex;
+XrdPosixPrefetchFile **XrdPosixPrefetch::fdTab   = 0;
+int                    XrdPosixPrefetch::fdTabSz = 0;
+bool                   XrdPosixPrefetch::doVRead = false;
+
+/******************************************************************************/
+/*                 X r d P o s i x P r e f e t c h B l k : :                  */
+/*                                  D o n e                                   */
+/******************************************************************************/
+
+// Note that this may be called in-line by XrdPosixXrootd::Pread() so the file
+// condition variable must never be held when a prefetch is started.
+//
+void XrdPosixPrefetchBlk::Done(int result)
+{
+   fileP->fCV.Lock();
+   dlen  = result;
+   state = isReady;
+   fileP->inFlight--;
+   fileP->fCV.Broadcast();
+   fileP->fCV.UnLock();
+}
+
+/******************************************************************************/
+/*                X r d P o s i x P r e f e t c h F i l e : :                 */
+/*                           C o n s t r u c t o r                            */
+/******************************************************************************/
+
+XrdPosixPrefetchFile::XrdPosixPrefetchFile(int fd, long long size)
+                     : fCV(0), fSize(size), nextOff(0), raNext(0),
+                       fdNum(fd), seqCnt(0), inFlight(0), users(0)
+{
+   blkTab = new XrdPosixPrefetchBlk[blkNum];
+   for (int i = 0; i < blkNum; i++) blkTab[i].fileP = this;
+}
+
+/******************************************************************************/
+/*                 X r d P o s i x P r e f e t c h F i l e : :                */
+/*                            D e s t r u c t o r                             */
+/******************************************************************************/
+
+XrdPosixPrefetchFile::~XrdPosixPrefetchFile()
+{
+   int i, n = 0;
+
+// Return the block buffers to the memory pool
+//
+   for (i = 0; i < blkNum; i++) if (blkTab[i].buff) {free(blkTab[i].buff); n++;}
+   if (n) {memMutex.Lock(); memUsed -= n*blkSize; memMutex.UnLock();}
+   delete [] blkTab;
+}
+
+/******************************************************************************/
+/*             X r d P o s i x P r e f e t c h F i l e : : F i n d            */
+/******************************************************************************/
+
+// The caller must hold the file condition variable lock
+//
+XrdPosixPrefetchBlk *XrdPosixPrefetchFile::Find(long long offs)
+{
+   for (int i = 0; i < blkNum; i++)
+       {if (blkTab[i].state != XrdPosixPrefetchBlk::isFree
+        &&  offs >= blkTab[i].offset && offs < blkTab[i].offset+blkTab[i].rlen)
+           return &blkTab[i];
+       }
+   return 0;
+}
+
+/******************************************************************************/
+/*             X r d P o s i x P r e f e t c h F i l e : : R e a d            */
+/******************************************************************************/
+
+ssize_t XrdPosixPrefetchFile::Read(char *buff, size_t blen, long long offs)
+{
+   XrdPosixPrefetchBlk *bP, *toDo[blkMax];
+   long long endOff = offs + blen, curOff = offs, n;
+   int i, nToDo = 0;
+   bool atEOF = false;
+
+// Track sequential access. Any other access pattern stops further prefetching
+// until the file is again read sequentially.
+//
+   fCV.Lock();
+   if (offs != nextOff) seqCnt = 0;
+      else if (seqCnt < raTrigger) seqCnt++;
+   nextOff = endOff;
+
+// Copy out whatever the prefetched blocks can supply, waiting for ones still
+// in flight. Failed prefetches are discarded and the read is redone below so
+// that the error is properly reported.
+//
+   while(curOff < endOff && (bP = Find(curOff)))
+        {if (bP->state == XrdPosixPrefetchBlk::inFlight)
+            {fCV.Wait(); continue;}
+         if (bP->dlen < 0) {bP->state = XrdPosixPrefetchBlk::isFree; break;}
+         if (curOff >= bP->offset + bP->dlen) {atEOF = true; break;}
+         n = bP->offset + bP->dlen;
+         if (n > endOff) n = endOff;
+         memcpy(buff+(curOff-offs), bP->buff+(curOff-bP->offset), n-curOff);
+         curOff = n;
+         if (bP->dlen < bP->rlen && curOff < endOff) {atEOF = true; break;}
+        }
+   if (curOff >= fSize) atEOF = true;
+
+// Start prefetching ahead of this read if the access is sequential
+//
+   if (seqCnt >= raTrigger) nToDo = Schedule(endOff, toDo);
+   fCV.UnLock();
+
+   for (i = 0; i < nToDo; i++)
+       XrdPosixXrootd::Pread(fdNum, toDo[i]->buff, toDo[i]->rlen,
+                                    toDo[i]->offset, toDo[i]);
+
+// Read anything that was not prefetched
+//
+   if (curOff < endOff && !atEOF)
+      {if ((n = XrdPosixXrootd::Pread(fdNum, buff+(curOff-offs),
+                                      endOff-curOff, curOff)) < 0)
+          return (curOff > offs ? curOff-offs : -1);
+       curOff += n;
+      }
+   return curOff - offs;
+}
+
+/******************************************************************************/
+/*            X r d P o s i x P r e f e t c h F i l e : : R e a d V           */
+/******************************************************************************/
+
+ssize_t XrdPosixPrefetchFile::ReadV(const struct iovec *iov, int iovcnt,
+                                    long long offs)
+{
+   ssize_t bytes, totbytes = 0;
+   int i;
+
+// Reads from prefetched data are cheap so simply do each element in turn
+//
+   for (i = 0; i < iovcnt; i++)
+       {bytes = Read((char *)iov[i].iov_base, iov[i].iov_len, offs);
+        if (bytes < 0) return (totbytes ? totbytes : -1);
+        totbytes += bytes; offs += bytes;
+        if (bytes < (ssize_t)iov[i].iov_len) break;
+       }
+   return totbytes;
+}
+
+/******************************************************************************/
+/*         X r d P o s i x P r e f e t c h F i l e : : S c h e d u l e        */
+/******************************************************************************/
+
+// The caller must hold the file condition variable lock. The returned blocks
+// are marked in flight and must be started once the lock is released.
+//
+int XrdPosixPrefetchFile::Schedule(long long offs, XrdPosixPrefetchBlk **toDo)
+{
+   XrdPosixPrefetchBlk *bP;
+   long long wEnd = offs + blkNum*blkSize;
+   int i, nToDo = 0;
+   bool haveMem;
+
+// The window ends at the end of the file. Restart it if we fell behind or the
+// reader skipped ahead of it.
+//
+   if (wEnd > fSize) wEnd = fSize;
+   if (raNext < offs || raNext > wEnd) raNext = offs;
+
+// Free blocks that have been consumed or fell outside the window
+//
+   for (i = 0; i < blkNum; i++)
+       {bP = &blkTab[i];
+        if (bP->state == XrdPosixPrefetchBlk::isReady
+        && (bP->offset + bP->rlen <= offs || bP->offset >= wEnd))
+           bP->state = XrdPosixPrefetchBlk::isFree;
+       }
+
+// Fill the window with free blocks, skipping over data already being fetched
+//
+   while(raNext < wEnd)
+        {if ((bP = Find(raNext))) {raNext = bP->offset + bP->rlen; continue;}
+         for (i = 0; i < blkNum; i++)
+             if (blkTab[i].state == XrdPosixPrefetchBlk::isFree) break;
+         if (i >= blkNum) break;
+         bP = &blkTab[i];
+         if (!bP->buff)
+            {memMutex.Lock();
+             if ((haveMem = (memUsed + blkSize <= maxMem))) memUsed += blkSize;
+             memMutex.UnLock();
+             if (!haveMem) break;
+             if (!(bP->buff = (char *)malloc(blkSize)))
+                {memMutex.Lock(); memUsed -= blkSize; memMutex.UnLock();
+                 break;
+                }
+            }
+         bP->offset = raNext;
+         bP->rlen   = (fSize - raNext < blkSize ? fSize - raNext : blkSize);
+         bP->state  = XrdPosixPrefetchBlk::inFlight;
+         raNext    += bP->rlen;
+         inFlight++;
+         toDo[nToDo++] = bP;
+        }
+   return nToDo;
+}
+
+/******************************************************************************/
+/*                                 C l o s e                                  */
+/******************************************************************************/
+
+void XrdPosixPrefetch::Close(int fd)
+{
+   XrdPosixPrefetchFile *fP;
+
+// Remove the file from the table
+//
+   if (fd < 0 || fd >= fdTabSz) return;
+   tabMutex.Lock();
+   fP = fdTab[fd]; fdTab[fd] = 0;
+   tabMutex.UnLock();
+   if (!fP) return;
+
+// Wait for any prefetches and concurrent readers to finish
+//
+   fP->fCV.Lock();
+   while(fP->inFlight || fP->users) fP->fCV.Wait();
+   fP->fCV.UnLock();
+   delete fP;
+}
+
+/******************************************************************************/
+/*                                   G e t                                    */
+/******************************************************************************/
+
+XrdPosixPrefetchFile *XrdPosixPrefetch::Get(int fd)
+{
+   XrdPosixPrefetchFile *fP;
+
+   if (fd < 0 || fd >= fdTabSz) return 0;
+
+   tabMutex.Lock();
+   if ((fP = fdTab[fd]))
+      {fP->fCV.Lock(); fP->users++; fP->fCV.UnLock();}
+   tabMutex.UnLock();
+   return fP;
+}
+
+/******************************************************************************/
+/*                                  I n i t                                   */
+/******************************************************************************/
+
+// Parse options specified as a cgi string (i.e. var=val&var=val&...). Vars:
+
+// blocks=n    - number of prefetch blocks per file.
+// blksz=n     - size of a prefetch block   (can be suffixed in k, m, g).
+// maxmem=n    - memory for all prefetching (can be suffixed in k, m, g).
+// trigger=n   - sequential reads that start prefetching.
+// vread=0     - do not convert readv() and preadv() to a vector read.
+//
+namespace
+{
+void GetVal(XrdOucEnv &theEnv, const char *vName, long long &Dest)
+{
+   char *eP, *tP;
+   long long Val;
+
+// Extract variable
+//
+   if (!(tP = theEnv.Get(vName)) || !(*tP)) return;
+
+// Convert the value
+//
+   errno = 0;
+   Val = strtoll(tP, &eP, 10);
+   if (!errno && tP != eP && Val >= 0)
+      {     if (*eP == 'k' || *eP == 'K') {Val *= 1024LL;               eP++;}
+       else if (*eP == 'm' || *eP == 'M') {Val *= 1024LL*1024LL;        eP++;}
+       else if (*eP == 'g' || *eP == 'G') {Val *= 1024LL*1024LL*1024LL; eP++;}
+       if (!(*eP)) {Dest = Val; return;}
+      }
+   cerr <<"XrdPosix: 'XRDPOSIX_PREFETCH=" <<vName <<'=' <<tP
+        <<"' is invalid." <<endl;
+}
+}
+
+bool XrdPosixPrefetch::Init()
+{
+   static const int maxFD = 1048576;
+   struct rlimit rlim;
+   long long Val;
+   char *evar, *tP;
+
+// Prefetching is only done when asked for
+//
+   if (!(evar = getenv("XRDPOSIX_PREFETCH")) || !(*evar)) return false;
+   XrdOucEnv theEnv(evar);
+
+// Get the settings, applying reasonable limits
+//
+   Val = blkNum;    GetVal(theEnv, "blocks",  Val);
+   if (Val > 0 && Val <= blkMax)      blkNum    = static_cast<int>(Val);
+   Val = blkSize;   GetVal(theEnv, "blksz",   Val);
+   if (Val >= 4096 && Val <= segMax*4) blkSize  = Val;
+   Val = maxMem;    GetVal(theEnv, "maxmem",  Val);
+   if (Val >= 0)                      maxMem    = Val;
+   Val = raTrigger; GetVal(theEnv, "trigger", Val);
+   if (Val >= 0 && Val <= 1024)       raTrigger = static_cast<int>(Val);
+   doVRead = !((tP = theEnv.Get("vread")) && *tP == '0');
+
+// Size the file table the same way XrdPosixObject does
+//
+   if (getrlimit(RLIMIT_NOFILE, &rlim)
+   ||  rlim.rlim_max == RLIM_INFINITY || (int)rlim.rlim_max > maxFD)
+      rlim.rlim_max = maxFD;
+   fdTabSz = static_cast<int>(rlim.rlim_max);
+   if (!(fdTab = (XrdPosixPrefetchFile **)calloc(fdTabSz, sizeof(*fdTab))))
+      {fdTabSz = 0; return false;}
+   return true;
+}
+
+/******************************************************************************/
+/*                                  O p e n                                   */
+/******************************************************************************/
+
+void XrdPosixPrefetch::Open(int fd, int oflag)
+{
+   static bool isOn = Init();
+   XrdPosixPrefetchFile *fP;
+   struct stat Stat;
+
+// Only files opened read-only are prefetched as data cannot change under us
+//
+   if (!isOn || !maxMem || fd < 0 || fd >= fdTabSz
+   ||  (oflag & O_ACCMODE) != O_RDONLY
+   ||  XrdPosixXrootd::Fstat(fd, &Stat)) return;
+
+// Add the file to the table
+//
+   fP = new XrdPosixPrefetchFile(fd, Stat.st_size);
+   tabMutex.Lock();
+   if (!fdTab[fd]) {fdTab[fd] = fP; fP = 0;}
+   tabMutex.UnLock();
+   if (fP) delete fP;
+}
+
+/******************************************************************************/
+/*                                 P r e a d                                  */
+/******************************************************************************/
+
+ssize_t XrdPosixPrefetch::Pread(int fd, void *buf, size_t nbyte, off_t offset)
+{
+   XrdPosixPrefetchFile *fP;
+   ssize_t bytes;
+
+   if (!(fP = Get(fd))) return XrdPosixXrootd::Pread(fd, buf, nbyte, offset);
+
+   bytes = fP->Read((char *)buf, nbyte, offset);
+   Put(fP);
+   return bytes;
+}
+
+/******************************************************************************/
+/*                                P r e a d v                                 */
+/******************************************************************************/
+
+ssize_t XrdPosixPrefetch::Preadv(int fd, const struct iovec *iov, int iovcnt,
+                                 off_t offset)
+{
+   XrdPosixPrefetchFile *fP;
+   ssize_t bytes, totbytes = 0;
+   int i;
+
+// Use prefetched data if we have any, else do a vector read if allowed
+//
+   if ((fP = Get(fd)))
+      {bytes = fP->ReadV(iov, iovcnt, offset);
+       Put(fP);
+       return bytes;
+      }
+   if (doVRead && iovcnt > 1) return VRead(fd, iov, iovcnt, offset);
+
+// Read each element in turn
+//
+   for (i = 0; i < iovcnt; i++)
+       {bytes = XrdPosixXrootd::Pread(fd, iov[i].iov_base, iov[i].iov_len,
+                                      offset);
+        if (bytes < 0) return (totbytes ? totbytes : -1);
+        totbytes += bytes; offset += bytes;
+        if (bytes < (ssize_t)iov[i].iov_len) break;
+       }
+   return totbytes;
+}
+
+/******************************************************************************/
+/*                                   P u t                                    */
+/******************************************************************************/
+
+void XrdPosixPrefetch::Put(XrdPosixPrefetchFile *fP)
+{
+   fP->fCV.Lock();
+   if (!(--fP->users)) fP->fCV.Broadcast();
+   fP->fCV.UnLock();
+}
+
+/******************************************************************************/
+/*                                  R e a d                                   */
+/******************************************************************************/
+
+ssize_t XrdPosixPrefetch::Read(int fd, void *buf, size_t nbyte)
+{
+   XrdPosixPrefetchFile *fP;
+   long long offs;
+   ssize_t bytes;
+
+   if (!(fP = Get(fd))) return XrdPosixXrootd::Read(fd, buf, nbyte);
+
+// Reads relative to the file offset must be serialized
+//
+   fP->rdMutex.Lock();
+   if ((offs = XrdPosixXrootd::Lseek(fd, 0, SEEK_CUR)) < 0) bytes = -1;
+      else if ((bytes = fP->Read((char *)buf, nbyte, offs)) > 0)
+              XrdPosixXrootd::Lseek(fd, offs+bytes, SEEK_SET);
+   fP->rdMutex.UnLock();
+   Put(fP);
+   return bytes;
+}
+
+/******************************************************************************/
+/*                                 R e a d v                                  */
+/******************************************************************************/
+
+ssize_t XrdPosixPrefetch::Readv(int fd, const struct iovec *iov, int iovcnt)
+{
+   XrdPosixPrefetchFile *fP;
+   long long offs;
+   ssize_t bytes;
+
+// If there is nothing special to do, do a normal readv()
+//
+   if (!(fP = Get(fd)) && (!doVRead || iovcnt < 2))
+      return XrdPosixXrootd::Readv(fd, iov, iovcnt);
+
+// Use the prefetched data or do a vector read at the current offset
+//
+   if (fP) fP->rdMutex.Lock();
+   if ((offs = XrdPosixXrootd::Lseek(fd, 0, SEEK_CUR)) < 0) bytes = -1;
+      else {bytes = (fP ? fP->ReadV(iov, iovcnt, offs)
+                        : VRead(fd, iov, iovcnt, offs));
+            if (bytes > 0) XrdPosixXrootd::Lseek(fd, offs+bytes, SEEK_SET);
+           }
+   if (fP) {fP->rdMutex.UnLock(); Put(fP);}
+   return bytes;
+}
+
+/******************************************************************************/
+/*                                 V R e a d                                  */
+/******************************************************************************/
+
+// A vector read fails unless every element can be fully read. So, elements
+// are clipped at the end of file. Elements are also split to fit the server's
+// limits and sent in as few requests as possible.
+//
+namespace
+{
+ssize_t Issue(int fd, XrdOucIOVec *readV, int n)
+{
+   if (n == 1) return XrdPosixXrootd::Pread(fd, readV[0].data, readV[0].size,
+                                                readV[0].offset);
+   return XrdPosixXrootd::VRead(fd, readV, n);
+}
+}
+
+ssize_t XrdPosixPrefetch::VRead(int fd, const struct iovec *iov, int iovcnt,
+                                off_t offset)
+{
+   XrdOucIOVec readV[vecMax];
+   struct stat Stat;
+   long long fSize, left, totbytes = 0;
+   ssize_t bytes;
+   char *buff;
+   int i, k = 0, iolen;
+
+// Get the file size
+//
+   if (XrdPosixXrootd::Fstat(fd, &Stat)) return -1;
+   fSize = Stat.st_size;
+
+// Fill out the read vector, issuing it whenever it becomes full
+//
+   for (i = 0; i < iovcnt && offset < fSize; i++)
+       {buff = (char *)iov[i].iov_base;
+        left = static_cast<long long>(iov[i].iov_len);
+        while(left > 0 && offset < fSize)
+             {if (k >= vecMax)
+                 {if ((bytes = Issue(fd, readV, k)) < 0)
+                     return (totbytes ? totbytes : -1);
+                  totbytes += bytes; k = 0;
+                 }
+              iolen = (left > segMax ? segMax : static_cast<int>(left));
+              if (iolen > fSize - offset) iolen = fSize - offset;
+              readV[k].offset = offset; readV[k].size = iolen;
+              readV[k].info   = 0;      readV[k].data = buff;
+              offset += iolen; buff += iolen; left -= iolen; k++;
+             }
+       }
+
+// Issue whatever is left
+//
+   if (k)
+      {if ((bytes = Issue(fd, readV, k)) < 0) return (totbytes ? totbytes : -1);
+       totbytes += bytes;
+      }
+   return totbytes;
+}
@@ -0,0 +1,90 @@
+#ifndef __XRDPOSIXPREFETCH_HH__
+#define __XRDPOSIXPREFETCH_HH__
+/******************************************************************************/
+/*                                                                            */
+/*                   X r d P o s i x P r e f e t c h . h h                    */
+/*                                                                            */
+/* (c) 2015 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                            All Rights Reserved                             */
+/*   Produced by Andrew Hanushevsky for Stanford University under contract    */
+/*              DE-AC02-76-SFO0515 with the Department of Energy              */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include "XrdSys/XrdSysPthread.hh"
+
+class XrdPosixPrefetchFile;
+
+/******************************************************************************/
+/*                X r d P o s i x P r e f e t c h   C l a s s                 */
+/******************************************************************************/
+
+// This class implements the read side of the preload library. Legacy programs
+// typically read files in small chunks and each chunk would otherwise cost a
+// full round trip. When XRDPOSIX_PREFETCH is set, files opened read-only are
+// tracked per file descriptor; once a file is read sequentially the following
+// blocks are fetched asynchronously into a bounded set of buffers. Scattered
+// reads (readv() and preadv()) are converted to a single vector read. All
+// methods must only be called for file descriptors owned by XrdPosixXrootd.
+
+class XrdPosixPrefetch
+{
+public:
+
+// Close() discards any prefetch state associated with a file, waiting for
+//         outstanding prefetches to complete. Call it before closing the file.
+//
+static void    Close(int fd);
+
+// Open()  starts tracking a newly opened file. Only read-only files are
+//         prefetched. The method does nothing unless XRDPOSIX_PREFETCH is set.
+//
+static void    Open(int fd, int oflag);
+
+// The following methods have the same semantics as their POSIX counterparts.
+//
+static ssize_t Pread (int fd, void *buf, size_t nbyte, off_t offset);
+
+static ssize_t Preadv(int fd, const struct iovec *iov, int iovcnt,
+                      off_t offset);
+
+static ssize_t Read  (int fd, void *buf, size_t nbyte);
+
+static ssize_t Readv (int fd, const struct iovec *iov, int iovcnt);
+
+private:
+
+static XrdPosixPrefetchFile *Get(int fd);
+static bool                  Init();
+static void                  Put(XrdPosixPrefetchFile *fP);
+static ssize_t               VRead(int fd, const struct iovec *iov, int iovcnt,
+                                   off_t offset);
+
+static XrdSysMutex           tabMutex;
+static XrdPosixPrefetchFile **fdTab;
+static int                   fdTabSz;
+static bool                  doVRead;
+};
+#endif
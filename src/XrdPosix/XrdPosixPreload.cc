@@ -519,6 +519,22 @@ ssize_t pread64(int fildes, void *buf, size_t nbyte, off_t offset)
 }
 }
 
+/******************************************************************************/
+/*                                p r e a d v                                 */
+/******************************************************************************/
+  
+#ifdef __linux__
+extern "C"
+{
+ssize_t preadv64(int fildes, const struct iovec *iov, int iovcnt, off_t offset)
+{
+   static int Init = Xunix.Init(&Init);
+
+   return XrdPosix_Preadv(fildes, iov, iovcnt, offset);
+}
+}
+#endif
+
 /******************************************************************************/
 /*                                p w r i t e                                 */
 /******************************************************************************/
@@ -367,6 +367,22 @@ ssize_t pread(int fildes, void *buf, size_t nbyte, off_t offset)
 }
 #endif
 
+/******************************************************************************/
+/*                                p r e a d v                                 */
+/******************************************************************************/
+  
+#ifdef __linux__
+extern "C"
+{
+ssize_t preadv(int fildes, const struct iovec *iov, int iovcnt, off_t offset)
+{
+   static int Init = Xunix.Init(&Init);
+
+   return XrdPosix_Preadv(fildes, iov, iovcnt, offset);
+}
+}
+#endif
+
 /******************************************************************************/
 /*                               r e a d d i r                                */
 /******************************************************************************/
@@ -148,7 +148,13 @@ int XrdPosixXrootd::Close(int fildes)
    if (!(fP = XrdPosixObject::ReleaseFile(fildes)))
       {errno = EBADF; return -1;}
 
-   if (fP->XCio->ioActive())
+// A cache may write behind to the origin. Flush it so that the data is at the
+// origin when close returns and any write error is reported here.
+//
+   int syncRC = 0;
+   if (fP->XCio != (XrdOucCacheIO *)fP && fP->XCio->Sync() < 0) syncRC = errno;
+
+   if (fP->XCio->ioActive() || fP->Refs())
    {
       if (XrdPosixGlobals::schedP )
       {
@@ -158,12 +164,14 @@ int XrdPosixXrootd::Close(int fildes)
          pthread_t tid;
          XrdSysThread::Run(&tid, XrdPosixFile::DelayedDestroy, fP, 0, "PosixFileDestroy");
       }
+      if (syncRC) {errno = syncRC; return -1;}
       return 0;
    }
    else
    {
       ret = fP->Close(Status);
       delete fP;
+      if (syncRC) {errno = syncRC; return -1;}
       return (ret ? 0 : XrdPosixMap::Result(Status));
    }
 }
@@ -273,6 +281,24 @@ int XrdPosixXrootd::Fsync(int fildes)
    return 0;
 }
   
+/******************************************************************************/
+/*                                 F s y n c                                  */
+/******************************************************************************/
+  
+void XrdPosixXrootd::Fsync(int fildes, XrdPosixCallBackIO *cbp)
+{
+   XrdPosixFile *fp;
+
+// Find the file object
+//
+   if (!(fp = XrdPosixObject::File(fildes))) {cbp->Done(-errno); return;}
+
+// Start the sync
+//
+   fp->Sync(cbp);
+   fp->UnLock();
+}
+  
 /******************************************************************************/
 /*                             F t r u n c a t e                              */
 /******************************************************************************/
@@ -525,6 +551,37 @@ ssize_t XrdPosixXrootd::Pread(int fildes, void *buf, size_t nbyte, off_t offset)
    return (ssize_t)bytes;
 }
 
+/******************************************************************************/
+/*                                 P r e a d                                  */
+/******************************************************************************/
+  
+void XrdPosixXrootd::Pread(int fildes, void *buf, size_t nbyte, off_t offset,
+                           XrdPosixCallBackIO *cbp)
+{
+   XrdPosixFile *fp;
+   long long     offs;
+   int           iosz;
+
+// Find the file object
+//
+   if (!(fp = XrdPosixObject::File(fildes))) {cbp->Done(-errno); return;}
+
+// Make sure the size is not too large
+//
+   if (nbyte > (size_t)0x7fffffff)
+      {fp->UnLock();
+       cbp->Done(-EOVERFLOW);
+       return;
+      }
+
+// Start the read
+//
+   offs = static_cast<long long>(offset);
+   iosz = static_cast<int>(nbyte);
+   fp->Read(cbp, (char *)buf, offs, iosz);
+   fp->UnLock();
+}
+
 /******************************************************************************/
 /*                                P w r i t e                                 */
 /******************************************************************************/
@@ -557,6 +614,37 @@ ssize_t XrdPosixXrootd::Pwrite(int fildes, const void *buf, size_t nbyte, off_t
    return (ssize_t)iosz;
 }
 
+/******************************************************************************/
+/*                                P w r i t e                                 */
+/******************************************************************************/
+  
+void XrdPosixXrootd::Pwrite(int fildes, const void *buf, size_t nbyte,
+                            off_t offset, XrdPosixCallBackIO *cbp)
+{
+   XrdPosixFile *fp;
+   long long     offs;
+   int           iosz;
+
+// Find the file object
+//
+   if (!(fp = XrdPosixObject::File(fildes))) {cbp->Done(-errno); return;}
+
+// Make sure the size is not too large
+//
+   if (nbyte > (size_t)0x7fffffff)
+      {fp->UnLock();
+       cbp->Done(-EOVERFLOW);
+       return;
+      }
+
+// Start the write
+//
+   offs = static_cast<long long>(offset);
+   iosz = static_cast<int>(nbyte);
+   fp->Write(cbp, (char *)buf, offs, iosz);
+   fp->UnLock();
+}
+
 /******************************************************************************/
 /*                                  R e a d                                   */
 /******************************************************************************/
@@ -634,6 +722,25 @@ ssize_t XrdPosixXrootd::VRead(int fildes, const XrdOucIOVec *readV, int n)
    return bytes;
 }
 
+/******************************************************************************/
+/*                                 V R e a d                                  */
+/******************************************************************************/
+
+void XrdPosixXrootd::VRead(int fildes, const XrdOucIOVec *readV, int n,
+                           XrdPosixCallBackIO *cbp)
+{
+   XrdPosixFile *fp;
+
+// Find the file object
+//
+   if (!(fp = XrdPosixObject::File(fildes))) {cbp->Done(-errno); return;}
+
+// Start the read
+//
+   fp->ReadV(cbp, readV, n);
+   fp->UnLock();
+}
+
 /******************************************************************************/
 /*                                R e a d d i r                               */
 /******************************************************************************/
@@ -1100,6 +1207,7 @@ void XrdPosixXrootd::initEnv()
 // max2cache=n - maximum read to cache          (can be suffized in k, m, g).
 // maxfiles=n  - maximum number of files to support.
 // mode={c|s}  - running as a client (default) or server.
+// opthp=1     - allocate cache memory from huge pages when possible
 // optlg=1     - log statistics
 // optpr=1     - enable pre-reads
 // optsf=<val> - optimize structured file: 1 = all, 0 = off, .<sfx> specific
@@ -1156,6 +1264,8 @@ void XrdPosixXrootd::initEnv(char *eData)
 
 // Get final options, any non-zero value will do here
 //
+   if ((tP = theEnv.Get("opthp")) && *tP && *tP != '0')
+      myParms.Options |= XrdOucCache::hugePages;
    if ((tP = theEnv.Get("optlg")) && *tP && *tP != '0')
       myParms.Options |= XrdOucCache::logStats;
    if ((tP = theEnv.Get("optpr")) && *tP && *tP != '0')
@@ -53,6 +53,7 @@ class XrdScheduler;
 class XrdOucCache;
 class XrdOucEnv;
 class XrdPosixCallBack;
+class XrdPosixCallBackIO;
 class XrdPosixFile;
 
 //-----------------------------------------------------------------------------
@@ -106,6 +107,16 @@ static int     Fstat(int fildes, struct stat *buf);
 
 static int     Fsync(int fildes);
 
+//-----------------------------------------------------------------------------
+//! Fsync() is a POSIX extension that asynchronously syncs a file.
+//!
+//! @param  fildes the file descriptor of an open file.
+//! @param  cbp    the callback object whose Done() method is invoked with the
+//!                result (see XrdPosixCallBack.hh).
+//-----------------------------------------------------------------------------
+
+static void    Fsync(int fildes, XrdPosixCallBackIO *cbp);
+
 //-----------------------------------------------------------------------------
 //! Ftruncate() conforms to POSIX.1-2001 ftruncate()
 //-----------------------------------------------------------------------------
@@ -175,12 +186,42 @@ static DIR*    Opendir(const char *path);
   
 static ssize_t Pread(int fildes, void *buf, size_t nbyte, off_t offset);
 
+//-----------------------------------------------------------------------------
+//! Pread() is a POSIX extension that asynchronously reads from a file.
+//!
+//! @param  fildes the file descriptor of an open file.
+//! @param  buf    the buffer to receive the data; it must remain valid until
+//!                the callback is invoked.
+//! @param  nbyte  the number of bytes to read.
+//! @param  offset the offset at which to start reading.
+//! @param  cbp    the callback object whose Done() method is invoked with the
+//!                result (see XrdPosixCallBack.hh).
+//-----------------------------------------------------------------------------
+
+static void    Pread(int fildes, void *buf, size_t nbyte, off_t offset,
+                     XrdPosixCallBackIO *cbp);
+
 //-----------------------------------------------------------------------------
 //! Pwrite() conforms to POSIX.1-2001 pwrite()
 //-----------------------------------------------------------------------------
 
 static ssize_t Pwrite(int fildes, const void *buf, size_t nbyte, off_t offset);
 
+//-----------------------------------------------------------------------------
+//! Pwrite() is a POSIX extension that asynchronously writes to a file.
+//!
+//! @param  fildes the file descriptor of an open file.
+//! @param  buf    the buffer holding the data; it must remain valid until
+//!                the callback is invoked.
+//! @param  nbyte  the number of bytes to write.
+//! @param  offset the offset at which to start writing.
+//! @param  cbp    the callback object whose Done() method is invoked with the
+//!                result (see XrdPosixCallBack.hh).
+//-----------------------------------------------------------------------------
+
+static void    Pwrite(int fildes, const void *buf, size_t nbyte, off_t offset,
+                      XrdPosixCallBackIO *cbp);
+
 //-----------------------------------------------------------------------------
 //! QueryChksum() is a POSIX extension and returns a file's modification time
 //! and its associated checksum value.
@@ -317,6 +358,21 @@ static int     Unlink(const char *path);
 
 static ssize_t VRead(int fildes, const XrdOucIOVec *readV, int n);
 
+//-----------------------------------------------------------------------------
+//! VRead() is a POSIX extension that asynchronously reads multiple chunks.
+//!
+//! @param  fildes the file descriptor of an open file.
+//! @param  readV  pointer to the array of read requests; the data buffers
+//!                must remain valid until the callback is invoked but the
+//!                array itself may be reused as soon as VRead() returns.
+//! @param  n      the number of elements in the array.
+//! @param  cbp    the callback object whose Done() method is invoked with the
+//!                result (see XrdPosixCallBack.hh).
+//-----------------------------------------------------------------------------
+
+static void    VRead(int fildes, const XrdOucIOVec *readV, int n,
+                     XrdPosixCallBackIO *cbp);
+
 //-----------------------------------------------------------------------------
 //! Write() conforms to POSIX.1-2001 write()
 //-----------------------------------------------------------------------------
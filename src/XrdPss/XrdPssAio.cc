@@ -31,14 +31,15 @@
 #include <stdio.h>
 #include <unistd.h>
 
+#include "XrdOss/XrdOssError.hh"
+#include "XrdPosix/XrdPosixXrootd.hh"
 #include "XrdPss/XrdPss.hh"
+#include "XrdPss/XrdPssAioCB.hh"
 #include "XrdSfs/XrdSfsAio.hh"
 
-// All AIO interfaces are defined here.
- 
-
-// Currently we disable aio support for proxies because the client does not
-// support async reads and writes. It should to make proxy I/O more scalable.
+// All AIO interfaces are defined here. Requests are passed to the client as
+// asynchronous requests and complete on one of the client's response threads
+// so that no xrootd thread waits for the remote server to respond.
 
 /******************************************************************************/
 /*                                 F s y n c                                  */
@@ -53,13 +54,13 @@
 int XrdPssFile::Fsync(XrdSfsAio *aiop)
 {
 
-// Execute this request in a synchronous fashion
+// Complain if the file is not open
 //
-   if ((aiop->Result = Fsync())) aiop->Result = -errno;
+   if (fd < 0) return -XRDOSS_E8004;
 
-// Simply call the write completion routine and return as if all went well
+// Start the sync. The callback will invoke the completion routine.
 //
-   aiop->doneWrite();
+   XrdPosixXrootd::Fsync(fd, XrdPssAioCB::Alloc(aiop, true));
    return 0;
 }
 
@@ -81,15 +82,16 @@ int XrdPssFile::Fsync(XrdSfsAio *aiop)
 int XrdPssFile::Read(XrdSfsAio *aiop)
 {
 
-// Execute this request in a synchronous fashion
+// Complain if the file is not open
 //
-   aiop->Result = this->Read((void *)aiop->sfsAio.aio_buf,
-                              (off_t)aiop->sfsAio.aio_offset,
-                             (size_t)aiop->sfsAio.aio_nbytes);
+   if (fd < 0) return -XRDOSS_E8004;
 
-// Simple call the read completion routine and return as if all went well
+// Start the read. The callback will invoke the completion routine.
 //
-   aiop->doneRead();
+   XrdPosixXrootd::Pread(fd, (void *)aiop->sfsAio.aio_buf,
+                            (size_t)aiop->sfsAio.aio_nbytes,
+                             (off_t)aiop->sfsAio.aio_offset,
+                         XrdPssAioCB::Alloc(aiop, false));
    return 0;
 }
 
@@ -111,14 +113,15 @@ int XrdPssFile::Read(XrdSfsAio *aiop)
 int XrdPssFile::Write(XrdSfsAio *aiop)
 {
 
-// Execute this request in a synchronous fashion
+// Complain if the file is not open
 //
-   aiop->Result = this->Write((const void *)aiop->sfsAio.aio_buf,
-                                     (off_t)aiop->sfsAio.aio_offset,
-                                    (size_t)aiop->sfsAio.aio_nbytes);
+   if (fd < 0) return -XRDOSS_E8004;
 
-// Simply call the write completion routine and return as if all went well
+// Start the write. The callback will invoke the completion routine.
 //
-   aiop->doneWrite();
+   XrdPosixXrootd::Pwrite(fd, (const void *)aiop->sfsAio.aio_buf,
+                                   (size_t)aiop->sfsAio.aio_nbytes,
+                                    (off_t)aiop->sfsAio.aio_offset,
+                          XrdPssAioCB::Alloc(aiop, true));
    return 0;
 }
@@ -201,10 +201,6 @@ int XrdPssSys::Configure(const char *cfn)
        return 1;
       }
 
-// Tell xrootd to disable async I/O as it just will slow everything down.
-//
-   XrdOucEnv::Export("XRDXROOTD_NOAIO", "1");
-
 // Thell xrootd to disable POSC mode as this is meaningless here
 //
    XrdOucEnv::Export("XRDXROOTD_NOPOSC", "1");
@@ -213,6 +209,11 @@ int XrdPssSys::Configure(const char *cfn)
 //
    if (cPath && !getCache()) return 1;
 
+// Tell xrootd to disable async I/O when a cache is being used as the cache is
+// synchronous and async I/O would just slow everything down.
+//
+   if (cPath) XrdOucEnv::Export("XRDXROOTD_NOAIO", "1");
+
 // Allocate an Xroot proxy object (only one needed here). Tell it to not
 // shadow open files with real file descriptors (we will be honest). This can
 // be done before we initialize the ffs.
@@ -469,6 +470,7 @@ int XrdPssSys::getCache()
 
              <keyword> is one of the following:
              debug     {0 | 1 | 2}
+             hugepages allocate cache memory from huge pages when possible.
              logstats  enables stats logging
              max2cache largest read to cache   (can be suffixed with k, m, g).
              mode      {r | w}
@@ -486,6 +488,7 @@ int XrdPssSys::xcach(XrdSysError *Eroute, XrdOucStream &Config)
    long long llVal, cSize=-1, m2Cache=-1, pSize=-1;
    const char *ivN = 0;
    char  *val, *sfSfx = 0, sfVal = '0', lgVal = '0', dbVal = '0', rwVal = '0';
+   char   hpVal = '0';
    char eBuff[2048], pBuff[1024], *eP;
    struct sztab {const char *Key; long long *Val;} szopts[] =
                {{"max2cache", &m2Cache},
@@ -512,6 +515,7 @@ do{for (i = 0; i < numopts; i++) if (!strcmp(szopts[i].Key, val)) break;
                 || ((*val < '0' || *val > '3') && !*(val+1))) ivN = "debug";
                    else dbVal = *val;
                }
+       else if (!strcmp("hugepages", val)) hpVal = '1';
        else if (!strcmp("logstats", val)) lgVal = '1';
        else if (!strcmp("preread", val))
                {if ((val = xcapr(Eroute, Config, pBuff))) continue;
@@ -544,6 +548,7 @@ do{for (i = 0; i < numopts; i++) if (!strcmp(szopts[i].Key, val)) break;
    if (dbVal != '0') eP += sprintf(eP, "&debug=%c", dbVal);
    if (m2Cache > 0)  eP += sprintf(eP, "&max2cache=%lld", m2Cache);
    if (pSize > 0)    eP += sprintf(eP, "&pagesz=%lld", pSize);
+   if (hpVal != '0') strcat(eP, "&opthp=1");
    if (lgVal != '0') strcat(eP, "&optlg=1");
    if (sfVal != '0' || sfSfx)
       {if (!sfSfx)   strcat(eP, "&optsf=1");
@@ -28,9 +28,11 @@ add_library(
   XrdXrootd/XrdXrootdFileLock1.cc       XrdXrootd/XrdXrootdFileLock1.hh
                                         XrdXrootd/XrdXrootdFileStats.hh
   XrdXrootd/XrdXrootdJob.cc             XrdXrootd/XrdXrootdJob.hh
+  XrdXrootd/XrdXrootdLatency.cc         XrdXrootd/XrdXrootdLatency.hh
   XrdXrootd/XrdXrootdLoadLib.cc
                                         XrdXrootd/XrdXrootdMonData.hh
   XrdXrootd/XrdXrootdMonFile.cc         XrdXrootd/XrdXrootdMonFile.hh
+                                        XrdXrootd/XrdXrootdMonPack.hh
   XrdXrootd/XrdXrootdMonFMap.cc         XrdXrootd/XrdXrootdMonFMap.hh
   XrdXrootd/XrdXrootdMonitor.cc         XrdXrootd/XrdXrootdMonitor.hh
 
@@ -170,11 +170,15 @@ FileSystem::Configure(XrdSysError & log, XrdSfsFileSystem *native_fs)
 
 /* Function: xthrottle
 
-   Purpose:  To parse the directive: throttle [data <drate>] [iops <irate>] [concurrency <climit>] [interval <rint>]
+   Purpose:  To parse the directive: throttle [data <drate>] [iops <irate>] [concurrency <climit>] [adaptive] [interval <rint>]
 
              <drate>    maximum bytes per second through the server.
              <irate>    maximum IOPS per second through the server.
              <climit>   maximum number of concurrent IO connections.
+             adaptive   lower the concurrency limit, down to 1, when the IO
+                        latency rises and raise it back, up to <climit>, when
+                        it recovers. Load shedding is then only triggered by
+                        running into this limit.
              <rint>     minimum interval in milliseconds between throttle re-computing.
 
    Output: 0 upon success or !0 upon failure.
@@ -183,6 +187,7 @@ int
 FileSystem::xthrottle(XrdOucStream &Config)
 {
     long long drate = -1, irate = -1, rint = 1000, climit = -1;
+    bool adaptive = false;
     char *val;
 
     while ((val = Config.GetWord()))
@@ -211,13 +216,20 @@ FileSystem::xthrottle(XrdOucStream &Config)
              {m_eroute.Emsg("Config", "Concurrency limit not specified."); return 1;}
           if (XrdOuca2x::a2sz(m_eroute,"Concurrency limit value",val,&climit,1)) return 1;
        }
+       else if (strcmp("adaptive", val) == 0)
+       {
+          adaptive = true;
+       }
        else
        {
           m_eroute.Emsg("Config", "Warning - unknown throttle option specified", val, ".");
        }
     }
 
-    m_throttle.SetThrottles(drate, irate, climit, static_cast<float>(rint)/1000.0);
+    if (adaptive && climit < 0)
+       {m_eroute.Emsg("Config", "adaptive throttle requires a concurrency limit."); return 1;}
+
+    m_throttle.SetThrottles(drate, irate, climit, static_cast<float>(rint)/1000.0, adaptive);
     return 0;
 }
 
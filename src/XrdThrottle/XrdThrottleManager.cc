@@ -1,6 +1,9 @@
 
 #include "XrdThrottleManager.hh"
 
+#include <math.h>
+#include <sys/time.h>
+
 #include "XrdSys/XrdSysAtomics.hh"
 #include "XrdSys/XrdSysTimer.hh"
 
@@ -15,6 +18,9 @@ XrdThrottleManager::TraceID = "ThrottleManager";
 const
 int XrdThrottleManager::m_max_users = 1024;
 
+const
+int XrdThrottleManager::m_delay_bins = 24;
+
 #if defined(__linux__)
 int clock_id;
 int XrdThrottleTimer::clock_id = clock_getcpuclockid(0, &clock_id) != ENOENT ? CLOCK_THREAD_CPUTIME_ID : CLOCK_MONOTONIC;
@@ -29,7 +35,17 @@ XrdThrottleManager::XrdThrottleManager(XrdSysError *lP, XrdOucTrace *tP) :
    m_bytes_per_second(-1),
    m_ops_per_second(-1),
    m_concurrency_limit(-1),
+   m_adaptive(false),
+   m_concurrency_max(-1),
+   m_concurrency_hit(0),
+   m_io_peak(0),
+   m_limit_smooth(0),
+   m_lat_baseline(0),
+   m_lat_count(0),
+   m_lat_sum(0),
    m_last_round_allocation(100*1024),
+   m_last_round_ops(10),
+   m_pace_steps(1),
    m_io_counter(0),
    m_loadshed_host(""),
    m_loadshed_port(0),
@@ -44,19 +60,25 @@ void
 XrdThrottleManager::Init()
 {
    TRACE(DEBUG, "Initializing the throttle manager.");
-   // Initialize all our shares to zero.
-   m_primary_bytes_shares.reserve(m_max_users);
-   m_secondary_bytes_shares.reserve(m_max_users);
-   m_primary_ops_shares.reserve(m_max_users);
-   m_secondary_ops_shares.reserve(m_max_users);
    // Allocate each user 100KB and 10 ops to bootstrap;
-   for (int i=0; i<m_max_users; i++)
-   {
-      m_primary_bytes_shares[i] = m_last_round_allocation;
-      m_secondary_bytes_shares[i] = 0;
-      m_primary_ops_shares[i] = 10;
-      m_secondary_ops_shares[i] = 0;
-   }
+   m_bytes_tokens.assign(m_max_users, m_last_round_allocation);
+   m_ops_tokens.assign(m_max_users, m_last_round_ops);
+   m_bytes_credit.assign(m_max_users, 0);
+   m_ops_credit.assign(m_max_users, 0);
+   m_waiters.assign(m_max_users, 0);
+   m_active.assign(m_max_users, 0);
+   m_delay_hist.assign(m_max_users*m_delay_bins, 0);
+   m_lat_hist.assign(m_delay_bins, 0);
+   // An adaptive limit starts low so the first latencies we see are those
+   // of an unloaded backend; it then grows as long as they hold.
+   if (m_adaptive && m_concurrency_limit > 16) m_concurrency_limit = 16;
+   m_limit_smooth = m_concurrency_limit;
+
+   // Refill the buckets ten times per interval, but not more than every 10ms.
+   int interval_ms = static_cast<int>(1000*m_interval_length_seconds);
+   m_pace_steps = interval_ms / 10;
+   if (m_pace_steps > 10) m_pace_steps = 10;
+   if (m_pace_steps < 1) m_pace_steps = 1;
 
    m_io_wait.tv_sec = 0;
    m_io_wait.tv_nsec = 0;
@@ -69,44 +91,50 @@ XrdThrottleManager::Init()
 }
 
 /*
- * Take as many shares as possible to fulfill the request; update
- * request with current remaining value, or zero if satisfied.
+ * Take the request out of a token bucket.  Returns zero if there were
+ * enough tokens; otherwise, the request is left owing and we return the
+ * credit level that the user must reach before it has been paid for.
+ * Requests borrowing from the same bucket are thus served in order.
  */
-inline void
-XrdThrottleManager::GetShares(int &shares, int &request)
+long long
+XrdThrottleManager::Borrow(int &tokens, long long &credit, int request)
 {
-   int remaining;
-   AtomicFSub(remaining, shares, request);
-   if (remaining > 0)
-   {
-      request -= (remaining < request) ? remaining : request;
-   }
+   int before;
+   long long owed;
+   AtomicBeg(m_compute_var);
+   AtomicFSub(before, tokens, request);
+   owed = AtomicGet(credit);
+   AtomicEnd(m_compute_var);
+   if (before >= request) return 0;
+   return owed + request - before;
 }
 
 /*
- * Iterate through all of the secondary shares, attempting 
- * to steal enough to fulfill the request.
+ * Credit a user's bucket with up to amount tokens without exceeding cap.
+ * Returns the number of tokens that did not fit.
  */
-void
-XrdThrottleManager::StealShares(int uid, int &reqsize, int &reqops)
+int
+XrdThrottleManager::Credit(int &tokens, long long &credit, int amount, int cap)
 {
-   if (!reqsize && !reqops) return;
-   TRACE(BANDWIDTH, "Stealing shares to fill request of " << reqsize << " bytes");
-   TRACE(IOPS, "Stealing shares to fill request of " << reqops << " ops.");
-
-   for (int i=uid+1; i % m_max_users == uid; i++)
+   AtomicBeg(m_compute_var);
+   int cur = AtomicGet(tokens);
+   int add = (cur >= cap) ? 0 : ((amount > cap - cur) ? cap - cur : amount);
+   if (add)
    {
-      if (reqsize) GetShares(m_secondary_bytes_shares[i % m_max_users], reqsize);
-      if (reqops)  GetShares(m_secondary_ops_shares[  i % m_max_users], reqops);
+      AtomicAdd(tokens, add);
+      AtomicAdd(credit, add);
    }
-
-   TRACE(BANDWIDTH, "After stealing shares, " << reqsize << " of request bytes remain.");
-   TRACE(IOPS, "After stealing shares, " << reqops << " of request ops remain.");
+   AtomicEnd(m_compute_var);
+   return amount - add;
 }
 
 /*
  * Apply the throttle.  If there are no limits set, returns immediately.  Otherwise,
  * this applies the limits as best possible, stalling the thread if necessary.
+ *
+ * The fast path is a single atomic subtraction per limit; only requests that
+ * exceed their user's tokens wait, and they are released as soon as a refill
+ * covers them rather than at the next interval.
  */
 void
 XrdThrottleManager::Apply(int reqsize, int reqops, int uid)
@@ -115,40 +143,51 @@ XrdThrottleManager::Apply(int reqsize, int reqops, int uid)
       reqsize = 0;
    if (m_ops_per_second < 0)
       reqops = 0;
-   while (reqsize || reqops)
+   if (!reqsize && !reqops) return;
+
+   if (unlikely(!m_active[uid])) m_active[uid] = 1;
+
+   long long bytes_owed = reqsize ? Borrow(m_bytes_tokens[uid], m_bytes_credit[uid], reqsize) : 0;
+   long long ops_owed   = reqops  ? Borrow(m_ops_tokens[uid],   m_ops_credit[uid],   reqops)  : 0;
+   if (likely(!bytes_owed && !ops_owed))
+   {
+      RecordDelay(uid, 0);
+      return;
+   }
+
+   struct timeval start, end;
+   gettimeofday(&start, 0);
+   AtomicBeg(m_compute_var);
+   AtomicInc(m_waiters[uid]);
+   AtomicEnd(m_compute_var);
+   while ((bytes_owed && AtomicGet(m_bytes_credit[uid]) < bytes_owed) ||
+          (ops_owed   && AtomicGet(m_ops_credit[uid])   < ops_owed))
    {
-      // Subtract the requested out of the shares
+      if (bytes_owed) TRACE(BANDWIDTH, "Sleeping to wait for throttle fairshare.");
+      if (ops_owed) TRACE(IOPS, "Sleeping to wait for throttle fairshare.");
+      m_compute_var.Wait();
       AtomicBeg(m_compute_var);
-      GetShares(m_primary_bytes_shares[uid], reqsize);
-      if (reqsize)
-      {
-         TRACE(BANDWIDTH, "Using secondary shares; request has " << reqsize << " bytes left.");
-         GetShares(m_secondary_bytes_shares[uid], reqsize);
-         TRACE(BANDWIDTH, "Finished with secondary shares; request has " << reqsize << " bytes left.");
-      }
-      else
-      {
-         TRACE(BANDWIDTH, "Filled byte shares out of primary; " << m_primary_bytes_shares[uid] << " left.");
-      }
-      GetShares(m_primary_ops_shares[uid], reqops);
-      if (reqops)
-      {
-         GetShares(m_secondary_ops_shares[uid], reqops);
-      }
-      StealShares(uid, reqsize, reqops);
+      AtomicInc(m_loadshed_limit_hit);
       AtomicEnd(m_compute_var);
-
-      if (reqsize || reqops)
-      {
-         if (reqsize) TRACE(BANDWIDTH, "Sleeping to wait for throttle fairshare.");
-         if (reqops) TRACE(IOPS, "Sleeping to wait for throttle fairshare.");
-         m_compute_var.Wait();
-         AtomicBeg(m_compute_var);
-         AtomicInc(m_loadshed_limit_hit);
-         AtomicEnd(m_compute_var);
-      }
    }
+   AtomicBeg(m_compute_var);
+   AtomicDec(m_waiters[uid]);
+   AtomicEnd(m_compute_var);
+   gettimeofday(&end, 0);
+   RecordDelay(uid, (end.tv_sec-start.tv_sec)*1000000LL + (end.tv_usec-start.tv_usec));
+}
 
+/*
+ * Add a queue delay sample to the user's histogram.
+ */
+void
+XrdThrottleManager::RecordDelay(int uid, long long usecs)
+{
+   int bin = 0;
+   while (usecs > 0 && bin < m_delay_bins-1) {usecs >>= 1; bin++;}
+   AtomicBeg(m_compute_var);
+   AtomicInc(m_delay_hist[uid*m_delay_bins+bin]);
+   AtomicEnd(m_compute_var);
 }
 
 void *
@@ -162,31 +201,98 @@ XrdThrottleManager::RecomputeBootstrap(void *instance)
 void
 XrdThrottleManager::Recompute()
 {
+   int step = 0;
    while (1)
    {
-      TRACE(DEBUG, "Recomputing fairshares for throttle.");
-      RecomputeInternal();
-      TRACE(DEBUG, "Finished recomputing fairshares for throttle; sleeping for " << m_interval_length_seconds << " seconds.");
-      XrdSysTimer::Wait(static_cast<int>(1000*m_interval_length_seconds));
+      if (++step >= m_pace_steps)
+      {
+         step = 0;
+         TRACE(DEBUG, "Recomputing fairshares for throttle.");
+         RecomputeInternal();
+         TRACE(DEBUG, "Finished recomputing fairshares for throttle; sleeping for " << m_interval_length_seconds << " seconds.");
+      }
+      Refill();
+      m_compute_var.Broadcast();
+      XrdSysTimer::Wait(static_cast<int>(1000*m_interval_length_seconds/m_pace_steps));
    }
 }
 
 /*
- * The heart of the manager approach.
- *
- * This routine periodically recomputes the shares of each current user.
- * Each user has a "primary" and a "secondary" share.  At the end of the
- * each time interval, the remaining primary share is moved to secondary.
- * A user can utilize both shares; if both are gone, they must block until
- * the next recompute interval.
+ * Refill the token buckets for one pacing step.
  *
- * The secondary share can be "stolen" by any other user; so, if a user
- * is idle or under-utilizing, their share can be used by someone else.
- * However, they can never be completely starved, as no one can steal
- * primary share.
+ * Every active user that is not sitting on a full bucket gets an equal
+ * quantum of this step's tokens, up to its cap; idle users keep what they
+ * have.  Whatever does not fit (because
+ * a user is idle or under-utilizing) is then dealt round-robin to the
+ * users that have requests waiting, deficit round robin style; the
+ * starting user rotates so that remainders are spread evenly.
+ */
+void
+XrdThrottleManager::Refill()
+{
+   static int next_uid = 0;
+   float step_seconds = m_interval_length_seconds / m_pace_steps;
+   int bytes_step = (m_bytes_per_second > 0) ? static_cast<int>(m_bytes_per_second * step_seconds) : 0;
+   int ops_step   = (m_ops_per_second > 0)   ? static_cast<int>(m_ops_per_second * step_seconds) : 0;
+   if (!bytes_step && !ops_step) return;
+
+   int hungry = 0, waiting = 0;
+   std::vector<int> fill;
+   for (int i=0; i<m_max_users; i++)
+   {
+      int waiters = AtomicGet(m_waiters[i]);
+      if (waiters) waiting++;
+      if ((waiters || m_active[i]) &&
+          (m_bytes_tokens[i] < m_last_round_allocation || m_ops_tokens[i] < m_last_round_ops))
+      {
+         fill.push_back(i);
+         hungry++;
+      }
+   }
+   if (!hungry) return;
+
+   int bytes_quantum = bytes_step / hungry, ops_quantum = ops_step / hungry;
+   int bytes_left = bytes_step - bytes_quantum*hungry, ops_left = ops_step - ops_quantum*hungry;
+   for (int j=0; j<hungry; j++)
+   {
+      int i = fill[j];
+      if (bytes_quantum) bytes_left += Credit(m_bytes_tokens[i], m_bytes_credit[i], bytes_quantum, m_last_round_allocation);
+      if (ops_quantum)   ops_left   += Credit(m_ops_tokens[i],   m_ops_credit[i],   ops_quantum,   m_last_round_ops);
+   }
+
+   // Hand the leftovers to the waiting users.
+   if (!waiting || (!bytes_left && !ops_left)) return;
+   int bytes_extra = bytes_left / waiting + 1, ops_extra = ops_left / waiting + 1;
+   for (int j=0; j<m_max_users && (bytes_left > 0 || ops_left > 0); j++)
+   {
+      int i = (next_uid + j) % m_max_users;
+      if (!AtomicGet(m_waiters[i])) continue;
+      if (bytes_left > 0)
+      {
+         int amt = (bytes_extra < bytes_left) ? bytes_extra : bytes_left;
+         bytes_left -= amt - Credit(m_bytes_tokens[i], m_bytes_credit[i], amt, m_last_round_allocation);
+      }
+      if (ops_left > 0)
+      {
+         int amt = (ops_extra < ops_left) ? ops_extra : ops_left;
+         ops_left -= amt - Credit(m_ops_tokens[i], m_ops_credit[i], amt, m_last_round_ops);
+      }
+   }
+   next_uid = (next_uid + 1) % m_max_users;
+}
+
+/*
+ * The heart of the manager approach.
  *
- * In this way, we violate the throttle for an interval, but never starve.
+ * Once per interval, this routine recomputes the bucket size of each
+ * user, that is, the most a user can save up while idle or burst once it
+ * becomes active.  This is an even split of one interval's worth of the
+ * throttle among the users active during the last interval.  The refills
+ * themselves happen in Refill(), several times per interval, so waiting
+ * requests are paced out smoothly instead of all at interval boundaries.
  *
+ * A new user starts with a full bucket; in this way, we may violate the
+ * throttle by one bucket, but never starve anyone.
  */
 void
 XrdThrottleManager::RecomputeInternal()
@@ -196,23 +302,15 @@ XrdThrottleManager::RecomputeInternal()
    float total_bytes_shares = m_bytes_per_second / intervals_per_second;
    float total_ops_shares   = m_ops_per_second / intervals_per_second;
 
-   // Compute the number of active users; a user is active if they used
-   // any primary share during the last interval;
-   AtomicBeg(m_compute_var);
+   // Compute the number of active users; a user is active if they did
+   // any IO during the last interval or are waiting to;
    float active_users = 0;
-   long bytes_used = 0;
    for (int i=0; i<m_max_users; i++)
    {
-      int primary = AtomicFAZ(m_primary_bytes_shares[i]);
-      if (primary != m_last_round_allocation)
+      if (m_active[i] || AtomicGet(m_waiters[i]))
       {
          active_users++;
-         if (primary >= 0)
-            m_secondary_bytes_shares[i] = primary;
-         primary = AtomicFAZ(m_primary_ops_shares[i]);
-         if (primary >= 0)
-             m_secondary_ops_shares[i] = primary;
-         bytes_used += (primary < 0) ? m_last_round_allocation : (m_last_round_allocation-primary);
+         m_active[i] = 0;
       }
    }
 
@@ -221,24 +319,50 @@ XrdThrottleManager::RecomputeInternal()
       active_users++;
    }
 
-   // Note we allocate the same number of shares to *all* users, not
-   // just the active ones.  If a new user becomes active in the next
-   // interval, we'll go over our bandwidth budget just a bit.
-   m_last_round_allocation = static_cast<int>(total_bytes_shares / active_users);
-   int ops_shares = static_cast<int>(total_ops_shares / active_users);
-   TRACE(BANDWIDTH, "Round byte allocation " << m_last_round_allocation << " ; last round used " << bytes_used << ".");
-   TRACE(IOPS, "Round ops allocation " << ops_shares);
-   for (int i=0; i<m_max_users; i++)
-   {
-      m_primary_bytes_shares[i] = m_last_round_allocation;
-      m_primary_ops_shares[i] = ops_shares;
-   }
+   // Note the bucket size is the same for *all* users, not just the
+   // active ones.  If a new user becomes active in the next interval,
+   // we'll go over our bandwidth budget just a bit.
+   if (m_bytes_per_second > 0)
+      m_last_round_allocation = static_cast<int>(total_bytes_shares / active_users);
+   if (m_ops_per_second > 0)
+      m_last_round_ops = static_cast<int>(total_ops_shares / active_users);
+   if (m_last_round_allocation < 1) m_last_round_allocation = 1;
+   if (m_last_round_ops < 1) m_last_round_ops = 1;
+   TRACE(BANDWIDTH, "Round byte allocation " << m_last_round_allocation << " for " << active_users << " active users.");
+   TRACE(IOPS, "Round ops allocation " << m_last_round_ops);
+
+   if (TRACING((TRACE_BANDWIDTH | TRACE_IOPS))) ReportDelays();
 
    // Reset the loadshed limit counter.
+   AtomicBeg(m_compute_var);
    int limit_hit = AtomicFAZ(m_loadshed_limit_hit);
+   int concurrency_hit = AtomicFAZ(m_concurrency_hit);
+   int lat_count = AtomicFAZ(m_lat_count);
+   long long lat_sum = AtomicFAZ(m_lat_sum);
+   AtomicEnd(m_compute_var);
    TRACE(DEBUG, "Throttle limit hit " << limit_hit << " times during last interval.");
+   TRACE(IOLOAD, "Concurrency limit " << m_concurrency_limit << " hit " << concurrency_hit << " times during last interval.");
 
-   AtomicEnd(m_compute_var);
+   // Let the IO latency drive the concurrency limit and report it.
+   if (m_adaptive) AdaptConcurrency(lat_count, lat_count ? lat_sum/lat_count : 0);
+   if (TRACING(TRACE_IOLOAD))
+   {
+      int hist[3] = {0, 0, 0}, total = 0, b;
+      static const int pct[] = {50, 90, 99};
+      std::vector<int> lat(m_delay_bins);
+      AtomicBeg(m_compute_var);
+      for (b=0; b<m_delay_bins; b++) {lat[b] = AtomicFAZ(m_lat_hist[b]); total += lat[b];}
+      AtomicEnd(m_compute_var);
+      long long seen = 0;
+      b = 0;
+      for (int p=0; p<3 && total; p++)
+      {
+         while (b < m_delay_bins-1 && (seen + lat[b])*100 < static_cast<long long>(total)*pct[p]) seen += lat[b++];
+         hist[p] = b ? (1 << b) : 0;
+      }
+      TRACE(IOLOAD, "IO latency over " << lat_count << " requests: mean " << (lat_count ? lat_sum/lat_count : 0)
+                    << "us p50 " << hist[0] << "us p90 " << hist[1] << "us p99 " << hist[2] << "us.");
+   }
 
    // Update the IO counters
    m_compute_var.Lock();
@@ -254,7 +378,40 @@ XrdThrottleManager::RecomputeInternal()
    }
    m_compute_var.UnLock();
    TRACE(IOLOAD, "Current IO counter is " << m_stable_io_counter << "; total IO wait time is " << (m_stable_io_wait.tv_sec*1000+m_stable_io_wait.tv_nsec/1000000) << "ms.");
-   m_compute_var.Broadcast();
+}
+
+/*
+ * Report the queue delay percentiles of each user seen during the last
+ * interval and start over.  Values are the upper bound of the histogram
+ * bin the percentile falls in.
+ */
+void
+XrdThrottleManager::ReportDelays()
+{
+   static const int pct[] = {50, 90, 99};
+   std::vector<int> hist(m_delay_bins);
+   for (int i=0; i<m_max_users; i++)
+   {
+      long long total = 0;
+      AtomicBeg(m_compute_var);
+      for (int b=0; b<m_delay_bins; b++)
+      {
+         hist[b] = AtomicFAZ(m_delay_hist[i*m_delay_bins+b]);
+         total += hist[b];
+      }
+      AtomicEnd(m_compute_var);
+      if (!total) continue;
+
+      long long val[3], seen = 0;
+      int b = 0;
+      for (int p=0; p<3; p++)
+      {
+         while (b < m_delay_bins-1 && (seen + hist[b])*100 < total*pct[p]) seen += hist[b++];
+         val[p] = b ? (1LL << b) : 0;
+      }
+      TRACE(BANDWIDTH, "User slot " << i << " requests " << total << " queue delay p50 " << val[0]
+                       << "us p90 " << val[1] << "us p99 " << val[2] << "us.");
+   }
 }
 
 /*
@@ -284,10 +441,12 @@ XrdThrottleManager::StartIOTimer()
    AtomicBeg(m_compute_var);
    int cur_counter = AtomicInc(m_io_counter);
    AtomicEnd(m_compute_var);
+   if (cur_counter >= m_io_peak) m_io_peak = cur_counter+1;
    while (m_concurrency_limit >= 0 && cur_counter > m_concurrency_limit)
    {
       AtomicBeg(m_compute_var);
       AtomicInc(m_loadshed_limit_hit);
+      AtomicInc(m_concurrency_hit);
       AtomicDec(m_io_counter);
       AtomicEnd(m_compute_var);
       m_compute_var.Wait();
@@ -302,19 +461,65 @@ XrdThrottleManager::StartIOTimer()
  * Finish recording an IO timer.
  */
 void
-XrdThrottleManager::StopIOTimer(struct timespec timer)
+XrdThrottleManager::StopIOTimer(struct timespec timer, long long wall_usecs)
 {
+   int bin = 0;
+   for (long long usecs = wall_usecs; usecs > 0 && bin < m_delay_bins-1; usecs >>= 1) bin++;
    AtomicBeg(m_compute_var);
    AtomicDec(m_io_counter);
    AtomicAdd(m_io_wait.tv_sec, timer.tv_sec);
    // Note this may result in tv_nsec > 1e9
    AtomicAdd(m_io_wait.tv_nsec, timer.tv_nsec);
+   AtomicInc(m_lat_count);
+   AtomicAdd(m_lat_sum, wall_usecs);
+   AtomicInc(m_lat_hist[bin]);
    AtomicEnd(m_compute_var);
 }
 
+/*
+ * Adjust the concurrency limit from the IO latency of the last interval,
+ * in the manner of a gradient concurrency limiter.
+ *
+ * The baseline is the latency seen when the backend is not queueing; it
+ * follows drops in latency immediately and rises only slowly.  As long as
+ * the latency stays within twice the baseline, the limit may grow by about
+ * its square root per interval (but only if we actually came close to
+ * using it); beyond that, it shrinks in proportion to the latency
+ * increase, by at most half per interval.  The result is smoothed and kept
+ * between 1 and the configured concurrency.
+ */
+void
+XrdThrottleManager::AdaptConcurrency(int samples, long long mean_usecs)
+{
+   int peak = m_io_peak;
+   m_io_peak = 0;
+   if (samples < 10 || mean_usecs <= 0) return;
+
+   if (!m_lat_baseline || mean_usecs < m_lat_baseline) m_lat_baseline = mean_usecs;
+      else m_lat_baseline += (mean_usecs - m_lat_baseline) / 64;
+
+   double limit = m_limit_smooth;
+   double gradient = 2.0 * m_lat_baseline / mean_usecs;
+   if (gradient > 1.0) gradient = 1.0;
+   if (gradient < 0.5) gradient = 0.5;
+
+   double target = limit * gradient;
+   if (gradient >= 1.0 && peak * 2 >= limit) target += sqrt(limit);
+
+   m_limit_smooth = 0.8 * limit + 0.2 * target;
+   if (m_limit_smooth > m_concurrency_max) m_limit_smooth = m_concurrency_max;
+   if (m_limit_smooth < 1) m_limit_smooth = 1;
+   m_concurrency_limit = static_cast<int>(m_limit_smooth + 0.5);
+
+   TRACE(IOLOAD, "Adaptive concurrency limit now " << m_concurrency_limit << " (latency " << mean_usecs
+                 << "us baseline " << m_lat_baseline << "us peak " << peak << ").");
+}
+
 /*
  * Check the counters to see if we have hit any throttle limits in the
- * current time period.  If so, shed the client randomly.
+ * current time period.  If so, shed the client randomly.  With an adaptive
+ * concurrency limit, only running into that limit counts: the rate limits
+ * merely pace clients, while a saturated limit means the backend is slow.
  *
  * If the client has already been load-shedded once and reconnected to this
  * server, then do not load-shed it again.
@@ -326,7 +531,9 @@ XrdThrottleManager::CheckLoadShed(const std::string &opaque)
    {
       return false;
    }
-   if (AtomicGet(m_loadshed_limit_hit) == 0)
+   int hits = m_adaptive ? AtomicGet(m_concurrency_hit)
+                         : AtomicGet(m_loadshed_limit_hit);
+   if (hits == 0)
    {
       return false;
    }
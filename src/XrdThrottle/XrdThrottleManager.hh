@@ -9,8 +9,11 @@
  *
  * The XrdThrottleManager is user-aware and provides fairshare.
  *
- * This works by having a separate thread periodically refilling
- * each user's shares.
+ * This works by having a separate thread refilling each user's token
+ * bucket several times per interval.  Requests that find their bucket
+ * empty borrow against future refills and wait, in order, until their
+ * user has been credited enough; tokens that idle users cannot hold are
+ * handed round-robin to the users with waiting requests.
  *
  * Note that we do not actually keep close track of users, but rather
  * put them into a hash.  This way, we can pretend there's a constant
@@ -31,6 +34,7 @@
 #include <string>
 #include <vector>
 #include <time.h>
+#include <sys/time.h>
 
 #include "XrdSys/XrdSysPthread.hh"
 
@@ -51,9 +55,11 @@ void        Apply(int reqsize, int reqops, int uid);
 
 bool        IsThrottling() {return (m_ops_per_second > 0) || (m_bytes_per_second > 0);}
 
-void        SetThrottles(float reqbyterate, float reqoprate, int concurrency, float interval_length)
+void        SetThrottles(float reqbyterate, float reqoprate, int concurrency, float interval_length,
+                         bool adaptive=false)
             {m_interval_length_seconds = interval_length; m_bytes_per_second = reqbyterate;
-             m_ops_per_second = reqoprate; m_concurrency_limit = concurrency;}
+             m_ops_per_second = reqoprate; m_concurrency_limit = concurrency;
+             m_concurrency_max = concurrency; m_adaptive = adaptive && concurrency > 0;}
 
 void        SetLoadShed(std::string &hostname, unsigned port, unsigned frequency)
             {m_loadshed_host = hostname; m_loadshed_port = port; m_loadshed_frequency = frequency;}
@@ -77,7 +83,7 @@ void        PerformLoadShed(const std::string &opaque, std::string &host, unsign
 
 protected:
 
-void        StopIOTimer(struct timespec);
+void        StopIOTimer(struct timespec, long long wall_usecs);
 
 private:
 
@@ -88,11 +94,17 @@ void        RecomputeInternal();
 static
 void *      RecomputeBootstrap(void *pp);
 
-int         WaitForShares();
+void        Refill();
 
-void        GetShares(int &shares, int &request);
+long long   Borrow(int &tokens, long long &credit, int request);
 
-void        StealShares(int uid, int &reqsize, int &reqops);
+int         Credit(int &tokens, long long &credit, int amount, int cap);
+
+void        RecordDelay(int uid, long long usecs);
+
+void        ReportDelays();
+
+void        AdaptConcurrency(int samples, long long mean_usecs);
 
 XrdOucTrace * m_trace;
 XrdSysError * m_log;
@@ -105,14 +117,39 @@ float       m_bytes_per_second;
 float       m_ops_per_second;
 int         m_concurrency_limit;
 
-// Maintain the shares
+// Adaptive concurrency limit; m_concurrency_limit moves between 1 and
+// m_concurrency_max following the IO latency measured each interval.
+bool        m_adaptive;
+int         m_concurrency_max;
+int         m_concurrency_hit;
+int         m_io_peak;
+double      m_limit_smooth;
+long long   m_lat_baseline;
+int         m_lat_count;
+long long   m_lat_sum;
+std::vector<int> m_lat_hist;
+
+// Maintain the shares. The token counts go negative when requests borrow
+// against future refills; the credit counters only ever grow and tell a
+// waiting request when the tokens it borrowed have been paid for.
 static const
 int         m_max_users;
-std::vector<int> m_primary_bytes_shares;
-std::vector<int> m_secondary_bytes_shares;
-std::vector<int> m_primary_ops_shares;
-std::vector<int> m_secondary_ops_shares;
+std::vector<int> m_bytes_tokens;
+std::vector<int> m_ops_tokens;
+std::vector<long long> m_bytes_credit;
+std::vector<long long> m_ops_credit;
+std::vector<int> m_waiters;
+std::vector<int> m_active;
 int         m_last_round_allocation;
+int         m_last_round_ops;
+
+// Number of refills per interval (sub-interval pacing)
+int         m_pace_steps;
+
+// Per-user queue delay histograms; bin i counts delays below 2^i usecs
+static const
+int         m_delay_bins;
+std::vector<int> m_delay_hist;
 
 // Active IO counter
 int         m_io_counter;
@@ -158,7 +195,7 @@ void StopTimer()
    }
    if (m_timer.tv_nsec != -1)
    {
-      m_manager.StopIOTimer(end_timer);
+      m_manager.StopIOTimer(end_timer, WallClock() - m_wall);
    }
    m_timer.tv_sec = 0;
    m_timer.tv_nsec = -1;
@@ -187,11 +224,26 @@ XrdThrottleTimer(XrdThrottleManager & manager) :
       m_timer.tv_sec = 0;
       m_timer.tv_nsec = 0;
    }
+   m_wall = WallClock();
+}
+
+static long long WallClock()
+{
+#if defined(__linux__)
+   struct timespec now;
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   return now.tv_sec*1000000LL + now.tv_nsec/1000;
+#else
+   struct timeval now;
+   gettimeofday(&now, 0);
+   return now.tv_sec*1000000LL + now.tv_usec;
+#endif
 }
 
 private:
 XrdThrottleManager &m_manager;
 struct timespec m_timer;
+long long m_wall;
 
 static int clock_id;
 };
@@ -974,6 +974,7 @@ int XrdXrootdProtocol::xlog(XrdOucStream &Config)
 
    Purpose:  Parse directive: monitor [all] [auth]  [flush [io] <sec>]
                                       [fstat <sec> [lfn] [ops] [ssq] [xfr <n>]
+                                             [compact] [segs] [file <path>]
                                       [ident <sec>] [mbuff <sz>] [rbuff <sz>]
                                       [rnums <cnt>] [window <sec>]
                                       dest [Events] <host:port>
@@ -991,6 +992,10 @@ int XrdXrootdProtocol::xlog(XrdOucStream &Config)
                             ssq    - computes the sum of squares for the ops rec
                             xfr <n>- inserts i/o stats for open files every
                                      <sec>*<n>. Minimum is 1.
+                            compact- uses the compact encoding for records
+                                     and, with ops, adds latency histograms.
+                            segs   - adds readv segment lists (implies compact)
+                            file <path> also appends each packet to <path>.
          ident  <sec>       time (seconds, M, H) between identification records.
          mbuff  <sz>        size of message buffer for event trace monitoring.
          rbuff  <sz>        size of message buffer for redirection monitoring.
@@ -1019,6 +1024,7 @@ int XrdXrootdProtocol::xmon(XrdOucStream &Config)
     int i, monFlash = 0, monFlush=0, monMBval=0, monRBval=0, monWWval=0;
     int    monIdent = 3600, xmode=0, monMode[2] = {0, 0}, mrType, *flushDest;
     int    monRnums = 0, monFSint = 0, monFSopt = 0, monFSion = 0;
+    char  *monFSfile = 0;
     int    haveWord = 0;
 
     while(haveWord || (val = Config.GetWord()))
@@ -1048,6 +1054,19 @@ int XrdXrootdProtocol::xmon(XrdOucStream &Config)
                         if (!strcmp("lfn", val)) monFSopt |=  XROOTD_MON_FSLFN;
                    else if (!strcmp("ops", val)) monFSopt |=  XROOTD_MON_FSOPS;
                    else if (!strcmp("ssq", val)) monFSopt |=  XROOTD_MON_FSSSQ;
+                   else if (!strcmp("compact", val))
+                           monFSopt |=  XROOTD_MON_FSPCK;
+                   else if (!strcmp("segs", val))
+                           monFSopt |= (XROOTD_MON_FSPCK | XROOTD_MON_FSSEG);
+                   else if (!strcmp("file", val))
+                           {if (!(val = Config.GetWord()) || *val != '/')
+                               {eDest.Emsg("Config", "monitor fstat file path not specified");
+                                if (monFSfile) free(monFSfile);
+                                return 1;
+                               }
+                            if (monFSfile) free(monFSfile);
+                            monFSfile = strdup(val);
+                           }
                    else if (!strcmp("xfr", val))
                            {if (!(val = Config.GetWord()))
                                {eDest.Emsg("Config", "monitor fstat xfr count not specified");
@@ -1153,7 +1172,8 @@ int XrdXrootdProtocol::xmon(XrdOucStream &Config)
 //
    XrdXrootdMonitor::Defaults(monMBval, monRBval, monWWval,
                               monFlush, monFlash, monIdent, monRnums,
-                              monFSint, monFSopt, monFSion);
+                              monFSint, monFSopt, monFSion, monFSfile);
+   if (monFSfile) free(monFSfile);
 
    if (monDest[0]) monMode[0] |= (monMode[0] ? xmode : XROOTD_MON_FILE|xmode);
    if (monDest[1]) monMode[1] |= (monMode[1] ? xmode : XROOTD_MON_FILE|xmode);
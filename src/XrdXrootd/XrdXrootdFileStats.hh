@@ -30,7 +30,10 @@
 /* specific prior written permission of the institution or contributor.       */
 /******************************************************************************/
 
+#include <sys/time.h>
+
 #include "XrdXrootd/XrdXrootdMonData.hh"
+#include "XrdXrootd/XrdXrootdMonPack.hh"
 
 class XrdXrootdFileStats
 {
@@ -40,6 +43,7 @@ kXR_unt32           FileID;   // Unique file id used for monitoring
 short               MonEnt;   // Set by mon: entry in reporting table or -1
 char                monLvl;   // Set by mon: level of data collection needed
 char                xfrXeq;   // Transfer has occurred
+char                monLat;   // Set by mon: collect request latencies
 long long           fSize;    // Size of file when opened
 XrdXrootdMonStatXFR xfr;
 XrdXrootdMonStatOPS ops;
@@ -48,11 +52,13 @@ struct {double      read;     // sum(read_size[i] **2) i = 1 to Ops.read
         double      rsegs;    // sum(readv_segs[i]**2) i = 1 to Ops.readv
         double      write;    // sum(write_size[i]**2) i = 1 to Ops.write
        }            ssq;
+kXR_unt32           lat[XrdXrootdMonPack::latBins]; // log2(usec) histogram
 
 enum monLevel {monOff = 0, monOn = 1, monOps = 2, monSsq = 3};
 
        void Init()
-                {FileID = 0; MonEnt = -1; monLvl = xfrXeq = 0;
+                {FileID = 0; MonEnt = -1; monLvl = xfrXeq = monLat = 0;
+                 memset(lat, 0, sizeof(lat));
                  memset(&xfr, 0, sizeof(xfr));
                  memset(&ops, 0, sizeof(ops));
                  ops.rsMin = 0x7fff;
@@ -104,6 +110,21 @@ inline void wrOps(int wsz)
                      }
                  }
 
+static
+inline long long Clock()
+                  {struct timeval tNow;
+                   gettimeofday(&tNow, 0);
+                   return tNow.tv_sec*1000000LL + tNow.tv_usec;
+                  }
+
+inline void rqLat(long long tBeg)
+                 {long long usec = Clock() - tBeg;
+                  int i = 0;
+                  while(usec > 1 && i < XrdXrootdMonPack::latBins-1)
+                       {usec >>= 1; i++;}
+                  lat[i]++;
+                 }
+
        XrdXrootdFileStats() {Init();}
       ~XrdXrootdFileStats() {}
 };
@@ -0,0 +1,209 @@
+/******************************************************************************/
+/*                                                                            */
+/*                   X r d X r o o t d L a t e n c y . c c                    */
+/*                                                                            */
+/* (c) 2014 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                            All Rights Reserved                             */
+/*   Produced by Andrew Hanushevsky for Stanford University under contract    */
+/*              DE-AC02-76-SFO0515 with the Department of Energy              */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "XProtocol/XProtocol.hh"
+#include "XrdXrootd/XrdXrootdLatency.hh"
+
+/******************************************************************************/
+/*                     L o c a l   S t a t i c   D a t a                      */
+/******************************************************************************/
+
+const char *XrdXrootdLatency::latName[XrdXrootdLatency::latTypes] =
+           {"open", "fsopen", "rd", "rv", "wr", "sync", "close", "stat",
+            "auth", "login", "locate", "query", "dirl", "misc", "queue"};
+
+/******************************************************************************/
+/*                           C o n s t r u c t o r                            */
+/******************************************************************************/
+
+XrdXrootdLatency::XrdXrootdLatency()
+{
+   int i;
+
+   for (i = 0; i < latShards; i++)
+       {memset(Shard[i].Bins, 0, sizeof(Shard[i].Bins));
+        memset(Shard[i].Sums, 0, sizeof(Shard[i].Sums));
+       }
+}
+
+/******************************************************************************/
+/*                                D e t a i l                                 */
+/******************************************************************************/
+
+int XrdXrootdLatency::Detail(char *buff, int blen)
+{
+   static const char *sHdr = "<stats id=\"xrdlat\">", *sTrl = "</stats>";
+   long long bins[latBins], num, sum;
+   int i, j, n, len;
+
+// If no buffer, caller wants the maximum size we will generate. Each bin
+// is at most "<low>:<count> " and each type is wrapped in a tag with a count.
+//
+   if (!buff)
+      return strlen(sHdr) + strlen(sTrl)
+           + latTypes*(2*8 + 5 + 20 + latBins*(2*20 + 2));
+
+// Format the header
+//
+   if ((len = snprintf(buff, blen, "%s", sHdr)) >= blen) return 0;
+
+// Each type is listed as space separated <low>:<count> pairs for each
+// non-empty bin where low is the smallest latency the bin holds.
+//
+   for (i = 0; i < latTypes; i++)
+       {Merge(i, bins, num, sum);
+        n = snprintf(buff+len, blen-len, "<%s n=\"%lld\">", latName[i], num);
+        if ((len += n) >= blen) return 0;
+        for (j = 0; j < latBins; j++)
+            {if (!bins[j]) continue;
+             n = snprintf(buff+len, blen-len, "%lld:%lld ", BinLow(j), bins[j]);
+             if ((len += n) >= blen) return 0;
+            }
+        if (buff[len-1] == ' ') len--;
+        n = snprintf(buff+len, blen-len, "</%s>", latName[i]);
+        if ((len += n) >= blen) return 0;
+       }
+
+// Add the trailer and return
+//
+   if ((len += snprintf(buff+len, blen-len, "%s", sTrl)) >= blen) return 0;
+   return len;
+}
+
+/******************************************************************************/
+/*                                 M e r g e                                  */
+/******************************************************************************/
+
+void XrdXrootdLatency::Merge(int lType, long long *bins, long long &num,
+                                                         long long &sum)
+{
+   latShard *sP;
+   int i, j;
+
+// Sum up each of the shards for the requested type
+//
+   memset(bins, 0, sizeof(long long)*latBins);
+   num = sum = 0;
+   for (i = 0; i < latShards; i++)
+       {sP = &Shard[i];
+        AtomicBeg(sP->Mutex);
+        for (j = 0; j < latBins; j++) bins[j] += AtomicGet(sP->Bins[lType][j]);
+        sum += AtomicGet(sP->Sums[lType]);
+        AtomicEnd(sP->Mutex);
+       }
+
+// Compute the total number of samples
+//
+   for (j = 0; j < latBins; j++) num += bins[j];
+}
+
+/******************************************************************************/
+/*                               S u m m a r y                                */
+/******************************************************************************/
+
+int XrdXrootdLatency::Summary(char *buff, int blen)
+{
+   static const char *sFmt = "<%s><n>%lld</n><avg>%lld</avg><p50>%lld</p50>"
+                             "<p90>%lld</p90><p99>%lld</p99><max>%lld</max>"
+                             "</%s>";
+   static const long long LLMax = 0x7fffffffffffffffLL;
+   static const int       pctNum = 3;
+   static const int       pctVal[pctNum] = {50, 90, 99};
+   long long bins[latBins], num, sum, tot, pct[pctNum], vmax;
+   char dummy[512];
+   int i, j, k, len, n;
+
+// If no buffer, caller wants the maximum size we will generate
+//
+   if (!buff)
+      {len = 0;
+       for (i = 0; i < latTypes; i++)
+           len += snprintf(dummy, sizeof(dummy), sFmt, latName[i], LLMax,
+                           LLMax, LLMax, LLMax, LLMax, LLMax, latName[i]);
+       return len + 11;
+      }
+
+// Format the header
+//
+   if ((len = snprintf(buff, blen, "<lat>")) >= blen) return 0;
+
+// Percentiles and the maximum are reported as the low end of the bin they
+// fall in and are, therefore, accurate to within 25%.
+//
+   for (i = 0; i < latTypes; i++)
+       {Merge(i, bins, num, sum);
+        memset(pct, 0, sizeof(pct)); vmax = 0;
+        if (num)
+           {tot = 0; k = 0;
+            for (j = 0; j < latBins; j++)
+                {if (!bins[j]) continue;
+                 tot += bins[j]; vmax = BinLow(j);
+                 while(k < pctNum && tot*100 >= num*pctVal[k]) pct[k++] = vmax;
+                }
+           }
+        n = snprintf(buff+len, blen-len, sFmt, latName[i], num,
+                     (num ? sum/num : 0), pct[0], pct[1], pct[2], vmax,
+                     latName[i]);
+        if ((len += n) >= blen) return 0;
+       }
+
+// Add the trailer and return
+//
+   if ((len += snprintf(buff+len, blen-len, "</lat>")) >= blen) return 0;
+   return len;
+}
+
+/******************************************************************************/
+/*                                  T y p e                                   */
+/******************************************************************************/
+
+int XrdXrootdLatency::Type(int reqID)
+{
+   switch(reqID)
+         {case kXR_read:     return latRead;
+          case kXR_readv:    return latReadV;
+          case kXR_write:    return latWrite;
+          case kXR_open:     return latOpen;
+          case kXR_close:    return latClose;
+          case kXR_stat:
+          case kXR_statx:    return latStat;
+          case kXR_sync:     return latSync;
+          case kXR_auth:     return latAuth;
+          case kXR_login:    return latLogin;
+          case kXR_locate:   return latLocate;
+          case kXR_query:    return latQuery;
+          case kXR_dirlist:  return latDirl;
+          default:           break;
+         }
+   return latOther;
+}
@@ -0,0 +1,154 @@
+#ifndef __XRDXROOTDLATENCY__
+#define __XRDXROOTDLATENCY__
+/******************************************************************************/
+/*                                                                            */
+/*                   X r d X r o o t d L a t e n c y . h h                    */
+/*                                                                            */
+/* (c) 2014 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                            All Rights Reserved                             */
+/*   Produced by Andrew Hanushevsky for Stanford University under contract    */
+/*              DE-AC02-76-SFO0515 with the Department of Energy              */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <pthread.h>
+#include <sys/time.h>
+
+#include "XrdSys/XrdSysAtomics.hh"
+#include "XrdSys/XrdSysPthread.hh"
+
+/******************************************************************************/
+/*                C l a s s   X r d X r o o t d L a t e n c y                 */
+/******************************************************************************/
+
+// This class keeps log-linear latency histograms (in microseconds) for each
+// class of xrootd request. Each power of two is split into four sub-buckets
+// so that any reported percentile is within 25% of the true value. Samples
+// are recorded into one of several shards selected by the calling thread so
+// that worker threads rarely contend on the same cache lines; the shards are
+// only merged when statistics are requested. The cost of recording a sample
+// is two atomic adds plus the two clock reads done by the caller.
+
+class XrdXrootdLatency
+{
+public:
+
+enum latType {latOpen = 0, latOpenFS, latRead, latReadV, latWrite, latSync,
+              latClose, latStat, latAuth, latLogin, latLocate, latQuery,
+              latDirl, latOther, latQueue, latTypes};
+
+static const int latBins = 120;
+
+//-----------------------------------------------------------------------------
+//! Record a sample.
+//!
+//! @param  lType  the latType the sample belongs to.
+//! @param  usec   the elapsed time in microseconds.
+//-----------------------------------------------------------------------------
+
+inline void       Add(int lType, long long usec)
+                     {latShard *sP = &Shard[Slot()];
+                      int bin = Bin(usec);
+                      AtomicBeg(sP->Mutex);
+                      AtomicInc(sP->Bins[lType][bin]);
+                      AtomicAdd(sP->Sums[lType], usec);
+                      AtomicEnd(sP->Mutex);
+                     }
+
+//-----------------------------------------------------------------------------
+//! Format the full histograms as xml.
+//!
+//! @param  buff   the buffer to receive the text. When nil, the maximum
+//!                length that may be generated is returned.
+//! @param  blen   the length of the buffer.
+//!
+//! @return The number of characters placed in buff, not counting the null.
+//-----------------------------------------------------------------------------
+
+int               Detail(char *buff, int blen);
+
+//-----------------------------------------------------------------------------
+//! Return the current time in microseconds.
+//-----------------------------------------------------------------------------
+
+static long long  Now() {struct timeval tv;
+                         gettimeofday(&tv, 0);
+                         return tv.tv_sec*1000000LL + tv.tv_usec;
+                        }
+
+//-----------------------------------------------------------------------------
+//! Format count, average, p50, p90, p99, and max of each type as xml.
+//!
+//! @param  buff   the buffer to receive the text. When nil, the maximum
+//!                length that may be generated is returned.
+//! @param  blen   the length of the buffer.
+//!
+//! @return The number of characters placed in buff, not counting the null.
+//-----------------------------------------------------------------------------
+
+int               Summary(char *buff, int blen);
+
+//-----------------------------------------------------------------------------
+//! Map an xrootd request code to the latType it is accounted under.
+//-----------------------------------------------------------------------------
+
+static int        Type(int reqID);
+
+                  XrdXrootdLatency();
+                 ~XrdXrootdLatency() {}
+
+private:
+
+static int        Bin(long long usec)
+                     {unsigned long long v = (usec > 0 ? usec : 0);
+                      int e;
+                      if (v < 4) return (int)v;
+#ifdef __GNUC__
+                      e = 63 - __builtin_clzll(v);
+#else
+                      e = 2; while(v >> (e+1)) e++;
+#endif
+                      e = 4*(e-1) + (int)((v >> (e-2)) & 3);
+                      return (e < latBins ? e : latBins-1);
+                     }
+static long long  BinLow(int bin)
+                     {if (bin < 4) return bin;
+                      return (long long)(4 + (bin & 3)) << ((bin >> 2) - 1);
+                     }
+void              Merge(int lType, long long *bins, long long &num,
+                                                    long long &sum);
+static int        Slot() {unsigned long tid = (unsigned long)pthread_self();
+                          tid ^= (tid >> 7) ^ (tid >> 13) ^ (tid >> 21);
+                          return (int)(tid & (latShards-1));
+                         }
+
+static const int  latShards = 16;
+static const char *latName[latTypes];
+
+struct latShard
+      {XrdSysMutex Mutex;
+       long long   Bins[latTypes][latBins];
+       long long   Sums[latTypes];
+       char        Pad[64];
+      }           Shard[latShards];
+};
+#endif
@@ -37,7 +37,7 @@
 /******************************************************************************/
   
 struct XrdXrootdMonHeader
-       {kXR_char   code;         // '='|'d'|'f'|'i'|'p'|'r'|'t'|'u'|'x'
+       {kXR_char   code;         // '='|'c'|'d'|'f'|'i'|'p'|'r'|'t'|'u'|'x'
         kXR_char   pseq;         // packet sequence
         kXR_unt16  plen;         // packet length
         kXR_int32  stod;         // Unix time at Server Start
@@ -95,6 +95,7 @@ const kXR_char XROOTD_MON_WINDOW        = 0xe0;
 
 const kXR_char XROOTD_MON_MAPIDNT       = '=';
 const kXR_char XROOTD_MON_MAPPATH       = 'd';
+const kXR_char XROOTD_MON_MAPFPCK       = 'c'; // The compact "f" stream
 const kXR_char XROOTD_MON_MAPFSTA       = 'f'; // The "f" stream
 const kXR_char XROOTD_MON_MAPINFO       = 'i';
 const kXR_char XROOTD_MON_MAPMIGR       = 'm'; // Internal use only!
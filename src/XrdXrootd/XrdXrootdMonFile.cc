@@ -28,14 +28,21 @@
 /* specific prior written permission of the institution or contributor.       */
 /******************************************************************************/
 
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "Xrd/XrdScheduler.hh"
 
+#include "XrdOuc/XrdOucIOVec.hh"
 #include "XrdSys/XrdSysError.hh"
 #include "XrdSys/XrdSysPlatform.hh"
 
 #include "XrdXrootd/XrdXrootdMonFile.hh"
+#include "XrdXrootd/XrdXrootdMonPack.hh"
 #include "XrdXrootd/XrdXrootdFileStats.hh"
 
 /******************************************************************************/
@@ -62,6 +69,16 @@ int                  XrdXrootdMonFile::fmHWM    =-1;
 int                  XrdXrootdMonFile::crecSize = 0;
 int                  XrdXrootdMonFile::xfrCnt   = 0;
 int                  XrdXrootdMonFile::xfrRem   = 0;
+int                  XrdXrootdMonFile::fsFD     =-1;
+char                *XrdXrootdMonFile::fsSink   = 0;
+XrdXrootdMonFile::SinkMsg
+                    *XrdXrootdMonFile::sinkFirst= 0;
+XrdXrootdMonFile::SinkMsg
+                    *XrdXrootdMonFile::sinkLast = 0;
+XrdSysMutex          XrdXrootdMonFile::sinkMutex;
+XrdSysSemaphore      XrdXrootdMonFile::sinkSem(0);
+int                  XrdXrootdMonFile::sinkNum  = 0;
+int                  XrdXrootdMonFile::sinkDrop = 0;
 XrdXrootdMonFileXFR  XrdXrootdMonFile::xfrRec;
 short                XrdXrootdMonFile::crecNLen = 0;
 short                XrdXrootdMonFile::trecNLen = 0;
@@ -70,8 +87,20 @@ char                 XrdXrootdMonFile::fsLVL    = 0;
 char                 XrdXrootdMonFile::fsOPS    = 0;
 char                 XrdXrootdMonFile::fsSSQ    = 0;
 char                 XrdXrootdMonFile::fsXFR    = 0;
+char                 XrdXrootdMonFile::fsPCK    = 0;
+char                 XrdXrootdMonFile::fsSEG    = 0;
 char                 XrdXrootdMonFile::crecFlag = 0;
 
+/******************************************************************************/
+/*                     T h r e a d   I n t e r f a c e s                      */
+/******************************************************************************/
+
+void *XrdXrootdMonFileSinkQ(void *carg)
+{
+   XrdXrootdMonFile::SinkQ();
+   return (void *)0;
+}
+
 /******************************************************************************/
 /*                                 C l o s e                                  */
 /******************************************************************************/
@@ -93,6 +122,10 @@ void XrdXrootdMonFile::Close(XrdXrootdFileStats *fsP, bool isDisc)
        fmMutex.UnLock();
       }
 
+// Use the compact encoding if so wanted
+//
+   if (fsPCK) {PackClose(fsP, isDisc); return;}
+
 // Insert a close record header (mostly precomputed)
 //
    cRec.Hdr.recType = XrdXrootdMonFileHdr::isClose;
@@ -162,7 +195,8 @@ void XrdXrootdMonFile::Close(XrdXrootdFileStats *fsP, bool isDisc)
 /*                              D e f a u l t s                               */
 /******************************************************************************/
   
-void XrdXrootdMonFile::Defaults(int intv, int opts, int xfrcnt)
+void XrdXrootdMonFile::Defaults(int intv, int opts, int xfrcnt,
+                                const char *sink)
 {
 
 // Set the reporting interval and I/O counter
@@ -177,6 +211,13 @@ void XrdXrootdMonFile::Defaults(int intv, int opts, int xfrcnt)
    fsLFN  = (opts &  XROOTD_MON_FSLFN) != 0;
    fsOPS  = (opts & (XROOTD_MON_FSOPS  | XROOTD_MON_FSSSQ)) != 0;
    fsSSQ  = (opts &  XROOTD_MON_FSSSQ) != 0;
+   fsPCK  = (opts & (XROOTD_MON_FSPCK  | XROOTD_MON_FSSEG)) != 0;
+   fsSEG  = (opts &  XROOTD_MON_FSSEG) != 0;
+
+// Record where a copy of each packet is to be written, if anywhere
+//
+   if (fsSink) free(fsSink);
+   fsSink = (sink ? strdup(sink) : 0);
 
 // Set monitoring level
 //
@@ -195,6 +236,17 @@ void XrdXrootdMonFile::Disc(unsigned int usrID)
    static short drecSize = htons(sizeof(XrdXrootdMonFileDSC));
    XrdXrootdMonFileDSC *dP;
 
+// Use the compact encoding if so wanted
+//
+   if (fsPCK)
+      {char *cP = GetSlot(2 + XrdXrootdMonPack::maxVsz);
+       *cP++ = XrdXrootdMonPack::isDisc;
+       *cP++ = 0;
+       repNext = XrdXrootdMonPack::PutV(cP, ntohl(usrID));
+       bfMutex.UnLock();
+       return;
+      }
+
 // Get a pointer to the next slot (the buffer gets locked)
 //
    dP = (XrdXrootdMonFileDSC *)GetSlot(sizeof(XrdXrootdMonFileDSC));
@@ -288,6 +340,21 @@ void XrdXrootdMonFile::DoXFR(XrdXrootdFileStats *fsP)
    xfrReadv = fsP->xfr.readv;
    xfrWrite = fsP->xfr.write;
 
+// Use the compact encoding if so wanted
+//
+   if (fsPCK)
+      {cP = GetSlot(2 + XrdXrootdMonPack::maxVsz*4);
+       *cP++ = XrdXrootdMonPack::isXfr;
+       *cP++ = 0;
+       cP = XrdXrootdMonPack::PutV(cP, ntohl(fsP->FileID));
+       cP = XrdXrootdMonPack::PutV(cP, xfrRead);
+       cP = XrdXrootdMonPack::PutV(cP, xfrReadv);
+       repNext = XrdXrootdMonPack::PutV(cP, xfrWrite);
+       xfrRecs++;
+       bfMutex.UnLock();
+       return;
+      }
+
 // Complete the record
 //
    xfrRec.Hdr.fileID = fsP->FileID;
@@ -328,7 +395,7 @@ bool XrdXrootdMonFile::Init(XrdScheduler *sp, XrdSysError  *errp, int bfsz)
 // Set the header (always present)
 //
    repHdr = (XrdXrootdMonHeader *)repBuff;
-   repHdr->code = XROOTD_MON_MAPFSTA;
+   repHdr->code = (fsPCK ? XROOTD_MON_MAPFPCK : XROOTD_MON_MAPFSTA);
    repHdr->pseq = 0;
    repHdr->stod = XrdXrootdMonitor::startTime;
 
@@ -336,9 +403,33 @@ bool XrdXrootdMonFile::Init(XrdScheduler *sp, XrdSysError  *errp, int bfsz)
 //
    repTOD   = (XrdXrootdMonFileTOD *)(repBuff + sizeof(XrdXrootdMonHeader));
    repTOD->Hdr.recType = XrdXrootdMonFileHdr::isTime;
-   repTOD->Hdr.recFlag = 0;
+   repTOD->Hdr.recFlag = (fsPCK ? XrdXrootdMonPack::Version : 0);
    repTOD->Hdr.recSize = htons(sizeof(XrdXrootdMonFileTOD));
 
+// Open the local file sink, if any. Packets are appended to it by a separate
+// thread as they are sent and, as each starts with a header holding its length,
+// are easily separated by a reader.
+//
+   if (fsSink
+   &&  (fsFD = open(fsSink, O_WRONLY|O_CREAT|O_APPEND, 0644)) < 0)
+      {eDest->Emsg("MonFile", errno, "open fstat sink", fsSink);
+       return false;
+      }
+
+// Start the sink writer. Packets are flushed by I/O threads holding the buffer
+// lock and those must never wait for the disk.
+//
+   if (fsFD >= 0)
+      {pthread_t tid;
+       int rc;
+       if ((rc = XrdSysThread::Run(&tid, XrdXrootdMonFileSinkQ, (void *)0,
+                                   0, "Monitor fstat sink")))
+          {eDest->Emsg("MonFile", rc, "create fstat sink thread");
+           close(fsFD); fsFD = -1;
+           return false;
+          }
+      }
+
 // Establish first real record in the buffer (always fixed)
 //
    repFirst = repBuff+sizeof(XrdXrootdMonHeader)+sizeof(XrdXrootdMonFileTOD);
@@ -409,6 +500,7 @@ void XrdXrootdMonFile::Flush() // The bfMutex must be locked
 // Write this out
 //
    XrdXrootdMonitor::Send(XROOTD_MON_FSTA, repBuff, bfSize);
+   if (fsFD >= 0) Sink(repBuff, bfSize);
    repTOD->tBeg = repTOD->tEnd;
    xfrRecs = totRecs = 0;
 }
@@ -483,8 +575,13 @@ void XrdXrootdMonFile::Open(XrdXrootdFileStats *fsP, const char *Path,
 //
    fsP->MonEnt = (sNum | (i << XrdXrootdMonFMap::fmShft)) & 0xffff;
    fsP->monLvl = fsLVL;
+   fsP->monLat = fsPCK && fsOPS;
    fsP->xfrXeq = 0;
 
+// Use the compact encoding if so wanted
+//
+   if (fsPCK) {PackOpen(fsP, Path, uDID, isRW); return;}
+
 // Compute the size of this record
 //
    rLen = minRecSz;
@@ -517,3 +614,219 @@ void XrdXrootdMonFile::Open(XrdXrootdFileStats *fsP, const char *Path,
       }
    bfMutex.UnLock();
 }
+
+/******************************************************************************/
+/* Private:                    P a c k C l o s e                              */
+/******************************************************************************/
+  
+void XrdXrootdMonFile::PackClose(XrdXrootdFileStats *fsP, bool isDisc)
+{
+   static const int maxRecSz = 2 + XrdXrootdMonPack::maxVsz*16 + 4*8
+                             + 1 + XrdXrootdMonPack::maxVsz
+                                 * XrdXrootdMonPack::latBins;
+   char *cP, *fP;
+   int i, nBins;
+
+// Get a pointer to the next slot (the buffer gets locked)
+//
+   cP = GetSlot(maxRecSz);
+   *cP++ = XrdXrootdMonPack::isClose;
+   fP    = cP++;
+   *fP   = (isDisc ? XrdXrootdMonPack::forced : 0);
+
+// Insert the I/O bytes
+//
+   cP = XrdXrootdMonPack::PutV(cP, ntohl(fsP->FileID));
+   cP = XrdXrootdMonPack::PutV(cP, fsP->xfr.read);
+   cP = XrdXrootdMonPack::PutV(cP, fsP->xfr.readv);
+   cP = XrdXrootdMonPack::PutV(cP, fsP->xfr.write);
+
+// Insert ops if so wanted. Minimums are zero when there were no requests.
+//
+   if (fsOPS)
+      {*fP |= XrdXrootdMonPack::hasOPS;
+       cP = XrdXrootdMonPack::PutV(cP, fsP->ops.read);
+       cP = XrdXrootdMonPack::PutV(cP, fsP->ops.readv);
+       cP = XrdXrootdMonPack::PutV(cP, fsP->ops.write);
+       cP = XrdXrootdMonPack::PutV(cP, (fsP->ops.readv ? fsP->ops.rsMin : 0));
+       cP = XrdXrootdMonPack::PutV(cP, (fsP->ops.readv ? fsP->ops.rsMax : 0));
+       cP = XrdXrootdMonPack::PutV(cP, fsP->ops.rsegs);
+       cP = XrdXrootdMonPack::PutV(cP, (fsP->ops.read  ? fsP->ops.rdMin : 0));
+       cP = XrdXrootdMonPack::PutV(cP, (fsP->ops.read  ? fsP->ops.rdMax : 0));
+       cP = XrdXrootdMonPack::PutV(cP, (fsP->ops.readv ? fsP->ops.rvMin : 0));
+       cP = XrdXrootdMonPack::PutV(cP, (fsP->ops.readv ? fsP->ops.rvMax : 0));
+       cP = XrdXrootdMonPack::PutV(cP, (fsP->ops.write ? fsP->ops.wrMin : 0));
+       cP = XrdXrootdMonPack::PutV(cP, (fsP->ops.write ? fsP->ops.wrMax : 0));
+      }
+
+// Record sum of squares if so needed
+//
+   if (fsSSQ)
+      {*fP |= XrdXrootdMonPack::hasSSQ;
+       cP = XrdXrootdMonPack::PutD(cP, fsP->ssq.read);
+       cP = XrdXrootdMonPack::PutD(cP, fsP->ssq.readv);
+       cP = XrdXrootdMonPack::PutD(cP, fsP->ssq.rsegs);
+       cP = XrdXrootdMonPack::PutD(cP, fsP->ssq.write);
+      }
+
+// Record the latency histogram, omitting trailing empty bins
+//
+   if (fsP->monLat)
+      {*fP |= XrdXrootdMonPack::hasLAT;
+       nBins = XrdXrootdMonPack::latBins;
+       while(nBins && !fsP->lat[nBins-1]) nBins--;
+       *cP++ = static_cast<char>(nBins);
+       for (i = 0; i < nBins; i++) cP = XrdXrootdMonPack::PutV(cP,fsP->lat[i]);
+      }
+
+// Return unused space in the slot
+//
+   repNext = cP;
+   bfMutex.UnLock();
+}
+
+/******************************************************************************/
+/* Private:                     P a c k O p e n                               */
+/******************************************************************************/
+  
+void XrdXrootdMonFile::PackOpen(XrdXrootdFileStats *fsP, const char *Path,
+                                unsigned int uDID, bool isRW)
+{
+   char *cP;
+   int rLen, pLen = 0;
+
+// Compute the maximum size of this record. The lfn is not null terminated.
+//
+   rLen = 2 + XrdXrootdMonPack::maxVsz*2;
+   if (fsLFN)
+      {pLen = strlen(Path);
+       if (pLen > 1024) pLen = 1024;
+       rLen += XrdXrootdMonPack::maxVsz*2 + pLen;
+      }
+
+// Get a pointer to the next slot (the buffer gets locked) and fill it out
+//
+   cP = GetSlot(rLen);
+   *cP++ = XrdXrootdMonPack::isOpen;
+   *cP++ = (isRW ? XrdXrootdMonPack::hasRW : 0)
+         | (fsLFN ? XrdXrootdMonPack::hasLFN : 0);
+   cP = XrdXrootdMonPack::PutV(cP, ntohl(fsP->FileID));
+   cP = XrdXrootdMonPack::PutV(cP, fsP->fSize);
+   if (fsLFN)
+      {cP = XrdXrootdMonPack::PutV(cP, ntohl(uDID));
+       cP = XrdXrootdMonPack::PutV(cP, pLen);
+       memcpy(cP, Path, pLen); cP += pLen;
+      }
+
+// Return unused space in the slot
+//
+   repNext = cP;
+   bfMutex.UnLock();
+}
+
+/******************************************************************************/
+/*                                 R e a d V                                  */
+/******************************************************************************/
+  
+void XrdXrootdMonFile::ReadV(XrdXrootdFileStats *fsP,
+                             const XrdOucIOVec *vP, int vN)
+{
+   static const int segSz = XrdXrootdMonPack::maxVsz*2;
+   long long prvEnd = 0;
+   char *cP;
+   int i;
+
+// Only report segments if so wanted and they fit in a packet
+//
+   if (!fsSEG || !fsP->monLvl || vN <= 0) return;
+   if ((2 + XrdXrootdMonPack::maxVsz*2 + vN*segSz) > (repLast - repFirst))
+      return;
+
+// Get a pointer to the next slot (the buffer gets locked) and fill it out.
+// Offsets are relative to the end of the previous segment.
+//
+   cP = GetSlot(2 + XrdXrootdMonPack::maxVsz*2 + vN*segSz);
+   *cP++ = XrdXrootdMonPack::isReadV;
+   *cP++ = 0;
+   cP = XrdXrootdMonPack::PutV(cP, ntohl(fsP->FileID));
+   cP = XrdXrootdMonPack::PutV(cP, vN);
+   for (i = 0; i < vN; i++)
+       {cP = XrdXrootdMonPack::PutZ(cP, vP[i].offset - prvEnd);
+        cP = XrdXrootdMonPack::PutV(cP, vP[i].size);
+        prvEnd = vP[i].offset + vP[i].size;
+       }
+
+// Return unused space in the slot
+//
+   repNext = cP;
+   bfMutex.UnLock();
+}
+
+/******************************************************************************/
+/* Private:                         S i n k                                   */
+/******************************************************************************/
+
+void XrdXrootdMonFile::Sink(const char *buff, int blen)
+{
+   SinkMsg *mP;
+
+// Copy the packet as the caller reuses its buffer once we return. Should the
+// disk be unable to keep up we drop the packet rather than stall the caller.
+//
+   if (!(mP = (SinkMsg *)malloc(sizeof(SinkMsg) + blen))) return;
+   mP->Next = 0;
+   mP->Dlen = blen;
+   memcpy(mP->Data, buff, blen);
+
+   sinkMutex.Lock();
+   if (sinkNum >= sinkMax)
+      {sinkDrop++;
+       sinkMutex.UnLock();
+       free(mP);
+       return;
+      }
+   if (sinkLast) sinkLast->Next = mP;
+      else sinkFirst = mP;
+   sinkLast = mP;
+   if (!sinkNum++) sinkSem.Post();
+   sinkMutex.UnLock();
+}
+
+/******************************************************************************/
+/* Private:                        S i n k Q                                  */
+/******************************************************************************/
+
+void XrdXrootdMonFile::SinkQ()
+{
+   SinkMsg *mList, *mP;
+   int nDrop;
+   bool wErr = false;
+   char dBuff[32];
+
+// Wait for packets to arrive and append them to the sink. Only the first
+// write error is reported to avoid flooding the log.
+//
+   while(1)
+        {sinkSem.Wait();
+         sinkMutex.Lock();
+         mList = sinkFirst; sinkFirst = sinkLast = 0; sinkNum = 0;
+         nDrop = sinkDrop;  sinkDrop  = 0;
+         sinkMutex.UnLock();
+
+         while((mP = mList))
+              {if (write(fsFD, mP->Data, mP->Dlen) != mP->Dlen)
+                  {if (!wErr)
+                      eDest->Emsg("MonFile", errno, "write fstat sink", fsSink);
+                   wErr = true;
+                  } else wErr = false;
+               mList = mP->Next;
+               free(mP);
+              }
+
+         if (nDrop)
+            {sprintf(dBuff, "%d", nDrop);
+             eDest->Emsg("MonFile", dBuff, "fstat packets not written to",
+                         fsSink);
+            }
+        }
+}
@@ -40,14 +40,16 @@ class XrdSysError;
 class XrdXrootdFileStats;
 class XrdXrootdMonHeader;
 class XrdXrootdMonTrace;
+struct XrdOucIOVec;
   
 class XrdXrootdMonFile : XrdJob
 {
+friend void *XrdXrootdMonFileSinkQ(void *);
 public:
 
 static void Close(XrdXrootdFileStats *fsP, bool isDisc=false);
 
-static void Defaults(int intv, int opts, int iocnt);
+static void Defaults(int intv, int opts, int iocnt, const char *sink=0);
 
 static void Disc(unsigned int usrID);
 
@@ -58,6 +60,10 @@ static bool Init(XrdScheduler *sp, XrdSysError  *errp, int bfsz=65472);
 static void Open(XrdXrootdFileStats *fsP,
                  const char *Path, unsigned int uDID, bool isRW);
 
+static void ReadV(XrdXrootdFileStats *fsP, const XrdOucIOVec *vP, int vN);
+
+static bool RvSegs() {return fsSEG != 0;}
+
        XrdXrootdMonFile() : XrdJob("monitor fstat") {}
       ~XrdXrootdMonFile() {}
 
@@ -67,6 +73,11 @@ static void                 DoXFR();
 static void                 DoXFR(XrdXrootdFileStats *fsP);
 static void                 Flush();
 static char                *GetSlot(int slotSZ);
+static void                 PackClose(XrdXrootdFileStats *fsP, bool isDisc);
+static void                 PackOpen(XrdXrootdFileStats *fsP, const char *Path,
+                                     unsigned int uDID, bool isRW);
+static void                 Sink(const char *buff, int blen);
+static void                 SinkQ();
                           
 static XrdSysError         *eDest;
 static XrdScheduler        *Sched;
@@ -88,6 +99,22 @@ static int                  fmHWM;
 static int                  crecSize;
 static int                  xfrCnt;
 static int                  xfrRem;
+static int                  fsFD;
+static char                *fsSink;
+
+struct SinkMsg
+      {SinkMsg              *Next;
+       int                   Dlen;
+       char                  Data[8];
+      };
+static SinkMsg             *sinkFirst;
+static SinkMsg             *sinkLast;
+static XrdSysMutex          sinkMutex;
+static XrdSysSemaphore      sinkSem;
+static int                  sinkNum;
+static int                  sinkDrop;
+static const int            sinkMax = 1024;
+
 static XrdXrootdMonFileXFR  xfrRec;
 static short                crecNLen;
 static short                trecNLen;
@@ -96,6 +123,8 @@ static char                 fsLVL;
 static char                 fsOPS;
 static char                 fsSSQ;
 static char                 fsXFR;
+static char                 fsPCK;
+static char                 fsSEG;
 static char                 crecFlag;
 };
 #endif
@@ -0,0 +1,166 @@
+#ifndef __XRDXROOTDMONPACK__
+#define __XRDXROOTDMONPACK__
+/******************************************************************************/
+/*                                                                            */
+/*                   X r d X r o o t d M o n P a c k . h h                    */
+/*                                                                            */
+/* (c) 2014 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                            All Rights Reserved                             */
+/*   Produced by Andrew Hanushevsky for Stanford University under contract    */
+/*              DE-AC02-76-SFO0515 with the Department of Energy              */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <string.h>
+
+#include "XrdSys/XrdSysPlatform.hh"
+#include "XrdXrootd/XrdXrootdMonData.hh"
+
+/******************************************************************************/
+/*          C o m p a c t   " f "   S t r e a m   E n c o d i n g             */
+/******************************************************************************/
+
+// The compact "f" stream carries the same events as the "f" stream but encodes
+// each record using variable length integers (LEB128, 7 bits per byte, low
+// order group first). It is selected by "fstat ... compact". The UDP buffer
+// layout is as follows:
+//
+// XrdXrootdMonHeader    with Code    ==  XROOTD_MON_MAPFPCK
+// XrdXrootdMonFileTOD   with recType == isTime and recFlag == Version
+// <rec> ...             a sequence of compact records (see below)
+//
+// The XrdXrootdMonFileTOD is identical to the one in the "f" stream and is
+// in network byte order. The packet ends at XrdXrootdMonHeader.plen bytes.
+// Every compact record starts with two bytes followed by record specific
+// fields. In what follows, v is a varint, z is a zigzag encoded varint, d is
+// an 8 byte network ordered IEEE754 double, and b is a single byte. All
+// dictionary ids are sent as v in host order (i.e. after ntohl()).
+//
+// b recType  One of recTval
+// b recFlag  One of recFval, depending on recType
+//
+// isOpen:  v fileID v fsize [v userID v lfnlen <lfnlen bytes>]
+//          The bracketed fields are present only if (recFlag & hasLFN).
+// isClose: v fileID v read  v readv v write
+//          [v ops.read  v ops.readv v ops.write v rsMin v rsMax v rsegs
+//           v rdMin     v rdMax     v rvMin     v rvMax v wrMin v wrMax]
+//          [d ssq.read  d ssq.readv d ssq.rsegs d ssq.write]
+//          [b nbins     v bin[0] ... v bin[nbins-1]]
+//          Present only if, respectively, hasOPS, hasSSQ, and hasLAT is set.
+//          bin[i] counts requests that took [2**i, 2**(i+1)) microseconds
+//          to service (bin[0] also counts requests taking under 1us).
+// isXfr:   v fileID v read  v readv v write
+// isDisc:  v userID
+// isReadV: v fileID v nsegs {z offset delta v length} * nsegs
+//          The offset delta is relative to the end of the previous segment
+//          (the first is relative to zero) so sequential segments encode as 0.
+
+class XrdXrootdMonPack
+{
+public:
+
+static const kXR_char Version = 1;
+
+static const int      latBins = 24;  // Latency histogram bins (16s max)
+
+static const int      maxVsz  = 10;  // Longest possible varint
+
+enum  recTval {isClose = 0,   // Record for close
+               isOpen  = 1,   // Record for open
+               isXfr   = 3,   // Record for transfers
+               isDisc  = 4,   // Record for disconnection
+               isReadV = 5    // Record for a readv segment list
+              };
+
+enum  recFval {forced  =0x01, // isClose: close due to disconnect
+               hasOPS  =0x02, // isClose: ops fields are present
+               hasSSQ  =0x04, // isClose: ssq fields are present
+               hasLAT  =0x08, // isClose: latency histogram is present
+               hasLFN  =0x01, // isOpen:  user and lfn are present
+               hasRW   =0x02  // isOpen:  file opened r/w
+              };
+
+//-----------------------------------------------------------------------------
+//! Encode values into a buffer. Each returns the pointer past the value. The
+//! caller must assure that there is enough space in the buffer.
+//-----------------------------------------------------------------------------
+
+static inline
+char          *PutV(char *bP, unsigned long long val)
+                   {while(val >= 0x80)
+                         {*bP++ = static_cast<char>(val | 0x80); val >>= 7;}
+                    *bP++ = static_cast<char>(val);
+                    return bP;
+                   }
+
+static inline
+char          *PutZ(char *bP, long long val)
+                   {return PutV(bP, (static_cast<unsigned long long>(val) << 1)
+                                   ^ static_cast<unsigned long long>(val >> 63));
+                   }
+
+static inline
+char          *PutD(char *bP, double val)
+                   {XrdXrootdMonDouble xval;
+                    xval.dreal = val; xval.dlong = htonll(xval.dlong);
+                    memcpy(bP, &xval.dlong, sizeof(xval.dlong));
+                    return bP + sizeof(xval.dlong);
+                   }
+
+//-----------------------------------------------------------------------------
+//! Decode values from a buffer ending at eP. Each returns the pointer past the
+//! value or nil if the buffer is exhausted or the value is malformed.
+//-----------------------------------------------------------------------------
+
+static inline
+const char    *GetV(const char *bP, const char *eP, unsigned long long &val)
+                   {int shft = 0;
+                    val = 0;
+                    while(bP < eP && shft < 64)
+                         {val |= static_cast<unsigned long long>(*bP & 0x7f)
+                                 << shft;
+                          if (!(*bP++ & 0x80)) return bP;
+                          shft += 7;
+                         }
+                    return 0;
+                   }
+
+static inline
+const char    *GetZ(const char *bP, const char *eP, long long &val)
+                   {unsigned long long uval;
+                    if (!(bP = GetV(bP, eP, uval))) return 0;
+                    val = static_cast<long long>(uval >> 1)
+                        ^ -static_cast<long long>(uval & 1);
+                    return bP;
+                   }
+
+static inline
+const char    *GetD(const char *bP, const char *eP, double &val)
+                   {XrdXrootdMonDouble xval;
+                    if (eP - bP < static_cast<int>(sizeof(xval.dlong))) return 0;
+                    memcpy(&xval.dlong, bP, sizeof(xval.dlong));
+                    xval.dlong = ntohll(xval.dlong);
+                    val = xval.dreal;
+                    return bP + sizeof(xval.dlong);
+                   }
+};
+#endif
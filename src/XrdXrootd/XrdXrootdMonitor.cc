@@ -43,6 +43,7 @@
 #include "XrdNet/XrdNetMsg.hh"
 #include "XrdOuc/XrdOucEnv.hh"
 #include "XrdOuc/XrdOucUtils.hh"
+#include "XrdSys/XrdSysAtomics.hh"
 #include "XrdSys/XrdSysError.hh"
 #include "XrdSys/XrdSysPlatform.hh"
 
@@ -71,9 +72,18 @@ kXR_int32          XrdXrootdMonitor::startTime  = 0;
 int                XrdXrootdMonitor::monRlen    = 0;
 XrdXrootdMonitor::MonRdrBuff
                    XrdXrootdMonitor::rdrMon[XrdXrootdMonitor::rdrMax];
-XrdXrootdMonitor::MonRdrBuff
-                  *XrdXrootdMonitor::rdrMP      = 0;
+int                XrdXrootdMonitor::rdrCnt     = 0;
+unsigned int       XrdXrootdMonitor::rdrNext    = 0;
 XrdSysMutex        XrdXrootdMonitor::rdrMutex;
+XrdXrootdMonitor::MonMsg
+                  *XrdXrootdMonitor::sendFirst  = 0;
+XrdXrootdMonitor::MonMsg
+                  *XrdXrootdMonitor::sendLast   = 0;
+XrdSysMutex        XrdXrootdMonitor::sendMutex;
+XrdSysSemaphore    XrdXrootdMonitor::sendSem(0);
+int                XrdXrootdMonitor::sendNum    = 0;
+int                XrdXrootdMonitor::sendDrop   = 0;
+bool               XrdXrootdMonitor::sendAsync  = false;
 int                XrdXrootdMonitor::monBlen    = 0;
 int                XrdXrootdMonitor::lastEnt    = 0;
 int                XrdXrootdMonitor::lastRnt    = 0;
@@ -175,6 +185,16 @@ XrdScheduler  *Sched;     // System scheduler
 int            Window;
 };
 
+/******************************************************************************/
+/*                     T h r e a d   I n t e r f a c e s                      */
+/******************************************************************************/
+  
+void *XrdXrootdMonSendQ(void *carg)
+{
+   XrdXrootdMonitor::SendQ();
+   return (void *)0;
+}
+
 /******************************************************************************/
 /*            C l a s s   X r d X r o o t d M o n i t o r L o c k             */
 /******************************************************************************/
@@ -437,7 +457,8 @@ void XrdXrootdMonitor::Defaults(char *dest1, int mode1, char *dest2, int mode2)
 
 void XrdXrootdMonitor::Defaults(int msz,   int rsz,   int wsz,
                                 int flush, int flash, int idt, int rnm,
-                                int fsint, int fsopt, int fsion)
+                                int fsint, int fsopt, int fsion,
+                                const char *fsfile)
 {
 
 // Set default window size and flush time
@@ -452,7 +473,7 @@ void XrdXrootdMonitor::Defaults(int msz,   int rsz,   int wsz,
 
 // Set the fstat defaults
 //
-   XrdXrootdMonFile::Defaults(fsint, fsopt, fsion);
+   XrdXrootdMonFile::Defaults(fsint, fsopt, fsion, fsfile);
    monFSTAT = fsint != 0;
 
 // Set default monitor buffer size
@@ -524,14 +545,16 @@ void XrdXrootdMonitor::Dup(XrdXrootdMonTrace *mrec)
   
 XrdXrootdMonitor::MonRdrBuff *XrdXrootdMonitor::Fetch()
 {
-   MonRdrBuff *bP;
+   unsigned int bNum;
 
-// Get the next available stream and promote another one
+// Get the next available stream in round-robin fashion. A simple counter is
+// all we need so there is no reason to serialize callers here.
 //
-   rdrMutex.Lock();
-   if ((bP = rdrMP)) rdrMP = rdrMP->Next;
-   rdrMutex.UnLock();
-   return bP;
+   if (!rdrCnt) return 0;
+   AtomicBeg(rdrMutex);
+   bNum = AtomicInc(rdrNext);
+   AtomicEnd(rdrMutex);
+   return &rdrMon[bNum % rdrCnt];
 }
 
 /******************************************************************************/
@@ -588,6 +611,17 @@ int XrdXrootdMonitor::Init(XrdScheduler *sp,    XrdSysError *errp,
           }
       }
 
+// Start the sender thread so that messages are never sent inline. Should we
+// not be able to start it, we simply fall back to sending inline.
+//
+   {pthread_t tid;
+    int rc;
+    if ((rc = XrdSysThread::Run(&tid, XrdXrootdMonSendQ, (void *)0,
+                                0, "Monitor sender")))
+       eDest->Emsg("Monitor", rc, "create monitor sender thread");
+       else sendAsync = true;
+   }
+
 // If there is a destination that is only collecting file events, then
 // allocate a global monitor object but don't start the timer just yet.
 //
@@ -636,13 +670,11 @@ int XrdXrootdMonitor::Init(XrdScheduler *sp,    XrdSysError *errp,
            }
         rdrMon[i].Buff->sID    = mySID;
         rdrMon[i].Buff->sXX[0] = XROOTD_MON_REDSID;
-        rdrMon[i].Next = (i ? &rdrMon[i-1] : &rdrMon[0]);
         rdrMon[i].nextEnt = 0;
         rdrMon[i].flushIt = Now + autoFlush;
         rdrMon[i].lastTOD = 0;
        }
-   rdrMon[0].Next = &rdrMon[i-1];
-   rdrMP = &rdrMon[0];
+   rdrCnt = rdrNum;
 
 // All done
 //
@@ -661,9 +693,9 @@ kXR_unt32 XrdXrootdMonitor::GetDictID()
 
 // Assign a unique ID for this entry
 //
-   seqMutex.Lock();
-   mySeqID = monSeqID++;
-   seqMutex.UnLock();
+   AtomicBeg(seqMutex);
+   mySeqID = AtomicInc(monSeqID);
+   AtomicEnd(seqMutex);
 
 // Return the ID
 //
@@ -897,9 +929,9 @@ void XrdXrootdMonitor::fillHeader(XrdXrootdMonHeader *hdr,
 
 // Generate a new sequence number
 //
-   seqMutex.Lock();
-   myseq = 0x00ff & (seq++);
-   seqMutex.UnLock();
+   AtomicBeg(seqMutex);
+   myseq = 0x00ff & AtomicInc(seq);
+   AtomicEnd(seqMutex);
 
 // Fill in the header
 //
@@ -1038,14 +1070,59 @@ void XrdXrootdMonitor::Mark()
 /******************************************************************************/
   
 int XrdXrootdMonitor::Send(int monMode, void *buff, int blen)
+{
+   MonMsg *mP;
+
+// If there is no sender thread, send the message inline
+//
+   if (!sendAsync) return SendNow(monMode, buff, blen);
+
+// Avoid copying messages that no one wants
+//
+   if (!((monMode & monMode1 && InetDest1) || (monMode & monMode2 && InetDest2)))
+      return 0;
+
+// Copy the message so that the caller can immediately reuse its buffer
+//
+   if (!(mP = (MonMsg *)malloc(sizeof(MonMsg) + blen))) return -ENOMEM;
+   mP->Next = 0;
+   mP->Mode = monMode;
+   mP->Dlen = blen;
+   memcpy(mP->Data, buff, blen);
+
+// Queue the message for the sender thread. Should the collector be unable to
+// keep up we drop the message rather than stall the caller. The sender is
+// only woken up when the queue goes from empty to non-empty as it always
+// drains the whole queue before waiting again.
+//
+   sendMutex.Lock();
+   if (sendNum >= sendMax)
+      {sendDrop++;
+       sendMutex.UnLock();
+       free(mP);
+       return 1;
+      }
+   if (sendLast) sendLast->Next = mP;
+      else sendFirst = mP;
+   sendLast = mP;
+   if (!sendNum++) sendSem.Post();
+   sendMutex.UnLock();
+   return 0;
+}
+
+/******************************************************************************/
+/*                               S e n d N o w                                */
+/******************************************************************************/
+  
+int XrdXrootdMonitor::SendNow(int monMode, void *buff, int blen)
 {
 #ifndef NODEBUG
     const char *TraceID = "Monitor";
 #endif
-    static XrdSysMutex sendMutex;
+    static XrdSysMutex xmitMutex;
     int rc1, rc2;
 
-    sendMutex.Lock();
+    xmitMutex.Lock();
     if (monMode & monMode1 && InetDest1)
        {rc1  = InetDest1->Send((char *)buff, blen);
         TRACE(DEBUG,blen <<" bytes sent to " <<Dest1 <<" rc=" <<rc1);
@@ -1056,11 +1133,69 @@ int XrdXrootdMonitor::Send(int monMode, void *buff, int blen)
         TRACE(DEBUG,blen <<" bytes sent to " <<Dest2 <<" rc=" <<rc2);
        }
        else rc2 = 0;
-    sendMutex.UnLock();
+    xmitMutex.UnLock();
 
     return (rc1 ? rc1 : rc2);
 }
 
+/******************************************************************************/
+/*                                 S e n d Q                                  */
+/******************************************************************************/
+  
+void XrdXrootdMonitor::SendQ()
+{
+#ifndef NODEBUG
+   const char *TraceID = "Monitor";
+#endif
+   static const int msgMax = 64;
+   struct iovec iov1[msgMax], iov2[msgMax];
+   MonMsg *mList, *mP, *mNext;
+   int n1, n2, nDrop, rc;
+   char dBuff[32];
+
+// Wait for messages to arrive and send them off in batches. Each message is a
+// separate datagram but the kernel gets a whole batch at a time.
+//
+   while(1)
+        {sendSem.Wait();
+         sendMutex.Lock();
+         mList = sendFirst; sendFirst = sendLast = 0; sendNum = 0;
+         nDrop = sendDrop;  sendDrop  = 0;
+         sendMutex.UnLock();
+
+         while(mList)
+              {n1 = n2 = 0; mP = mList;
+               while(mP && n1 < msgMax && n2 < msgMax)
+                    {if (mP->Mode & monMode1 && InetDest1)
+                        {iov1[n1].iov_base = mP->Data;
+                         iov1[n1].iov_len  = mP->Dlen; n1++;
+                        }
+                     if (mP->Mode & monMode2 && InetDest2)
+                        {iov2[n2].iov_base = mP->Data;
+                         iov2[n2].iov_len  = mP->Dlen; n2++;
+                        }
+                     mP = mP->Next;
+                    }
+               if (n1)
+                  {rc = InetDest1->SendBatch(iov1, n1);
+                   TRACE(DEBUG,n1 <<" msgs sent to " <<Dest1 <<" rc=" <<rc);
+                  }
+               if (n2)
+                  {rc = InetDest2->SendBatch(iov2, n2);
+                   TRACE(DEBUG,n2 <<" msgs sent to " <<Dest2 <<" rc=" <<rc);
+                  }
+               while(mList != mP)
+                    {mNext = mList->Next; free(mList); mList = mNext;}
+              }
+
+         if (nDrop)
+            {snprintf(dBuff, sizeof(dBuff), "%d", nDrop);
+             eDest->Emsg("Monitor", "Send queue full;", dBuff,
+                                    "monitor records dropped.");
+            }
+        }
+}
+
 /******************************************************************************/
 /*                            s t a r t C l o c k                             */
 /******************************************************************************/
@@ -59,6 +59,8 @@
 #define XROOTD_MON_FSOPS    2
 #define XROOTD_MON_FSSSQ    4
 #define XROOTD_MON_FSXFR    8
+#define XROOTD_MON_FSPCK   16
+#define XROOTD_MON_FSSEG   32
 
 class XrdScheduler;
 class XrdNetMsg;
@@ -74,6 +76,7 @@ public:
        class User;
 friend class User;
 friend class XrdXrootdMonFile;
+friend void *XrdXrootdMonSendQ(void *);
 
 // All values for Add_xx() must be passed in network byte order
 //
@@ -111,7 +114,8 @@ inline void              Add_wr(kXR_unt32 dictid,
 static void              Defaults(char *dest1, int m1, char *dest2, int m2);
 static void              Defaults(int msz,     int rsz,     int wsz,
                                   int flush,   int flash,   int iDent, int rnm,
-                                  int fsint=0, int fsopt=0, int fsion=0);
+                                  int fsint=0, int fsopt=0, int fsion=0,
+                                  const char *fsfile=0);
 
 static void              Ident() {Send(-1, idRec, idLen);}
 
@@ -193,16 +197,31 @@ private:
 
 static
 struct MonRdrBuff
-      {MonRdrBuff        *Next;
-       XrdXrootdMonBurr  *Buff;
+      {XrdXrootdMonBurr  *Buff;
        int                nextEnt;
        int                flushIt;
        kXR_int32          lastTOD;
        XrdSysMutex        Mutex;
       }                   rdrMon[rdrMax];
-static MonRdrBuff        *rdrMP;
+static int                rdrCnt;
+static unsigned int       rdrNext;
 static XrdSysMutex        rdrMutex;
 
+struct MonMsg
+      {MonMsg            *Next;
+       int                Mode;
+       int                Dlen;
+       char               Data[8];
+      };
+static MonMsg            *sendFirst;
+static MonMsg            *sendLast;
+static XrdSysMutex        sendMutex;
+static XrdSysSemaphore    sendSem;
+static int                sendNum;
+static int                sendDrop;
+static bool               sendAsync;
+static const int          sendMax = 4096;
+
 inline void              Add_io(kXR_unt32 duid, kXR_int32 blen, kXR_int64 offs)
                                {if (lastWindow != currWindow) Mark();
                                    else if (nextEnt == lastEnt) Flush();
@@ -223,6 +242,8 @@ static kXR_unt32         Map(char  code, XrdXrootdMonitor::User &uInfo,
                              const char *path);
        void              Mark();
 static int               Send(int mmode, void *buff, int size);
+static int               SendNow(int mmode, void *buff, int size);
+static void              SendQ();
 static void              startClock();
 static void              unAlloc(XrdXrootdMonitor *monp);
 
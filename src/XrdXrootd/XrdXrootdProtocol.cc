@@ -331,8 +331,14 @@ int dlen, rc;
   
 int XrdXrootdProtocol::Process(XrdLink *lp) // We ignore the argument here
 {
+   long long qTime;
    int rc;
 
+// Account for the time the link waited for a thread after it became ready
+//
+   if ((qTime = Link->QueueTime()))
+      SI->Lat.Add(XrdXrootdLatency::latQueue, XrdXrootdLatency::Now() - qTime);
+
 // Check if we are servicing a slow link
 //
    if (Resume)
@@ -390,6 +396,24 @@ int XrdXrootdProtocol::Process(XrdLink *lp) // We ignore the argument here
 /******************************************************************************/
   
 int XrdXrootdProtocol::Process2()
+{
+   int lType = XrdXrootdLatency::Type(Request.header.requestid);
+   long long tBeg = XrdXrootdLatency::Now();
+   int rc;
+
+// Execute the request and record how long it took. Note that the request
+// may be asynchronous in which case this only covers the synchronous part.
+//
+   rc = Dispatch();
+   SI->Lat.Add(lType, XrdXrootdLatency::Now() - tBeg);
+   return rc;
+}
+
+/******************************************************************************/
+/*                      p r i v a t e   D i s p a t c h                       */
+/******************************************************************************/
+  
+int XrdXrootdProtocol::Dispatch()
 {
 
 // If the user is not yet logged in, restrict what the user can do
@@ -28,6 +28,8 @@
 /******************************************************************************/
  
 #include <stdio.h>
+#include <stdlib.h>
+#include <strings.h>
   
 #include "Xrd/XrdStats.hh"
 #include "XrdSfs/XrdSfsInterface.hh"
@@ -81,7 +83,7 @@ int XrdXrootdStats::Stats(char *buff, int blen, int do_sync)
    "<sync>%d</sync><getf>%d</getf><putf>%d</putf><misc>%d</misc></ops>"
    "<aio><num>%lld</num><max>%d</max><rej>%lld</rej></aio>"
    "<err>%d</err><rdr>%lld</rdr><dly>%d</dly>"
-   "<lgn><num>%d</num><af>%d</af><au>%d</au><ua>%d</ua></lgn></stats>";
+   "<lgn><num>%d</num><af>%d</af><au>%d</au><ua>%d</ua></lgn>";
 //                                   1 2 3 4 5 6 7 8
    static const long long LLMax = 0x7fffffffffffffffLL;
    static const int       INMax = 0x7fffffff;
@@ -96,6 +98,7 @@ int XrdXrootdStats::Stats(char *buff, int blen, int do_sync)
                       INMax, INMax,
                       LLMax, INMax, LLMax, INMax, LLMax, INMax,
                       INMax, INMax, INMax, INMax);
+       len += Lat.Summary(0, 0) + 8;
        return len + (fsP ? fsP->getStats(0,0) : 0);
       }
 
@@ -109,6 +112,12 @@ int XrdXrootdStats::Stats(char *buff, int blen, int do_sync)
                   LoginAT, AuthBad, LoginAU, LoginUA);
    statsMutex.UnLock();
 
+// Add the latency summary and close off our section
+//
+   if (len < blen) len += Lat.Summary(buff+len, blen-len);
+   if (len < blen) len += snprintf(buff+len, blen-len, "</stats>");
+   if (len >= blen) return 0;
+
 // Now include filesystem statistics and return
 //
    if (fsP) len += fsP->getStats(buff+len, blen-len);
@@ -132,6 +141,20 @@ int XrdXrootdStats::Stats(XrdXrootdResponse &resp, const char *opts)
     statsInfo statsResp(&resp);
     int xopts = 0;
 
+// The full latency histograms are requested by 'h' and, as they are only
+// known to us, they are returned in place of anything else requested.
+//
+    if (index(opts, 'h'))
+       {int rc, bsz = Lat.Detail(0, 0) + 1;
+        char *bP = (char *)malloc(bsz);
+        if (!bP) return resp.Send(kXR_NoMemory, "insufficient memory");
+        if ((bsz = Lat.Detail(bP, bsz)) <= 0)
+           rc = resp.Send(kXR_ServerError, "unable to format latency histograms");
+           else rc = resp.Send((void *)bP, bsz+1);
+        free(bP);
+        return rc;
+       }
+
     while(*opts)
          {switch(*opts)
                 {case 'a': xopts |= XRD_STATS_ALL;  break;
@@ -31,6 +31,7 @@
 
 #include "XrdSys/XrdSysPthread.hh"
 #include "XrdOuc/XrdOucStats.hh"
+#include "XrdXrootd/XrdXrootdLatency.hh"
 
 class XrdSfsFileSystem;
 class XrdStats;
@@ -62,6 +63,7 @@ int              LoginAT;      // Stats: Number of   attempted     logins
 int              LoginAU;      // Stats: Number of   authenticated logins
 int              LoginUA;      // Stats: Number of unauthenticated logins
 int              AuthBad;      // Stats: Number of authentication failures
+XrdXrootdLatency Lat;          // Stats: Request latency histograms
 
 void             setFS(XrdSfsFileSystem *fsp) {fsP = fsp;}
 
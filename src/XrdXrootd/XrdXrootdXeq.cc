@@ -1157,6 +1157,7 @@ int XrdXrootdProtocol::do_Open()
    int fhandle;
    int rc, mode, opts, openopts, doforce = 0, compchk = 0;
    int popt, retStat = 0;
+   long long tBeg;
    const char *opaque;
    char usage, ebuff[2048], opC;
    bool doDig;
@@ -1255,11 +1256,13 @@ int XrdXrootdProtocol::do_Open()
    fp->error.setErrCB(&openCB, ReqID.getID());
    fp->error.setUCap(clientPV);
 
-// Open the file
+// Open the file, recording how long the filesystem took (this includes any
+// cmsd location lookup done on our behalf when we are a redirector).
 //
-   if ((rc = fp->open(fn, (XrdSfsFileOpenMode)openopts,
-                     (mode_t)mode, CRED, opaque)))
-      {rc = fsError(rc, opC, fp->error, fn); delete fp; return rc;}
+   tBeg = XrdXrootdLatency::Now();
+   rc = fp->open(fn, (XrdSfsFileOpenMode)openopts, (mode_t)mode, CRED, opaque);
+   SI->Lat.Add(XrdXrootdLatency::latOpenFS, XrdXrootdLatency::Now() - tBeg);
+   if (rc) {rc = fsError(rc, opC, fp->error, fn); delete fp; return rc;}
 
 // Obtain a hyper file object
 //
@@ -1882,8 +1885,14 @@ int XrdXrootdProtocol::do_Read()
 //
    if (pathID) return do_Offload(pathID, 0);
 
-// Now read all of the data (do pre-reads first)
+// Now read all of the data (do pre-reads first). Time it if we need to.
 //
+   if (myFile->Stats.monLat)
+      {long long rqBeg = XrdXrootdFileStats::Clock();
+       int rc = do_ReadAll();
+       myFile->Stats.rqLat(rqBeg);
+       return rc;
+      }
    return do_ReadAll();
 }
 
@@ -2023,7 +2032,8 @@ int XrdXrootdProtocol::do_ReadV()
    const int hdrSZ = sizeof(readahead_list);
    struct XrdOucIOVec     rdVec[maxRvecsz+1];
    struct readahead_list *raVec, respHdr;
-   long long totSZ;
+   XrdXrootdFileStats *latStats = 0;
+   long long totSZ, rqBeg = 0;
    XrdSfsXferSize rdVAmt, rdVXfr, xfrSZ;
    int rdVBeg, rdVBreak, rdVNow, rdVNum, rdVecNum;
    int currFH, i, k, Quantum, Qleft, rdVecLen = Request.header.dlen;
@@ -2100,6 +2110,8 @@ int XrdXrootdProtocol::do_ReadV()
    memcpy(respHdr.fhandle, &currFH, sizeof(respHdr.fhandle));
    if (!(myFile = FTab->Get(currFH))) return Response.Send(kXR_FileNotOpen,
                                       "readv does not refer to an open file");
+   if (myFile->Stats.monLat)
+      {latStats = &myFile->Stats; rqBeg = XrdXrootdFileStats::Clock();}
 
 // Setup variables for running through the list.
 //
@@ -2114,6 +2126,8 @@ int XrdXrootdProtocol::do_ReadV()
             if (xfrSZ != rdVAmt) break;
             rdVNum = i - rdVBeg; rdVXfr += rdVAmt;
             myFile->Stats.rvOps(rdVXfr, rdVNum);
+            if (XrdXrootdMonFile::RvSegs())
+               XrdXrootdMonFile::ReadV(&myFile->Stats,&rdVec[rdVBeg],rdVNum);
             if (rvMon)
                {Monitor.Agent->Add_rv(myFile->Stats.FileID, htonl(rdVXfr),
                                               htons(rdVNum), rvSeq, vType);
@@ -2161,6 +2175,10 @@ int XrdXrootdProtocol::do_ReadV()
        return fsError(xfrSZ, 0, myFile->XrdSfsp->error, 0);
       }
 
+// Record the latency of the whole request against the file it started with
+//
+   if (latStats) latStats->rqLat(rqBeg);
+
 // All done, return result of the last segment or just zero
 //
    return (Quantum != Qleft ? Response.Send(argp->buff, Quantum-Qleft) : 0);
@@ -24,6 +24,9 @@
 #include "CppUnitXrdHelpers.hh"
 
 #include <pthread.h>
+#include <unistd.h>
+#include <ctime>
+#include <sstream>
 
 #include "TestEnv.hh"
 #include "IdentityPlugIn.hh"
@@ -41,6 +44,7 @@ class FileSystemTest: public CppUnit::TestCase
       CPPUNIT_TEST( MvTest );
       CPPUNIT_TEST( ServerQueryTest );
       CPPUNIT_TEST( TruncateRmTest );
+      CPPUNIT_TEST( CreateNewTest );
       CPPUNIT_TEST( MkdirRmdirTest );
       CPPUNIT_TEST( ChmodTest );
       CPPUNIT_TEST( PingTest );
@@ -51,12 +55,14 @@ class FileSystemTest: public CppUnit::TestCase
       CPPUNIT_TEST( DirListTest );
       CPPUNIT_TEST( SendInfoTest );
       CPPUNIT_TEST( PrepareTest );
+      CPPUNIT_TEST( PrepareBatchTest );
       CPPUNIT_TEST( PlugInTest );
     CPPUNIT_TEST_SUITE_END();
     void LocateTest();
     void MvTest();
     void ServerQueryTest();
     void TruncateRmTest();
+    void CreateNewTest();
     void MkdirRmdirTest();
     void ChmodTest();
     void PingTest();
@@ -67,6 +73,7 @@ class FileSystemTest: public CppUnit::TestCase
     void DirListTest();
     void SendInfoTest();
     void PrepareTest();
+    void PrepareBatchTest();
     void PlugInTest();
 };
 
@@ -201,6 +208,54 @@ void FileSystemTest::TruncateRmTest()
   CPPUNIT_ASSERT_XRDST( fs.Rm( filePath ) );
 }
 
+//------------------------------------------------------------------------------
+// Create a file that no server has through the manager. When the data servers
+// send namespace summaries (cms.summary) every one of them rules the file out,
+// which must still let the manager select a server for the new file.
+//------------------------------------------------------------------------------
+void FileSystemTest::CreateNewTest()
+{
+  using namespace XrdCl;
+
+  //----------------------------------------------------------------------------
+  // Get the environment variables
+  //----------------------------------------------------------------------------
+  Env *testEnv = TestEnv::GetEnv();
+
+  std::string address;
+  std::string dataPath;
+
+  CPPUNIT_ASSERT( testEnv->GetString( "MainServerURL", address ) );
+  CPPUNIT_ASSERT( testEnv->GetString( "DataPath", dataPath ) );
+
+  URL url( address );
+  CPPUNIT_ASSERT( url.IsValid() );
+
+  std::ostringstream name;
+  name << dataPath << "/testfile_new_" << getpid() << "_" << time(0);
+  std::string filePath = name.str();
+  std::string fileUrl  = address + "/";
+  fileUrl += filePath;
+
+  //----------------------------------------------------------------------------
+  // Create, write and check the file, then remove it
+  //----------------------------------------------------------------------------
+  FileSystem fs( url );
+  File       f;
+  char       buff[] = "new file";
+  StatInfo  *info = 0;
+
+  CPPUNIT_ASSERT_XRDST( f.Open( fileUrl, OpenFlags::New | OpenFlags::Write,
+                                Access::UR | Access::UW ) );
+  CPPUNIT_ASSERT_XRDST( f.Write( 0, sizeof(buff), buff ) );
+  CPPUNIT_ASSERT_XRDST( f.Close() );
+  CPPUNIT_ASSERT_XRDST( fs.Stat( filePath, info ) );
+  CPPUNIT_ASSERT( info );
+  CPPUNIT_ASSERT( info->GetSize() == sizeof(buff) );
+  delete info;
+  CPPUNIT_ASSERT_XRDST( fs.Rm( filePath ) );
+}
+
 //------------------------------------------------------------------------------
 // Mkdir/Rmdir test
 //------------------------------------------------------------------------------
@@ -496,6 +551,58 @@ void FileSystemTest::PrepareTest()
   delete id;
 }
 
+//------------------------------------------------------------------------------
+// Prepare a batch of files; the manager splits it and forwards each path to
+// the server holding it, after which the cluster must still answer for all
+//------------------------------------------------------------------------------
+void FileSystemTest::PrepareBatchTest()
+{
+  using namespace XrdCl;
+
+  //----------------------------------------------------------------------------
+  // Get the environment variables
+  //----------------------------------------------------------------------------
+  Env *testEnv = TestEnv::GetEnv();
+
+  std::string address;
+  std::string dataPath;
+
+  CPPUNIT_ASSERT( testEnv->GetString( "MainServerURL", address ) );
+  CPPUNIT_ASSERT( testEnv->GetString( "DataPath", dataPath ) );
+  URL url( address );
+  CPPUNIT_ASSERT( url.IsValid() );
+
+  FileSystem fs( url );
+
+  std::vector<std::string> list;
+  list.push_back( dataPath + "/1db882c8-8cd6-4df1-941f-ce669bad3458.dat" );
+  list.push_back( dataPath + "/3c9a9dd8-bc75-422c-b12c-f00604486cc1.dat" );
+  list.push_back( dataPath + "/7235b5d1-cede-4700-a8f9-596506b4cc38.dat" );
+  list.push_back( dataPath + "/7e480547-fe1a-4eaf-a210-0f3927751a43.dat" );
+  list.push_back( dataPath + "/89120cec-5244-444c-9313-703e4bee72de.dat" );
+
+  Buffer *id = 0;
+  CPPUNIT_ASSERT_XRDST( fs.Prepare( list, PrepareFlags::Stage, 1, id ) );
+  CPPUNIT_ASSERT( id );
+  CPPUNIT_ASSERT( id->GetSize() );
+  delete id;
+
+  //----------------------------------------------------------------------------
+  // Give the forwarded requests time to arrive and make sure every server
+  // still understands its manager
+  //----------------------------------------------------------------------------
+  sleep( 1 );
+  for( size_t i = 0; i < list.size(); ++i )
+  {
+    LocationInfo *locations = 0;
+    CPPUNIT_ASSERT_XRDST( fs.DeepLocate( list[i], OpenFlags::Refresh,
+                                         locations ) );
+    CPPUNIT_ASSERT( locations );
+    CPPUNIT_ASSERT( locations->GetSize() != 0 );
+    delete locations;
+  }
+}
+
 //------------------------------------------------------------------------------
 // Plug-in test
 //------------------------------------------------------------------------------
@@ -0,0 +1,309 @@
+//------------------------------------------------------------------------------
+// Copyright (c) 2014 by European Organization for Nuclear Research (CERN)
+//------------------------------------------------------------------------------
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//------------------------------------------------------------------------------
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "TestEnv.hh"
+#include "Utils.hh"
+#include "CppUnitXrdHelpers.hh"
+#include "XrdCl/XrdClLog.hh"
+#include "XrdOuc/XrdOucIOVec.hh"
+#include "XrdPosix/XrdPosixCallBack.hh"
+#include "XrdPosix/XrdPosixXrootd.hh"
+#include "XrdSys/XrdSysPthread.hh"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <cerrno>
+#include <cstring>
+
+using namespace XrdClTests;
+
+//------------------------------------------------------------------------------
+// Declaration
+//------------------------------------------------------------------------------
+class PosixTest: public CppUnit::TestCase
+{
+  public:
+    CPPUNIT_TEST_SUITE( PosixTest );
+      CPPUNIT_TEST( AsyncReadTest );
+      CPPUNIT_TEST( AsyncVectorReadTest );
+      CPPUNIT_TEST( AsyncWriteTest );
+    CPPUNIT_TEST_SUITE_END();
+    void AsyncReadTest();
+    void AsyncVectorReadTest();
+    void AsyncWriteTest();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( PosixTest );
+
+namespace
+{
+  //----------------------------------------------------------------------------
+  // The posix layer needs one instance per executable image
+  //----------------------------------------------------------------------------
+  XrdPosixXrootd posixXrootd( -1024 );
+
+  const int      BlockSize = 4096;
+
+  uint64_t Now()
+  {
+    timeval tv;
+    gettimeofday( &tv, 0 );
+    return tv.tv_sec*1000000ULL + tv.tv_usec;
+  }
+
+  //----------------------------------------------------------------------------
+  // State shared by all of the outstanding reads of a run
+  //----------------------------------------------------------------------------
+  struct ReadRun
+  {
+    ReadRun(): fd( -1 ), reference( 0 ), blocks( 0 ), total( 0 ),
+               issued( 0 ), done( 0 ), failed( 0 ), finished( 0 ) {}
+    int              fd;
+    const char      *reference;
+    int              blocks;
+    int              total;
+    int              issued;
+    int              done;
+    int              failed;
+    XrdSysMutex      mutex;
+    XrdSysSemaphore  finished;
+  };
+
+  //----------------------------------------------------------------------------
+  // A reader that issues the next read from the completion callback so that
+  // a fixed number of reads are always in flight
+  //----------------------------------------------------------------------------
+  class Reader: public XrdPosixCallBackIO
+  {
+    public:
+      Reader(): run( 0 ), offset( 0 ) {}
+
+      void Start()
+      {
+        run->mutex.Lock();
+        if( run->issued >= run->total )
+        {
+          run->mutex.UnLock();
+          return;
+        }
+        offset = ((run->issued++ * 7919LL) % run->blocks) * BlockSize;
+        run->mutex.UnLock();
+        XrdPosixXrootd::Pread( run->fd, buffer, BlockSize, offset, this );
+      }
+
+      virtual void Done( int result )
+      {
+        bool ok = ( result == BlockSize &&
+                    !memcmp( buffer, run->reference + offset, BlockSize ) );
+        run->mutex.Lock();
+        if( !ok ) run->failed++;
+        bool last = ( ++run->done == run->total );
+        run->mutex.UnLock();
+        if( last ) run->finished.Post();
+        else Start();
+      }
+
+      ReadRun   *run;
+      off_t      offset;
+      char       buffer[BlockSize];
+  };
+
+  //----------------------------------------------------------------------------
+  // A callback that simply records the result
+  //----------------------------------------------------------------------------
+  class Waiter: public XrdPosixCallBackIO
+  {
+    public:
+      Waiter(): result( 0 ), sem( 0 ) {}
+      virtual void Done( int res ) { result = res; sem.Post(); }
+      int Wait() { sem.Wait(); return result; }
+      int             result;
+      XrdSysSemaphore sem;
+  };
+
+  //----------------------------------------------------------------------------
+  // Read the file at the given queue depth and return the number of IOPS
+  //----------------------------------------------------------------------------
+  double ReadAtDepth( ReadRun &run, int depth, int total )
+  {
+    Reader *readers = new Reader[depth];
+    run.issued = run.done = run.failed = 0;
+    run.total  = total;
+
+    uint64_t start = Now();
+    for( int i = 0; i < depth; ++i )
+    {
+      readers[i].run = &run;
+      readers[i].Start();
+    }
+    run.finished.Wait();
+    uint64_t elapsed = Now() - start;
+
+    delete [] readers;
+    return elapsed ? total * 1000000.0 / elapsed : 0;
+  }
+
+  //----------------------------------------------------------------------------
+  // Open the test file and read the reference copy synchronously
+  //----------------------------------------------------------------------------
+  char *OpenReference( int &fd, int &size )
+  {
+    XrdCl::Env *testEnv = TestEnv::GetEnv();
+    std::string address;
+    std::string dataPath;
+    struct stat buf;
+
+    CPPUNIT_ASSERT( testEnv->GetString( "MainServerURL", address ) );
+    CPPUNIT_ASSERT( testEnv->GetString( "DataPath", dataPath ) );
+
+    std::string fileUrl = "root://" + address + "/" + dataPath +
+                          "/cb4aacf1-6f28-42f2-b68a-90a73460f424.dat";
+
+    fd = XrdPosixXrootd::Open( fileUrl.c_str(), O_RDONLY );
+    CPPUNIT_ASSERT( fd >= 0 );
+    CPPUNIT_ASSERT( XrdPosixXrootd::Fstat( fd, &buf ) == 0 );
+
+    size = ( buf.st_size > 16*1024*1024 ? 16*1024*1024 : (int)buf.st_size );
+    size = size / BlockSize * BlockSize;
+    CPPUNIT_ASSERT( size > 0 );
+
+    char *reference = new char[size];
+    CPPUNIT_ASSERT( XrdPosixXrootd::Pread( fd, reference, size, 0 ) == size );
+    return reference;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Asynchronous read test
+//------------------------------------------------------------------------------
+void PosixTest::AsyncReadTest()
+{
+  XrdCl::Log *log = TestEnv::GetLog();
+  ReadRun     run;
+  int         size;
+
+  run.reference = OpenReference( run.fd, size );
+  run.blocks    = size / BlockSize;
+
+  //----------------------------------------------------------------------------
+  // Read with a single outstanding request and with many of them. Each read
+  // is checked against the reference; the rates depend on the machine, so
+  // they are only logged
+  //----------------------------------------------------------------------------
+  double iops1  = ReadAtDepth( run, 1, 2000 );
+  CPPUNIT_ASSERT( run.failed == 0 );
+  double iops64 = ReadAtDepth( run, 64, 20000 );
+  CPPUNIT_ASSERT( run.failed == 0 );
+
+  log->Info( 1, "Async pread IOPS: %.0f at depth 1, %.0f at depth 64",
+             iops1, iops64 );
+
+  //----------------------------------------------------------------------------
+  // Errors are reported through the callback
+  //----------------------------------------------------------------------------
+  Waiter w;
+  char   buffer[BlockSize];
+  XrdPosixXrootd::Pread( 12345, buffer, BlockSize, 0, &w );
+  CPPUNIT_ASSERT( w.Wait() == -EBADF );
+
+  CPPUNIT_ASSERT( XrdPosixXrootd::Close( run.fd ) == 0 );
+  delete [] run.reference;
+}
+
+//------------------------------------------------------------------------------
+// Asynchronous vector read test
+//------------------------------------------------------------------------------
+void PosixTest::AsyncVectorReadTest()
+{
+  int   fd, size;
+  char *reference = OpenReference( fd, size );
+
+  const int    chunks = 64;
+  XrdOucIOVec  readV[chunks];
+  char        *buffer = new char[chunks*BlockSize];
+  int          blocks = size / BlockSize;
+
+  for( int i = 0; i < chunks; ++i )
+  {
+    readV[i].offset = ((i * 7919LL) % blocks) * BlockSize;
+    readV[i].size   = BlockSize;
+    readV[i].info   = 0;
+    readV[i].data   = buffer + i*BlockSize;
+  }
+
+  Waiter w;
+  XrdPosixXrootd::VRead( fd, readV, chunks, &w );
+  CPPUNIT_ASSERT( w.Wait() == chunks*BlockSize );
+
+  for( int i = 0; i < chunks; ++i )
+    CPPUNIT_ASSERT( !memcmp( readV[i].data, reference + readV[i].offset,
+                             BlockSize ) );
+
+  CPPUNIT_ASSERT( XrdPosixXrootd::Close( fd ) == 0 );
+  delete [] buffer;
+  delete [] reference;
+}
+
+//------------------------------------------------------------------------------
+// Asynchronous write test
+//------------------------------------------------------------------------------
+void PosixTest::AsyncWriteTest()
+{
+  XrdCl::Env *testEnv = TestEnv::GetEnv();
+  std::string address;
+  std::string dataPath;
+
+  CPPUNIT_ASSERT( testEnv->GetString( "MainServerURL", address ) );
+  CPPUNIT_ASSERT( testEnv->GetString( "DataPath", dataPath ) );
+
+  std::string fileUrl = "root://" + address + "/" + dataPath +
+                        "/testPosixAsyncWrite.dat";
+
+  const int size   = 1024*1024;
+  char     *data   = new char[size];
+  char     *buffer = new char[size];
+  CPPUNIT_ASSERT( Utils::GetRandomBytes( data, size ) == size );
+
+  //----------------------------------------------------------------------------
+  // Write the file in two halves and sync it
+  //----------------------------------------------------------------------------
+  int fd = XrdPosixXrootd::Open( fileUrl.c_str(), O_CREAT|O_TRUNC|O_RDWR,
+                                 0644 );
+  CPPUNIT_ASSERT( fd >= 0 );
+
+  Waiter w1, w2;
+  XrdPosixXrootd::Pwrite( fd, data,        size/2, 0,      &w1 );
+  XrdPosixXrootd::Pwrite( fd, data+size/2, size/2, size/2, &w2 );
+  CPPUNIT_ASSERT( w1.Wait() == size/2 );
+  CPPUNIT_ASSERT( w2.Wait() == size/2 );
+
+  XrdPosixXrootd::Fsync( fd, &w1 );
+  CPPUNIT_ASSERT( w1.Wait() == 0 );
+
+  //----------------------------------------------------------------------------
+  // Read it back and clean up
+  //----------------------------------------------------------------------------
+  CPPUNIT_ASSERT( XrdPosixXrootd::Pread( fd, buffer, size, 0 ) == size );
+  CPPUNIT_ASSERT( !memcmp( data, buffer, size ) );
+  CPPUNIT_ASSERT( XrdPosixXrootd::Close( fd ) == 0 );
+  CPPUNIT_ASSERT( XrdPosixXrootd::Unlink( fileUrl.c_str() ) == 0 );
+
+  delete [] data;
+  delete [] buffer;
+}